@@ -0,0 +1,103 @@
+#ifndef SMF_PARSER_H
+#define SMF_PARSER_H
+
+/*
+ * Streaming Standard MIDI File (type 0/1) parser.
+ *
+ * Bytes are pushed in with smf_parser_feed() in pieces of any size, so a file
+ * never has to be in RAM as a whole. Notes of the selected tracks (type 1) or
+ * channels (type 0) become monophonic score_note_t events of up to
+ * SMF_MAX_PARTS parts (PART_A..PART_D), timed in milliseconds through the
+ * tempo map. Tempo changes have to be in the first track, as the standard
+ * requires for type 1 files.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "score_codec.h"
+
+#define SMF_MAX_PARTS           4       // PART_A..PART_D
+#define SMF_MAX_TEMPO_CHANGES   64
+#define SMF_DEFAULT_US_PER_QUARTER 500000   // 120 BPM until the first tempo event
+#define SMF_SOURCE_AUTO         0xFE    // Next unused track/channel that has notes
+#define SMF_SOURCE_NONE         0xFF    // Part stays empty
+#define SMF_DRUM_CHANNEL        9       // MIDI channel 10, skipped by SMF_SOURCE_AUTO
+
+typedef enum {
+    SMF_OK = 0,
+    SMF_ERR_FORMAT,         // Not a valid SMF
+    SMF_ERR_UNSUPPORTED,    // Type 2 files
+    SMF_ERR_TRUNCATED,      // smf_parser_finish() before the last track ended
+} smf_result_t;
+
+typedef enum {
+    SMF_MAP_AUTO = 0,       // Tracks for type 1, channels for type 0
+    SMF_MAP_TRACKS,
+    SMF_MAP_CHANNELS,
+} smf_map_mode_t;
+
+typedef struct {
+    smf_map_mode_t mode;
+    uint8_t part_source[SMF_MAX_PARTS];  // Track index / channel per part, or SMF_SOURCE_*
+} smf_config_t;
+
+// Output of one part, events go into the caller's buffer
+typedef struct {
+    score_note_t* events;
+    uint16_t capacity;
+    uint16_t count;
+    bool overflow;          // Events were dropped because the buffer was full
+    uint16_t source;        // Track/channel feeding this part (0xFFFF = none yet)
+    // Conversion state
+    bool sounding;
+    uint8_t note;
+    uint32_t on_ms;
+    uint32_t end_ms;        // End of the last note (where the next gap starts)
+} smf_part_t;
+
+typedef struct {
+    uint32_t tick;
+    uint32_t us_per_quarter;
+    uint64_t start_us;
+} smf_tempo_t;
+
+typedef struct {
+    smf_config_t config;
+    smf_part_t parts[SMF_MAX_PARTS];
+
+    // Header
+    uint16_t format;
+    uint16_t track_count;
+    uint16_t division;
+    smf_tempo_t tempo[SMF_MAX_TEMPO_CHANGES];
+    uint8_t tempo_count;
+
+    // Stream state
+    uint8_t state;
+    uint8_t buf[8];
+    uint8_t buf_len;
+    uint8_t need;           // Bytes still to collect into buf
+    uint32_t skip;          // Event bytes to drop (sysex, long meta events)
+    uint32_t varint;
+    uint8_t varint_bytes;
+    uint32_t chunk_remaining;
+    bool in_track;
+    uint16_t track_index;
+    uint16_t tracks_done;
+    uint32_t tick;
+    uint8_t running_status;
+    uint8_t meta_type;
+    smf_result_t error;
+} smf_parser_t;
+
+void smf_parser_init(smf_parser_t* parser, const smf_config_t* config);
+void smf_parser_set_part_buffer(smf_parser_t* parser, uint8_t part, score_note_t* events, uint16_t capacity);
+smf_result_t smf_parser_feed(smf_parser_t* parser, const uint8_t* data, size_t len);
+smf_result_t smf_parser_finish(smf_parser_t* parser);
+
+// Initial tempo of the file in BPM (for orchestra_song_t.tempo_bpm)
+uint8_t smf_parser_tempo_bpm(const smf_parser_t* parser);
+const char* smf_result_name(smf_result_t result);
+
+#endif // SMF_PARSER_H
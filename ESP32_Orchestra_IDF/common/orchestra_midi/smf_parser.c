@@ -0,0 +1,462 @@
+/*
+ * Streaming Standard MIDI File Parser
+ * อ่าน SMF ทีละ byte (state machine) แปลงเวลาแบบ tick เป็น ms ผ่าน tempo map
+ * และแยกโน๊ตเป็น part (PART_A..PART_D) ตาม track หรือ channel
+ */
+
+#include <string.h>
+#include "smf_parser.h"
+
+enum {
+    ST_CHUNK_HEADER = 0,    // "MThd"/"MTrk" + 32-bit length
+    ST_HEADER_BODY,
+    ST_SKIP_CHUNK,          // Unknown chunk or header bytes we do not use
+    ST_DELTA,
+    ST_STATUS,
+    ST_DATA,
+    ST_META_TYPE,
+    ST_EVENT_LEN,
+    ST_EVENT_DATA,
+    ST_ERROR,
+};
+
+#define META_TEMPO          0x51
+#define NO_SOURCE           0xFFFF
+
+static void fail(smf_parser_t* p, smf_result_t error) {
+    p->error = error;
+    p->state = ST_ERROR;
+}
+
+void smf_parser_init(smf_parser_t* parser, const smf_config_t* config) {
+    memset(parser, 0, sizeof(*parser));
+    if (config) {
+        parser->config = *config;
+    } else {
+        for (int i = 0; i < SMF_MAX_PARTS; i++) {
+            parser->config.part_source[i] = SMF_SOURCE_AUTO;
+        }
+    }
+    for (int i = 0; i < SMF_MAX_PARTS; i++) {
+        parser->parts[i].source = NO_SOURCE;
+    }
+    parser->tempo[0].us_per_quarter = SMF_DEFAULT_US_PER_QUARTER;
+    parser->tempo_count = 1;
+    parser->state = ST_CHUNK_HEADER;
+}
+
+void smf_parser_set_part_buffer(smf_parser_t* parser, uint8_t part, score_note_t* events, uint16_t capacity) {
+    if (part < SMF_MAX_PARTS) {
+        parser->parts[part].events = events;
+        parser->parts[part].capacity = capacity;
+        parser->parts[part].count = 0;
+    }
+}
+
+// ---- Timing ----
+
+static uint64_t tick_to_us(const smf_parser_t* p, uint32_t tick) {
+    if (p->division & 0x8000) {
+        // SMPTE: frames per second (negative, 29 = 29.97 drop frame) x ticks per frame
+        int fps = -(int8_t)(p->division >> 8);
+        uint32_t ticks_per_frame = p->division & 0xFF;
+        if (fps <= 0 || ticks_per_frame == 0) {
+            return 0;
+        }
+        if (fps == 29) {
+            return (uint64_t)tick * 1001000000ULL / (30000ULL * ticks_per_frame);
+        }
+        return (uint64_t)tick * 1000000ULL / ((uint64_t)fps * ticks_per_frame);
+    }
+
+    const smf_tempo_t* t = &p->tempo[0];
+    for (uint8_t i = 1; i < p->tempo_count && p->tempo[i].tick <= tick; i++) {
+        t = &p->tempo[i];
+    }
+    return t->start_us + (uint64_t)(tick - t->tick) * t->us_per_quarter / p->division;
+}
+
+static uint32_t tick_to_ms(const smf_parser_t* p, uint32_t tick) {
+    return (uint32_t)((tick_to_us(p, tick) + 500) / 1000);
+}
+
+static void add_tempo(smf_parser_t* p, uint32_t us_per_quarter) {
+    if (us_per_quarter == 0) {
+        return;
+    }
+    smf_tempo_t* last = &p->tempo[p->tempo_count - 1];
+    if (last->tick == p->tick) {
+        last->us_per_quarter = us_per_quarter;
+        return;
+    }
+    if (p->tick < last->tick || p->tempo_count >= SMF_MAX_TEMPO_CHANGES) {
+        return;
+    }
+    smf_tempo_t* next = &p->tempo[p->tempo_count];
+    next->start_us = tick_to_us(p, p->tick);
+    next->tick = p->tick;
+    next->us_per_quarter = us_per_quarter;
+    p->tempo_count++;
+}
+
+// ---- Part output (monophonic: a new note cuts the sounding one) ----
+
+static void emit(smf_part_t* part, uint8_t note) {
+    if (part->count >= part->capacity) {
+        part->overflow = true;
+        return;
+    }
+    part->events[part->count].note = note;
+    part->events[part->count].duration_ms = 0;
+    part->events[part->count].delay_ms = 0;
+    part->count++;
+}
+
+// Silence before the next note goes into the delay of the previous event,
+// rests are inserted where the 16-bit delay is not enough
+static void add_gap(smf_part_t* part, uint32_t gap_ms) {
+    while (gap_ms > 0 && !part->overflow) {
+        score_note_t* last = part->count ? &part->events[part->count - 1] : NULL;
+        if (last && last->delay_ms < UINT16_MAX) {
+            uint32_t take = UINT16_MAX - last->delay_ms;
+            if (take > gap_ms) {
+                take = gap_ms;
+            }
+            last->delay_ms += take;
+            gap_ms -= take;
+        } else {
+            emit(part, 0); // NOTE_REST
+        }
+    }
+}
+
+static void note_end(smf_part_t* part, uint32_t time_ms) {
+    if (!part->sounding) {
+        return;
+    }
+    uint32_t duration_ms = time_ms - part->on_ms;
+    if (duration_ms > UINT16_MAX) {
+        duration_ms = UINT16_MAX;
+    }
+    part->events[part->count - 1].duration_ms = (uint16_t)duration_ms;
+    part->end_ms = part->on_ms + duration_ms;
+    part->sounding = false;
+}
+
+static void note_start(smf_part_t* part, uint8_t note, uint32_t time_ms) {
+    if (part->overflow) {
+        return;
+    }
+    if (part->sounding) {
+        note_end(part, time_ms);
+    }
+    if (time_ms < part->end_ms) {
+        return; // Source went back in time (channel spread over several tracks)
+    }
+    add_gap(part, time_ms - part->end_ms);
+    emit(part, note);
+    if (!part->overflow) {
+        part->sounding = true;
+        part->note = note;
+        part->on_ms = time_ms;
+    }
+}
+
+// Part fed by a track/channel - assigned on the first note of that source
+static int resolve_part(smf_parser_t* p, uint16_t source, uint8_t channel, bool assign) {
+    for (int i = 0; i < SMF_MAX_PARTS; i++) {
+        if (p->parts[i].source == source) {
+            return i;
+        }
+    }
+    if (!assign) {
+        return -1;
+    }
+    for (int i = 0; i < SMF_MAX_PARTS; i++) {
+        if (p->parts[i].source == NO_SOURCE && p->config.part_source[i] == source) {
+            p->parts[i].source = source;
+            return i;
+        }
+    }
+    if (channel == SMF_DRUM_CHANNEL) {
+        return -1; // Unpitched, only played if mapped explicitly
+    }
+    for (int i = 0; i < SMF_MAX_PARTS; i++) {
+        if (p->parts[i].source == NO_SOURCE && p->config.part_source[i] == SMF_SOURCE_AUTO) {
+            p->parts[i].source = source;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool map_by_tracks(const smf_parser_t* p) {
+    if (p->config.mode == SMF_MAP_AUTO) {
+        return p->format == 1;
+    }
+    return p->config.mode == SMF_MAP_TRACKS;
+}
+
+static void channel_event(smf_parser_t* p) {
+    uint8_t type = p->running_status & 0xF0;
+    uint8_t channel = p->running_status & 0x0F;
+    bool note_on = (type == 0x90 && p->buf[1] > 0);
+    bool note_off = (type == 0x80 || (type == 0x90 && p->buf[1] == 0));
+    if (!note_on && !note_off) {
+        return;
+    }
+
+    uint16_t source = map_by_tracks(p) ? p->track_index : channel;
+    int index = resolve_part(p, source, channel, note_on);
+    if (index < 0 || p->parts[index].events == NULL) {
+        return;
+    }
+
+    smf_part_t* part = &p->parts[index];
+    uint32_t time_ms = tick_to_ms(p, p->tick);
+    if (note_on) {
+        note_start(part, p->buf[0], time_ms);
+    } else if (part->sounding && part->note == p->buf[0]) {
+        note_end(part, time_ms);
+    }
+}
+
+static void end_track(smf_parser_t* p) {
+    uint32_t time_ms = tick_to_ms(p, p->tick);
+    for (int i = 0; i < SMF_MAX_PARTS; i++) {
+        smf_part_t* part = &p->parts[i];
+        if (part->sounding && (!map_by_tracks(p) || part->source == p->track_index)) {
+            note_end(part, time_ms);
+        }
+    }
+    p->in_track = false;
+    p->track_index++;
+    p->tracks_done++;
+}
+
+// ---- Byte-level state machine ----
+
+static uint32_t read_be32(const uint8_t* b) {
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static void start_chunk(smf_parser_t* p) {
+    p->chunk_remaining = read_be32(&p->buf[4]);
+    p->buf_len = 0;
+
+    if (memcmp(p->buf, "MThd", 4) == 0) {
+        if (p->chunk_remaining < 6) {
+            fail(p, SMF_ERR_FORMAT);
+            return;
+        }
+        p->state = ST_HEADER_BODY;
+    } else if (memcmp(p->buf, "MTrk", 4) == 0) {
+        if (p->division == 0) {
+            fail(p, SMF_ERR_FORMAT); // Track before the header
+            return;
+        }
+        p->in_track = true;
+        p->tick = 0;
+        p->running_status = 0;
+        p->varint = 0;
+        p->varint_bytes = 0;
+        p->state = ST_DELTA;
+    } else {
+        p->state = ST_SKIP_CHUNK;
+    }
+
+    if (p->chunk_remaining == 0) {
+        if (p->in_track) {
+            end_track(p);
+        }
+        p->state = ST_CHUNK_HEADER;
+    }
+}
+
+static void parse_header(smf_parser_t* p) {
+    p->format = ((uint16_t)p->buf[0] << 8) | p->buf[1];
+    p->track_count = ((uint16_t)p->buf[2] << 8) | p->buf[3];
+    p->division = ((uint16_t)p->buf[4] << 8) | p->buf[5];
+
+    if (p->format == 2) {
+        fail(p, SMF_ERR_UNSUPPORTED);
+    } else if (p->format > 2 || p->division == 0) {
+        fail(p, SMF_ERR_FORMAT);
+    } else {
+        p->state = ST_SKIP_CHUNK;
+    }
+}
+
+// Returns true once the varint is complete (value in p->varint)
+static bool varint_byte(smf_parser_t* p, uint8_t b) {
+    p->varint = (p->varint << 7) | (b & 0x7F);
+    if (b & 0x80) {
+        if (++p->varint_bytes >= 4) {
+            fail(p, SMF_ERR_FORMAT);
+        }
+        return false;
+    }
+    p->varint_bytes = 0;
+    return true;
+}
+
+static uint8_t channel_data_len(uint8_t status) {
+    uint8_t type = status & 0xF0;
+    return (type == 0xC0 || type == 0xD0) ? 1 : 2;
+}
+
+static void finish_event(smf_parser_t* p) {
+    if (p->meta_type == META_TEMPO && p->buf_len == 3 && p->track_index == 0) {
+        add_tempo(p, ((uint32_t)p->buf[0] << 16) | ((uint32_t)p->buf[1] << 8) | p->buf[2]);
+    }
+    p->state = ST_DELTA;
+}
+
+static void track_byte(smf_parser_t* p, uint8_t b) {
+    switch (p->state) {
+        case ST_DELTA:
+            if (varint_byte(p, b)) {
+                p->tick += p->varint;
+                p->varint = 0;
+                p->state = ST_STATUS;
+            }
+            break;
+
+        case ST_STATUS:
+            if (b == 0xFF) {
+                p->running_status = 0;
+                p->state = ST_META_TYPE;
+            } else if (b == 0xF0 || b == 0xF7) {
+                p->running_status = 0;
+                p->meta_type = 0; // Sysex: length + data, all skipped
+                p->state = ST_EVENT_LEN;
+            } else if (b >= 0xF0) {
+                fail(p, SMF_ERR_FORMAT);
+            } else if (b & 0x80) {
+                p->running_status = b;
+                p->buf_len = 0;
+                p->need = channel_data_len(b);
+                p->state = ST_DATA;
+            } else if (p->running_status) {
+                p->buf[0] = b;
+                p->buf_len = 1;
+                p->need = channel_data_len(p->running_status);
+                if (p->buf_len == p->need) {
+                    channel_event(p);
+                    p->state = ST_DELTA;
+                } else {
+                    p->state = ST_DATA;
+                }
+            } else {
+                fail(p, SMF_ERR_FORMAT); // Data byte without running status
+            }
+            break;
+
+        case ST_DATA:
+            p->buf[p->buf_len++] = b;
+            if (p->buf_len == p->need) {
+                channel_event(p);
+                p->state = ST_DELTA;
+            }
+            break;
+
+        case ST_META_TYPE:
+            p->meta_type = b;
+            p->varint = 0;
+            p->state = ST_EVENT_LEN;
+            break;
+
+        case ST_EVENT_LEN:
+            if (varint_byte(p, b)) {
+                // Only the first 3 bytes of a meta event matter (tempo)
+                uint32_t len = p->varint;
+                p->need = p->meta_type == 0 ? 0 : (len < 3 ? (uint8_t)len : 3);
+                p->skip = len - p->need;
+                p->buf_len = 0;
+                p->varint = 0;
+                if (len == 0) {
+                    finish_event(p);
+                } else {
+                    p->state = ST_EVENT_DATA;
+                }
+            }
+            break;
+
+        case ST_EVENT_DATA:
+            if (p->buf_len < p->need) {
+                p->buf[p->buf_len++] = b;
+            } else {
+                p->skip--;
+            }
+            if (p->buf_len == p->need && p->skip == 0) {
+                finish_event(p);
+            }
+            break;
+    }
+}
+
+smf_result_t smf_parser_feed(smf_parser_t* p, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len && p->state != ST_ERROR; i++) {
+        uint8_t b = data[i];
+
+        if (p->state == ST_CHUNK_HEADER) {
+            p->buf[p->buf_len++] = b;
+            if (p->buf_len == 8) {
+                start_chunk(p);
+            }
+            continue;
+        }
+
+        if (p->state == ST_HEADER_BODY) {
+            p->buf[p->buf_len++] = b;
+            if (p->buf_len == 6) {
+                parse_header(p);
+            }
+        } else if (p->in_track) {
+            track_byte(p, b);
+        }
+
+        // Chunk length decides where the next chunk starts, even after a bad event
+        if (--p->chunk_remaining == 0 && p->state != ST_ERROR) {
+            if (p->in_track) {
+                end_track(p);
+            }
+            p->buf_len = 0;
+            p->state = ST_CHUNK_HEADER;
+        }
+    }
+    return p->error;
+}
+
+smf_result_t smf_parser_finish(smf_parser_t* p) {
+    if (p->error != SMF_OK) {
+        return p->error;
+    }
+    // Close what was read so far, the notes are still usable
+    bool truncated = p->in_track || p->buf_len != 0;
+    if (p->in_track) {
+        end_track(p);
+    }
+    if (truncated || p->division == 0 || p->tracks_done < p->track_count) {
+        return SMF_ERR_TRUNCATED;
+    }
+    return SMF_OK;
+}
+
+uint8_t smf_parser_tempo_bpm(const smf_parser_t* parser) {
+    uint32_t bpm = (60000000UL + parser->tempo[0].us_per_quarter / 2) / parser->tempo[0].us_per_quarter;
+    if (bpm < 1) {
+        bpm = 1;
+    }
+    return bpm > 255 ? 255 : (uint8_t)bpm;
+}
+
+const char* smf_result_name(smf_result_t result) {
+    switch (result) {
+        case SMF_OK:              return "OK";
+        case SMF_ERR_FORMAT:      return "invalid MIDI file";
+        case SMF_ERR_UNSUPPORTED: return "unsupported MIDI format (type 2)";
+        case SMF_ERR_TRUNCATED:   return "MIDI file truncated";
+    }
+    return "unknown";
+}
@@ -0,0 +1,18 @@
+#ifndef FRAME_CRC_H
+#define FRAME_CRC_H
+
+/*
+ * Frame CRC - CRC-16 ของทุก ESP-NOW frame (แทน checksum แบบบวก byte)
+ * CRC-16/X-25: poly 0x1021 (reflected 0x8408), init/xorout 0xFFFF, check("123456789") = 0x906E
+ * บน ESP32 ใช้ esp_rom_crc16_le() ใน ROM, บน host ใช้ table 256 ค่า (ผลเท่ากัน)
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FRAME_CRC16_CHECK   0x906E  // frame_crc16(0, "123456789", 9)
+
+// crc = 0 to start, or the result of the previous call to continue over more bytes
+uint16_t frame_crc16(uint16_t crc, const void* data, size_t len);
+
+#endif // FRAME_CRC_H
@@ -0,0 +1,30 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+/*
+ * Latency histogram - นับเวลา (us หรือ ns) ลง bucket แบบ log: 4 bucket ต่อ 2 เท่า (ผิดไม่เกิน 25%)
+ * ขนาดคงที่ ไม่มี malloc ใช้ได้ทั้งใน callback ของ firmware และ host tools ไม่มี dependency กับ ESP-IDF
+ * percentile ตอบขอบบนของ bucket (ไม่เกิน max ที่เคยเห็น)
+ */
+
+#include <stdint.h>
+
+#define LATENCY_HIST_SUB_BUCKETS    4
+#define LATENCY_HIST_BUCKETS        (LATENCY_HIST_SUB_BUCKETS * 31)     // Up to UINT32_MAX
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;               // 0 when empty
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+void latency_hist_reset(latency_hist_t* hist);
+void latency_hist_add(latency_hist_t* hist, uint32_t value);
+
+// per_mille: 500 = median, 990 = p99 (0 when empty)
+uint32_t latency_hist_percentile(const latency_hist_t* hist, uint32_t per_mille);
+uint32_t latency_hist_mean(const latency_hist_t* hist);
+
+#endif // LATENCY_HIST_H
@@ -0,0 +1,77 @@
+#ifndef NOTE_FEC_H
+#define NOTE_FEC_H
+
+/*
+ * Note FEC - ส่งโน๊ตซ้ำ (redundancy) แทน XOR parity
+ * โน๊ตที่ส่งไปแล้วติดไปกับ depth batch ถัดไปอีกครั้ง ถ้ายังไม่ถึงเวลาเล่น และถ้าไม่มี batch ใหม่
+ * ภายใน NOTE_FEC_REPEAT_MS ก็ส่ง frame ที่มีแต่โน๊ตซ้ำ (เพลงช้าโน๊ตห่างกว่า look-ahead)
+ * frame ไหนหาย copy ถัดไปยังทัน ไม่ต้องรอ frame ครบกลุ่มแบบ parity
+ * ฝั่งรับตัดโน๊ตซ้ำด้วย (start time, part, note) ไม่มี dependency กับ ESP-IDF
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NOTE_FEC_MAX_DEPTH      3       // Extra copies of every note
+#define NOTE_FEC_REPEAT_MS      30      // Repeat-only frame when no batch went out this long
+#define NOTE_FEC_MAX_PENDING    64      // Notes the sender still has to repeat
+#define NOTE_FEC_DEDUP_SIZE     64      // Notes the receiver remembers
+
+typedef struct {
+    uint32_t start_ms;          // Conductor time
+    uint16_t duration_ms;
+    uint8_t part_id;
+    uint8_t note;
+    uint8_t velocity;
+} fec_note_t;
+
+typedef struct {
+    fec_note_t note;
+    uint8_t repeats_left;
+} fec_pending_t;
+
+typedef struct {
+    uint8_t depth;              // 0 = off
+    uint8_t count;
+    fec_pending_t pending[NOTE_FEC_MAX_PENDING];  // Oldest first
+    uint32_t repeated;          // Notes sent again
+    uint32_t overflows;         // New notes that found the list full (sent once only)
+} note_fec_encoder_t;
+
+typedef struct {
+    uint32_t start_ms;
+    uint8_t part_id;
+    uint8_t note;
+} fec_note_key_t;
+
+typedef struct {
+    uint8_t next;
+    uint8_t count;
+    fec_note_key_t seen[NOTE_FEC_DEDUP_SIZE];
+    uint32_t accepted;
+    uint32_t duplicates;        // Copies of notes already scheduled
+} note_fec_decoder_t;
+
+// Encoder (conductor). depth is clamped to NOTE_FEC_MAX_DEPTH.
+void note_fec_encoder_init(note_fec_encoder_t* encoder, uint8_t depth);
+
+// New notes a frame may carry so the repeated ones still fit in max_notes
+size_t note_fec_new_notes_limit(const note_fec_encoder_t* encoder, size_t max_notes);
+
+// Copy notes sent before that start at or after not_before_ms and still have repeats left
+// (earliest first), notes already played or repeated depth times are forgotten
+size_t note_fec_encoder_repeat(note_fec_encoder_t* encoder, fec_note_t* out, size_t max,
+                               uint32_t not_before_ms);
+
+// Remember the new notes of the batch just sent (call after note_fec_encoder_repeat)
+void note_fec_encoder_push(note_fec_encoder_t* encoder, const fec_note_t* notes, size_t count);
+
+// Something left to repeat that has not started by now_ms (worth a repeat-only frame)
+bool note_fec_encoder_pending(const note_fec_encoder_t* encoder, uint32_t now_ms);
+
+// Decoder (musician): true the first time a note is seen
+void note_fec_decoder_init(note_fec_decoder_t* decoder);
+bool note_fec_decoder_accept(note_fec_decoder_t* decoder, const fec_note_t* note);
+
+#endif // NOTE_FEC_H
@@ -0,0 +1,80 @@
+#ifndef RELIABLE_CTRL_H
+#define RELIABLE_CTRL_H
+
+/*
+ * Reliable Control - sequence number, ACK ต่อ musician, ส่งซ้ำแบบจำกัดครั้ง และตัด duplicate
+ * ใช้กับข้อความควบคุม (MSG_SONG_START / MSG_SONG_END) เท่านั้น โน๊ตยังเป็น best-effort
+ * ไม่มี dependency กับ ESP-IDF และไม่ส่งเอง: ผู้เรียกส่ง frame และล็อกเอง (host tools จำลอง link ได้)
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define RELIABLE_SEQ_NONE       0       // Best-effort frame, never acknowledged
+#define RELIABLE_MAX_PENDING    4       // Control messages waiting for ACKs at once
+#define RELIABLE_MAX_FRAME      32      // Bytes kept for retransmission
+#define RELIABLE_RETRY_MS       20      // First retransmission, doubles every attempt
+#define RELIABLE_RETRY_MAX_MS   160
+#define RELIABLE_MAX_ATTEMPTS   6       // Transmissions per message (20+40+80+160+160 ms = 460 ms)
+#define RELIABLE_WINDOW         32      // Receiver remembers this many sequence numbers
+
+typedef struct {
+    bool in_use;
+    uint16_t sequence;
+    uint32_t pending_mask;      // Bit n = musician n has not acknowledged yet
+    uint8_t attempts;           // Transmissions so far
+    uint32_t next_retry_ms;
+    uint8_t len;
+    uint8_t frame[RELIABLE_MAX_FRAME];
+} reliable_slot_t;
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t retransmits;
+    uint32_t completed;         // Every expected musician acknowledged
+    uint32_t expired;           // Gave up after RELIABLE_MAX_ATTEMPTS
+    uint32_t cancelled;
+    uint32_t acks;
+    uint32_t stale_acks;        // Unknown sequence, duplicate or unexpected musician
+    uint32_t last_expired_mask; // Musicians that never answered the last expired message
+} reliable_sender_stats_t;
+
+typedef struct {
+    uint16_t next_sequence;
+    reliable_slot_t slots[RELIABLE_MAX_PENDING];
+    reliable_sender_stats_t stats;
+} reliable_sender_t;
+
+typedef struct {
+    bool has_last;
+    uint16_t last_sequence;     // Newest sequence accepted
+    uint32_t window;            // Bit n = last_sequence - n already seen
+    uint32_t accepted;
+    uint32_t duplicates;
+} reliable_receiver_t;
+
+// Sender (conductor). first_sequence: random at boot, so a restarted conductor does not
+// look like a replay to musicians that still remember the old numbers.
+void reliable_sender_init(reliable_sender_t* sender, uint16_t first_sequence);
+uint16_t reliable_sender_next_sequence(reliable_sender_t* sender);  // Never RELIABLE_SEQ_NONE
+
+// Track a frame that already carries `sequence`; the caller sends it the first time.
+// expected_mask = musicians that must ACK (0 = nobody known, nothing to track).
+bool reliable_sender_submit(reliable_sender_t* sender, const void* frame, size_t len,
+                            uint16_t sequence, uint32_t expected_mask, uint32_t now_ms);
+bool reliable_sender_ack(reliable_sender_t* sender, uint8_t musician_id, uint16_t sequence);
+void reliable_sender_cancel_all(reliable_sender_t* sender);
+
+// Copy the next frame that is due for retransmission into out, 0 = none due.
+// Call until it returns 0, sending each frame. Messages out of attempts are dropped here.
+size_t reliable_sender_poll(reliable_sender_t* sender, uint32_t now_ms, void* out, size_t out_size);
+uint32_t reliable_sender_next_due_ms(const reliable_sender_t* sender, uint32_t now_ms);  // UINT32_MAX = idle
+bool reliable_sender_busy(const reliable_sender_t* sender);
+
+// Receiver (musician): true the first time a sequence is seen. ACK every copy anyway -
+// the conductor may have missed the previous ACK.
+void reliable_receiver_init(reliable_receiver_t* receiver);
+bool reliable_receiver_accept(reliable_receiver_t* receiver, uint16_t sequence);
+
+#endif // RELIABLE_CTRL_H
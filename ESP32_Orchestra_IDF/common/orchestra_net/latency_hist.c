@@ -0,0 +1,67 @@
+/*
+ * Latency Histogram Implementation
+ * Bucket = (ตำแหน่ง bit สูงสุด, 2 bit ถัดไป): ค่า 0-3 ได้ bucket ของตัวเอง
+ */
+
+#include <string.h>
+#include "latency_hist.h"
+
+static unsigned bucket_of(uint32_t value) {
+    if (value < LATENCY_HIST_SUB_BUCKETS) {
+        return value;
+    }
+    unsigned msb = 31u - (unsigned)__builtin_clz(value);
+    unsigned sub = (value >> (msb - 2)) & (LATENCY_HIST_SUB_BUCKETS - 1);
+    return (msb - 1) * LATENCY_HIST_SUB_BUCKETS + sub;
+}
+
+// Largest value that lands in the bucket
+static uint32_t bucket_top(unsigned bucket) {
+    if (bucket < LATENCY_HIST_SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned msb = bucket / LATENCY_HIST_SUB_BUCKETS + 1;
+    unsigned sub = bucket % LATENCY_HIST_SUB_BUCKETS;
+    uint64_t low = (uint64_t)(LATENCY_HIST_SUB_BUCKETS + sub) << (msb - 2);
+    return (uint32_t)(low + (1ull << (msb - 2)) - 1);
+}
+
+void latency_hist_reset(latency_hist_t* hist) {
+    memset(hist, 0, sizeof(*hist));
+}
+
+void latency_hist_add(latency_hist_t* hist, uint32_t value) {
+    hist->buckets[bucket_of(value)]++;
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t* hist, uint32_t per_mille) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    // Nearest rank
+    uint64_t rank = ((uint64_t)hist->count * per_mille + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < LATENCY_HIST_BUCKETS; bucket++) {
+        seen += hist->buckets[bucket];
+        if (seen >= rank) {
+            uint32_t top = bucket_top(bucket);
+            return top < hist->max ? top : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+uint32_t latency_hist_mean(const latency_hist_t* hist) {
+    return hist->count ? (uint32_t)(hist->sum / hist->count) : 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Note FEC Implementation
+ * Encoder เก็บโน๊ตที่ยังต้องส่งซ้ำพร้อมจำนวนครั้งที่เหลือ, decoder จำโน๊ตที่ schedule แล้ว (ring)
+ */
+
+#include <string.h>
+#include "note_fec.h"
+
+static bool not_started(const fec_note_t* note, uint32_t now_ms) {
+    return (int32_t)(note->start_ms - now_ms) >= 0;
+}
+
+void note_fec_encoder_init(note_fec_encoder_t* encoder, uint8_t depth) {
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->depth = depth > NOTE_FEC_MAX_DEPTH ? NOTE_FEC_MAX_DEPTH : depth;
+}
+
+size_t note_fec_new_notes_limit(const note_fec_encoder_t* encoder, size_t max_notes) {
+    size_t limit = max_notes / (encoder->depth + 1u);
+    return limit > 0 ? limit : 1;
+}
+
+size_t note_fec_encoder_repeat(note_fec_encoder_t* encoder, fec_note_t* out, size_t max,
+                               uint32_t not_before_ms) {
+    size_t count = 0;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < encoder->count; i++) {
+        fec_pending_t entry = encoder->pending[i];
+        if (!not_started(&entry.note, not_before_ms)) {
+            continue;
+        }
+        if (count < max) {
+            out[count++] = entry.note;
+            entry.repeats_left--;
+        }
+        if (entry.repeats_left > 0) {
+            encoder->pending[kept++] = entry;
+        }
+    }
+    encoder->count = kept;
+    encoder->repeated += count;
+    return count;
+}
+
+void note_fec_encoder_push(note_fec_encoder_t* encoder, const fec_note_t* notes, size_t count) {
+    if (encoder->depth == 0) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (encoder->count >= NOTE_FEC_MAX_PENDING) {
+            encoder->overflows += count - i;
+            return;
+        }
+        encoder->pending[encoder->count].note = notes[i];
+        encoder->pending[encoder->count].repeats_left = encoder->depth;
+        encoder->count++;
+    }
+}
+
+bool note_fec_encoder_pending(const note_fec_encoder_t* encoder, uint32_t now_ms) {
+    for (uint8_t i = 0; i < encoder->count; i++) {
+        if (not_started(&encoder->pending[i].note, now_ms)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void note_fec_decoder_init(note_fec_decoder_t* decoder) {
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+bool note_fec_decoder_accept(note_fec_decoder_t* decoder, const fec_note_t* note) {
+    for (uint8_t i = 0; i < decoder->count; i++) {
+        const fec_note_key_t* key = &decoder->seen[i];
+        if (key->start_ms == note->start_ms && key->part_id == note->part_id && key->note == note->note) {
+            decoder->duplicates++;
+            return false;
+        }
+    }
+
+    // Oldest entry goes first - its note has been played long before the last repeat
+    fec_note_key_t* key = &decoder->seen[decoder->next];
+    key->start_ms = note->start_ms;
+    key->part_id = note->part_id;
+    key->note = note->note;
+    decoder->next = (uint8_t)((decoder->next + 1) % NOTE_FEC_DEDUP_SIZE);
+    if (decoder->count < NOTE_FEC_DEDUP_SIZE) {
+        decoder->count++;
+    }
+    decoder->accepted++;
+    return true;
+}
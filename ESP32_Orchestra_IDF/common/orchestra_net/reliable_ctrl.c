@@ -0,0 +1,159 @@
+/*
+ * Reliable Control Implementation
+ * ฝั่งส่งเก็บ frame ไว้จนทุก musician ที่คาดไว้ ACK หรือครบจำนวนครั้ง (backoff เท่าตัว)
+ * ฝั่งรับจำ sequence ล่าสุด RELIABLE_WINDOW ตัว (sliding window แบบ anti-replay)
+ */
+
+#include <string.h>
+#include "reliable_ctrl.h"
+
+void reliable_sender_init(reliable_sender_t* sender, uint16_t first_sequence) {
+    memset(sender, 0, sizeof(*sender));
+    sender->next_sequence = first_sequence;
+}
+
+uint16_t reliable_sender_next_sequence(reliable_sender_t* sender) {
+    if (sender->next_sequence == RELIABLE_SEQ_NONE) {
+        sender->next_sequence++;
+    }
+    return sender->next_sequence++;
+}
+
+static uint32_t retry_delay_ms(uint8_t attempts) {
+    uint32_t delay_ms = RELIABLE_RETRY_MS << (attempts > 1 ? attempts - 1 : 0);
+    return delay_ms > RELIABLE_RETRY_MAX_MS ? RELIABLE_RETRY_MAX_MS : delay_ms;
+}
+
+bool reliable_sender_submit(reliable_sender_t* sender, const void* frame, size_t len,
+                            uint16_t sequence, uint32_t expected_mask, uint32_t now_ms) {
+    if (expected_mask == 0 || len > RELIABLE_MAX_FRAME) {
+        return false;
+    }
+
+    for (int i = 0; i < RELIABLE_MAX_PENDING; i++) {
+        reliable_slot_t* slot = &sender->slots[i];
+        if (slot->in_use) {
+            continue;
+        }
+        slot->in_use = true;
+        slot->sequence = sequence;
+        slot->pending_mask = expected_mask;
+        slot->attempts = 1;     // The caller's own first transmission
+        slot->next_retry_ms = now_ms + retry_delay_ms(1);
+        slot->len = (uint8_t)len;
+        memcpy(slot->frame, frame, len);
+        sender->stats.submitted++;
+        return true;
+    }
+    return false; // Every slot busy - sent once, best-effort
+}
+
+bool reliable_sender_ack(reliable_sender_t* sender, uint8_t musician_id, uint16_t sequence) {
+    if (musician_id < 32) {
+        for (int i = 0; i < RELIABLE_MAX_PENDING; i++) {
+            reliable_slot_t* slot = &sender->slots[i];
+            if (!slot->in_use || slot->sequence != sequence || !(slot->pending_mask & (1UL << musician_id))) {
+                continue;
+            }
+            slot->pending_mask &= ~(1UL << musician_id);
+            sender->stats.acks++;
+            if (slot->pending_mask == 0) {
+                slot->in_use = false;
+                sender->stats.completed++;
+            }
+            return true;
+        }
+    }
+    sender->stats.stale_acks++;
+    return false;
+}
+
+void reliable_sender_cancel_all(reliable_sender_t* sender) {
+    for (int i = 0; i < RELIABLE_MAX_PENDING; i++) {
+        if (sender->slots[i].in_use) {
+            sender->slots[i].in_use = false;
+            sender->stats.cancelled++;
+        }
+    }
+}
+
+size_t reliable_sender_poll(reliable_sender_t* sender, uint32_t now_ms, void* out, size_t out_size) {
+    for (int i = 0; i < RELIABLE_MAX_PENDING; i++) {
+        reliable_slot_t* slot = &sender->slots[i];
+        if (!slot->in_use || (int32_t)(now_ms - slot->next_retry_ms) < 0) {
+            continue;
+        }
+        if (slot->attempts >= RELIABLE_MAX_ATTEMPTS) {
+            slot->in_use = false;
+            sender->stats.expired++;
+            sender->stats.last_expired_mask = slot->pending_mask;
+            continue;
+        }
+        if (slot->len > out_size) {
+            continue;
+        }
+
+        slot->attempts++;
+        slot->next_retry_ms = now_ms + retry_delay_ms(slot->attempts);
+        sender->stats.retransmits++;
+        memcpy(out, slot->frame, slot->len);
+        return slot->len;
+    }
+    return 0;
+}
+
+uint32_t reliable_sender_next_due_ms(const reliable_sender_t* sender, uint32_t now_ms) {
+    uint32_t next_ms = UINT32_MAX;
+    for (int i = 0; i < RELIABLE_MAX_PENDING; i++) {
+        const reliable_slot_t* slot = &sender->slots[i];
+        if (!slot->in_use) {
+            continue;
+        }
+        int32_t due_ms = (int32_t)(slot->next_retry_ms - now_ms);
+        uint32_t wait_ms = due_ms > 0 ? (uint32_t)due_ms : 0;
+        next_ms = wait_ms < next_ms ? wait_ms : next_ms;
+    }
+    return next_ms;
+}
+
+bool reliable_sender_busy(const reliable_sender_t* sender) {
+    for (int i = 0; i < RELIABLE_MAX_PENDING; i++) {
+        if (sender->slots[i].in_use) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void reliable_receiver_init(reliable_receiver_t* receiver) {
+    memset(receiver, 0, sizeof(*receiver));
+}
+
+bool reliable_receiver_accept(reliable_receiver_t* receiver, uint16_t sequence) {
+    if (sequence == RELIABLE_SEQ_NONE) {
+        return true;
+    }
+
+    int16_t ahead = (int16_t)(sequence - receiver->last_sequence);
+    uint16_t behind = (uint16_t)(-ahead);
+    if (!receiver->has_last || ahead > 0 || behind >= RELIABLE_WINDOW) {
+        // Newer, or so far behind that it is a restarted conductor: start over from it
+        if (receiver->has_last && ahead > 0 && ahead < RELIABLE_WINDOW) {
+            receiver->window = (receiver->window << ahead) | 1;
+        } else {
+            receiver->window = 1;
+        }
+        receiver->has_last = true;
+        receiver->last_sequence = sequence;
+        receiver->accepted++;
+        return true;
+    }
+
+    if (receiver->window & (1UL << behind)) {
+        receiver->duplicates++;
+        return false;
+    }
+    receiver->window |= 1UL << behind; // Late but first copy (reordered)
+    receiver->accepted++;
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef SCORE_CODEC_H
+#define SCORE_CODEC_H
+
+/*
+ * Orchestra Score Format (.osc) - compact binary score shared by conductor,
+ * musician and the host tools. Plain C, no ESP-IDF dependencies.
+ *
+ * Layout (version 1, all multi-byte numbers are LEB128 varints):
+ *   "OS" | version | flags | tempo_bpm | part_count | time_unit_ms
+ *   | note_table_len | note_table[] | per part: event_count, stream_len
+ *   | part streams
+ *
+ * Part stream tokens:
+ *   0b0Tnnnnnn  event, n = note table index (63 = escape, index in next byte),
+ *               T = same timing as the previous event, otherwise followed by
+ *               zigzag deltas of duration and delay (in time units)
+ *   0b1lllllll  repeat: copy l+1 earlier events, followed by the distance back
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SCORE_FORMAT_MAGIC_0    'O'
+#define SCORE_FORMAT_MAGIC_1    'S'
+#define SCORE_FORMAT_VERSION    1
+
+#define SCORE_FLAG_RLE          0x01    // Encoder may emit repeat tokens
+#define SCORE_MAX_PARTS         8
+#define SCORE_MAX_NOTE_TABLE    128
+
+// One note or rest (note 0), same layout the song tables use
+typedef struct {
+    uint8_t note;           // MIDI note number (0 = rest)
+    uint16_t duration_ms;   // ความยาวโน๊ต
+    uint16_t delay_ms;      // หน่วงเวลาก่อนโน๊ตถัดไป
+} score_note_t;
+
+// Encoder input: one part
+typedef struct {
+    const score_note_t* events;
+    uint16_t event_count;
+} score_part_src_t;
+
+// Parsed header, the part streams stay in the caller's buffer
+typedef struct {
+    uint8_t version;
+    uint8_t flags;
+    uint8_t tempo_bpm;
+    uint8_t part_count;
+    uint16_t time_unit_ms;
+    uint8_t note_table_len;
+    const uint8_t* note_table;
+    uint16_t event_count[SCORE_MAX_PARTS];
+    const uint8_t* stream[SCORE_MAX_PARTS];
+    uint16_t stream_len[SCORE_MAX_PARTS];
+} score_info_t;
+
+// Encode parts into out. Returns the encoded size, 0 if it does not fit or
+// the input cannot be represented (too many parts or distinct notes).
+size_t score_encode(const score_part_src_t* parts, uint8_t part_count, uint8_t tempo_bpm,
+                    uint8_t flags, uint8_t* out, size_t out_size);
+
+// Validate the header and locate every part stream
+bool score_parse(const uint8_t* data, size_t len, score_info_t* info);
+
+// Decode one part. Returns the number of events, -1 on corrupt data or if
+// the part has more than max_events events.
+int score_decode_part(const score_info_t* info, uint8_t part, score_note_t* out, size_t max_events);
+
+#endif // SCORE_CODEC_H
@@ -0,0 +1,58 @@
+#ifndef SONG_LIBRARY_FORMAT_H
+#define SONG_LIBRARY_FORMAT_H
+
+/*
+ * Song Library Image - เพลงทั้งหมดใน data partition "songs"
+ * Conductor mmap ทั้ง partition แล้วอ่านโน๊ตจาก flash ตรงๆ (ไม่ copy ลง RAM)
+ * สร้างด้วย tools/host/song_packer
+ *
+ *   song_library_header_t      magic, version, CRC และ index[song_id] -> offset
+ *   song_library_song_t ...    ข้อมูลเพลง + ตาราง part
+ *   score_note_t[] ...         โน๊ตของแต่ละ part (layout เดียวกับ note_event_t)
+ *
+ * ทุก field เป็น little-endian, offset นับจากต้น image และ align 4 byte
+ */
+
+#include <stdint.h>
+#include "score_codec.h"
+
+#define SONG_LIBRARY_MAGIC          "OSLB"
+#define SONG_LIBRARY_VERSION        1
+#define SONG_LIBRARY_INDEX_SIZE     256     // song_id 0-255, lookup = index[song_id]
+#define SONG_LIBRARY_NAME_LEN       32      // รวม '\0'
+#define SONG_LIBRARY_PART_NAME_LEN  16      // รวม '\0'
+#define SONG_LIBRARY_ALIGN          4
+
+// Partition in partitions.csv (data, custom subtype)
+#define SONG_LIBRARY_PARTITION_LABEL    "songs"
+#define SONG_LIBRARY_PARTITION_SUBTYPE  0x40
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t song_count;
+    uint32_t image_size;        // Header + records + events
+    uint32_t crc32;             // CRC-32 (zlib) of bytes [sizeof(header), image_size)
+    uint32_t index[SONG_LIBRARY_INDEX_SIZE];  // Offset of song_library_song_t, 0 = no song
+} song_library_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t events_offset;     // score_note_t[event_count]
+    uint16_t event_count;
+    uint16_t reserved;
+    char name[SONG_LIBRARY_PART_NAME_LEN];
+} song_library_part_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t song_id;
+    uint8_t tempo_bpm;
+    uint8_t part_count;
+    uint8_t fec_depth;          // Note FEC depth (was reserved, 0 in older images = off)
+    char name[SONG_LIBRARY_NAME_LEN];
+    song_library_part_t parts[];
+} song_library_song_t;
+
+// The image stores note arrays exactly as the scheduler reads them
+_Static_assert(sizeof(score_note_t) == 6, "score_note_t layout must match the library image");
+
+#endif // SONG_LIBRARY_FORMAT_H
@@ -0,0 +1,337 @@
+/*
+ * Orchestra Score Codec
+ * เข้ารหัส/ถอดรหัส score แบบ binary: ตารางโน๊ต + varint delta ของเวลา + RLE
+ * ของท่อนที่ซ้ำ - ใช้ร่วมกันทั้ง Conductor, Musician และ host tools
+ */
+
+#include <string.h>
+#include "score_codec.h"
+
+#define TOKEN_REPEAT        0x80
+#define TOKEN_SAME_TIMING   0x40
+#define TOKEN_NOTE_MASK     0x3F
+#define NOTE_INDEX_ESCAPE   0x3F    // Index does not fit in 6 bits, next byte holds it
+#define REPEAT_MAX_LEN      128
+#define REPEAT_WINDOW       255     // How far back the encoder looks for repeats
+
+// Byte writer - with buf == NULL it only counts
+typedef struct {
+    uint8_t* buf;
+    size_t size;
+    size_t pos;
+} score_writer_t;
+
+static void put_byte(score_writer_t* w, uint8_t value) {
+    if (w->buf && w->pos < w->size) {
+        w->buf[w->pos] = value;
+    }
+    w->pos++;
+}
+
+static void put_varint(score_writer_t* w, uint32_t value) {
+    while (value >= 0x80) {
+        put_byte(w, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(w, (uint8_t)value);
+}
+
+static size_t varint_len(uint32_t value) {
+    size_t len = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        len++;
+    }
+    return len;
+}
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static bool get_varint(const uint8_t* data, size_t len, size_t* pos, uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*pos >= len) {
+            return false;
+        }
+        uint8_t byte = data[(*pos)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint16_t gcd16(uint16_t a, uint16_t b) {
+    while (b) {
+        uint16_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static bool same_event(const score_note_t* a, const score_note_t* b) {
+    return a->note == b->note && a->duration_ms == b->duration_ms && a->delay_ms == b->delay_ms;
+}
+
+// Encoder state shared by the helpers below
+typedef struct {
+    uint8_t note_index[256];    // MIDI note -> table index + 1 (0 = not in table)
+    uint16_t time_unit_ms;
+} encode_ctx_t;
+
+// Literal event, timing is relative to *prev_dur / *prev_delay (in time units)
+static void put_event(score_writer_t* w, const encode_ctx_t* ctx, const score_note_t* event,
+                      int32_t* prev_dur, int32_t* prev_delay) {
+    uint8_t index = ctx->note_index[event->note] - 1;
+    int32_t dur = event->duration_ms / ctx->time_unit_ms;
+    int32_t delay = event->delay_ms / ctx->time_unit_ms;
+    bool same_timing = (dur == *prev_dur && delay == *prev_delay);
+
+    uint8_t token = (same_timing ? TOKEN_SAME_TIMING : 0) |
+                    (index < NOTE_INDEX_ESCAPE ? index : NOTE_INDEX_ESCAPE);
+    put_byte(w, token);
+    if (index >= NOTE_INDEX_ESCAPE) {
+        put_byte(w, index);
+    }
+    if (!same_timing) {
+        put_varint(w, zigzag(dur - *prev_dur));
+        put_varint(w, zigzag(delay - *prev_delay));
+    }
+    *prev_dur = dur;
+    *prev_delay = delay;
+}
+
+// Longest earlier run equal to events[i..], the run may overlap position i
+static uint16_t find_repeat(const score_part_src_t* part, uint16_t i, uint16_t* distance) {
+    uint16_t best_len = 0;
+    uint16_t start = i > REPEAT_WINDOW ? i - REPEAT_WINDOW : 0;
+
+    for (uint16_t j = i; j-- > start;) {
+        uint16_t len = 0;
+        while (i + len < part->event_count && len < REPEAT_MAX_LEN &&
+               same_event(&part->events[j + len], &part->events[i + len])) {
+            len++;
+        }
+        if (len > best_len) {
+            best_len = len;
+            *distance = i - j;
+        }
+    }
+    return best_len;
+}
+
+static void put_part_stream(score_writer_t* w, const encode_ctx_t* ctx,
+                            const score_part_src_t* part, bool use_rle) {
+    int32_t prev_dur = 0, prev_delay = 0;
+    uint16_t i = 0;
+
+    while (i < part->event_count) {
+        uint16_t distance = 0;
+        uint16_t len = use_rle ? find_repeat(part, i, &distance) : 0;
+
+        if (len > 0) {
+            // Only worth it if the reference is smaller than the literal events
+            score_writer_t counter = {0};
+            int32_t d = prev_dur, dl = prev_delay;
+            for (uint16_t k = 0; k < len; k++) {
+                put_event(&counter, ctx, &part->events[i + k], &d, &dl);
+            }
+            if (1 + varint_len(distance) < counter.pos) {
+                put_byte(w, (uint8_t)(TOKEN_REPEAT | (len - 1)));
+                put_varint(w, distance);
+                prev_dur = d;
+                prev_delay = dl;
+                i += len;
+                continue;
+            }
+        }
+
+        put_event(w, ctx, &part->events[i], &prev_dur, &prev_delay);
+        i++;
+    }
+}
+
+size_t score_encode(const score_part_src_t* parts, uint8_t part_count, uint8_t tempo_bpm,
+                    uint8_t flags, uint8_t* out, size_t out_size) {
+    if (part_count == 0 || part_count > SCORE_MAX_PARTS) {
+        return 0;
+    }
+
+    // Note table in order of first use, and the common time unit of all timings
+    encode_ctx_t ctx;
+    uint8_t note_table[SCORE_MAX_NOTE_TABLE];
+    uint8_t note_table_len = 0;
+    uint16_t time_unit_ms = 0;
+    memset(ctx.note_index, 0, sizeof(ctx.note_index));
+
+    for (uint8_t p = 0; p < part_count; p++) {
+        for (uint16_t i = 0; i < parts[p].event_count; i++) {
+            const score_note_t* event = &parts[p].events[i];
+            if (ctx.note_index[event->note] == 0) {
+                if (note_table_len >= SCORE_MAX_NOTE_TABLE) {
+                    return 0;
+                }
+                note_table[note_table_len++] = event->note;
+                ctx.note_index[event->note] = note_table_len;
+            }
+            time_unit_ms = gcd16(time_unit_ms, event->duration_ms);
+            time_unit_ms = gcd16(time_unit_ms, event->delay_ms);
+        }
+    }
+    ctx.time_unit_ms = time_unit_ms ? time_unit_ms : 1;
+    bool use_rle = (flags & SCORE_FLAG_RLE) != 0;
+
+    score_writer_t w = {out, out_size, 0};
+    put_byte(&w, SCORE_FORMAT_MAGIC_0);
+    put_byte(&w, SCORE_FORMAT_MAGIC_1);
+    put_byte(&w, SCORE_FORMAT_VERSION);
+    put_byte(&w, flags);
+    put_byte(&w, tempo_bpm);
+    put_byte(&w, part_count);
+    put_varint(&w, ctx.time_unit_ms);
+    put_byte(&w, note_table_len);
+    for (uint8_t i = 0; i < note_table_len; i++) {
+        put_byte(&w, note_table[i]);
+    }
+
+    // Part directory needs the stream sizes, so every stream is encoded twice
+    for (uint8_t p = 0; p < part_count; p++) {
+        score_writer_t counter = {0};
+        put_part_stream(&counter, &ctx, &parts[p], use_rle);
+        put_varint(&w, parts[p].event_count);
+        put_varint(&w, (uint32_t)counter.pos);
+    }
+    for (uint8_t p = 0; p < part_count; p++) {
+        put_part_stream(&w, &ctx, &parts[p], use_rle);
+    }
+
+    return w.pos <= out_size ? w.pos : 0;
+}
+
+bool score_parse(const uint8_t* data, size_t len, score_info_t* info) {
+    size_t pos = 0;
+    uint32_t value;
+
+    memset(info, 0, sizeof(*info));
+    if (len < 8 || data[0] != SCORE_FORMAT_MAGIC_0 || data[1] != SCORE_FORMAT_MAGIC_1) {
+        return false;
+    }
+    info->version = data[2];
+    info->flags = data[3];
+    info->tempo_bpm = data[4];
+    info->part_count = data[5];
+    pos = 6;
+    if (info->version != SCORE_FORMAT_VERSION ||
+        info->part_count == 0 || info->part_count > SCORE_MAX_PARTS) {
+        return false;
+    }
+
+    if (!get_varint(data, len, &pos, &value) || value == 0 || value > UINT16_MAX) {
+        return false;
+    }
+    info->time_unit_ms = (uint16_t)value;
+
+    if (pos >= len || data[pos] > SCORE_MAX_NOTE_TABLE || pos + 1 + data[pos] > len) {
+        return false;
+    }
+    info->note_table_len = data[pos++];
+    info->note_table = &data[pos];
+    pos += info->note_table_len;
+
+    uint32_t streams_len = 0;
+    for (uint8_t p = 0; p < info->part_count; p++) {
+        if (!get_varint(data, len, &pos, &value) || value > UINT16_MAX) {
+            return false;
+        }
+        info->event_count[p] = (uint16_t)value;
+        if (!get_varint(data, len, &pos, &value) || value > UINT16_MAX) {
+            return false;
+        }
+        info->stream_len[p] = (uint16_t)value;
+        streams_len += value;
+    }
+    if (pos + streams_len > len) {
+        return false;
+    }
+
+    for (uint8_t p = 0; p < info->part_count; p++) {
+        info->stream[p] = &data[pos];
+        pos += info->stream_len[p];
+    }
+    return true;
+}
+
+int score_decode_part(const score_info_t* info, uint8_t part, score_note_t* out, size_t max_events) {
+    if (part >= info->part_count || info->event_count[part] > max_events) {
+        return -1;
+    }
+
+    const uint8_t* data = info->stream[part];
+    size_t len = info->stream_len[part];
+    size_t pos = 0;
+    uint16_t count = 0;
+    uint16_t total = info->event_count[part];
+    int64_t prev_dur = 0, prev_delay = 0;   // Wide enough that corrupt deltas cannot overflow
+    uint32_t value;
+
+    while (pos < len) {
+        uint8_t token = data[pos++];
+
+        if (token & TOKEN_REPEAT) {
+            uint16_t run = (token & ~TOKEN_REPEAT) + 1;
+            if (!get_varint(data, len, &pos, &value) || value == 0 || value > count ||
+                count + run > total) {
+                return -1;
+            }
+            for (uint16_t k = 0; k < run; k++, count++) {
+                out[count] = out[count - value];
+            }
+            prev_dur = out[count - 1].duration_ms / info->time_unit_ms;
+            prev_delay = out[count - 1].delay_ms / info->time_unit_ms;
+            continue;
+        }
+
+        uint8_t index = token & TOKEN_NOTE_MASK;
+        if (index == NOTE_INDEX_ESCAPE) {
+            if (pos >= len) {
+                return -1;
+            }
+            index = data[pos++];
+        }
+        if (index >= info->note_table_len || count >= total) {
+            return -1;
+        }
+
+        if (!(token & TOKEN_SAME_TIMING)) {
+            if (!get_varint(data, len, &pos, &value)) {
+                return -1;
+            }
+            prev_dur += unzigzag(value);
+            if (!get_varint(data, len, &pos, &value)) {
+                return -1;
+            }
+            prev_delay += unzigzag(value);
+        }
+
+        int64_t duration_ms = prev_dur * info->time_unit_ms;
+        int64_t delay_ms = prev_delay * info->time_unit_ms;
+        if (duration_ms < 0 || duration_ms > UINT16_MAX || delay_ms < 0 || delay_ms > UINT16_MAX) {
+            return -1;
+        }
+        out[count].note = info->note_table[index];
+        out[count].duration_ms = (uint16_t)duration_ms;
+        out[count].delay_ms = (uint16_t)delay_ms;
+        count++;
+    }
+
+    return count == total ? count : -1;
+}
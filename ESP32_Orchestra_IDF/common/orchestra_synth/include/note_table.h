@@ -0,0 +1,47 @@
+#ifndef NOTE_TABLE_H
+#define NOTE_TABLE_H
+
+/*
+ * Note Table - ความถี่และค่า LEDC timer ของทุก MIDI note คำนวณครั้งเดียวตอน boot
+ * เริ่มโน๊ตจึงไม่ต้องเรียก powf หรือให้ ledc_set_freq หา clock divider ใหม่
+ * ไม่มี dependency กับ ESP-IDF (host tools ใช้ตรวจและวัดความเร็วได้)
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NOTE_TABLE_SIZE         128
+
+// ESP32 low-speed LEDC timer: Q10.8 divider from APB (80 MHz) or REF_TICK (1 MHz)
+#define NOTE_TABLE_APB_HZ       80000000UL
+#define NOTE_TABLE_REF_TICK_HZ  1000000UL
+#define NOTE_TABLE_DIV_FRAC_BITS 8
+#define NOTE_TABLE_DIV_MIN      (1UL << NOTE_TABLE_DIV_FRAC_BITS)   // 1.0
+#define NOTE_TABLE_DIV_MAX      0x3FFFFUL                           // 1023.996
+#define NOTE_TABLE_DUTY_BITS    8
+
+typedef enum {
+    NOTE_CLK_APB = 0,
+    NOTE_CLK_REF_TICK,
+} note_clk_t;
+
+typedef struct {
+    float frequency;            // Exact pitch in Hz (0 for note 0 / rest)
+    float ledc_frequency;       // Pitch the LEDC timer really produces (clamped + divider rounding)
+    uint32_t clock_divider;     // Q10.8, 0 = not playable on LEDC
+    uint8_t duty_resolution;    // Bits, duty 50% = 1 << (duty_resolution - 1)
+    uint8_t clk_src;            // note_clk_t
+} note_table_entry_t;
+
+// Clamp range of the LEDC engine (MIN_FREQUENCY / MAX_FREQUENCY)
+void note_table_init(float min_hz, float max_hz);
+bool note_table_is_ready(void);
+
+extern note_table_entry_t note_table[NOTE_TABLE_SIZE];
+
+// NULL for notes above 127
+static inline const note_table_entry_t* note_table_get(uint8_t note) {
+    return note < NOTE_TABLE_SIZE ? &note_table[note] : NULL;
+}
+
+#endif // NOTE_TABLE_H
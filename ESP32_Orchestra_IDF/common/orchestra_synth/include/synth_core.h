@@ -0,0 +1,79 @@
+#ifndef SYNTH_CORE_H
+#define SYNTH_CORE_H
+
+/*
+ * Orchestra Synth Core - wavetable oscillator bank + ADSR แบบ fixed-point
+ * ไม่มี dependency กับ ESP-IDF: Musician ใช้กับ I2S/DAC, host tools ใช้ทดสอบและวัดความเร็ว
+ * ไม่ thread-safe - ให้ task เดียวเรียกทุกฟังก์ชัน (note on/off ผ่านคิวของ synth_output)
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SYNTH_MAX_VOICES        8
+#define SYNTH_TABLE_BITS        8                       // 256-sample wavetable
+#define SYNTH_TABLE_SIZE        (1 << SYNTH_TABLE_BITS)
+#define SYNTH_CONTROL_FRAMES    16      // Envelope/duration update rate (frames)
+#define SYNTH_ENV_MAX           (1 << 23)               // Envelope full scale (Q23)
+
+typedef enum {
+    SYNTH_WAVE_SINE = 0,
+    SYNTH_WAVE_TRIANGLE,
+    SYNTH_WAVE_SQUARE,          // Band-limited to the first harmonics, no aliasing buzz
+    SYNTH_WAVE_SAW,
+} synth_wave_t;
+
+typedef enum {
+    SYNTH_STAGE_IDLE = 0,
+    SYNTH_STAGE_ATTACK,
+    SYNTH_STAGE_DECAY,
+    SYNTH_STAGE_SUSTAIN,
+    SYNTH_STAGE_RELEASE,
+} synth_stage_t;
+
+typedef struct {
+    uint16_t attack_ms;
+    uint16_t decay_ms;
+    uint8_t sustain_level;      // 0-255 of the peak level
+    uint16_t release_ms;
+} synth_adsr_t;
+
+typedef struct {
+    uint32_t phase;             // Q32 position in the wavetable
+    uint32_t phase_inc;
+    int32_t env;                // Q23 envelope level
+    int32_t env_step;           // Change per control block
+    int32_t amp;                // Q15 env * velocity, fixed for one control block
+    uint16_t velocity_gain;     // Q15
+    uint32_t remaining;         // Frames until release starts (note duration)
+    uint32_t age;               // note_on order, for stealing
+    uint8_t note;
+    uint8_t stage;              // synth_stage_t
+} synth_voice_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    int16_t table[SYNTH_TABLE_SIZE + 1];    // +1 guard sample for interpolation
+    uint32_t note_inc[128];                 // Phase increment of every MIDI note
+    int32_t attack_step, decay_step, sustain_env;
+    uint32_t release_blocks;
+    uint16_t master_gain;                   // Q15, applied to the mix
+    uint32_t age_counter;
+    uint32_t voices_stolen;
+    synth_voice_t voices[SYNTH_MAX_VOICES];
+} synth_t;
+
+// Synth Functions
+void synth_init(synth_t* synth, uint32_t sample_rate, synth_wave_t wave, const synth_adsr_t* adsr);
+int synth_note_on(synth_t* synth, uint8_t note, uint8_t velocity, uint32_t duration_frames);
+void synth_note_off(synth_t* synth, uint8_t note);
+void synth_all_off(synth_t* synth);
+void synth_render(synth_t* synth, int16_t* out, size_t frames);   // Mono, any frame count
+uint8_t synth_active_voices(const synth_t* synth);
+
+static inline uint32_t synth_ms_to_frames(const synth_t* synth, uint32_t ms) {
+    return (uint32_t)(((uint64_t)ms * synth->sample_rate) / 1000);
+}
+
+#endif // SYNTH_CORE_H
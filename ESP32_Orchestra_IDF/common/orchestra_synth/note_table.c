@@ -0,0 +1,56 @@
+/*
+ * Note Table - ตารางความถี่ + LEDC divider ของ MIDI note 0-127
+ * ใช้สูตรเดียวกับ ledc_set_freq (divider = src_clk * 256 / freq / 2^duty_bits)
+ * แต่คำนวณจากความถี่จริง (float) แทนค่าที่ปัดเป็น Hz แล้ว เสียงจึงตรงกว่าเดิม
+ */
+
+#include <math.h>
+#include <string.h>
+#include "note_table.h"
+
+note_table_entry_t note_table[NOTE_TABLE_SIZE];
+static bool table_ready = false;
+
+// Rounded Q10.8 divider, 0 if out of the timer's range
+static uint32_t divider_for(uint32_t src_hz, double hz) {
+    double div = ((double)src_hz * (1 << NOTE_TABLE_DIV_FRAC_BITS)) / (hz * (1 << NOTE_TABLE_DUTY_BITS));
+    uint32_t rounded = (uint32_t)(div + 0.5);
+    if (div + 0.5 > (double)UINT32_MAX || rounded < NOTE_TABLE_DIV_MIN || rounded > NOTE_TABLE_DIV_MAX) {
+        return 0;
+    }
+    return rounded;
+}
+
+void note_table_init(float min_hz, float max_hz) {
+    memset(note_table, 0, sizeof(note_table));
+
+    // Note 0 doubles as NOTE_REST and stays silent
+    for (int note = 1; note < NOTE_TABLE_SIZE; note++) {
+        note_table_entry_t* entry = &note_table[note];
+        double hz = 440.0 * pow(2.0, (note - 69) / 12.0);
+        entry->frequency = (float)hz;
+        entry->duty_resolution = NOTE_TABLE_DUTY_BITS;
+
+        double clamped = hz < min_hz ? min_hz : hz > max_hz ? max_hz : hz;
+
+        // APB gives the finest divider; low notes overflow it and fall back to REF_TICK
+        uint32_t src_hz = NOTE_TABLE_APB_HZ;
+        uint32_t div = divider_for(src_hz, clamped);
+        entry->clk_src = NOTE_CLK_APB;
+        if (div == 0) {
+            src_hz = NOTE_TABLE_REF_TICK_HZ;
+            div = divider_for(src_hz, clamped);
+            entry->clk_src = NOTE_CLK_REF_TICK;
+        }
+        entry->clock_divider = div;
+        if (div != 0) {
+            entry->ledc_frequency = (float)(((double)src_hz * (1 << NOTE_TABLE_DIV_FRAC_BITS)) /
+                                            ((double)div * (1 << NOTE_TABLE_DUTY_BITS)));
+        }
+    }
+    table_ready = true;
+}
+
+bool note_table_is_ready(void) {
+    return table_ready;
+}
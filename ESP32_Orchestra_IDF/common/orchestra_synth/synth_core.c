@@ -0,0 +1,251 @@
+/*
+ * Orchestra Synth Core
+ * Oscillator = phase accumulator 32 bit + wavetable 256 จุด (linear interpolation)
+ * Envelope/duration อัพเดตทุก SYNTH_CONTROL_FRAMES frame, ระดับเสียงไล่ค่าในแต่ละ block ไม่ให้มีเสียงแตก
+ */
+
+#include <string.h>
+#include <math.h>
+#include "synth_core.h"
+
+#define TABLE_PEAK          30000   // Headroom for interpolation and rounding
+#define FRAC_BITS           15
+#define PHASE_INDEX_SHIFT   (32 - SYNTH_TABLE_BITS)
+#define PHASE_FRAC_SHIFT    (PHASE_INDEX_SHIFT - FRAC_BITS)
+#define DEFAULT_MASTER_GAIN 8192    // Q15 0.25 - four full-scale voices before clipping
+#define TWO_PI              6.28318530718f
+
+static void build_table(synth_t* synth, synth_wave_t wave) {
+    static float shape[SYNTH_TABLE_SIZE];   // Only used at init
+    float peak = 0.0f;
+
+    for (int i = 0; i < SYNTH_TABLE_SIZE; i++) {
+        float x = TWO_PI * i / SYNTH_TABLE_SIZE;
+        float value = 0.0f;
+        switch (wave) {
+            case SYNTH_WAVE_TRIANGLE:
+                for (int k = 1; k <= 7; k += 2) {
+                    value += ((k / 2) % 2 ? -1.0f : 1.0f) * sinf(k * x) / (k * k);
+                }
+                break;
+            case SYNTH_WAVE_SQUARE:
+                for (int k = 1; k <= 7; k += 2) {
+                    value += sinf(k * x) / k;
+                }
+                break;
+            case SYNTH_WAVE_SAW:
+                for (int k = 1; k <= 8; k++) {
+                    value += sinf(k * x) / k;
+                }
+                break;
+            case SYNTH_WAVE_SINE:
+            default:
+                value = sinf(x);
+                break;
+        }
+        shape[i] = value;
+        if (fabsf(value) > peak) {
+            peak = fabsf(value);
+        }
+    }
+
+    for (int i = 0; i < SYNTH_TABLE_SIZE; i++) {
+        synth->table[i] = (int16_t)lrintf(shape[i] / peak * TABLE_PEAK);
+    }
+    synth->table[SYNTH_TABLE_SIZE] = synth->table[0];
+}
+
+static uint32_t ms_to_blocks(uint32_t sample_rate, uint16_t ms) {
+    uint32_t blocks = (uint32_t)(((uint64_t)ms * sample_rate) / (1000ULL * SYNTH_CONTROL_FRAMES));
+    return blocks > 0 ? blocks : 1;
+}
+
+void synth_init(synth_t* synth, uint32_t sample_rate, synth_wave_t wave, const synth_adsr_t* adsr) {
+    memset(synth, 0, sizeof(*synth));
+    synth->sample_rate = sample_rate;
+    synth->master_gain = DEFAULT_MASTER_GAIN;
+    build_table(synth, wave);
+
+    // Notes above Nyquist get a zero increment and stay silent
+    for (int note = 0; note < 128; note++) {
+        double hz = 440.0 * pow(2.0, (note - 69) / 12.0);
+        double inc = hz * 4294967296.0 / sample_rate;
+        synth->note_inc[note] = inc < 2147483648.0 ? (uint32_t)(inc + 0.5) : 0;
+    }
+
+    synth->attack_step = SYNTH_ENV_MAX / (int32_t)ms_to_blocks(sample_rate, adsr->attack_ms);
+    synth->sustain_env = (int32_t)(((int64_t)SYNTH_ENV_MAX * adsr->sustain_level) / 255);
+    synth->decay_step = (SYNTH_ENV_MAX - synth->sustain_env) / (int32_t)ms_to_blocks(sample_rate, adsr->decay_ms);
+    if (synth->decay_step == 0) {
+        synth->decay_step = 1;
+    }
+    synth->release_blocks = ms_to_blocks(sample_rate, adsr->release_ms);
+}
+
+static void start_release(synth_t* synth, synth_voice_t* voice) {
+    voice->stage = SYNTH_STAGE_RELEASE;
+    voice->env_step = voice->env / (int32_t)synth->release_blocks;
+    if (voice->env_step == 0) {
+        voice->env_step = 1;
+    }
+}
+
+// Free voice, else the quietest releasing one, else the oldest note
+static synth_voice_t* pick_voice(synth_t* synth) {
+    synth_voice_t* releasing = NULL;
+    synth_voice_t* oldest = &synth->voices[0];
+
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        synth_voice_t* voice = &synth->voices[i];
+        if (voice->stage == SYNTH_STAGE_IDLE) {
+            return voice;
+        }
+        if (voice->stage == SYNTH_STAGE_RELEASE && (!releasing || voice->env < releasing->env)) {
+            releasing = voice;
+        }
+        if ((int32_t)(voice->age - oldest->age) < 0) {
+            oldest = voice;
+        }
+    }
+    synth->voices_stolen++;
+    return releasing ? releasing : oldest;
+}
+
+int synth_note_on(synth_t* synth, uint8_t note, uint8_t velocity, uint32_t duration_frames) {
+    if (note > 127 || synth->note_inc[note] == 0 || duration_frames == 0) {
+        return -1;
+    }
+
+    synth_voice_t* voice = pick_voice(synth);
+    if (voice->stage == SYNTH_STAGE_IDLE) {
+        voice->env = 0;
+        voice->amp = 0;
+        voice->phase = 0;
+    }
+    // A stolen voice keeps its level and phase, the attack starts from there (no click)
+    voice->phase_inc = synth->note_inc[note];
+    voice->note = note;
+    voice->stage = SYNTH_STAGE_ATTACK;
+    voice->env_step = synth->attack_step;
+    voice->remaining = duration_frames;
+    voice->age = ++synth->age_counter;
+
+    // Quadratic velocity curve sounds closer to even loudness steps than a linear one
+    uint32_t v = velocity > 127 ? 127 : velocity;
+    voice->velocity_gain = (uint16_t)((v * v * 32767) / (127 * 127));
+    return (int)(voice - synth->voices);
+}
+
+void synth_note_off(synth_t* synth, uint8_t note) {
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        synth_voice_t* voice = &synth->voices[i];
+        if (voice->note == note && voice->stage != SYNTH_STAGE_IDLE && voice->stage != SYNTH_STAGE_RELEASE) {
+            start_release(synth, voice);
+        }
+    }
+}
+
+void synth_all_off(synth_t* synth) {
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        synth_voice_t* voice = &synth->voices[i];
+        if (voice->stage != SYNTH_STAGE_IDLE && voice->stage != SYNTH_STAGE_RELEASE) {
+            start_release(synth, voice);
+        }
+    }
+}
+
+// Advance the envelope by one control block, returns the Q15 amplitude at its end
+static int32_t control_update(synth_t* synth, synth_voice_t* voice, uint32_t frames) {
+    if (voice->stage != SYNTH_STAGE_RELEASE) {
+        if (voice->remaining <= frames) {
+            start_release(synth, voice);
+        } else {
+            voice->remaining -= frames;
+        }
+    }
+
+    switch (voice->stage) {
+        case SYNTH_STAGE_ATTACK:
+            voice->env += voice->env_step;
+            if (voice->env >= SYNTH_ENV_MAX) {
+                voice->env = SYNTH_ENV_MAX;
+                voice->stage = SYNTH_STAGE_DECAY;
+            }
+            break;
+        case SYNTH_STAGE_DECAY:
+            voice->env -= synth->decay_step;
+            if (voice->env <= synth->sustain_env) {
+                voice->env = synth->sustain_env;
+                voice->stage = SYNTH_STAGE_SUSTAIN;
+            }
+            break;
+        case SYNTH_STAGE_RELEASE:
+            voice->env -= voice->env_step;
+            if (voice->env <= 0) {
+                voice->env = 0;
+                voice->stage = SYNTH_STAGE_IDLE;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return (int32_t)(((int64_t)(voice->env >> 8) * voice->velocity_gain) >> 15);
+}
+
+// Inner loop: interpolated table lookup, amplitude ramp, accumulate into the mix
+static void render_voice(const synth_t* synth, synth_voice_t* voice, int32_t* mix,
+                         uint32_t frames, int32_t target_amp) {
+    const int16_t* table = synth->table;
+    uint32_t phase = voice->phase;
+    uint32_t inc = voice->phase_inc;
+    int32_t amp = voice->amp;
+    int32_t amp_step = (target_amp - amp) / (int32_t)frames;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        uint32_t index = phase >> PHASE_INDEX_SHIFT;
+        int32_t frac = (int32_t)((phase >> PHASE_FRAC_SHIFT) & ((1 << FRAC_BITS) - 1));
+        int32_t a = table[index];
+        int32_t sample = a + (((table[index + 1] - a) * frac) >> FRAC_BITS);
+        mix[i] += (sample * amp) >> 15;
+        amp += amp_step;
+        phase += inc;
+    }
+
+    voice->phase = phase;
+    voice->amp = target_amp;
+}
+
+void synth_render(synth_t* synth, int16_t* out, size_t frames) {
+    int32_t mix[SYNTH_CONTROL_FRAMES];
+
+    while (frames > 0) {
+        uint32_t n = frames < SYNTH_CONTROL_FRAMES ? (uint32_t)frames : SYNTH_CONTROL_FRAMES;
+        memset(mix, 0, n * sizeof(int32_t));
+
+        for (int v = 0; v < SYNTH_MAX_VOICES; v++) {
+            synth_voice_t* voice = &synth->voices[v];
+            if (voice->stage == SYNTH_STAGE_IDLE) {
+                continue;
+            }
+            render_voice(synth, voice, mix, n, control_update(synth, voice, n));
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t sample = (int32_t)(((int64_t)mix[i] * synth->master_gain) >> 15);
+            out[i] = (int16_t)(sample > INT16_MAX ? INT16_MAX : sample < INT16_MIN ? INT16_MIN : sample);
+        }
+        out += n;
+        frames -= n;
+    }
+}
+
+uint8_t synth_active_voices(const synth_t* synth) {
+    uint8_t count = 0;
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        if (synth->voices[i].stage != SYNTH_STAGE_IDLE) {
+            count++;
+        }
+    }
+    return count;
+}
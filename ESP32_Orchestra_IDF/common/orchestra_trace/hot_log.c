@@ -0,0 +1,39 @@
+/*
+ * Hot-path Log Implementation
+ * ไม่มี lock: limit ที่ถูกเรียกจากหลาย task แย่งกันได้แค่พิมพ์เกินหนึ่งบรรทัดหรือนับ skipped คลาดเล็กน้อย
+ * counter ถูกอ่านจาก status task เท่านั้น
+ */
+
+#include "hot_log.h"
+#include "esp_timer.h"
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+bool hot_log_allow(hot_log_limit_t* limit, uint32_t* skipped) {
+    uint32_t now = now_ms();
+    if (limit->printed && now - limit->last_ms < HOT_LOG_SUMMARY_MS) {
+        limit->skipped++;
+        return false;
+    }
+    *skipped = limit->skipped;
+    limit->skipped = 0;
+    limit->last_ms = now;
+    limit->printed = true;
+    return true;
+}
+
+void hot_log_summary(const char* tag, hot_log_counter_t* counter, uint32_t total) {
+    uint32_t now = now_ms();
+    uint32_t elapsed_ms = now - counter->last_ms;
+    if (elapsed_ms < HOT_LOG_SUMMARY_MS) {
+        return;
+    }
+    if (total != counter->reported) {
+        ESP_LOGI(tag, "📈 %lu %s in last %lu s", (unsigned long)(total - counter->reported), counter->what,
+                 (unsigned long)((elapsed_ms + 500) / 1000));
+    }
+    counter->reported = total;
+    counter->last_ms = now;
+}
@@ -0,0 +1,66 @@
+#ifndef HOT_LOG_H
+#define HOT_LOG_H
+
+/*
+ * Hot-path log - log ที่เกิดทุก packet / ทุกโน๊ต (Wi-Fi callback, dispatch, note onset)
+ * site ที่ละเอียดกว่า HOT_LOG_LEVEL หายไปตอน compile ทั้งบรรทัด (รวม float formatting) แต่ args ยังถูกตรวจ type
+ * ที่เหลือเป็นสรุปจาก counter ทุก HOT_LOG_SUMMARY_MS ("120 notes in last 5 s") และ warning ที่จำกัดความถี่
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_log.h"
+
+// Most detailed level the packet path still prints: ESP_LOG_INFO = one line per frame/note as before
+#ifndef HOT_LOG_LEVEL
+#define HOT_LOG_LEVEL           ESP_LOG_WARN
+#endif
+
+#define HOT_LOG_SUMMARY_MS      5000    // Summaries and limited warnings at most this often
+
+#define HOT_LOGI(tag, format, ...) do {                                     \
+        if (HOT_LOG_LEVEL >= ESP_LOG_INFO) {                                \
+            ESP_LOGI(tag, format, ##__VA_ARGS__);                           \
+        }                                                                   \
+    } while (0)
+
+#define HOT_LOGD(tag, format, ...) do {                                     \
+        if (HOT_LOG_LEVEL >= ESP_LOG_DEBUG) {                               \
+            ESP_LOGD(tag, format, ##__VA_ARGS__);                           \
+        }                                                                   \
+    } while (0)
+
+// A warning/error that can repeat every packet: first one, then at most one per HOT_LOG_SUMMARY_MS
+// with the number left out in between. format must be a string literal.
+#define HOT_LOG_LIMITED_(log, limit, tag, format, ...) do {                 \
+        uint32_t hot_log_skipped_;                                          \
+        if (hot_log_allow((limit), &hot_log_skipped_)) {                    \
+            log(tag, format " (+%lu skipped)", ##__VA_ARGS__,               \
+                (unsigned long)hot_log_skipped_);                           \
+        }                                                                   \
+    } while (0)
+
+#define HOT_LOGW_LIMITED(limit, tag, format, ...)   HOT_LOG_LIMITED_(ESP_LOGW, limit, tag, format, ##__VA_ARGS__)
+#define HOT_LOGE_LIMITED(limit, tag, format, ...)   HOT_LOG_LIMITED_(ESP_LOGE, limit, tag, format, ##__VA_ARGS__)
+
+typedef struct {
+    uint32_t last_ms;
+    uint32_t skipped;
+    bool printed;
+} hot_log_limit_t;
+
+// Summary of a running total the module keeps anyway (frames sent, notes played ...)
+typedef struct {
+    const char* what;
+    uint32_t reported;          // Total at the last summary
+    uint32_t last_ms;
+} hot_log_counter_t;
+
+#define HOT_LOG_COUNTER(what)   {(what), 0, 0}
+
+bool hot_log_allow(hot_log_limit_t* limit, uint32_t* skipped);
+
+// Status task: "<n> <what> in last <s> s" once per HOT_LOG_SUMMARY_MS, nothing while the total stands still
+void hot_log_summary(const char* tag, hot_log_counter_t* counter, uint32_t total);
+
+#endif // HOT_LOG_H
@@ -0,0 +1,73 @@
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+/*
+ * Hot-path trace - record ละ 12 byte (event, cycle counter, 2 args) ลง ring ของ core ที่รันอยู่
+ * ตอนบันทึกไม่มี lock ไม่มี printf, พิมพ์ออก UART เป็น hex ทีหลังจาก task ที่ priority ต่ำ
+ * tools/host/trace_decode แปลง log เป็น Chrome trace JSON (เปิดใน ui.perfetto.dev / chrome://tracing)
+ */
+
+#include <stdint.h>
+
+// 1 = record the instrumented points on this board (one flag for conductor and musician).
+// A dump is requested at every song end and printed by trace_poll():
+//   TRACE,<board>,core,<core>,<cycles per us>,<records written since the last dump>
+//   TRACE,<board>,<core>,<record>...   (TRACE_DUMP_PER_LINE records, 24 hex digits each)
+//   TRACE,<board>,end
+// <board> is the musician ID, TRACE_BOARD_CONDUCTOR for the conductor
+#ifndef TRACE_RING
+#define TRACE_RING              0
+#endif
+
+#define TRACE_RING_SIZE         1024        // Records per core, power of two - the oldest are overwritten
+#define TRACE_ANCHOR_US         1000000     // Clock anchor at least this often (the cycle counter wraps every 17 s at 240 MHz)
+#define TRACE_DUMP_PER_LINE     8
+#define TRACE_BOARD_CONDUCTOR   (-1)
+
+typedef enum {
+    TRACE_EV_ANCHOR = 0,        // arg0:arg1 = board clock in us (48 bits) at this cycle count
+    TRACE_EV_SEND_EVENTS,       // send_song_events(): begin arg0 = events waiting; end arg0 = events sent
+    TRACE_EV_RECV,              // espnow_on_data_recv(): begin arg0 = length, arg1 = message type; end arg0 = 1 if kept
+    TRACE_EV_DISPATCH,          // Musician dispatch_frame(): begin arg0 = message type, arg1 = length
+    TRACE_EV_PLAY_NOTE,         // sound_play_note(): begin arg0 = note, arg1 = duration ms; end arg1 = esp_err_t
+    TRACE_EV_COUNT,
+} trace_event_t;
+
+#define TRACE_EVENT_NAMES       {"anchor", "send_song_events", "espnow_on_data_recv", "dispatch_frame", \
+                                 "sound_play_note"}
+
+typedef enum {
+    TRACE_BEGIN = 0,
+    TRACE_END,
+    TRACE_INSTANT,
+} trace_phase_t;
+
+typedef struct {
+    uint32_t cycles;            // CPU cycle counter of the core that wrote it
+    uint8_t event;              // trace_event_t
+    uint8_t phase;              // trace_phase_t
+    uint16_t arg0;
+    uint32_t arg1;
+} trace_record_t;
+
+#if TRACE_RING
+void trace_record(uint8_t event, uint8_t phase, uint16_t arg0, uint32_t arg1);
+void trace_set_clock(int64_t (*clock_us)(int64_t local_us));   // Anchors on another clock (musician: conductor time)
+void trace_request_dump(void);          // Any context, only sets a flag
+void trace_poll(int board);             // Low-priority task: prints and restarts the rings if a dump was requested
+#else
+static inline void trace_record(uint8_t event, uint8_t phase, uint16_t arg0, uint32_t arg1) {}
+static inline void trace_set_clock(int64_t (*clock_us)(int64_t local_us)) {}
+static inline void trace_request_dump(void) {}
+static inline void trace_poll(int board) {}
+#endif
+
+static inline void trace_begin(uint8_t event, uint16_t arg0, uint32_t arg1) {
+    trace_record(event, TRACE_BEGIN, arg0, arg1);
+}
+
+static inline void trace_end(uint8_t event, uint16_t arg0, uint32_t arg1) {
+    trace_record(event, TRACE_END, arg0, arg1);
+}
+
+#endif // TRACE_RING_H
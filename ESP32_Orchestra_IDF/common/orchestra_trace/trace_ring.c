@@ -0,0 +1,100 @@
+/*
+ * Trace Ring Implementation
+ * ring ละ core: จองช่องด้วย atomic add (task กับ callback บน core เดียวกันแทรกกันได้) ไม่มี critical section
+ * record anchor (cycle count คู่กับเวลา us) ทุก TRACE_ANCHOR_US ให้ decoder แปลง cycle เป็นเวลาและเทียบข้าม core/บอร์ด
+ * สมมติว่า CPU frequency คงที่ (ไม่เปิด dynamic frequency scaling)
+ */
+
+#include "trace_ring.h"
+
+#if TRACE_RING
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+typedef struct {
+    trace_record_t records[TRACE_RING_SIZE];
+    uint32_t head;              // Records written since the last dump, slot = head % TRACE_RING_SIZE
+    uint32_t anchor_cycles;
+    bool anchored;
+} trace_ring_t;
+
+static trace_ring_t rings[portNUM_PROCESSORS];
+static volatile bool enabled = true;            // Off while the rings are printed
+static volatile bool dump_requested = false;
+static uint32_t anchor_interval_cycles = 0;
+static int64_t (*anchor_clock_us)(int64_t local_us) = NULL;
+
+static void put(trace_ring_t* ring, uint32_t cycles, uint8_t event, uint8_t phase, uint16_t arg0, uint32_t arg1) {
+    uint32_t slot = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & (TRACE_RING_SIZE - 1);
+    ring->records[slot] = (trace_record_t){cycles, event, phase, arg0, arg1};
+}
+
+void trace_record(uint8_t event, uint8_t phase, uint16_t arg0, uint32_t arg1) {
+    if (!enabled) {
+        return;
+    }
+    trace_ring_t* ring = &rings[esp_cpu_get_core_id()];
+    uint32_t cycles = esp_cpu_get_cycle_count();
+
+    // First record after a dump and then about once a second - the only esp_timer read on this path
+    if (!ring->anchored || cycles - ring->anchor_cycles >= anchor_interval_cycles) {
+        if (anchor_interval_cycles == 0) {
+            anchor_interval_cycles = esp_rom_get_cpu_ticks_per_us() * TRACE_ANCHOR_US;
+        }
+        int64_t now_us = esp_timer_get_time();
+        if (anchor_clock_us) {
+            now_us = anchor_clock_us(now_us);
+        }
+        ring->anchor_cycles = cycles;
+        ring->anchored = true;
+        put(ring, cycles, TRACE_EV_ANCHOR, TRACE_INSTANT, (uint16_t)((uint64_t)now_us >> 32), (uint32_t)now_us);
+    }
+    put(ring, cycles, event, phase, arg0, arg1);
+}
+
+void trace_set_clock(int64_t (*clock_us)(int64_t local_us)) {
+    anchor_clock_us = clock_us;
+}
+
+void trace_request_dump(void) {
+    dump_requested = true;
+}
+
+void trace_poll(int board) {
+    if (!dump_requested) {
+        return;
+    }
+    dump_requested = false;
+    enabled = false;
+    vTaskDelay(1);  // A writer that already passed the check finishes its record
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_ring_t* ring = &rings[core];
+        uint32_t count = ring->head < TRACE_RING_SIZE ? ring->head : TRACE_RING_SIZE;
+        printf("TRACE,%d,core,%d,%lu,%lu\n", board, core, (unsigned long)esp_rom_get_cpu_ticks_per_us(),
+               (unsigned long)ring->head);
+        for (uint32_t i = 0; i < count; i++) {
+            const trace_record_t* record = &ring->records[(ring->head - count + i) & (TRACE_RING_SIZE - 1)];
+            if (i % TRACE_DUMP_PER_LINE == 0) {
+                printf("TRACE,%d,%d,", board, core);
+            }
+            printf("%08lx%02x%02x%04x%08lx", (unsigned long)record->cycles, record->event, record->phase,
+                   record->arg0, (unsigned long)record->arg1);
+            if (i % TRACE_DUMP_PER_LINE == TRACE_DUMP_PER_LINE - 1 || i == count - 1) {
+                printf("\n");
+            }
+        }
+        ring->head = 0;
+        ring->anchored = false;
+    }
+    printf("TRACE,%d,end\n", board);
+    enabled = true;
+}
+
+#endif // TRACE_RING
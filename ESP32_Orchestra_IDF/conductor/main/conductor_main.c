@@ -21,7 +21,11 @@
 
 #include "orchestra_common.h"
 #include "midi_songs.h"
+#include "song_library.h"
 #include "espnow_conductor.h"
+#include "part_map.h"
+#include "stress_test.h"
+#include "trace_ring.h"
 
 static const char *TAG = "MAIN";
 
@@ -62,22 +66,52 @@ void app_main(void) {
         ESP_LOGI(TAG, "✅ Conductor ready!");
     }
     
+    // Part assignment: boards get an ID when they join and the online ones share the
+    // parts of each song (every part covered). Fixed parts for a board can be set here, e.g.
+    // part_map_set(4, (1 << PART_A) | (1 << PART_C));   // Board 4 plays melody and bass
+    // part_map_set(5, 1 << PART_A);                      // Board 5 doubles the melody
+    part_map_init();
+
+    // Songs from the flash partition (falls back to the built-in ones)
+    song_library_init();
+    if (!song_library_find(selected_song)) {
+        selected_song = song_library_next_id(selected_song);
+    }
+
     // Display available songs
     ESP_LOGI(TAG, "🎼 Available songs:");
-    for (int i = 0; i < TOTAL_SONGS; i++) {
-        ESP_LOGI(TAG, "   %d. %s (%d parts, %d BPM)", 
-                 all_songs[i].song_id, 
-                 all_songs[i].song_name,
-                 all_songs[i].part_count,
-                 all_songs[i].tempo_bpm);
-    }
+    uint8_t first_id = song_library_next_id(0);
+    uint8_t song_id = first_id;
+    do {
+        const orchestra_song_t* song = song_library_find(song_id);
+        if (song) {
+            ESP_LOGI(TAG, "   %d. %s (%d parts, %d BPM)",
+                     song->song_id,
+                     song->song_name,
+                     song->part_count,
+                     song->tempo_bpm);
+        }
+        song_id = song_library_next_id(song_id);
+    } while (song_id != first_id && song_id != 0);
     ESP_LOGI(TAG, "📝 Press BOOT button to cycle songs, hold to play!");
     
     // Create tasks
-    xTaskCreate(button_task, "button_task", 2048, NULL, 5, &button_task_handle);
-    xTaskCreate(led_task, "led_task", 2048, NULL, 3, &led_task_handle);
+    xTaskCreate(button_task, "button_task", 4096, NULL, 5, &button_task_handle);
+    xTaskCreate(led_task, "led_task", TRACE_RING ? 3072 : 2048, NULL, 3, &led_task_handle);  // trace_poll() printf
     xTaskCreate(orchestra_task, "orchestra_task", 4096, NULL, 4, &orchestra_task_handle);
     
+    // Song events wake the orchestra task through a one-shot timer
+    ret = conductor_scheduler_init(orchestra_task_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to initialize scheduler: %s", esp_err_to_name(ret));
+        current_led_pattern = LED_FAST_BLINK;
+    }
+
+#if STRESS_TEST
+    ESP_LOGW(TAG, "🏋️ STRESS_TEST build: synthetic scores start in %d s", STRESS_SETTLE_MS / 1000);
+    stress_test_start();
+#endif
+
     ESP_LOGI(TAG, "🚀 All tasks created, conductor is running!");
 }
 
@@ -136,12 +170,9 @@ static void handle_button_press(uint32_t press_duration) {
         // Short press: Cycle through songs
         // Note: We need to access conductor_state somehow
         // For now, let's assume we're not playing
-        selected_song++;
-        if (selected_song > TOTAL_SONGS) {
-            selected_song = 1;
-        }
+        selected_song = song_library_next_id(selected_song);
         
-        const orchestra_song_t* song = get_song_by_id(selected_song);
+        const orchestra_song_t* song = song_library_find(selected_song);
         if (song) {
             ESP_LOGI(TAG, "🎵 Selected: %s", song->song_name);
             
@@ -164,7 +195,7 @@ static void handle_button_press(uint32_t press_duration) {
         } else {
             // Start selected song
             if (start_song(selected_song)) {
-                const orchestra_song_t* song = get_song_by_id(selected_song);
+                const orchestra_song_t* song = song_library_find(selected_song);
                 ESP_LOGI(TAG, "▶️  Playing: %s", song ? song->song_name : "Unknown");
                 current_led_pattern = LED_ON;
             } else {
@@ -222,28 +253,44 @@ static void led_task(void *pvParameters) {
                 break;
         }
         
+        // Lowest priority task: printing a trace dump never holds up the note scheduler
+        trace_poll(TRACE_BOARD_CONDUCTOR);
+
         vTaskDelay(pdMS_TO_TICKS(10)); // Update every 10ms
     }
 }
 
 static void orchestra_task(void *pvParameters) {
     uint32_t last_heartbeat = 0;
+    uint32_t wait_ms = HEARTBEAT_INTERVAL_MS;
     
     while (1) {
-        uint32_t current_time = get_time_ms();
+        // Sleep until the scheduler timer fires or the next heartbeat is due
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
         
-        // Send song events if playing
+        // Send song events that are due
         conductor_send_song_events();
         
+        // Resend song start/end to boards that have not acknowledged it
+        uint32_t control_wait_ms = conductor_poll_control();
+
         // Send periodic heartbeat
-        if (current_time - last_heartbeat > 5000) { // Every 5 seconds
+        uint32_t current_time = get_time_ms();
+        if (current_time - last_heartbeat >= HEARTBEAT_INTERVAL_MS) {
             send_heartbeat();
             last_heartbeat = current_time;
         }
         
+        // Online boards, parts of boards that went silent
+        conductor_check_roster();
+
         // Update conductor status
         update_conductor_status();
         
-        vTaskDelay(pdMS_TO_TICKS(10)); // Update every 10ms for precise timing
+        uint32_t since_heartbeat = get_time_ms() - last_heartbeat;
+        wait_ms = since_heartbeat < HEARTBEAT_INTERVAL_MS ? HEARTBEAT_INTERVAL_MS - since_heartbeat : 1;
+        if (control_wait_ms < wait_ms) {
+            wait_ms = control_wait_ms > 0 ? control_wait_ms : 1;
+        }
     }
-}
\ No newline at end of file
+}
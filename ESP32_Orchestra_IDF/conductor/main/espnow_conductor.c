@@ -9,9 +9,21 @@
 #include "esp_netif.h"
 #include "esp_mac.h"
 #include "esp_log.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
+#include "freertos/semphr.h"
 #include "espnow_conductor.h"
 #include "midi_songs.h"
+#include "song_library.h"
+#include "event_heap.h"
+#include "part_map.h"
+#include "roster.h"
+#include "score_codec.h"
+#include "reliable_ctrl.h"
+#include "note_fec.h"
+#include "stress_test.h"
+#include "trace_ring.h"
+#include "hot_log.h"
 
 static const char *TAG = "CONDUCTOR";
 
@@ -21,9 +33,64 @@ static uint8_t broadcast_addr[] = BROADCAST_ADDR;
 
 // Song playback state
 static const orchestra_song_t* current_song = NULL;
-static uint32_t song_position[MAX_MUSICIANS] = {0}; // Current position for each part
-static uint32_t next_event_time[MAX_MUSICIANS] = {0}; // Next event time for each part
-static uint32_t song_start_timestamp = 0;
+static orchestra_song_t playing_song;               // Copy of the lookup result (library slot gets reused)
+static song_part_t playing_parts[SONG_LIBRARY_MAX_PARTS];
+static uint32_t song_position[MAX_PARTS] = {0};   // Current position for each part
+static uint32_t next_event_time[MAX_PARTS] = {0}; // Next event time for each part
+static uint32_t song_start_timestamp = 0; // Conductor time at which the song starts sounding
+static int64_t song_start_us = 0;         // Same instant on the esp_timer clock
+static uint32_t song_length_ms = 0;       // Known once every part has been sent
+static uint32_t preloaded_parts = 0;      // Bit n = part n was preloaded, not streamed
+static orchestra_part_assign_t part_assign; // Part table sent for the current song
+
+_Static_assert(SONG_LIBRARY_MAX_PARTS <= MAX_PARTS, "every library part needs a scheduler slot");
+
+// Score preload: stop-and-wait, the receive callback signals the matching ACK
+static SemaphoreHandle_t score_ack_sem = NULL;
+static portMUX_TYPE score_ack_lock = portMUX_INITIALIZER_UNLOCKED;
+static orchestra_score_ack_t score_ack_expected;
+static uint32_t score_ack_pending = 0;  // Boards that have not acknowledged score_ack_expected yet
+static orchestra_score_chunk_t score_chunk;
+static uint8_t score_blob[SCORE_MAX_BLOB_LEN];
+
+// Song start/end: resent until every online board acknowledged (ACKs arrive in the Wi-Fi task)
+static reliable_sender_t ctrl_sender;
+static portMUX_TYPE ctrl_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Note FEC: every streamed note goes out fec_depth more times while it has not started yet
+static note_fec_encoder_t note_fec;
+static int64_t last_batch_us = 0;       // Repeat-only frames keep NOTE_FEC_REPEAT_MS apart
+
+// Unicast peers: part traffic goes only to the boards that play the part
+static uint8_t peer_macs[MAX_MUSICIANS][6];
+static uint32_t peer_mask = 0;          // Bit n = musician n is registered as an ESP-NOW peer
+
+// Event-driven scheduler: next event of every part in a min-heap, a one-shot
+// timer wakes the scheduler task exactly when the earliest one is due
+static event_heap_t event_heap;
+static esp_timer_handle_t event_timer = NULL;
+static TaskHandle_t scheduler_task = NULL;
+
+// Packet-path logging: failures at most every HOT_LOG_SUMMARY_MS, traffic as a summary (status task)
+static hot_log_limit_t send_fail_limit;
+static hot_log_limit_t unicast_fail_limit;
+static hot_log_limit_t delivery_fail_limit;     // Wi-Fi task
+static hot_log_counter_t notes_summary = HOT_LOG_COUNTER("notes sent");
+
+static void event_timer_callback(void *arg);
+static void arm_event_timer(void);
+static int64_t part_send_time_us(uint8_t part);
+static void handle_score_ack(const orchestra_score_ack_t* ack);
+static void handle_join(const uint8_t* mac, const orchestra_join_t* join);
+static void receive_frame(const esp_now_recv_info_t *recv_info, const uint8_t *incomingData, int len,
+                          int64_t rx_time_us);
+
+static void count_send_failure(esp_err_t result) {
+    conductor_state.send_failures++;
+    if (result == ESP_ERR_ESPNOW_NO_MEM) {
+        conductor_state.send_no_mem++;  // Sending faster than the air takes it
+    }
+}
 
 esp_err_t espnow_conductor_init(void) {
     esp_err_t ret;
@@ -36,6 +103,9 @@ esp_err_t espnow_conductor_init(void) {
     }
     ESP_ERROR_CHECK(ret);
 
+    // Boards that joined before keep their musician_id
+    roster_init();
+
     // Initialize network interface
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -62,8 +132,9 @@ esp_err_t espnow_conductor_init(void) {
         return ret;
     }
 
-    // Register send callback
+    // Register send and receive callbacks (musicians send time sync requests)
     ESP_ERROR_CHECK(esp_now_register_send_cb(espnow_on_data_sent));
+    ESP_ERROR_CHECK(esp_now_register_recv_cb(espnow_on_data_recv));
 
     // Add broadcast peer
     esp_now_peer_info_t peerInfo = {};
@@ -77,61 +148,441 @@ esp_err_t espnow_conductor_init(void) {
         return ret;
     }
 
+    conductor_state.lookahead_ms = NOTE_LOOKAHEAD_MS;
+    conductor_state.batch_notes = true;
+    conductor_state.preload_scores = true;
+    conductor_state.unicast_peers = true;
+    reliable_sender_init(&ctrl_sender, (uint16_t)esp_random());
+    score_ack_sem = xSemaphoreCreateBinary();
+    if (score_ack_sem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
     conductor_state.is_initialized = true;
     ESP_LOGI(TAG, "ESP-NOW Conductor initialized successfully");
     return ESP_OK;
 }
 
-esp_err_t espnow_send_message(const orchestra_message_t* msg) {
+esp_err_t espnow_send_frame(const void* frame, size_t len) {
     if (!conductor_state.is_initialized) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    esp_err_t result = esp_now_send(broadcast_addr, (uint8_t*)msg, sizeof(orchestra_message_t));
+    esp_err_t result = esp_now_send(broadcast_addr, (const uint8_t*)frame, len);
     if (result != ESP_OK) {
-        ESP_LOGE(TAG, "ESP-NOW send failed: %s", esp_err_to_name(result));
+        count_send_failure(result);
+        HOT_LOGE_LIMITED(&send_fail_limit, TAG, "ESP-NOW send failed: %s", esp_err_to_name(result));
+    } else {
+        conductor_state.frames_sent++;
     }
     return result;
 }
 
+esp_err_t espnow_send_message(const orchestra_message_t* msg) {
+    return espnow_send_frame(msg, sizeof(orchestra_message_t));
+}
+
+// Control message: next sequence number, sent now and tracked for retransmission
+// until every online board has sent MSG_CTRL_ACK (conductor_poll_control() resends)
+static esp_err_t espnow_send_control(orchestra_message_t* msg) {
+    uint32_t expected_mask = roster_online_mask();
+
+    portENTER_CRITICAL(&ctrl_lock);
+    msg->sequence = reliable_sender_next_sequence(&ctrl_sender);
+    portEXIT_CRITICAL(&ctrl_lock);
+    orchestra_frame_seal(msg, sizeof(*msg));
+
+    esp_err_t result = espnow_send_message(msg);
+
+    portENTER_CRITICAL(&ctrl_lock);
+    bool tracked = reliable_sender_submit(&ctrl_sender, msg, sizeof(*msg), msg->sequence,
+                                          expected_mask, get_time_ms());
+    portEXIT_CRITICAL(&ctrl_lock);
+
+    if (tracked) {
+        conductor_state.ctrl_messages_sent++;
+        if (scheduler_task) {
+            xTaskNotifyGive(scheduler_task); // Retransmissions run in the orchestra task
+        }
+        return ESP_OK; // A failed first send is retried like a lost one
+    }
+    return result;
+}
+
+static esp_err_t espnow_send_to(uint8_t musician_id, const void* frame, size_t len) {
+    esp_err_t result = esp_now_send(peer_macs[musician_id], (const uint8_t*)frame, len);
+    if (result != ESP_OK) {
+        count_send_failure(result);
+        HOT_LOGE_LIMITED(&unicast_fail_limit, TAG, "ESP-NOW send to Musician %d failed: %s", musician_id,
+                         esp_err_to_name(result));
+    } else {
+        conductor_state.frames_sent++;
+        conductor_state.unicast_frames_sent++;
+    }
+    return result;
+}
+
+// Boards that get part traffic one by one, 0 = broadcast it. Unicast only while the part
+// table of a song is valid and every online board has a peer entry - a board left out
+// would miss its notes, a board reached both ways would play them twice.
+static uint32_t unicast_targets(void) {
+    if (!conductor_state.unicast_peers || !current_song) {
+        return 0;
+    }
+    uint32_t online_mask = roster_online_mask();
+    if (online_mask == 0 || (online_mask & ~peer_mask) != 0) {
+        return 0;
+    }
+    return online_mask;
+}
+
+// Frame for some parts only: a copy to each board that plays one of them (MAC-level ACK
+// and retries), or a single broadcast
+static esp_err_t espnow_send_part_frame(uint8_t part_mask, const void* frame, size_t len) {
+    uint32_t targets = unicast_targets();
+    if (targets == 0) {
+        return espnow_send_frame(frame, len);
+    }
+
+    esp_err_t result = ESP_OK; // Nobody plays these parts - nothing to deliver
+    bool delivered = false;
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        if ((targets & (1UL << id)) && (part_assign_mask(&part_assign, id) & part_mask)) {
+            esp_err_t ret = espnow_send_to(id, frame, len);
+            if (ret == ESP_OK) {
+                delivered = true;
+            } else if (!delivered) {
+                result = ret;
+            }
+        }
+    }
+    return delivered ? ESP_OK : result;
+}
+
+// Register online boards as unicast peers (task context, the peer list is not touched from callbacks)
+static void sync_unicast_peers(uint32_t online_mask) {
+    if (!conductor_state.unicast_peers) {
+        return;
+    }
+
+    roster_entry_t entry;
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        if (!(online_mask & (1UL << id)) || !roster_get(id, &entry)) {
+            continue;
+        }
+        if (peer_mask & (1UL << id)) {
+            if (memcmp(peer_macs[id], entry.mac, 6) == 0) {
+                continue;
+            }
+            esp_now_del_peer(peer_macs[id]); // The roster gave this id to another board
+            peer_mask &= ~(1UL << id);
+        }
+        if (__builtin_popcount(peer_mask) >= UNICAST_MAX_PEERS) {
+            return; // The rest stays on broadcast (unicast_targets() sees the gap)
+        }
+
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, entry.mac, 6);
+        peerInfo.channel = ESPNOW_CHANNEL;
+        peerInfo.encrypt = false;
+        esp_err_t ret = esp_now_add_peer(&peerInfo);
+        if (ret == ESP_OK || ret == ESP_ERR_ESPNOW_EXIST) {
+            memcpy(peer_macs[id], entry.mac, 6);
+            peer_mask |= 1UL << id;
+            ESP_LOGI(TAG, "Musician %d added as unicast peer", id);
+        } else {
+            ESP_LOGW(TAG, "Failed to add Musician %d as peer: %s", id, esp_err_to_name(ret));
+        }
+    }
+}
+
 void espnow_on_data_sent(const wifi_tx_info_t *info, esp_now_send_status_t status) {
     if (status != ESP_NOW_SEND_SUCCESS) {
-        ESP_LOGW(TAG, "ESP-NOW send failed to %02x:%02x:%02x:%02x:%02x:%02x", 
-                 info->src_addr[0], info->src_addr[1], info->src_addr[2], 
-                 info->src_addr[3], info->src_addr[4], info->src_addr[5]);
+        // Broadcasts are never acknowledged, so this is a unicast frame that ran out of retries
+        conductor_state.unicast_failures++;
+        HOT_LOGW_LIMITED(&delivery_fail_limit, TAG, "ESP-NOW send failed to %02x:%02x:%02x:%02x:%02x:%02x",
+                         info->des_addr[0], info->des_addr[1], info->des_addr[2],
+                         info->des_addr[3], info->des_addr[4], info->des_addr[5]);
     }
 }
 
+void espnow_on_data_recv(const esp_now_recv_info_t *recv_info, const uint8_t *incomingData, int len) {
+    // Stamp t2 before anything else so the reply reflects the real arrival time
+    int64_t rx_time_us = esp_timer_get_time();
+
+    trace_begin(TRACE_EV_RECV, (uint16_t)len, get_message_type(incomingData, len));
+    receive_frame(recv_info, incomingData, len, rx_time_us);
+    trace_end(TRACE_EV_RECV, 0, 0);
+}
+
+static void receive_frame(const esp_now_recv_info_t *recv_info, const uint8_t *incomingData, int len,
+                          int64_t rx_time_us) {
+    // Boards with older firmware still join and sync - tell the user instead of ignoring them silently
+    uint8_t version = orchestra_frame_version(incomingData, len);
+    if (version != ORCHESTRA_PROTOCOL_VERSION) {
+        uint32_t count = ++conductor_state.other_version_frames;
+        if ((count & (count - 1)) == 0) { // 1st, 2nd, 4th, 8th ... frame
+            ESP_LOGW(TAG, "%02x:%02x:%02x:%02x:%02x:%02x speaks protocol version %d (we are %d) - reflash it",
+                     recv_info->src_addr[0], recv_info->src_addr[1], recv_info->src_addr[2],
+                     recv_info->src_addr[3], recv_info->src_addr[4], recv_info->src_addr[5],
+                     version, ORCHESTRA_PROTOCOL_VERSION);
+        }
+        return;
+    }
+
+    message_type_t type = get_message_type(incomingData, len);
+
+    if (type == MSG_SCORE_ACK && len == sizeof(orchestra_score_ack_t)) {
+        orchestra_score_ack_t ack;
+        memcpy(&ack, incomingData, sizeof(ack));
+        if (orchestra_frame_verify(&ack, sizeof(ack))) {
+            roster_seen(recv_info->src_addr, ack.musician_id);
+            handle_score_ack(&ack);
+        }
+        return;
+    }
+
+    if (type == MSG_CTRL_ACK && len == sizeof(orchestra_ctrl_ack_t)) {
+        orchestra_ctrl_ack_t ack;
+        memcpy(&ack, incomingData, sizeof(ack));
+        if (orchestra_frame_verify(&ack, sizeof(ack))) {
+            roster_seen(recv_info->src_addr, ack.musician_id);
+            portENTER_CRITICAL(&ctrl_lock);
+            reliable_sender_ack(&ctrl_sender, ack.musician_id, ack.sequence);
+            portEXIT_CRITICAL(&ctrl_lock);
+        }
+        return;
+    }
+
+    if (type == MSG_JOIN && len == sizeof(orchestra_join_t)) {
+        orchestra_join_t join;
+        memcpy(&join, incomingData, sizeof(join));
+        if (orchestra_frame_verify(&join, sizeof(join))) {
+            handle_join(recv_info->src_addr, &join);
+        }
+        return;
+    }
+
+    if (type != MSG_SYNC_TIME || len != sizeof(orchestra_sync_message_t)) {
+        return; // Otherwise the conductor only serves time sync requests
+    }
+
+    orchestra_sync_message_t request;
+    memcpy(&request, incomingData, sizeof(request));
+
+    if (request.stage != SYNC_STAGE_REQUEST ||
+        !orchestra_frame_verify(&request, sizeof(request))) {
+        return;
+    }
+
+    send_sync_time(&request, rx_time_us);
+    roster_seen(recv_info->src_addr, request.musician_id);
+}
+
+// Runs in the Wi-Fi task: the roster only records the binding, NVS is written by conductor_check_roster()
+static void handle_join(const uint8_t* mac, const orchestra_join_t* join) {
+    uint8_t musician_id = roster_join(mac, join);
+    if (musician_id == MUSICIAN_ID_NONE) {
+        return;
+    }
+
+    // Broadcast like everything else - the MAC in the frame says who it is for
+    orchestra_join_accept_t accept = {0};
+    accept.header.type = MSG_JOIN_ACCEPT;
+    memcpy(accept.mac, mac, 6);
+    accept.musician_id = musician_id;
+    orchestra_frame_seal(&accept, sizeof(accept));
+    espnow_send_frame(&accept, sizeof(accept));
+}
+
+// Every board of the part has to acknowledge a chunk, the semaphore is given by the last one
+static void handle_score_ack(const orchestra_score_ack_t* ack) {
+    bool complete = false;
+    portENTER_CRITICAL(&score_ack_lock);
+    if (score_ack_pending != 0 && ack->musician_id < MAX_MUSICIANS &&
+        ack->song_id == score_ack_expected.song_id &&
+        ack->part_id == score_ack_expected.part_id &&
+        ack->chunk_index == score_ack_expected.chunk_index) {
+        score_ack_pending &= ~(1UL << ack->musician_id);
+        complete = score_ack_pending == 0;
+    }
+    portEXIT_CRITICAL(&score_ack_lock);
+    if (complete) {
+        xSemaphoreGive(score_ack_sem);
+    }
+}
+
+// Length of one part from its first note to the end of its last one
+static uint32_t part_length_ms(const song_part_t* song_part) {
+    uint32_t length_ms = 0;
+    for (uint16_t i = 0; i < song_part->event_count; i++) {
+        length_ms += song_part->events[i].duration_ms + song_part->events[i].delay_ms;
+    }
+    return length_ms;
+}
+
+// Upload one part as an encoded score in numbered chunks, each one resent until every
+// board in boards (the part's players) acknowledged it. Returns false if one of them
+// is still missing a chunk, or nobody plays the part - it is streamed instead.
+static bool preload_part_score(const orchestra_song_t* song, uint8_t part, uint32_t boards) {
+    const song_part_t* song_part = &song->parts[part];
+    if (boards == 0 || song_part->event_count == 0 || song_part->event_count > SCORE_MAX_EVENTS) {
+        return false;
+    }
+
+    score_part_src_t src = {song_part->events, song_part->event_count};
+    size_t total_len = score_encode(&src, 1, song->tempo_bpm, SCORE_FLAG_RLE,
+                                    score_blob, sizeof(score_blob));
+    if (total_len == 0) {
+        ESP_LOGW(TAG, "Part %d: score does not fit in %d bytes", part, SCORE_MAX_BLOB_LEN);
+        return false;
+    }
+    uint8_t chunk_count = (total_len + SCORE_CHUNK_MAX_BYTES - 1) / SCORE_CHUNK_MAX_BYTES;
+
+    for (uint8_t chunk = 0; chunk < chunk_count; chunk++) {
+        size_t first = (size_t)chunk * SCORE_CHUNK_MAX_BYTES;
+        size_t count = total_len - first;
+        if (count > SCORE_CHUNK_MAX_BYTES) {
+            count = SCORE_CHUNK_MAX_BYTES;
+        }
+
+        score_chunk.header.type = MSG_SCORE_CHUNK;
+        score_chunk.song_id = song->song_id;
+        score_chunk.part_id = part;
+        score_chunk.chunk_index = chunk;
+        score_chunk.chunk_count = chunk_count;
+        score_chunk.data_len = (uint8_t)count;
+        score_chunk.total_len = (uint16_t)total_len;
+        memcpy(score_chunk.data, &score_blob[first], count);
+        size_t len = score_chunk_frame_len((uint8_t)count);
+        orchestra_frame_seal(&score_chunk, len);
+
+        xSemaphoreTake(score_ack_sem, 0); // Drop a stale signal
+        portENTER_CRITICAL(&score_ack_lock);
+        score_ack_expected.song_id = song->song_id;
+        score_ack_expected.part_id = part;
+        score_ack_expected.chunk_index = chunk;
+        score_ack_pending = boards;
+        portEXIT_CRITICAL(&score_ack_lock);
+
+        bool acked = false;
+        for (int attempt = 0; attempt <= SCORE_CHUNK_RETRIES && !acked; attempt++) {
+            if (attempt > 0) {
+                conductor_state.score_chunk_retries++;
+            }
+            if (espnow_send_part_frame(1u << part, &score_chunk, len) == ESP_OK) {
+                conductor_state.score_chunks_sent++;
+            }
+            acked = xSemaphoreTake(score_ack_sem, pdMS_TO_TICKS(SCORE_ACK_TIMEOUT_MS)) == pdTRUE;
+        }
+        portENTER_CRITICAL(&score_ack_lock);
+        uint32_t missing = score_ack_pending;
+        score_ack_pending = 0;
+        portEXIT_CRITICAL(&score_ack_lock);
+
+        if (!acked) {
+            ESP_LOGW(TAG, "Part %d: chunk %d/%d not acknowledged (boards 0x%08lx), part will be streamed",
+                     part, chunk + 1, chunk_count, missing);
+            return false;
+        }
+    }
+
+    ESP_LOGI(TAG, "Part %d: score preloaded (%d events in %d bytes, %d chunks)",
+             part, song_part->event_count, (int)total_len, chunk_count);
+    return true;
+}
+
 bool start_song(uint8_t song_id) {
-    current_song = get_song_by_id(song_id);
-    if (!current_song) {
+    const orchestra_song_t* song = song_library_find(song_id);
+    if (!song) {
         ESP_LOGE(TAG, "Song ID %d not found", song_id);
         return false;
     }
     
+    // Events stay where they are (flash or RAM), only the part table is copied
+    playing_song = *song;
+    if (playing_song.part_count > SONG_LIBRARY_MAX_PARTS) {
+        playing_song.part_count = SONG_LIBRARY_MAX_PARTS;
+    }
+    memcpy(playing_parts, song->parts, playing_song.part_count * sizeof(song_part_t));
+    playing_song.parts = playing_parts;
+    current_song = &playing_song;
+
     ESP_LOGI(TAG, "Starting song: %s", current_song->song_name);
     ESP_LOGI(TAG, "Parts: %d, Tempo: %d BPM", current_song->part_count, current_song->tempo_bpm);
     
-    // Reset playback state
-    song_start_timestamp = get_time_ms();
-    for (int i = 0; i < MAX_MUSICIANS; i++) {
+    // Musicians need a time reference before the first look-ahead note arrives
+    send_heartbeat();
+
+    if (event_timer) {
+        esp_timer_stop(event_timer);
+    }
+
+    // Tell every board which parts it plays in this song (broadcast, so repeated)
+    part_map_build(&part_assign, song_id, current_song->part_count, roster_online_mask());
+    for (int i = 0; i < PART_ASSIGN_REPEAT; i++) {
+        espnow_send_frame(&part_assign, sizeof(part_assign));
+    }
+
+    // Preload mode: upload every part first, parts some online player did not fully acknowledge are streamed
+    // (and parts some board plays as a second part - a musician preloads only one)
+    preloaded_parts = 0;
+    if (conductor_state.preload_scores) {
+        for (uint8_t part = 0; part < current_song->part_count && part < MAX_PARTS; part++) {
+            if (part_map_can_preload(&part_assign, part) &&
+                preload_part_score(current_song, part, part_map_boards(&part_assign, part, roster_online_mask()))) {
+                preloaded_parts |= 1UL << part;
+            }
+        }
+    }
+
+    // Reset playback state - the song starts one look-ahead horizon from now
+    // so that the first notes can also be sent early
+    song_start_us = (esp_timer_get_time() / 1000 + conductor_state.lookahead_ms) * 1000;
+    song_start_timestamp = (uint32_t)(song_start_us / 1000);
+    song_length_ms = 0;
+    for (int i = 0; i < MAX_PARTS; i++) {
         song_position[i] = 0;
         next_event_time[i] = 0;
     }
+    for (uint8_t part = 0; part < current_song->part_count && part < MAX_PARTS; part++) {
+        if (preloaded_parts & (1UL << part)) {
+            uint32_t length_ms = part_length_ms(&current_song->parts[part]);
+            if (length_ms > song_length_ms) {
+                song_length_ms = length_ms;
+            }
+        }
+    }
     
     // Send song start message to all musicians
     orchestra_message_t msg = {0};
-    msg.type = MSG_SONG_START;
+    msg.header.type = MSG_SONG_START;
     msg.song_id = song_id;
     msg.part_id = 0xFF; // All parts
+    msg.note = preloaded_parts ? SONG_FLAG_PRELOADED : 0;
+    msg.velocity = (uint8_t)preloaded_parts; // Only these parts play from the score, the rest is streamed
+    note_fec_encoder_init(&note_fec, conductor_state.batch_notes ? current_song->fec_depth : 0);
+    last_batch_us = 0;
+    if (note_fec.depth > 0) {
+        msg.note |= SONG_FLAG_FEC;
+    }
     msg.tempo_bpm = current_song->tempo_bpm;
     msg.timestamp = song_start_timestamp;
-    msg.checksum = calculate_checksum(&msg);
     
-    if (espnow_send_message(&msg) == ESP_OK) {
+    if (espnow_send_control(&msg) == ESP_OK) {
         conductor_state.is_playing = true;
         conductor_state.current_song_id = song_id;
         conductor_state.song_start_time = song_start_timestamp;
+
+        // Queue the first event of every streamed part and let the scheduler take over
+        // (with everything preloaded the timer only fires once, at the end of the song)
+        event_heap_clear(&event_heap);
+        for (uint8_t part = 0; part < current_song->part_count && part < MAX_PARTS; part++) {
+            if (current_song->parts[part].event_count > 0 && !(preloaded_parts & (1UL << part))) {
+                event_heap_push(&event_heap, part_send_time_us(part), part);
+            }
+        }
+        arm_event_timer();
+
         ESP_LOGI(TAG, "Song start message sent successfully");
         return true;
     } else {
@@ -147,17 +598,25 @@ bool stop_song(void) {
     
     // Send song end message
     orchestra_message_t msg = {0};
-    msg.type = MSG_SONG_END;
+    msg.header.type = MSG_SONG_END;
     msg.song_id = conductor_state.current_song_id;
     msg.part_id = 0xFF; // All parts
     msg.timestamp = get_time_ms();
-    msg.checksum = calculate_checksum(&msg);
     
-    esp_err_t result = espnow_send_message(&msg);
+    // A start nobody confirmed yet must not be resent after the end
+    portENTER_CRITICAL(&ctrl_lock);
+    reliable_sender_cancel_all(&ctrl_sender);
+    portEXIT_CRITICAL(&ctrl_lock);
+    esp_err_t result = espnow_send_control(&msg);
+    trace_request_dump();
     
     // Reset state
     conductor_state.is_playing = false;
     current_song = NULL;
+    if (event_timer) {
+        esp_timer_stop(event_timer);
+    }
+    event_heap_clear(&event_heap);
     
     if (result == ESP_OK) {
         ESP_LOGI(TAG, "Song stop message sent successfully");
@@ -168,115 +627,488 @@ bool stop_song(void) {
     }
 }
 
+esp_err_t conductor_scheduler_init(TaskHandle_t task) {
+    scheduler_task = task;
+    event_heap_clear(&event_heap);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = event_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "song_events",
+        .skip_unhandled_events = true,
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &event_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create event timer: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static void event_timer_callback(void *arg) {
+    // Sending happens in the scheduler task, the timer only wakes it
+    if (scheduler_task) {
+        xTaskNotifyGive(scheduler_task);
+    }
+}
+
+// When the next event of a part has to be sent (its start time minus the look-ahead)
+static int64_t part_send_time_us(uint8_t part) {
+    return song_start_us + ((int64_t)next_event_time[part] - conductor_state.lookahead_ms) * 1000;
+}
+
+// Arm the one-shot timer for the earliest pending event, or for the end of the song
+static void arm_event_timer(void) {
+    if (!event_timer || !conductor_state.is_playing) {
+        return;
+    }
+
+    int64_t due_time_us;
+    heap_event_t next;
+    if (event_heap_peek(&event_heap, &next)) {
+        due_time_us = next.due_time_us;
+    } else {
+        due_time_us = song_start_us + (int64_t)song_length_ms * 1000;
+    }
+
+    // Gap in the stream: wake up for a repeat-only frame while repeats are still useful
+    int64_t now_us = esp_timer_get_time();
+    int64_t repeat_us = last_batch_us + NOTE_FEC_REPEAT_MS * 1000;
+    if (note_fec.depth > 0 && repeat_us < due_time_us && note_fec_encoder_pending(&note_fec, (uint32_t)(now_us / 1000))) {
+        due_time_us = repeat_us;
+    }
+
+    int64_t delay_us = due_time_us - now_us;
+    esp_timer_stop(event_timer); // Not running is fine
+    esp_timer_start_once(event_timer, delay_us > 0 ? (uint64_t)delay_us : 0);
+}
+
+// Pending MSG_NOTE_BATCH being filled by send_song_events()
+static orchestra_batch_message_t note_batch;
+
+static orchestra_batch_message_t board_batch;
+
+// Unicast: every board gets a batch with only the notes of its own parts
+static bool send_board_batches(uint32_t targets) {
+    bool delivered = false;
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        if (!(targets & (1UL << id))) {
+            continue;
+        }
+        uint8_t mask = part_assign_mask(&part_assign, id);
+        board_batch.note_count = 0;
+        for (uint8_t i = 0; i < note_batch.note_count; i++) {
+            if (mask & (1u << note_batch.notes[i].part_id)) {
+                board_batch.notes[board_batch.note_count++] = note_batch.notes[i];
+            }
+        }
+        if (board_batch.note_count == 0) {
+            continue;
+        }
+
+        board_batch.header.type = MSG_NOTE_BATCH;
+        board_batch.song_id = note_batch.song_id;
+        board_batch.base_timestamp = note_batch.base_timestamp;
+        size_t len = note_batch_frame_len(board_batch.note_count);
+        orchestra_frame_seal(&board_batch, len);
+        if (espnow_send_to(id, &board_batch, len) == ESP_OK) {
+            delivered = true;
+        }
+    }
+    return delivered;
+}
+
+// Append repeats of notes sent before that have not started yet, then remember the new notes
+// (repeats start earlier, so the base moves back and the new notes' offsets grow)
+static void add_fec_repeats(uint32_t now_ms) {
+    static fec_note_t fresh[NOTE_BATCH_MAX_NOTES];
+    static fec_note_t repeats[NOTE_BATCH_MAX_NOTES];
+
+    uint8_t new_count = note_batch.note_count;
+    for (uint8_t i = 0; i < new_count; i++) {
+        const batch_note_t* entry = &note_batch.notes[i];
+        fresh[i] = (fec_note_t){note_batch.base_timestamp + entry->start_offset_ms, entry->duration_ms,
+                                entry->part_id, entry->note, entry->velocity};
+    }
+    size_t repeat_count = note_fec_encoder_repeat(&note_fec, repeats, NOTE_BATCH_MAX_NOTES - new_count, now_ms);
+    note_fec_encoder_push(&note_fec, fresh, new_count);
+    if (repeat_count == 0) {
+        return;
+    }
+
+    if (new_count == 0) {
+        note_batch.header.type = MSG_NOTE_BATCH;
+        note_batch.song_id = current_song->song_id;
+        note_batch.base_timestamp = repeats[0].start_ms;
+    }
+    uint32_t base = note_batch.base_timestamp;
+    for (size_t i = 0; i < repeat_count; i++) {
+        if ((int32_t)(repeats[i].start_ms - base) < 0) {
+            base = repeats[i].start_ms;
+        }
+    }
+    uint32_t shift = note_batch.base_timestamp - base;
+    for (uint8_t i = 0; i < new_count; i++) {
+        note_batch.notes[i].start_offset_ms += shift;
+    }
+    note_batch.base_timestamp = base;
+
+    for (size_t i = 0; i < repeat_count; i++) {
+        batch_note_t* entry = &note_batch.notes[note_batch.note_count++];
+        entry->part_id = repeats[i].part_id;
+        entry->note = repeats[i].note;
+        entry->velocity = repeats[i].velocity;
+        entry->start_offset_ms = (uint16_t)(repeats[i].start_ms - base);
+        entry->duration_ms = repeats[i].duration_ms;
+    }
+    conductor_state.fec_notes_repeated += repeat_count;
+}
+
+static void flush_note_batch(void) {
+    uint8_t new_count = note_batch.note_count;
+    int64_t now_us = esp_timer_get_time();
+    if (note_fec.depth > 0 && (new_count > 0 || now_us - last_batch_us >= NOTE_FEC_REPEAT_MS * 1000)) {
+        add_fec_repeats((uint32_t)(now_us / 1000));
+    }
+    if (note_batch.note_count == 0) {
+        return;
+    }
+
+    bool sent;
+    uint32_t targets = unicast_targets();
+    if (targets != 0) {
+        sent = send_board_batches(targets);
+    } else {
+        size_t len = note_batch_frame_len(note_batch.note_count);
+        orchestra_frame_seal(&note_batch, len);
+        sent = espnow_send_frame(&note_batch, len) == ESP_OK;
+    }
+
+    last_batch_us = now_us;
+    if (sent) {
+        conductor_state.notes_sent += new_count;
+        HOT_LOGI(TAG, "Batch: %d notes (+%d repeated) from +%lu ms%s", new_count, note_batch.note_count - new_count,
+                 note_batch.base_timestamp - song_start_timestamp, targets ? " (unicast)" : "");
+    }
+    note_batch.note_count = 0;
+}
+
+static void queue_note_event(uint8_t part, const note_event_t* event, uint32_t start_timestamp) {
+    if (!conductor_state.batch_notes) {
+        orchestra_message_t msg = {0};
+        msg.header.type = MSG_PLAY_NOTE;
+        msg.song_id = current_song->song_id;
+        msg.part_id = part;
+        msg.note = event->note;
+        msg.velocity = 100; // Default velocity
+        msg.duration_ms = event->duration_ms;
+        msg.timestamp = start_timestamp; // Start time (conductor time)
+        orchestra_frame_seal(&msg, sizeof(msg));
+
+        if (espnow_send_part_frame(1u << part, &msg, sizeof(msg)) == ESP_OK) {
+            conductor_state.notes_sent++;
+            HOT_LOGI(TAG, "Part %d: Note %d (%.1f Hz) for %d ms at +%lu ms",
+                     part, event->note,
+                     midi_note_to_frequency(event->note),
+                     event->duration_ms, start_timestamp - song_start_timestamp);
+        }
+        return;
+    }
+
+    // Events leave the heap in time order, so the first one is the earliest
+    if (note_batch.note_count == 0) {
+        note_batch.header.type = MSG_NOTE_BATCH;
+        note_batch.song_id = current_song->song_id;
+        note_batch.base_timestamp = start_timestamp;
+    }
+
+    batch_note_t* entry = &note_batch.notes[note_batch.note_count++];
+    entry->part_id = part;
+    entry->note = event->note;
+    entry->velocity = 100; // Default velocity
+    entry->start_offset_ms = (uint16_t)(start_timestamp - note_batch.base_timestamp);
+    entry->duration_ms = event->duration_ms;
+
+    // With FEC part of every frame is kept free for repeats
+    if (note_batch.note_count >= note_fec_new_notes_limit(&note_fec, NOTE_BATCH_MAX_NOTES)) {
+        flush_note_batch();
+    }
+}
+
 void send_song_events(void) {
     if (!current_song || !conductor_state.is_playing) {
         return;
     }
     
-    uint32_t current_time = get_time_ms();
-    uint32_t song_elapsed_time = current_time - song_start_timestamp;
+    int64_t now_us = esp_timer_get_time();
+    trace_begin(TRACE_EV_SEND_EVENTS, (uint16_t)event_heap.count, 0);
+    uint16_t events_sent = 0;
     
-    // Check each part for events that need to be sent
-    for (uint8_t part = 0; part < current_song->part_count && part < MAX_MUSICIANS; part++) {
+    // Events due within the batch window go out together in one frame
+    // (never earlier than the look-ahead allows)
+    uint32_t window_ms = 0;
+    if (conductor_state.batch_notes) {
+        window_ms = conductor_state.lookahead_ms < NOTE_BATCH_WINDOW_MS ?
+                    conductor_state.lookahead_ms : NOTE_BATCH_WINDOW_MS;
+    }
+    int64_t send_until_us = now_us + (int64_t)window_ms * 1000;
+    heap_event_t due;
+    note_batch.note_count = 0;
+
+    // Send every event whose send time has come, earliest first
+    while (event_heap_peek(&event_heap, &due) && due.due_time_us <= send_until_us) {
+        event_heap_pop(&event_heap, &due);
+        stress_test_record_send(now_us - due.due_time_us);
+        events_sent++;
+        uint8_t part = due.part;
         const song_part_t* song_part = &current_song->parts[part];
-        uint32_t part_position = song_position[part];
+        const note_event_t* event = &song_part->events[song_position[part]];
         
-        // Check if we have more events in this part
-        if (part_position >= song_part->event_count) {
-            continue;
+        if (event->note != NOTE_REST && event->duration_ms > 0) {
+            queue_note_event(part, event, song_start_timestamp + next_event_time[part]);
         }
         
-        // Check if it's time for the next event
-        if (song_elapsed_time >= next_event_time[part]) {
-            const note_event_t* event = &song_part->events[part_position];
-            
-            // Send note command
-            if (event->note != NOTE_REST && event->duration_ms > 0) {
-                orchestra_message_t msg = {0};
-                msg.type = MSG_PLAY_NOTE;
-                msg.song_id = current_song->song_id;
-                msg.part_id = part;
-                msg.note = event->note;
-                msg.velocity = 100; // Default velocity
-                msg.duration_ms = event->duration_ms;
-                msg.timestamp = current_time;
-                msg.checksum = calculate_checksum(&msg);
-                
-                if (espnow_send_message(&msg) == ESP_OK) {
-                    ESP_LOGI(TAG, "Part %d: Note %d (%.1f Hz) for %d ms", 
-                             part, event->note, 
-                             midi_note_to_frequency(event->note), 
-                             event->duration_ms);
-                }
-            }
-            
-            // Update timing for next event
-            next_event_time[part] += event->duration_ms + event->delay_ms;
-            song_position[part]++;
-            
-            // Check if this part is finished
-            if (song_position[part] >= song_part->event_count) {
-                ESP_LOGI(TAG, "Part %d finished", part);
+        // Update timing for next event
+        next_event_time[part] += event->duration_ms + event->delay_ms;
+        song_position[part]++;
+
+        if (song_position[part] < song_part->event_count) {
+            event_heap_push(&event_heap, part_send_time_us(part), part);
+        } else {
+            ESP_LOGI(TAG, "Part %d finished", part);
+            if (next_event_time[part] > song_length_ms) {
+                song_length_ms = next_event_time[part];
             }
         }
     }
+    flush_note_batch();
+    trace_end(TRACE_EV_SEND_EVENTS, events_sent, 0);
     
-    // Check if all parts are finished
-    bool all_parts_finished = true;
-    for (uint8_t part = 0; part < current_song->part_count && part < MAX_MUSICIANS; part++) {
-        if (song_position[part] < current_song->parts[part].event_count) {
-            all_parts_finished = false;
-            break;
-        }
-    }
-    
-    if (all_parts_finished) {
+    // All parts sent - finish once the last note has actually been played
+    if (event_heap.count == 0 && now_us >= song_start_us + (int64_t)song_length_ms * 1000) {
         ESP_LOGI(TAG, "Song finished!");
         stop_song();
+        return;
     }
+
+    arm_event_timer();
 }
 
 bool send_note_command(uint8_t part_id, uint8_t note, uint8_t velocity, uint16_t duration_ms) {
     orchestra_message_t msg = {0};
-    msg.type = MSG_PLAY_NOTE;
+    msg.header.type = MSG_PLAY_NOTE;
     msg.song_id = conductor_state.current_song_id;
     msg.part_id = part_id;
     msg.note = note;
     msg.velocity = velocity;
     msg.duration_ms = duration_ms;
     msg.timestamp = get_time_ms();
-    msg.checksum = calculate_checksum(&msg);
+    orchestra_frame_seal(&msg, sizeof(msg));
     
+    if (part_id < MAX_PARTS) {
+        return (espnow_send_part_frame(1u << part_id, &msg, sizeof(msg)) == ESP_OK);
+    }
     return (espnow_send_message(&msg) == ESP_OK);
 }
 
-bool send_sync_time(void) {
-    orchestra_message_t msg = {0};
-    msg.type = MSG_SYNC_TIME;
-    msg.timestamp = get_time_ms();
-    msg.checksum = calculate_checksum(&msg);
+bool send_sync_time(const orchestra_sync_message_t* request, int64_t rx_time_us) {
+    if (!conductor_state.is_initialized) {
+        return false;
+    }
     
-    return (espnow_send_message(&msg) == ESP_OK);
+    // Reply echoes t1 and adds our receive (t2) and transmit (t3) times.
+    // Stays broadcast: a MAC-level retry would go out after t3 and skew the offset.
+    orchestra_sync_message_t reply = {0};
+    reply.header.type = MSG_SYNC_TIME;
+    reply.stage = SYNC_STAGE_REPLY;
+    reply.musician_id = request->musician_id;
+    reply.sequence = request->sequence;
+    reply.t1_us = request->t1_us;
+    reply.t2_us = rx_time_us;
+    reply.t3_us = esp_timer_get_time();
+    orchestra_frame_seal(&reply, sizeof(reply));
+
+    esp_err_t result = esp_now_send(broadcast_addr, (uint8_t*)&reply, sizeof(reply));
+    if (result == ESP_OK) {
+        conductor_state.sync_requests_served++;
+    }
+    return (result == ESP_OK);
+}
+
+bool conductor_set_lookahead_ms(uint16_t lookahead_ms) {
+    if (conductor_state.is_playing) {
+        ESP_LOGW(TAG, "Cannot change look-ahead while playing");
+        return false;
+    }
+
+    conductor_state.lookahead_ms = lookahead_ms;
+    ESP_LOGI(TAG, "Look-ahead set to %d ms", lookahead_ms);
+    return true;
+}
+
+bool conductor_set_batching(bool enabled) {
+    if (conductor_state.is_playing) {
+        ESP_LOGW(TAG, "Cannot change batching while playing");
+        return false;
+    }
+
+    conductor_state.batch_notes = enabled;
+    ESP_LOGI(TAG, "Note batching %s", enabled ? "enabled" : "disabled");
+    return true;
+}
+
+bool conductor_set_preload(bool enabled) {
+    if (conductor_state.is_playing) {
+        ESP_LOGW(TAG, "Cannot change score preload while playing");
+        return false;
+    }
+
+    conductor_state.preload_scores = enabled;
+    ESP_LOGI(TAG, "Score preload %s", enabled ? "enabled" : "disabled");
+    return true;
+}
+
+bool conductor_set_unicast(bool enabled) {
+    if (conductor_state.is_playing) {
+        ESP_LOGW(TAG, "Cannot change unicast peers while playing");
+        return false;
+    }
+
+    conductor_state.unicast_peers = enabled;
+    ESP_LOGI(TAG, "Unicast peers %s", enabled ? "enabled" : "disabled");
+    return true;
 }
 
 bool send_heartbeat(void) {
     orchestra_message_t msg = {0};
-    msg.type = MSG_HEARTBEAT;
+    msg.header.type = MSG_HEARTBEAT;
     msg.timestamp = get_time_ms();
-    msg.checksum = calculate_checksum(&msg);
+    orchestra_frame_seal(&msg, sizeof(msg));
     
     return (espnow_send_message(&msg) == ESP_OK);
 }
 
+// Take over a part that was preloaded on a board that went silent: stream it from
+// the first event that can still be sent in time
+static void stream_part_from_now(uint8_t part) {
+    const song_part_t* song_part = &current_song->parts[part];
+    uint32_t target_ms = (uint32_t)((esp_timer_get_time() - song_start_us) / 1000) + conductor_state.lookahead_ms;
+    uint32_t time_ms = 0;
+    uint16_t position = 0;
+    while (position < song_part->event_count && time_ms < target_ms) {
+        time_ms += song_part->events[position].duration_ms + song_part->events[position].delay_ms;
+        position++;
+    }
+
+    preloaded_parts &= ~(1UL << part);
+    song_position[part] = position;
+    next_event_time[part] = time_ms;
+    if (position < song_part->event_count) {
+        event_heap_push(&event_heap, part_send_time_us(part), part);
+        ESP_LOGI(TAG, "Part %d: now streamed from event %d (+%lu ms)", part, position, time_ms);
+    }
+}
+
+uint32_t conductor_poll_control(void) {
+    static uint8_t frame[RELIABLE_MAX_FRAME];
+    uint32_t now_ms = get_time_ms();
+
+    while (true) {
+        portENTER_CRITICAL(&ctrl_lock);
+        uint32_t expired = ctrl_sender.stats.expired;
+        size_t len = reliable_sender_poll(&ctrl_sender, now_ms, frame, sizeof(frame));
+        bool gave_up = ctrl_sender.stats.expired != expired;
+        uint32_t missing_mask = ctrl_sender.stats.last_expired_mask;
+        portEXIT_CRITICAL(&ctrl_lock);
+
+        if (gave_up) {
+            ESP_LOGW(TAG, "Control message not acknowledged by musicians mask 0x%08lx", missing_mask);
+        }
+        if (len == 0) {
+            break;
+        }
+        espnow_send_frame(frame, len);
+    }
+
+    portENTER_CRITICAL(&ctrl_lock);
+    uint32_t next_ms = reliable_sender_next_due_ms(&ctrl_sender, now_ms);
+    portEXIT_CRITICAL(&ctrl_lock);
+    return next_ms;
+}
+
+void conductor_check_roster(void) {
+    static uint32_t last_online_mask = 0;
+    uint32_t lost = roster_check();
+    uint32_t online_mask = roster_online_mask();
+    conductor_state.connected_musicians = (uint8_t)__builtin_popcount(online_mask);
+    sync_unicast_peers(online_mask);
+
+    if (!conductor_state.is_playing || !current_song) {
+        last_online_mask = online_mask;
+        return;
+    }
+
+    // Boards that went silent mid-song: survivors pick up the parts nobody plays any more
+    uint8_t moved = 0;
+    if (lost) {
+        uint8_t voices[MAX_MUSICIANS] = {0};
+        roster_entry_t entry;
+        for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+            if (roster_get(id, &entry)) {
+                voices[id] = entry.voices;
+            }
+        }
+        moved = part_map_cover(&part_assign, online_mask, voices);
+        for (uint8_t part = 0; part < current_song->part_count && part < MAX_PARTS; part++) {
+            if ((moved & (1u << part)) && (preloaded_parts & (1UL << part))) {
+                stream_part_from_now(part);
+            }
+        }
+        if (moved) {
+            arm_event_timer();
+        }
+    }
+
+    // Resend the table when parts moved or a board came back (it may have missed the first one)
+    if (moved || (online_mask & ~last_online_mask)) {
+        for (int i = 0; i < PART_ASSIGN_REPEAT; i++) {
+            espnow_send_frame(&part_assign, sizeof(part_assign));
+        }
+    }
+    last_online_mask = online_mask;
+}
+
 void update_conductor_status(void) {
     static uint32_t last_status_update = 0;
     uint32_t current_time = get_time_ms();
     
+    hot_log_summary(TAG, &notes_summary, conductor_state.notes_sent);
+
     if (current_time - last_status_update > 10000) { // Every 10 seconds
         ESP_LOGI(TAG, "Conductor Status:");
         ESP_LOGI(TAG, "  Initialized: %s", conductor_state.is_initialized ? "Yes" : "No");
         ESP_LOGI(TAG, "  Playing: %s", conductor_state.is_playing ? "Yes" : "No");
         ESP_LOGI(TAG, "  Selected Song: %d", conductor_state.current_song_id);
+        ESP_LOGI(TAG, "  Sync Requests Served: %lu", conductor_state.sync_requests_served);
+        ESP_LOGI(TAG, "  Frames Sent: %lu, Notes Sent: %lu", conductor_state.frames_sent, conductor_state.notes_sent);
+        if (conductor_state.send_failures > 0) {
+            ESP_LOGW(TAG, "  Send Failures: %lu (queue full: %lu)", conductor_state.send_failures,
+                     conductor_state.send_no_mem);
+        }
+        ESP_LOGI(TAG, "  Score Chunks Sent: %lu (retries: %lu)",
+                 conductor_state.score_chunks_sent, conductor_state.score_chunk_retries);
+        ESP_LOGI(TAG, "  Musicians Online: %d", conductor_state.connected_musicians);
+        ESP_LOGI(TAG, "  Control: %lu sent, %lu retransmits, %lu acked by all, %lu expired",
+                 conductor_state.ctrl_messages_sent, ctrl_sender.stats.retransmits,
+                 ctrl_sender.stats.completed, ctrl_sender.stats.expired);
+        ESP_LOGI(TAG, "  Note FEC: depth %d, %lu notes repeated", note_fec.depth, conductor_state.fec_notes_repeated);
+        if (conductor_state.other_version_frames > 0) {
+            ESP_LOGW(TAG, "  Frames from other protocol versions: %lu", conductor_state.other_version_frames);
+        }
+        ESP_LOGI(TAG, "  Unicast: %s, %d peers, %lu frames (failed after retries: %lu)",
+                 unicast_targets() ? "active" : conductor_state.unicast_peers ? "broadcast fallback" : "off",
+                 __builtin_popcount(peer_mask), conductor_state.unicast_frames_sent, conductor_state.unicast_failures);
+        roster_print();
         
         if (current_song) {
             ESP_LOGI(TAG, "  Current Song: %s", current_song->song_name);
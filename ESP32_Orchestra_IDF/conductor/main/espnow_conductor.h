@@ -3,6 +3,8 @@
 
 #include "esp_now.h"
 #include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "orchestra_common.h"
 
 // Conductor State
@@ -13,19 +15,54 @@ typedef struct {
     uint32_t song_start_time;
     uint32_t last_heartbeat;
     uint8_t connected_musicians;
+    uint16_t lookahead_ms;      // ส่งโน๊ตล่วงหน้ากี่ ms (0 = ส่งตอนถึงเวลาเล่น)
+    uint32_t sync_requests_served;
+    bool batch_notes;           // รวมโน๊ตที่ถึงเวลาใกล้กันเป็น MSG_NOTE_BATCH
+    uint32_t frames_sent;
+    uint32_t notes_sent;
+    bool preload_scores;        // ส่งโน๊ตทั้ง part ให้ Musician ก่อนเริ่มเพลง
+    uint32_t score_chunks_sent;
+    uint32_t score_chunk_retries;
+    bool unicast_peers;         // ส่งโน๊ต/score ของแต่ละ part ตรงไปยังบอร์ดที่เล่น part นั้น
+    uint32_t unicast_frames_sent;
+    uint32_t unicast_failures;  // ไม่ได้ MAC ACK หลัง retry ครบ
+    uint32_t ctrl_messages_sent; // Song start/end ที่ต้องได้ MSG_CTRL_ACK
+    uint32_t fec_notes_repeated; // โน๊ตที่ส่งซ้ำใน batch ถัดไป (note FEC ของเพลง)
+    uint32_t other_version_frames; // Frame จาก firmware ที่ ORCHESTRA_PROTOCOL_VERSION ไม่ตรง
+    uint32_t send_failures;     // esp_now_send() ไม่รับ frame (ทุก error)
+    uint32_t send_no_mem;       // ในนั้น ESP_ERR_ESPNOW_NO_MEM: คิวส่งของ Wi-Fi เต็ม
 } conductor_state_t;
 
+// Unicast peers: above this many online boards one broadcast costs less airtime than
+// per-board copies (ESP-NOW allows ESP_NOW_MAX_TOTAL_PEER_NUM peers, broadcast included)
+#define UNICAST_MAX_PEERS       8
+
 // ESP-NOW Functions
 esp_err_t espnow_conductor_init(void);
 esp_err_t espnow_send_message(const orchestra_message_t* msg);
+esp_err_t espnow_send_frame(const void* frame, size_t len);
 void espnow_on_data_sent(const wifi_tx_info_t *info, esp_now_send_status_t status);
+void espnow_on_data_recv(const esp_now_recv_info_t *recv_info, const uint8_t *incomingData, int len);
+
+// Scheduler (wakes the given task whenever song events are due)
+esp_err_t conductor_scheduler_init(TaskHandle_t task);
 
 // Orchestra Control Functions
 bool start_song(uint8_t song_id);
 bool stop_song(void);
 bool send_note_command(uint8_t part_id, uint8_t note, uint8_t velocity, uint16_t duration_ms);
-bool send_sync_time(void);
+bool send_sync_time(const orchestra_sync_message_t* request, int64_t rx_time_us);
 bool send_heartbeat(void);
+bool conductor_set_lookahead_ms(uint16_t lookahead_ms);
+bool conductor_set_batching(bool enabled);
+bool conductor_set_preload(bool enabled);
+bool conductor_set_unicast(bool enabled);
+
+// Control retransmissions (call from the scheduler task). Returns ms until the next one is due.
+uint32_t conductor_poll_control(void);
+
+// Roster (call periodically from a task): online count, parts of boards that went silent
+void conductor_check_roster(void);
 
 // Helper Functions
 void update_conductor_status(void);
@@ -0,0 +1,73 @@
+/*
+ * Event Heap Implementation
+ * Min-heap ของ event ถัดไปของแต่ละ part เรียงตามเวลาที่ต้องส่ง
+ */
+
+#include "event_heap.h"
+
+static void swap_events(heap_event_t* a, heap_event_t* b) {
+    heap_event_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+void event_heap_clear(event_heap_t* heap) {
+    heap->count = 0;
+}
+
+bool event_heap_push(event_heap_t* heap, int64_t due_time_us, uint8_t part) {
+    if (heap->count >= EVENT_HEAP_CAPACITY) {
+        return false;
+    }
+
+    // Sift up
+    uint8_t i = heap->count++;
+    heap->events[i].due_time_us = due_time_us;
+    heap->events[i].part = part;
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (heap->events[parent].due_time_us <= heap->events[i].due_time_us) {
+            break;
+        }
+        swap_events(&heap->events[parent], &heap->events[i]);
+        i = parent;
+    }
+    return true;
+}
+
+bool event_heap_peek(const event_heap_t* heap, heap_event_t* out) {
+    if (heap->count == 0) {
+        return false;
+    }
+    *out = heap->events[0];
+    return true;
+}
+
+bool event_heap_pop(event_heap_t* heap, heap_event_t* out) {
+    if (heap->count == 0) {
+        return false;
+    }
+
+    *out = heap->events[0];
+    heap->events[0] = heap->events[--heap->count];
+
+    // Sift down
+    uint8_t i = 0;
+    while (true) {
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = i;
+        if (left < heap->count && heap->events[left].due_time_us < heap->events[smallest].due_time_us) {
+            smallest = left;
+        }
+        if (right < heap->count && heap->events[right].due_time_us < heap->events[smallest].due_time_us) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        swap_events(&heap->events[i], &heap->events[smallest]);
+        i = smallest;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef EVENT_HEAP_H
+#define EVENT_HEAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "orchestra_common.h"
+
+#define EVENT_HEAP_CAPACITY MAX_PARTS  // One pending event per part
+
+// Next event of one part, keyed by the absolute time it is due (esp_timer clock)
+typedef struct {
+    int64_t due_time_us;
+    uint8_t part;
+} heap_event_t;
+
+// Binary min-heap ordered by due_time_us
+typedef struct {
+    heap_event_t events[EVENT_HEAP_CAPACITY];
+    uint8_t count;
+} event_heap_t;
+
+// Heap Functions
+void event_heap_clear(event_heap_t* heap);
+bool event_heap_push(event_heap_t* heap, int64_t due_time_us, uint8_t part);
+bool event_heap_peek(const event_heap_t* heap, heap_event_t* out);
+bool event_heap_pop(event_heap_t* heap, heap_event_t* out);
+
+#endif // EVENT_HEAP_H
@@ -0,0 +1,210 @@
+/*
+ * MIDI Import for ESP-IDF
+ * แปลง Standard MIDI File เป็น orchestra_song_t ใน RAM ระหว่างอ่าน (ไม่ต้องโหลดทั้งไฟล์)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "midi_import.h"
+
+static const char *TAG = "MIDI_IMPORT";
+
+static const char* const part_names[SMF_MAX_PARTS] = {"Part A", "Part B", "Part C", "Part D"};
+static orchestra_song_t* imported_songs[MIDI_IMPORT_MAX_SONGS] = {0};
+
+static void free_song(orchestra_song_t* song) {
+    if (!song) {
+        return;
+    }
+    for (uint8_t p = 0; p < song->part_count; p++) {
+        free((void*)song->parts[p].events);
+    }
+    free((void*)song->parts);
+    free((void*)song->song_name);
+    free(song);
+}
+
+static esp_err_t smf_to_esp_err(smf_result_t result) {
+    switch (result) {
+        case SMF_OK:              return ESP_OK;
+        case SMF_ERR_UNSUPPORTED: return ESP_ERR_NOT_SUPPORTED;
+        case SMF_ERR_TRUNCATED:   return ESP_ERR_INVALID_SIZE;
+        default:                  return ESP_ERR_INVALID_ARG;
+    }
+}
+
+// Turn the parser output into an orchestra_song_t, the event buffers are shrunk and reused
+static orchestra_song_t* build_song(smf_parser_t* parser, score_note_t* buffers[SMF_MAX_PARTS],
+                                    uint8_t song_id, const char* name) {
+    uint8_t part_count = 0;
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        if (parser->parts[p].count > 0) {
+            part_count = p + 1; // Part index is the musician id, so gaps stay
+        }
+    }
+
+    orchestra_song_t* song = calloc(1, sizeof(orchestra_song_t));
+    song_part_t* parts = calloc(part_count, sizeof(song_part_t));
+    char* song_name = malloc(strlen(name) + 1);
+    if (!song || !parts || !song_name) {
+        free(song);
+        free(parts);
+        free(song_name);
+        return NULL;
+    }
+    strcpy(song_name, name);
+
+    for (uint8_t p = 0; p < part_count; p++) {
+        uint16_t count = parser->parts[p].count;
+        score_note_t* events = NULL;
+        if (count > 0) {
+            events = realloc(buffers[p], count * sizeof(score_note_t));
+            if (!events) {
+                events = buffers[p]; // Shrinking failed, keep the big buffer
+            }
+            buffers[p] = NULL;
+        }
+        parts[p].events = events;
+        parts[p].event_count = count;
+        parts[p].part_name = part_names[p];
+    }
+
+    song->song_name = song_name;
+    song->song_id = song_id;
+    song->tempo_bpm = smf_parser_tempo_bpm(parser);
+    song->part_count = part_count;
+    song->parts = parts;
+    return song;
+}
+
+esp_err_t midi_import_song(midi_read_fn_t read, void* ctx, uint8_t song_id, const char* name,
+                           const smf_config_t* config, const orchestra_song_t** out) {
+    smf_parser_t* parser = malloc(sizeof(smf_parser_t));
+    uint8_t* chunk = malloc(MIDI_IMPORT_READ_SIZE);
+    score_note_t* buffers[SMF_MAX_PARTS] = {0};
+    esp_err_t ret = ESP_OK;
+
+    if (!parser || !chunk) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    smf_parser_init(parser, config);
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        buffers[p] = malloc(MIDI_IMPORT_MAX_EVENTS * sizeof(score_note_t));
+        if (!buffers[p]) {
+            ret = ESP_ERR_NO_MEM;
+            goto cleanup;
+        }
+        smf_parser_set_part_buffer(parser, p, buffers[p], MIDI_IMPORT_MAX_EVENTS);
+    }
+
+    // Feed the file piece by piece
+    int n;
+    smf_result_t result = SMF_OK;
+    while (result == SMF_OK && (n = read(ctx, chunk, MIDI_IMPORT_READ_SIZE)) > 0) {
+        result = smf_parser_feed(parser, chunk, (size_t)n);
+    }
+    if (result == SMF_OK) {
+        result = smf_parser_finish(parser);
+    }
+    if (result != SMF_OK) {
+        ESP_LOGE(TAG, "Import of song %d failed: %s", song_id, smf_result_name(result));
+        ret = smf_to_esp_err(result);
+        goto cleanup;
+    }
+
+    bool has_notes = false;
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        has_notes |= parser->parts[p].count > 0;
+        if (parser->parts[p].overflow) {
+            ESP_LOGW(TAG, "Part %d truncated to %d events", p, MIDI_IMPORT_MAX_EVENTS);
+        }
+    }
+    if (!has_notes) {
+        ESP_LOGE(TAG, "Song %d has no notes on the selected tracks/channels", song_id);
+        ret = ESP_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    orchestra_song_t* song = build_song(parser, buffers, song_id, name);
+    if (!song) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    // Replace an earlier import with the same id, otherwise take a free slot
+    int slot = -1;
+    for (int i = 0; i < MIDI_IMPORT_MAX_SONGS; i++) {
+        if (imported_songs[i] && imported_songs[i]->song_id == song_id) {
+            slot = i;
+            break;
+        }
+        if (!imported_songs[i] && slot < 0) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        free_song(song);
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+    free_song(imported_songs[slot]);
+    imported_songs[slot] = song;
+
+    ESP_LOGI(TAG, "Imported song %d \"%s\": %d parts, %d BPM", song_id, name,
+             song->part_count, song->tempo_bpm);
+    if (out) {
+        *out = song;
+    }
+
+cleanup:
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        free(buffers[p]);
+    }
+    free(chunk);
+    free(parser);
+    return ret;
+}
+
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+} memory_reader_t;
+
+static int read_memory(void* ctx, uint8_t* buf, size_t len) {
+    memory_reader_t* reader = ctx;
+    size_t n = reader->len - reader->pos;
+    if (n > len) {
+        n = len;
+    }
+    memcpy(buf, reader->data + reader->pos, n);
+    reader->pos += n;
+    return (int)n;
+}
+
+esp_err_t midi_import_from_memory(const uint8_t* data, size_t len, uint8_t song_id, const char* name,
+                                  const smf_config_t* config, const orchestra_song_t** out) {
+    memory_reader_t reader = {data, len, 0};
+    return midi_import_song(read_memory, &reader, song_id, name, config, out);
+}
+
+const orchestra_song_t* midi_import_find_song(uint8_t song_id) {
+    for (int i = 0; i < MIDI_IMPORT_MAX_SONGS; i++) {
+        if (imported_songs[i] && imported_songs[i]->song_id == song_id) {
+            return imported_songs[i];
+        }
+    }
+    return NULL;
+}
+
+void midi_import_free_song(uint8_t song_id) {
+    for (int i = 0; i < MIDI_IMPORT_MAX_SONGS; i++) {
+        if (imported_songs[i] && imported_songs[i]->song_id == song_id) {
+            free_song(imported_songs[i]);
+            imported_songs[i] = NULL;
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef MIDI_IMPORT_H
+#define MIDI_IMPORT_H
+
+#include "esp_err.h"
+#include "midi_songs.h"
+#include "smf_parser.h"
+
+#define MIDI_IMPORT_MAX_SONGS   4       // เพลงที่ import แล้วเก็บไว้ใน RAM พร้อมกันได้
+#define MIDI_IMPORT_MAX_EVENTS  SCORE_MAX_EVENTS  // โน๊ตสูงสุดต่อ part
+#define MIDI_IMPORT_READ_SIZE   256     // อ่าน SMF ทีละกี่ byte
+
+// Reads up to len bytes, returns the number read (0 = end of file, < 0 = error)
+typedef int (*midi_read_fn_t)(void* ctx, uint8_t* buf, size_t len);
+
+// Import Functions (config NULL = SMF_MAP_AUTO, parts in order of first note)
+esp_err_t midi_import_song(midi_read_fn_t read, void* ctx, uint8_t song_id, const char* name,
+                           const smf_config_t* config, const orchestra_song_t** out);
+esp_err_t midi_import_from_memory(const uint8_t* data, size_t len, uint8_t song_id, const char* name,
+                                  const smf_config_t* config, const orchestra_song_t** out);
+const orchestra_song_t* midi_import_find_song(uint8_t song_id);
+void midi_import_free_song(uint8_t song_id);   // ห้ามเรียกระหว่างที่เพลงนั้นกำลังเล่น
+
+#endif // MIDI_IMPORT_H
@@ -2,13 +2,10 @@
 #define MIDI_SONGS_H
 
 #include "orchestra_common.h"
+#include "score_codec.h"
 
-// Note Event Structure for Orchestra
-typedef struct {
-    uint8_t note;           // MIDI note number (0 = rest)
-    uint16_t duration_ms;   // ความยาวโน๊ต
-    uint16_t delay_ms;      // หน่วงเวลาก่อนโน๊ตถัดไป
-} note_event_t;
+// Note Event Structure for Orchestra (same layout as the binary score codec)
+typedef score_note_t note_event_t;
 
 // Song Part Structure
 typedef struct {
@@ -17,12 +14,16 @@ typedef struct {
     const char* part_name;       // ชื่อ part
 } song_part_t;
 
+// Event count comes from the array itself - no end marker needed
+#define SONG_PART(events, name) {events, sizeof(events) / sizeof((events)[0]), name}
+
 // Complete Song Structure  
 typedef struct {
     const char* song_name;      // ชื่อเพลง
     uint8_t song_id;           // รหัสเพลง
     uint8_t tempo_bpm;         // Beats per minute
     uint8_t part_count;        // จำนวน parts
+    uint8_t fec_depth;         // Note FEC: ส่งโน๊ตของกี่ batch ก่อนหน้าซ้ำ (0 = ปิด, สูงสุด NOTE_FEC_MAX_DEPTH)
     const song_part_t* parts;  // Array ของ parts
 } orchestra_song_t;
 
@@ -79,7 +80,6 @@ static const note_event_t twinkle_melody[] = {
     {NOTE_D4, 400, 100},  // what
     {NOTE_D4, 400, 100},  // you
     {NOTE_C4, 800, 400},  // are
-    {NOTE_REST, 0, 0}     // End
 };
 
 // Part B: Harmony (3rd above melody)
@@ -131,7 +131,6 @@ static const note_event_t twinkle_harmony[] = {
     {NOTE_F4, 400, 100},  // Harmony for D
     {NOTE_F4, 400, 100},  // Harmony for D
     {NOTE_E4, 800, 400},  // Harmony for C
-    {NOTE_REST, 0, 0}     // End
 };
 
 // Part C: Bass Line (octave lower)
@@ -165,7 +164,6 @@ static const note_event_t twinkle_bass[] = {
     {NOTE_C3, 800, 200},  // C chord
     {NOTE_G3, 800, 200},  // G chord
     {NOTE_C3, 800, 400},  // C chord (end)
-    {NOTE_REST, 0, 0}     // End
 };
 
 // Part D: Rhythm/Percussion (using different frequencies)
@@ -195,15 +193,14 @@ static const note_event_t twinkle_rhythm[] = {
     {NOTE_G3, 200, 200}, {NOTE_REST, 0, 200}, {NOTE_G3, 200, 600},
     {NOTE_G3, 200, 200}, {NOTE_REST, 0, 200}, {NOTE_G3, 200, 200}, {NOTE_REST, 0, 200},
     {NOTE_G3, 200, 200}, {NOTE_REST, 0, 200}, {NOTE_G3, 200, 400},
-    {NOTE_REST, 0, 0}     // End
 };
 
 // Twinkle Star Parts Array
 static const song_part_t twinkle_parts[] = {
-    {twinkle_melody,  sizeof(twinkle_melody)/sizeof(note_event_t) - 1,  "Melody"},
-    {twinkle_harmony, sizeof(twinkle_harmony)/sizeof(note_event_t) - 1, "Harmony"},
-    {twinkle_bass,    sizeof(twinkle_bass)/sizeof(note_event_t) - 1,    "Bass"},
-    {twinkle_rhythm,  sizeof(twinkle_rhythm)/sizeof(note_event_t) - 1,  "Rhythm"}
+    SONG_PART(twinkle_melody, "Melody"),
+    SONG_PART(twinkle_harmony, "Harmony"),
+    SONG_PART(twinkle_bass, "Bass"),
+    SONG_PART(twinkle_rhythm, "Rhythm")
 };
 
 // =============================================================
@@ -241,7 +238,6 @@ static const note_event_t birthday_melody[] = {
     {NOTE_F4, 800, 100},  // -day
     {NOTE_G4, 800, 100},  // to
     {NOTE_F4, 1200, 400}, // you
-    {NOTE_REST, 0, 0}     // End
 };
 
 // Part B: Harmony
@@ -275,7 +271,6 @@ static const note_event_t birthday_harmony[] = {
     {NOTE_D4, 800, 100},
     {NOTE_E4, 800, 100},
     {NOTE_D4, 1200, 400},
-    {NOTE_REST, 0, 0}
 };
 
 // Part C: Bass
@@ -307,14 +302,13 @@ static const note_event_t birthday_bass[] = {
     {NOTE_F3, 800, 100},  // F chord
     {NOTE_C3, 800, 100},  // C chord
     {NOTE_F3, 1200, 400}, // F chord
-    {NOTE_REST, 0, 0}
 };
 
 // Happy Birthday Parts Array
 static const song_part_t birthday_parts[] = {
-    {birthday_melody,  sizeof(birthday_melody)/sizeof(note_event_t) - 1,  "Melody"},
-    {birthday_harmony, sizeof(birthday_harmony)/sizeof(note_event_t) - 1, "Harmony"},
-    {birthday_bass,    sizeof(birthday_bass)/sizeof(note_event_t) - 1,    "Bass"}
+    SONG_PART(birthday_melody, "Melody"),
+    SONG_PART(birthday_harmony, "Harmony"),
+    SONG_PART(birthday_bass, "Bass")
 };
 
 // =============================================================
@@ -350,7 +344,6 @@ static const note_event_t mary_melody[] = {
     {NOTE_E4, 400, 100},  // was
     {NOTE_D4, 400, 100},  // white
     {NOTE_C4, 800, 400},  // as snow
-    {NOTE_REST, 0, 0}     // End
 };
 
 // Part B: Harmony
@@ -382,13 +375,12 @@ static const note_event_t mary_harmony[] = {
     {NOTE_C4, 400, 100},
     {NOTE_B3, 400, 100},
     {NOTE_A3, 800, 400},
-    {NOTE_REST, 0, 0}
 };
 
 // Mary Parts Array
 static const song_part_t mary_parts[] = {
-    {mary_melody,  sizeof(mary_melody)/sizeof(note_event_t) - 1,  "Melody"},
-    {mary_harmony, sizeof(mary_harmony)/sizeof(note_event_t) - 1, "Harmony"}
+    SONG_PART(mary_melody, "Melody"),
+    SONG_PART(mary_harmony, "Harmony")
 };
 
 // =============================================================
@@ -401,6 +393,7 @@ static const orchestra_song_t all_songs[] = {
         .song_id = SONG_TWINKLE_STAR,
         .tempo_bpm = 120,
         .part_count = 4,
+        .fec_depth = 1,         // Densest song: streamed parts get each note twice
         .parts = twinkle_parts
     },
     {
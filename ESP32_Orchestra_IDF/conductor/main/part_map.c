@@ -0,0 +1,136 @@
+/*
+ * Part Map Implementation
+ * ตาราง part ของทุกบอร์ด - หลายบอร์ดเล่น part เดียวกัน หรือบอร์ดเดียวเล่นหลาย parts
+ * ส่งให้ Musician ทั้งวงด้วย MSG_PART_ASSIGN frame เดียวก่อนเริ่มเพลง
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "part_map.h"
+
+static const char *TAG = "PART_MAP";
+
+static uint8_t part_masks[MAX_MUSICIANS];
+
+void part_map_init(void) {
+    memset(part_masks, PART_MAP_AUTO, sizeof(part_masks));
+}
+
+bool part_map_set(uint8_t musician_id, uint8_t part_mask) {
+    if (musician_id >= MAX_MUSICIANS) {
+        ESP_LOGW(TAG, "Musician %d out of range (max %d)", musician_id, MAX_MUSICIANS - 1);
+        return false;
+    }
+
+    part_masks[musician_id] = part_mask;
+    if (part_mask == PART_MAP_AUTO) {
+        ESP_LOGI(TAG, "Musician %d: default part", musician_id);
+    } else {
+        ESP_LOGI(TAG, "Musician %d: parts mask 0x%02x", musician_id, part_mask);
+    }
+    return true;
+}
+
+uint8_t part_map_get(uint8_t musician_id) {
+    return musician_id < MAX_MUSICIANS ? part_masks[musician_id] : PART_MAP_AUTO;
+}
+
+void part_map_build(orchestra_part_assign_t* assign, uint8_t song_id, uint8_t part_count, uint32_t online_mask) {
+    memset(assign, 0, sizeof(*assign));
+    assign->header.type = MSG_PART_ASSIGN;
+    assign->song_id = song_id;
+    assign->part_count = part_count > MAX_PARTS ? MAX_PARTS : part_count;
+    memcpy(assign->part_masks, part_masks, sizeof(assign->part_masks));
+
+    if (online_mask != 0 && assign->part_count > 0) {
+        // Default boards that are online take the parts nobody plays yet, then double up in turn
+        uint8_t covered = 0;
+        for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+            if ((online_mask & (1UL << id)) && part_masks[id] != PART_MAP_AUTO) {
+                covered |= part_masks[id];
+            }
+        }
+        uint8_t next_part = 0;
+        for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+            if (!(online_mask & (1UL << id)) || part_masks[id] != PART_MAP_AUTO) {
+                continue; // Offline default boards keep the default rule if they come back
+            }
+            uint8_t part = next_part;
+            for (uint8_t p = 0; p < assign->part_count; p++) {
+                if (!(covered & (1u << p))) {
+                    part = p;
+                    break;
+                }
+            }
+            assign->part_masks[id] = 1u << part;
+            covered |= 1u << part;
+            next_part = (part + 1) % assign->part_count;
+        }
+        part_map_cover(assign, online_mask, NULL);
+    }
+
+    orchestra_frame_seal(assign, sizeof(*assign));
+}
+
+uint8_t part_map_cover(orchestra_part_assign_t* assign, uint32_t online_mask, const uint8_t voices[MAX_MUSICIANS]) {
+    uint8_t covered = 0;
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        if (online_mask & (1UL << id)) {
+            covered |= part_assign_mask(assign, id);
+        }
+    }
+
+    uint8_t moved = 0;
+    for (uint8_t part = 0; part < assign->part_count; part++) {
+        if (covered & (1u << part)) {
+            continue;
+        }
+
+        int best = -1;
+        int best_parts = 0;
+        for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+            if (!(online_mask & (1UL << id))) {
+                continue;
+            }
+            int parts = __builtin_popcount(part_assign_mask(assign, id));
+            if (best < 0 || parts < best_parts ||
+                (parts == best_parts && voices && voices[id] > voices[best])) {
+                best = id;
+                best_parts = parts;
+            }
+        }
+        if (best < 0) {
+            break; // Nobody online
+        }
+
+        // Explicit mask from here on, the default rule no longer describes this board
+        assign->part_masks[best] = part_assign_mask(assign, best) | (1u << part);
+        covered |= 1u << part;
+        moved |= 1u << part;
+        ESP_LOGI(TAG, "Part %d -> Musician %d (parts mask 0x%02x)", part, best, assign->part_masks[best]);
+    }
+
+    orchestra_frame_seal(assign, sizeof(*assign));
+    return moved;
+}
+
+bool part_map_can_preload(const orchestra_part_assign_t* assign, uint8_t part) {
+    // Default entries play a single part, so only explicit ones can rule a part out
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        uint8_t mask = part_assign_mask(assign, id);
+        if ((mask & (1u << part)) && part_mask_primary(mask) != part) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t part_map_boards(const orchestra_part_assign_t* assign, uint8_t part, uint32_t online_mask) {
+    uint32_t boards = 0;
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        if ((online_mask & (1UL << id)) && (part_assign_mask(assign, id) & (1u << part))) {
+            boards |= 1UL << id;
+        }
+    }
+    return boards;
+}
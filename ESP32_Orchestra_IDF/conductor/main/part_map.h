@@ -0,0 +1,30 @@
+#ifndef PART_MAP_H
+#define PART_MAP_H
+
+#include "orchestra_common.h"
+
+// Part assignment table: which parts every board (musician_id) plays.
+// Scheduler state is per part, so the number of boards only sizes this table.
+#define PART_MAP_AUTO   0       // Default: part (musician_id % part_count) of each song
+
+// Part Map Functions
+void part_map_init(void);
+bool part_map_set(uint8_t musician_id, uint8_t part_mask);
+uint8_t part_map_get(uint8_t musician_id);
+
+// Fill MSG_PART_ASSIGN for a song (every board in one frame). online_mask = boards in the roster
+// (bit n = musician_id n): default boards among them share the parts so that every part is
+// covered. 0 = no roster, every default board plays part (musician_id % part_count).
+void part_map_build(orchestra_part_assign_t* assign, uint8_t song_id, uint8_t part_count, uint32_t online_mask);
+
+// Give every part no online board plays to the online board with the fewest parts
+// (ties go to the one with more voices). Returns the parts that were moved.
+uint8_t part_map_cover(orchestra_part_assign_t* assign, uint32_t online_mask, const uint8_t voices[MAX_MUSICIANS]);
+
+// A part can be preloaded only if every board playing it has it as its primary part
+bool part_map_can_preload(const orchestra_part_assign_t* assign, uint8_t part);
+
+// Boards among online_mask that play part (bit n = musician_id n)
+uint32_t part_map_boards(const orchestra_part_assign_t* assign, uint8_t part, uint32_t online_mask);
+
+#endif // PART_MAP_H
@@ -0,0 +1,245 @@
+/*
+ * Roster Implementation
+ * รายชื่อบอร์ดในวง: MAC -> musician_id (เก็บใน NVS) + เวลาที่ได้ยินล่าสุด
+ * MSG_JOIN ให้ id, sync request / score ACK ทุกอันบอกว่าบอร์ดยัง online
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "esp_log.h"
+#include "roster.h"
+
+static const char *TAG = "ROSTER";
+
+static roster_entry_t roster[MAX_MUSICIANS];
+static portMUX_TYPE roster_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool roster_dirty = false;       // New binding waiting for roster_check() to save it
+static uint32_t reported_offline = 0;   // Already returned by roster_check()
+
+esp_err_t roster_init(void) {
+    memset(roster, 0, sizeof(roster));
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(ROSTER_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "No saved roster, boards get new IDs as they join");
+        return ESP_OK;
+    }
+
+    uint8_t macs[MAX_MUSICIANS][6];
+    size_t len = sizeof(macs);
+    ret = nvs_get_blob(handle, ROSTER_NVS_KEY, macs, &len);
+    nvs_close(handle);
+    if (ret != ESP_OK || len != sizeof(macs)) {
+        ESP_LOGW(TAG, "Saved roster unreadable (%s), starting empty", esp_err_to_name(ret));
+        return ESP_OK;
+    }
+
+    static const uint8_t empty[6] = {0};
+    int known = 0;
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (memcmp(macs[id], empty, 6) != 0) {
+            roster[id].in_use = true;
+            memcpy(roster[id].mac, macs[id], 6);
+            known++;
+        }
+    }
+    ESP_LOGI(TAG, "Roster loaded: %d known boards", known);
+    return ESP_OK;
+}
+
+static esp_err_t roster_save(void) {
+    uint8_t macs[MAX_MUSICIANS][6] = {0};
+    portENTER_CRITICAL(&roster_lock);
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (roster[id].in_use) {
+            memcpy(macs[id], roster[id].mac, 6);
+        }
+    }
+    portEXIT_CRITICAL(&roster_lock);
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(ROSTER_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_blob(handle, ROSTER_NVS_KEY, macs, sizeof(macs));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+// Must be called with roster_lock held
+static int find_mac(const uint8_t mac[6]) {
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (roster[id].in_use && memcmp(roster[id].mac, mac, 6) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+// Free id for a new board: the requested one if nobody holds it, else the lowest free one,
+// else the one silent for longest. Must be called with roster_lock held.
+static int allocate_id(uint8_t requested_id, uint32_t now_ms) {
+    if (requested_id < MAX_MUSICIANS && !roster[requested_id].in_use) {
+        return requested_id;
+    }
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (!roster[id].in_use) {
+            return id;
+        }
+    }
+
+    int oldest = -1;
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (!roster[id].online &&
+            (oldest < 0 || now_ms - roster[id].last_seen_ms > now_ms - roster[oldest].last_seen_ms)) {
+            oldest = id;
+        }
+    }
+    return oldest;
+}
+
+static void mark_seen(int id, uint32_t now_ms) {
+    roster[id].online = true;
+    roster[id].last_seen_ms = now_ms;
+    reported_offline &= ~(1UL << id);
+}
+
+uint8_t roster_join(const uint8_t mac[6], const orchestra_join_t* join) {
+    uint32_t now_ms = get_time_ms();
+    bool is_new = false;
+
+    portENTER_CRITICAL(&roster_lock);
+    int id = find_mac(mac);
+    if (id < 0) {
+        id = allocate_id(join->requested_id, now_ms);
+        if (id >= 0) {
+            memset(&roster[id], 0, sizeof(roster[id]));
+            roster[id].in_use = true;
+            memcpy(roster[id].mac, mac, 6);
+            roster_dirty = true;
+            is_new = true;
+        }
+    }
+    if (id >= 0) {
+        roster[id].voices = join->voices;
+        roster[id].engine = join->engine;
+        roster[id].joins++;
+        mark_seen(id, now_ms);
+    }
+    portEXIT_CRITICAL(&roster_lock);
+
+    if (id < 0) {
+        ESP_LOGW(TAG, "Roster full, %02x:%02x:%02x:%02x:%02x:%02x not admitted",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        return MUSICIAN_ID_NONE;
+    }
+    if (is_new) {
+        ESP_LOGI(TAG, "New board %02x:%02x:%02x:%02x:%02x:%02x -> Musician %d (%d voices)",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], id, join->voices);
+    }
+    return (uint8_t)id;
+}
+
+void roster_seen(const uint8_t mac[6], uint8_t musician_id_hint) {
+    uint32_t now_ms = get_time_ms();
+
+    portENTER_CRITICAL(&roster_lock);
+    int id = find_mac(mac);
+    // Board that kept its id while our roster was lost: bind it again if the id is free
+    if (id < 0 && musician_id_hint < MAX_MUSICIANS && !roster[musician_id_hint].in_use) {
+        id = musician_id_hint;
+        memset(&roster[id], 0, sizeof(roster[id]));
+        roster[id].in_use = true;
+        memcpy(roster[id].mac, mac, 6);
+        roster_dirty = true;
+    }
+    if (id >= 0) {
+        mark_seen(id, now_ms);
+    }
+    portEXIT_CRITICAL(&roster_lock);
+}
+
+uint32_t roster_check(void) {
+    uint32_t now_ms = get_time_ms();
+    uint32_t lost = 0;
+    bool save = false;
+
+    portENTER_CRITICAL(&roster_lock);
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (roster[id].online && now_ms - roster[id].last_seen_ms > ROSTER_TIMEOUT_MS) {
+            roster[id].online = false;
+        }
+        if (roster[id].in_use && !roster[id].online && roster[id].last_seen_ms != 0 &&
+            !(reported_offline & (1UL << id))) {
+            reported_offline |= 1UL << id;
+            lost |= 1UL << id;
+        }
+    }
+    save = roster_dirty;
+    roster_dirty = false;
+    portEXIT_CRITICAL(&roster_lock);
+
+    // NVS writes stay out of the Wi-Fi task
+    if (save) {
+        esp_err_t ret = roster_save();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to save roster: %s", esp_err_to_name(ret));
+        }
+    }
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (lost & (1UL << id)) {
+            ESP_LOGW(TAG, "Musician %d went silent", id);
+        }
+    }
+    return lost;
+}
+
+uint32_t roster_online_mask(void) {
+    uint32_t mask = 0;
+    portENTER_CRITICAL(&roster_lock);
+    for (int id = 0; id < MAX_MUSICIANS; id++) {
+        if (roster[id].online) {
+            mask |= 1UL << id;
+        }
+    }
+    portEXIT_CRITICAL(&roster_lock);
+    return mask;
+}
+
+uint8_t roster_online_count(void) {
+    return (uint8_t)__builtin_popcount(roster_online_mask());
+}
+
+bool roster_get(uint8_t musician_id, roster_entry_t* out) {
+    if (musician_id >= MAX_MUSICIANS) {
+        return false;
+    }
+    portENTER_CRITICAL(&roster_lock);
+    *out = roster[musician_id];
+    portEXIT_CRITICAL(&roster_lock);
+    return out->in_use;
+}
+
+void roster_print(void) {
+    uint32_t now_ms = get_time_ms();
+    roster_entry_t entry;
+    for (uint8_t id = 0; id < MAX_MUSICIANS; id++) {
+        if (!roster_get(id, &entry)) {
+            continue;
+        }
+        if (entry.last_seen_ms == 0) {
+            ESP_LOGI(TAG, "  Musician %2d %02x:%02x:%02x:%02x:%02x:%02x  not seen since boot", id,
+                     entry.mac[0], entry.mac[1], entry.mac[2], entry.mac[3], entry.mac[4], entry.mac[5]);
+        } else {
+            ESP_LOGI(TAG, "  Musician %2d %02x:%02x:%02x:%02x:%02x:%02x  %s, last seen %lu ms ago, %d voices", id,
+                     entry.mac[0], entry.mac[1], entry.mac[2], entry.mac[3], entry.mac[4], entry.mac[5],
+                     entry.online ? "online" : "OFFLINE", now_ms - entry.last_seen_ms, entry.voices);
+        }
+    }
+}
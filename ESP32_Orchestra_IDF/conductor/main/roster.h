@@ -0,0 +1,37 @@
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include "esp_err.h"
+#include "orchestra_common.h"
+
+#define ROSTER_NVS_NAMESPACE    "roster"
+#define ROSTER_NVS_KEY          "macs"
+
+// One board of the ensemble, indexed by musician_id
+typedef struct {
+    bool in_use;                // id bound to this MAC (kept in NVS)
+    bool online;                // Heard within ROSTER_TIMEOUT_MS
+    uint8_t mac[6];
+    uint8_t voices;             // From MSG_JOIN (0 = not announced yet)
+    uint8_t engine;
+    uint32_t last_seen_ms;
+    uint32_t joins;
+} roster_entry_t;
+
+// Roster Functions
+esp_err_t roster_init(void);                                    // Loads MAC -> id from NVS
+
+// Safe from the Wi-Fi receive callback
+uint8_t roster_join(const uint8_t mac[6], const orchestra_join_t* join);   // musician_id or MUSICIAN_ID_NONE
+void roster_seen(const uint8_t mac[6], uint8_t musician_id_hint);
+
+// Task context: marks silent boards offline, saves new bindings to NVS.
+// Returns the boards that went offline since the last call (bit n = musician_id n).
+uint32_t roster_check(void);
+
+uint32_t roster_online_mask(void);
+uint8_t roster_online_count(void);
+bool roster_get(uint8_t musician_id, roster_entry_t* out);
+void roster_print(void);
+
+#endif // ROSTER_H
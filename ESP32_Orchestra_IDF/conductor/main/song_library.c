@@ -0,0 +1,186 @@
+/*
+ * Song Library Implementation for ESP-IDF
+ * เพลงอยู่ใน data partition "songs" - mmap ครั้งเดียวตอนเริ่ม แล้ว song_part_t.events
+ * ชี้เข้า flash ตรงๆ เพิ่มเพลงได้เป็นร้อยโดยไม่ต้อง build app ใหม่
+ */
+
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+#include "song_library.h"
+#include "midi_import.h"
+#include "stress_test.h"
+
+static const char *TAG = "LIBRARY";
+
+// Mapped image (NULL = built-in songs only)
+static const uint8_t* library_image = NULL;
+static const song_library_header_t* library_header = NULL;
+static esp_partition_mmap_handle_t library_mmap_handle;
+static uint32_t library_valid[SONG_LIBRARY_INDEX_SIZE / 32];    // bit = record checked at init
+static uint16_t library_song_count = 0;
+
+// Built-in songs by ID: all_songs index + 1 (0 = none)
+static uint8_t builtin_index[SONG_LIBRARY_INDEX_SIZE];
+
+// Slot that library songs are rebuilt into (names and events stay in flash)
+static orchestra_song_t library_song;
+static song_part_t library_parts[SONG_LIBRARY_MAX_PARTS];
+
+static bool name_terminated(const char* name, size_t len) {
+    return memchr(name, '\0', len) != NULL;
+}
+
+// Every offset in the record must stay inside the image - checked once so lookups need no bounds checks
+static bool check_record(uint8_t song_id, uint32_t offset) {
+    uint32_t image_size = library_header->image_size;
+    if (offset < sizeof(song_library_header_t) || offset % SONG_LIBRARY_ALIGN != 0 ||
+        offset + sizeof(song_library_song_t) > image_size) {
+        return false;
+    }
+
+    const song_library_song_t* record = (const song_library_song_t*)(library_image + offset);
+    if (record->song_id != song_id || record->part_count == 0 ||
+        record->part_count > SONG_LIBRARY_MAX_PARTS ||
+        offset + sizeof(song_library_song_t) + record->part_count * sizeof(song_library_part_t) > image_size ||
+        !name_terminated(record->name, SONG_LIBRARY_NAME_LEN)) {
+        return false;
+    }
+
+    for (uint8_t p = 0; p < record->part_count; p++) {
+        const song_library_part_t* part = &record->parts[p];
+        if (part->events_offset % SONG_LIBRARY_ALIGN != 0 || part->events_offset > image_size ||
+            part->events_offset + (uint32_t)part->event_count * sizeof(score_note_t) > image_size ||
+            !name_terminated(part->name, SONG_LIBRARY_PART_NAME_LEN)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t check_image(size_t partition_size) {
+    const song_library_header_t* header = library_header;
+
+    if (memcmp(header->magic, SONG_LIBRARY_MAGIC, sizeof(header->magic)) != 0) {
+        return ESP_ERR_NOT_FOUND; // Erased or never flashed
+    }
+    if (header->version != SONG_LIBRARY_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header->image_size < sizeof(song_library_header_t) || header->image_size > partition_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint32_t crc = esp_rom_crc32_le(0, library_image + sizeof(song_library_header_t),
+                                    header->image_size - sizeof(song_library_header_t));
+    if (crc != header->crc32) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    memset(library_valid, 0, sizeof(library_valid));
+    library_song_count = 0;
+    for (int id = 0; id < SONG_LIBRARY_INDEX_SIZE; id++) {
+        if (header->index[id] == 0) {
+            continue;
+        }
+        if (check_record((uint8_t)id, header->index[id])) {
+            library_valid[id / 32] |= 1UL << (id % 32);
+            library_song_count++;
+        } else {
+            ESP_LOGW(TAG, "⚠️ Song %d: broken record, skipped", id);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t song_library_init(void) {
+    memset(builtin_index, 0, sizeof(builtin_index));
+    for (size_t i = 0; i < TOTAL_SONGS; i++) {
+        builtin_index[all_songs[i].song_id] = (uint8_t)(i + 1);
+    }
+
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)SONG_LIBRARY_PARTITION_SUBTYPE,
+        SONG_LIBRARY_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGW(TAG, "No \"%s\" partition - built-in songs only", SONG_LIBRARY_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void* mapped = NULL;
+    esp_err_t ret = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       &mapped, &library_mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map song partition: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    library_image = mapped;
+    library_header = mapped;
+
+    ret = check_image(partition->size);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Song library not usable (%s) - built-in songs only", esp_err_to_name(ret));
+        esp_partition_munmap(library_mmap_handle);
+        library_image = NULL;
+        library_header = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "📚 Song library: %d songs, %lu bytes mapped at %p",
+             library_song_count, (unsigned long)library_header->image_size, library_image);
+    return ESP_OK;
+}
+
+uint16_t song_library_count(void) {
+    return library_song_count;
+}
+
+static bool library_has(uint8_t song_id) {
+    return library_image && (library_valid[song_id / 32] & (1UL << (song_id % 32)));
+}
+
+static const orchestra_song_t* load_library_song(uint8_t song_id) {
+    const song_library_song_t* record =
+        (const song_library_song_t*)(library_image + library_header->index[song_id]);
+
+    for (uint8_t p = 0; p < record->part_count; p++) {
+        library_parts[p].events = (const note_event_t*)(library_image + record->parts[p].events_offset);
+        library_parts[p].event_count = record->parts[p].event_count;
+        library_parts[p].part_name = record->parts[p].name;
+    }
+    library_song.song_name = record->name;
+    library_song.song_id = record->song_id;
+    library_song.tempo_bpm = record->tempo_bpm;
+    library_song.part_count = record->part_count;
+    library_song.fec_depth = record->fec_depth;
+    library_song.parts = library_parts;
+    return &library_song;
+}
+
+const orchestra_song_t* song_library_find(uint8_t song_id) {
+    const orchestra_song_t* song = midi_import_find_song(song_id);
+    if (song) {
+        return song;
+    }
+    song = stress_score_find(song_id);
+    if (song) {
+        return song;
+    }
+    if (library_has(song_id)) {
+        return load_library_song(song_id);
+    }
+    if (builtin_index[song_id]) {
+        return &all_songs[builtin_index[song_id] - 1];
+    }
+    return NULL;
+}
+
+uint8_t song_library_next_id(uint8_t song_id) {
+    for (int step = 1; step <= SONG_LIBRARY_INDEX_SIZE; step++) {
+        uint8_t id = (uint8_t)(song_id + step);
+        if (id != 0 && (builtin_index[id] || library_has(id) || midi_import_find_song(id))) {
+            return id;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef SONG_LIBRARY_H
+#define SONG_LIBRARY_H
+
+#include "esp_err.h"
+#include "midi_songs.h"
+#include "song_library_format.h"
+
+#define SONG_LIBRARY_MAX_PARTS  SCORE_MAX_PARTS
+
+// Library Functions
+esp_err_t song_library_init(void);      // ไม่มี partition/ image เสีย = ใช้เพลง built-in อย่างเดียว
+uint16_t song_library_count(void);      // จำนวนเพลงใน image
+
+// Lookup order: MIDI imports, stress score, library image, built-in songs - all O(1) except the 4 import slots.
+// Library songs are rebuilt in one static slot: the result is valid until the next call.
+const orchestra_song_t* song_library_find(uint8_t song_id);
+
+// Next available song ID after song_id (wraps around, 0 = no songs at all)
+uint8_t song_library_next_id(uint8_t song_id);
+
+#endif // SONG_LIBRARY_H
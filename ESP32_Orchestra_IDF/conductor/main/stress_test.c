@@ -0,0 +1,121 @@
+/*
+ * Stress Test Implementation
+ * เพลงสังเคราะห์ที่หนาแน่น (โน๊ต 32nd วิ่งขึ้นลงทุก part) ส่งผ่าน note path ทั้งหมด (ไม่ preload)
+ * แล้วดูว่าถึงความหนาแน่นไหน esp_now_send() เริ่มตอบ ESP_ERR_ESPNOW_NO_MEM หรือส่งไม่ทันเวลา
+ */
+
+#include <stdlib.h>
+#include "esp_log.h"
+#include "stress_test.h"
+#include "song_library.h"
+
+static const char* const part_names[MAX_PARTS] = {
+    "Run 1", "Run 2", "Run 3", "Run 4", "Run 5", "Run 6", "Run 7", "Run 8"
+};
+static const uint8_t scale[] = {0, 2, 4, 5, 7, 9, 11, 12, 11, 9, 7, 5, 4, 2};  // Up and down, C major
+
+static orchestra_song_t stress_song;
+static song_part_t stress_parts[MAX_PARTS];
+static note_event_t* stress_events = NULL;
+
+const orchestra_song_t* stress_score_build(uint8_t part_count, uint16_t note_ms, uint16_t notes_per_part) {
+    if (part_count == 0 || part_count > SONG_LIBRARY_MAX_PARTS || note_ms < 2 || notes_per_part == 0) {
+        return NULL;
+    }
+    if (notes_per_part > STRESS_MAX_NOTES) {
+        notes_per_part = STRESS_MAX_NOTES;
+    }
+
+    free(stress_events);
+    stress_events = malloc((size_t)part_count * notes_per_part * sizeof(note_event_t));
+    if (!stress_events) {
+        stress_song.song_id = 0;
+        return NULL;
+    }
+
+    for (uint8_t part = 0; part < part_count; part++) {
+        note_event_t* events = &stress_events[(size_t)part * notes_per_part];
+        for (uint16_t i = 0; i < notes_per_part; i++) {
+            events[i].note = (uint8_t)(NOTE_C4 + 4 * part + scale[i % sizeof(scale)]);
+            events[i].duration_ms = note_ms - note_ms / 4;
+            events[i].delay_ms = note_ms / 4;
+        }
+        stress_parts[part].events = events;
+        stress_parts[part].event_count = notes_per_part;
+        stress_parts[part].part_name = part_names[part];
+    }
+
+    uint32_t bpm = 60000 / (8u * note_ms);  // A 32nd note is 1/8 beat
+    stress_song.song_name = "Stress";
+    stress_song.song_id = STRESS_SONG_ID;
+    stress_song.tempo_bpm = (uint8_t)(bpm > 255 ? 255 : bpm);
+    stress_song.part_count = part_count;
+    stress_song.fec_depth = 0;          // Every frame carries new notes only
+    stress_song.parts = stress_parts;
+    return &stress_song;
+}
+
+const orchestra_song_t* stress_score_find(uint8_t song_id) {
+    return song_id == STRESS_SONG_ID && stress_song.song_id == STRESS_SONG_ID ? &stress_song : NULL;
+}
+
+#if STRESS_TEST
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "latency_hist.h"
+#include "espnow_conductor.h"
+
+static const char *TAG = "STRESS";
+
+static latency_hist_t send_late_us;     // Scheduler task only (reset between levels)
+
+void stress_test_record_send(int64_t late_us) {
+    latency_hist_add(&send_late_us, late_us > 0 ? (uint32_t)late_us : 0);
+}
+
+static void stress_task(void *pvParameters) {
+    static const uint16_t levels_ms[] = STRESS_NOTE_MS;
+
+    vTaskDelay(pdMS_TO_TICKS(STRESS_SETTLE_MS));
+    conductor_set_preload(false);       // Every note goes through espnow_send_*()
+    ESP_LOGI(TAG, "Stress test: %d parts, %d musicians online", STRESS_PARTS,
+             get_conductor_state()->connected_musicians);
+
+    for (size_t level = 0; level < sizeof(levels_ms) / sizeof(levels_ms[0]); level++) {
+        uint16_t note_ms = levels_ms[level];
+        if (!stress_score_build(STRESS_PARTS, note_ms, STRESS_LEVEL_MS / note_ms)) {
+            ESP_LOGE(TAG, "No memory for the %d ms score", note_ms);
+            break;
+        }
+
+        conductor_state_t before = *get_conductor_state();
+        latency_hist_reset(&send_late_us);
+        if (!start_song(STRESS_SONG_ID)) {
+            ESP_LOGE(TAG, "Level %d ms did not start", note_ms);
+            continue;
+        }
+        while (is_conductor_playing()) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        const conductor_state_t* after = get_conductor_state();
+        ESP_LOGI(TAG, "Level %2d ms, %4lu notes/s: %lu notes in %lu frames, send failed %lu (NO_MEM %lu), "
+                 "unicast failed %lu, sent late p50 %lu p99 %lu max %lu us",
+                 note_ms, STRESS_PARTS * 1000UL / note_ms, after->notes_sent - before.notes_sent,
+                 after->frames_sent - before.frames_sent, after->send_failures - before.send_failures,
+                 after->send_no_mem - before.send_no_mem, after->unicast_failures - before.unicast_failures,
+                 latency_hist_percentile(&send_late_us, 500), latency_hist_percentile(&send_late_us, 990),
+                 send_late_us.max);
+        vTaskDelay(pdMS_TO_TICKS(STRESS_GAP_MS));
+    }
+
+    ESP_LOGI(TAG, "Stress test done");
+    vTaskDelete(NULL);
+}
+
+void stress_test_start(void) {
+    xTaskCreate(stress_task, "stress_task", 4096, NULL, 3, NULL);
+}
+
+#endif // STRESS_TEST
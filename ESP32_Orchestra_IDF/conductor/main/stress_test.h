@@ -0,0 +1,34 @@
+#ifndef STRESS_TEST_H
+#define STRESS_TEST_H
+
+#include "midi_songs.h"
+
+// 1 = after boot the conductor streams denser and denser synthetic scores instead of waiting for
+// the button, and prints per level what the ESP-NOW note path sustained (send errors, NO_MEM,
+// how late the scheduler got the frames out). Flash the musicians with STRESS_STATS 1
+// (stress_stats.h) for the receive side: callback time, note lead, late notes.
+#ifndef STRESS_TEST
+#define STRESS_TEST             0
+#endif
+
+#define STRESS_SONG_ID          200     // Outside the built-in and library IDs in use
+#define STRESS_MAX_NOTES        512     // Per part
+#define STRESS_PARTS            4
+#define STRESS_LEVEL_MS         5000    // Length of every level
+#define STRESS_NOTE_MS          {62, 31, 16, 8, 4}  // 32nd notes at 120, 240, 480, 960, 1920 BPM
+#define STRESS_SETTLE_MS        10000   // Boards join and lock their clocks first
+#define STRESS_GAP_MS           2000    // Musicians print their side before the next level
+
+// Synthetic score: every part runs up and down a scale, one note every note_ms (3/4 of it sounding),
+// parts a third apart. Replaces the previous one - not while it is playing. NULL = out of memory.
+const orchestra_song_t* stress_score_build(uint8_t part_count, uint16_t note_ms, uint16_t notes_per_part);
+const orchestra_song_t* stress_score_find(uint8_t song_id);
+
+#if STRESS_TEST
+void stress_test_start(void);                   // Runs the ladder in its own task
+void stress_test_record_send(int64_t late_us);  // Scheduler: send time of an event minus its due time
+#else
+static inline void stress_test_record_send(int64_t late_us) {}
+#endif
+
+#endif // STRESS_TEST_H
@@ -0,0 +1,245 @@
+/*
+ * Clock Sync Implementation for ESP-IDF
+ * ประมาณค่า offset และ drift ของนาฬิกา Conductor เทียบกับนาฬิกาของ Musician
+ * ด้วยการแลกเปลี่ยน timestamp สองทาง (NTP-style) ผ่าน MSG_SYNC_TIME
+ *
+ * Estimator: Kalman filter สองสถานะ (offset, skew) - skew คือความต่างของอัตรา
+ * นาฬิกา (ppm) ทำให้แปลงเวลาได้แม่นแม้ระหว่าง sample และเพลงยาวไม่หลุดเฟส
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "clock_sync.h"
+
+static const char *TAG = "CLOCK_SYNC";
+
+static clock_sync_state_t sync_state = {0};
+static uint8_t sync_musician_id = 0;
+static portMUX_TYPE sync_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Kalman filter: x = [offset (us), skew (ppm = us/s)] at kf_time_us (local clock)
+// Only touched from clock_sync_handle_reply(), results are published into sync_state
+#define KF_Q_OFFSET      4.0      // Offset white noise (us^2 per s)
+#define KF_Q_SKEW        1e-4     // Skew random walk (ppm^2 per s) - temperature drift
+#define KF_INIT_SKEW_STD 50.0     // Initial skew uncertainty (ppm), crystals are +-20-50
+static bool kf_running = false;
+static int64_t kf_time_us = 0;
+static double kf_x[2];
+static double kf_p[2][2];
+
+void clock_sync_init(uint8_t musician_id) {
+    sync_musician_id = musician_id;
+    clock_sync_reset();
+    ESP_LOGI(TAG, "⏰ Clock sync initialized for Musician %d", musician_id);
+}
+
+void clock_sync_set_musician_id(uint8_t musician_id) {
+    sync_musician_id = musician_id; // Replies to the old id are dropped, the next request uses the new one
+}
+
+void clock_sync_reset(void) {
+    portENTER_CRITICAL(&sync_lock);
+    memset(&sync_state, 0, sizeof(sync_state));
+    sync_state.min_rtt_us = INT64_MAX;
+    portEXIT_CRITICAL(&sync_lock);
+    kf_running = false;
+}
+
+void clock_sync_build_request(orchestra_sync_message_t* request) {
+    memset(request, 0, sizeof(*request));
+    request->header.type = MSG_SYNC_TIME;
+    request->stage = SYNC_STAGE_REQUEST;
+    request->musician_id = sync_musician_id;
+
+    portENTER_CRITICAL(&sync_lock);
+    request->sequence = sync_state.next_sequence++;
+    request->t1_us = esp_timer_get_time();
+    sync_state.pending_t1_us = request->t1_us;
+    sync_state.requests_sent++;
+    portEXIT_CRITICAL(&sync_lock);
+
+    orchestra_frame_seal(request, sizeof(*request));
+}
+
+// Offset predicted by the current model at a local time (lock held)
+static int64_t predicted_offset_us(int64_t local_time_us) {
+    int64_t elapsed_us = local_time_us - sync_state.ref_time_us;
+    return sync_state.offset_us + (int64_t)sync_state.drift_ppb * elapsed_us / 1000000000LL;
+}
+
+// Measurement noise: the asymmetric part of the path delay is bounded by rtt/2
+static double measurement_variance(int64_t rtt_us) {
+    double sigma_us = (double)rtt_us / 4.0 + 20.0;
+    return sigma_us * sigma_us;
+}
+
+static void kf_start(const clock_sync_sample_t* sample) {
+    kf_x[0] = (double)sample->offset_us;
+    kf_x[1] = 0.0;
+    kf_p[0][0] = measurement_variance(sample->rtt_us);
+    kf_p[0][1] = kf_p[1][0] = 0.0;
+    kf_p[1][1] = KF_INIT_SKEW_STD * KF_INIT_SKEW_STD;
+    kf_time_us = sample->local_time_us;
+    kf_running = true;
+}
+
+// Predict + update with one sample. Returns false if the sample fails the
+// innovation gate (the filter is left untouched in that case).
+static bool kf_update(const clock_sync_sample_t* sample, bool gate, double* residual_us) {
+    double dt = (double)(sample->local_time_us - kf_time_us) / 1e6;
+    if (dt < 0) {
+        dt = 0;
+    }
+
+    // Predict: offset grows by skew * dt
+    double x0 = kf_x[0] + kf_x[1] * dt;
+    double x1 = kf_x[1];
+    double p00 = kf_p[0][0] + dt * (kf_p[0][1] + kf_p[1][0]) + dt * dt * kf_p[1][1]
+                 + KF_Q_OFFSET * dt + KF_Q_SKEW * dt * dt * dt / 3.0;
+    double p01 = kf_p[0][1] + dt * kf_p[1][1] + KF_Q_SKEW * dt * dt / 2.0;
+    double p11 = kf_p[1][1] + KF_Q_SKEW * dt;
+
+    // Update with the measured offset
+    double y = (double)sample->offset_us - x0;
+    double s = p00 + measurement_variance(sample->rtt_us);
+    *residual_us = y;
+
+    if (gate && y * y > (double)CLOCK_SYNC_GATE_SIGMA * CLOCK_SYNC_GATE_SIGMA * s) {
+        return false;
+    }
+
+    double k0 = p00 / s;
+    double k1 = p01 / s;
+    kf_x[0] = x0 + k0 * y;
+    kf_x[1] = x1 + k1 * y;
+    kf_p[0][0] = (1.0 - k0) * p00;
+    kf_p[0][1] = kf_p[1][0] = (1.0 - k0) * p01;
+    kf_p[1][1] = p11 - k1 * p01;
+    kf_time_us = sample->local_time_us;
+    return true;
+}
+
+bool clock_sync_handle_reply(const orchestra_sync_message_t* reply, int64_t rx_time_us) {
+    if (reply->stage != SYNC_STAGE_REPLY || reply->musician_id != sync_musician_id) {
+        return false; // Reply to some other musician
+    }
+
+    portENTER_CRITICAL(&sync_lock);
+
+    if (reply->t1_us != sync_state.pending_t1_us || sync_state.pending_t1_us == 0) {
+        sync_state.samples_rejected++;
+        portEXIT_CRITICAL(&sync_lock);
+        return false; // Stale or duplicated reply
+    }
+    sync_state.pending_t1_us = 0;
+
+    clock_sync_sample_t sample;
+    int64_t t1 = reply->t1_us, t2 = reply->t2_us, t3 = reply->t3_us, t4 = rx_time_us;
+    sample.rtt_us = (t4 - t1) - (t3 - t2);
+    sample.offset_us = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.local_time_us = t1 + (t4 - t1) / 2;
+
+    if (sample.rtt_us < 0 || sample.rtt_us > CLOCK_SYNC_MAX_RTT_US) {
+        sync_state.samples_rejected++;
+        portEXIT_CRITICAL(&sync_lock);
+        return false;
+    }
+
+    sync_state.last_rtt_us = sample.rtt_us;
+    if (sample.rtt_us < sync_state.min_rtt_us) {
+        sync_state.min_rtt_us = sample.rtt_us;
+    }
+    portEXIT_CRITICAL(&sync_lock);
+
+    // Run the filter outside the critical section, it uses (software) doubles
+    double residual_us = 0;
+    bool accepted = true;
+    if (!kf_running) {
+        kf_start(&sample);
+    } else if (!kf_update(&sample, sync_state.is_locked, &residual_us)) {
+        accepted = false;
+    }
+
+    portENTER_CRITICAL(&sync_lock);
+    sync_state.last_residual_us = (int32_t)residual_us;
+    if (!accepted) {
+        sync_state.samples_rejected++;
+        // A string of outliers means the model is wrong (e.g. conductor reboot)
+        if (++sync_state.consecutive_outliers >= CLOCK_SYNC_MAX_OUTLIERS) {
+            kf_running = false;
+            sync_state.is_locked = false;
+            sync_state.consecutive_outliers = 0;
+        }
+        portEXIT_CRITICAL(&sync_lock);
+        return false;
+    }
+
+    sync_state.consecutive_outliers = 0;
+    sync_state.samples_accepted++;
+
+    // Publish the new model for the time conversion functions
+    sync_state.offset_us = (int64_t)kf_x[0];
+    sync_state.ref_time_us = kf_time_us;
+    sync_state.drift_ppb = (int32_t)(kf_x[1] * 1000.0);
+    sync_state.offset_std_us = (int32_t)sqrt(kf_p[0][0]);
+    sync_state.drift_std_ppb = (int32_t)(sqrt(kf_p[1][1]) * 1000.0);
+    sync_state.has_reference = true;
+    sync_state.is_locked = sync_state.samples_accepted >= SYNC_LOCK_SAMPLES &&
+                           sync_state.offset_std_us < CLOCK_SYNC_LOCK_STD_US;
+
+    portEXIT_CRITICAL(&sync_lock);
+    return true;
+}
+
+void clock_sync_one_way_sample(uint32_t conductor_time_ms) {
+    portENTER_CRITICAL(&sync_lock);
+    // Only a rough guess (includes the one-way latency) until an exchange completes
+    if (!kf_running) {
+        int64_t now_us = esp_timer_get_time();
+        sync_state.offset_us = (int64_t)conductor_time_ms * 1000 - now_us;
+        sync_state.ref_time_us = now_us;
+        sync_state.has_reference = true;
+    }
+    portEXIT_CRITICAL(&sync_lock);
+}
+
+uint32_t clock_sync_interval_ms(void) {
+    return sync_state.is_locked ? SYNC_INTERVAL_MS : SYNC_FAST_INTERVAL_MS;
+}
+
+int64_t local_time_to_conductor_us(int64_t local_time_us) {
+    portENTER_CRITICAL(&sync_lock);
+    int64_t offset_us = predicted_offset_us(local_time_us);
+    portEXIT_CRITICAL(&sync_lock);
+    return local_time_us + offset_us;
+}
+
+int64_t conductor_time_to_local_us(int64_t conductor_time_us) {
+    portENTER_CRITICAL(&sync_lock);
+    // The offset hardly changes over the correction itself, one iteration is enough
+    int64_t local_guess_us = conductor_time_us - sync_state.offset_us;
+    int64_t offset_us = predicted_offset_us(local_guess_us);
+    portEXIT_CRITICAL(&sync_lock);
+    return conductor_time_us - offset_us;
+}
+
+int64_t conductor_ms_to_local_us(uint32_t conductor_time_ms) {
+    // Rebuild the full 64-bit conductor time around "now" so the 32-bit ms wrap is handled
+    int64_t conductor_now_ms = local_time_to_conductor_us(esp_timer_get_time()) / 1000;
+    int32_t delta_ms = (int32_t)(conductor_time_ms - (uint32_t)conductor_now_ms);
+    return conductor_time_to_local_us((conductor_now_ms + delta_ms) * 1000);
+}
+
+int64_t clock_sync_now_us(void) {
+    return local_time_to_conductor_us(esp_timer_get_time());
+}
+
+uint32_t clock_sync_now_ms(void) {
+    return (uint32_t)(clock_sync_now_us() / 1000);
+}
+
+const clock_sync_state_t* clock_sync_get_state(void) {
+    return &sync_state;
+}
@@ -0,0 +1,60 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include "esp_err.h"
+#include "orchestra_common.h"
+
+#define CLOCK_SYNC_MAX_RTT_US    50000    // Round trips longer than this are discarded
+#define CLOCK_SYNC_GATE_SIGMA    5        // Reject samples this many std devs off the model
+#define CLOCK_SYNC_MAX_OUTLIERS  3        // Consecutive rejections before the model restarts
+#define CLOCK_SYNC_LOCK_STD_US   500      // Offset uncertainty required for lock
+
+// One completed two-way exchange
+typedef struct {
+    int64_t local_time_us;      // Midpoint of the exchange on the local clock
+    int64_t offset_us;          // conductor - local
+    int64_t rtt_us;             // Round trip minus conductor processing time
+} clock_sync_sample_t;
+
+// Clock Sync State
+typedef struct {
+    bool has_reference;         // Any estimate at all (one-way or two-way)
+    bool is_locked;             // Enough samples and offset_std_us below CLOCK_SYNC_LOCK_STD_US
+    int64_t offset_us;          // conductor - local at ref_time_us
+    int64_t ref_time_us;        // Local time of the offset estimate
+    int32_t drift_ppb;          // Conductor clock rate relative to ours (parts per billion)
+    int32_t offset_std_us;      // Estimated 1-sigma uncertainty of offset_us
+    int32_t drift_std_ppb;      // Estimated 1-sigma uncertainty of drift_ppb
+    int32_t last_residual_us;   // Last measurement minus model prediction
+    int64_t last_rtt_us;
+    int64_t min_rtt_us;
+    uint8_t next_sequence;
+    int64_t pending_t1_us;      // t1 of the request waiting for a reply (0 = none)
+    uint32_t requests_sent;
+    uint32_t samples_accepted;
+    uint32_t samples_rejected;
+    uint8_t consecutive_outliers;
+} clock_sync_state_t;
+
+// Clock Sync Functions
+void clock_sync_init(uint8_t musician_id);
+void clock_sync_set_musician_id(uint8_t musician_id);   // After MSG_JOIN_ACCEPT
+void clock_sync_reset(void);
+void clock_sync_build_request(orchestra_sync_message_t* request);
+bool clock_sync_handle_reply(const orchestra_sync_message_t* reply, int64_t rx_time_us);
+void clock_sync_one_way_sample(uint32_t conductor_time_ms);
+uint32_t clock_sync_interval_ms(void);
+
+// Time Conversion
+int64_t conductor_time_to_local_us(int64_t conductor_time_us);
+int64_t local_time_to_conductor_us(int64_t local_time_us);
+int64_t conductor_ms_to_local_us(uint32_t conductor_time_ms);
+
+// Drift-corrected clock (conductor timeline, runs at the conductor's rate)
+int64_t clock_sync_now_us(void);
+uint32_t clock_sync_now_ms(void);
+
+// Getter functions
+const clock_sync_state_t* clock_sync_get_state(void);
+
+#endif // CLOCK_SYNC_H
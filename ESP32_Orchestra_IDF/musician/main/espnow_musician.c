@@ -9,21 +9,91 @@
 #include "esp_netif.h"
 #include "esp_mac.h"
 #include "esp_log.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 #include "espnow_musician.h"
 #include "sound_player.h"
+#include "note_scheduler.h"
+#include "clock_sync.h"
+#include "rx_ring.h"
+#include "score_player.h"
+#include "reliable_ctrl.h"
+#include "note_fec.h"
+#include "timing_log.h"
+#include "stress_stats.h"
+#include "trace_ring.h"
+#include "hot_log.h"
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+#include "synth_output.h"
+#else
+#include "ledc_voices.h"
+#endif
 
 static const char *TAG = "MUSICIAN";
 
 // Global Variables
 static musician_state_t musician_state = {0};
+static uint8_t broadcast_addr[] = BROADCAST_ADDR;
+static esp_timer_handle_t sync_timer = NULL;
+static TaskHandle_t dispatch_task_handle = NULL;
+static esp_timer_handle_t join_timer = NULL;
+static uint8_t own_mac[6];
+static reliable_receiver_t ctrl_receiver;   // Song start/end seen so far (dispatch task only)
+static note_fec_decoder_t note_fec;         // Batched notes already scheduled (dispatch task only)
+static bool note_fec_active = false;        // Current song sends every note more than once
+static hot_log_limit_t ack_fail_limit;      // Dispatch task only
+static hot_log_counter_t frames_summary = HOT_LOG_COUNTER("frames received");
+static hot_log_counter_t notes_summary = HOT_LOG_COUNTER("notes scheduled");
+
+static void sync_timer_callback(void *arg);
+static void join_timer_callback(void *arg);
+static void dispatch_task(void *pvParameters);
 
 // External functions from sound_player.c
 extern bool sound_player_is_playing(void);
 extern uint8_t sound_player_current_note(void);
 extern float sound_player_current_frequency(void);
 
-esp_err_t espnow_musician_init(uint8_t musician_id) {
+// musician_id given by the conductor on an earlier boot, MUSICIAN_ID_NONE on a fresh board
+static uint8_t load_musician_id(void) {
+    nvs_handle_t handle;
+    uint8_t musician_id = MUSICIAN_ID_NONE;
+    if (nvs_open(MUSICIAN_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        if (nvs_get_u8(handle, MUSICIAN_NVS_KEY_ID, &musician_id) != ESP_OK || musician_id >= MAX_MUSICIANS) {
+            musician_id = MUSICIAN_ID_NONE;
+        }
+        nvs_close(handle);
+    }
+    return musician_id;
+}
+
+static esp_err_t save_musician_id(uint8_t musician_id) {
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(MUSICIAN_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_u8(handle, MUSICIAN_NVS_KEY_ID, musician_id);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+// Until the conductor sends a part table: one part, as with four boards (none without an id)
+static void set_default_parts(uint8_t musician_id) {
+    if (musician_id < MAX_MUSICIANS) {
+        musician_state.part_mask = (uint8_t)(1 << (musician_id % MAX_PARTS));
+        musician_state.primary_part = musician_id % MAX_PARTS;
+    } else {
+        musician_state.part_mask = 0;
+        musician_state.primary_part = 0xFF;
+    }
+}
+
+esp_err_t espnow_musician_init(void) {
     esp_err_t ret;
     
     // Initialize NVS
@@ -34,6 +104,8 @@ esp_err_t espnow_musician_init(uint8_t musician_id) {
     }
     ESP_ERROR_CHECK(ret);
 
+    uint8_t musician_id = load_musician_id();
+
     // Initialize network interface
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -48,10 +120,9 @@ esp_err_t espnow_musician_init(uint8_t musician_id) {
     ESP_ERROR_CHECK(esp_wifi_set_channel(ESPNOW_CHANNEL, WIFI_SECOND_CHAN_NONE));
 
     // Get MAC address
-    uint8_t mac[6];
-    ESP_ERROR_CHECK(esp_wifi_get_mac(WIFI_IF_STA, mac));
+    ESP_ERROR_CHECK(esp_wifi_get_mac(WIFI_IF_STA, own_mac));
     ESP_LOGI(TAG, "📡 MAC Address: %02x:%02x:%02x:%02x:%02x:%02x", 
-             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+             own_mac[0], own_mac[1], own_mac[2], own_mac[3], own_mac[4], own_mac[5]);
 
     // Initialize ESP-NOW
     ret = esp_now_init();
@@ -60,70 +131,270 @@ esp_err_t espnow_musician_init(uint8_t musician_id) {
         return ret;
     }
 
+    // Trace anchors on the conductor clock so every board lines up in one trace
+    trace_set_clock(local_time_to_conductor_us);
+
+    // Received frames are handled by the dispatch task, not in the Wi-Fi callback
+    if (xTaskCreate(dispatch_task, "espnow_dispatch", 4096, NULL,
+                    RX_DISPATCH_TASK_PRIORITY, &dispatch_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create dispatch task");
+        return ESP_ERR_NO_MEM;
+    }
+
     // Register receive callback
     ESP_ERROR_CHECK(esp_now_register_recv_cb(espnow_on_data_recv));
 
+    // Add broadcast peer (for time sync requests to the conductor)
+    esp_now_peer_info_t peerInfo = {};
+    memcpy(peerInfo.peer_addr, broadcast_addr, 6);
+    peerInfo.channel = ESPNOW_CHANNEL;
+    peerInfo.encrypt = false;
+
+    ret = esp_now_add_peer(&peerInfo);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add broadcast peer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Start periodic two-way time sync with the conductor
+    clock_sync_init(musician_id);
+    const esp_timer_create_args_t sync_timer_args = {
+        .callback = sync_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "clock_sync",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&sync_timer_args, &sync_timer));
+    ESP_ERROR_CHECK(esp_timer_start_once(sync_timer, (uint64_t)SYNC_FAST_INTERVAL_MS * 1000));
+
     // Initialize musician state
     musician_state.is_initialized = true;
     musician_state.musician_id = musician_id;
+    set_default_parts(musician_id);
     musician_state.is_active = false;
     musician_state.current_song_id = 0;
+    reliable_receiver_init(&ctrl_receiver);
     musician_state.last_message_time = get_time_ms();
     musician_state.messages_received = 0;
     musician_state.notes_played = 0;
     
-    ESP_LOGI(TAG, "✅ ESP-NOW initialized for Musician %d", musician_id);
+    // Announce ourselves until the conductor answers (also with a saved id - it confirms it
+    // and tells the conductor how many voices we have)
+    const esp_timer_create_args_t join_timer_args = {
+        .callback = join_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "join",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&join_timer_args, &join_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(join_timer, (uint64_t)JOIN_RETRY_MS * 1000));
+
+    if (musician_id == MUSICIAN_ID_NONE) {
+        ESP_LOGI(TAG, "✅ ESP-NOW initialized, waiting for an ID from the conductor");
+    } else {
+        ESP_LOGI(TAG, "✅ ESP-NOW initialized for Musician %d", musician_id);
+    }
     return ESP_OK;
 }
 
+esp_err_t espnow_musician_send(const void* data, size_t len) {
+    if (!musician_state.is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_now_send(broadcast_addr, (const uint8_t*)data, len);
+}
+
+static void join_timer_callback(void *arg) {
+    orchestra_join_t join = {0};
+    join.header.type = MSG_JOIN;
+    join.requested_id = musician_state.musician_id;
+    join.voices = sound_player_voice_count();
+    join.engine = SOUND_ENGINE;
+    orchestra_frame_seal(&join, sizeof(join));
+
+    esp_err_t ret = espnow_musician_send(&join, sizeof(join));
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ Join request failed: %s", esp_err_to_name(ret));
+    }
+}
+
+static void sync_timer_callback(void *arg) {
+    // Sync requests carry our id - nothing to ask until the conductor gave us one
+    if (musician_state.musician_id != MUSICIAN_ID_NONE) {
+        orchestra_sync_message_t request;
+        clock_sync_build_request(&request);
+
+        esp_err_t ret = espnow_musician_send(&request, sizeof(request));
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ Sync request failed: %s", esp_err_to_name(ret));
+        }
+    }
+
+    // Random jitter keeps musicians from asking at the same moment
+    uint32_t interval_ms = clock_sync_interval_ms() + (esp_random() % 64);
+    esp_timer_start_once(sync_timer, (uint64_t)interval_ms * 1000);
+}
+
+// Frames from firmware with another protocol version (counted in the Wi-Fi task)
+static volatile uint32_t other_version_frames = 0;
+static volatile uint8_t other_version_seen = 0;
+
+// Cheap checks that are safe to run in the Wi-Fi task: version, known size and CRC
+static bool is_valid_frame(const uint8_t* data, int len) {
+    uint8_t version = orchestra_frame_version(data, len);
+    if (version != ORCHESTRA_PROTOCOL_VERSION) {
+        other_version_frames++;
+        other_version_seen = version;
+        return false;
+    }
+
+    message_type_t type = get_message_type(data, len);
+    bool known_size = (len == sizeof(orchestra_message_t)) ||
+                      (type == MSG_SYNC_TIME && len == sizeof(orchestra_sync_message_t)) ||
+                      (type == MSG_NOTE_BATCH && len > (int)NOTE_BATCH_HEADER_LEN &&
+                       len == (int)note_batch_frame_len(((const orchestra_batch_message_t*)data)->note_count)) ||
+                      (type == MSG_SCORE_CHUNK && len > (int)SCORE_CHUNK_HEADER_LEN &&
+                       len == (int)score_chunk_frame_len(((const orchestra_score_chunk_t*)data)->data_len)) ||
+                      (type == MSG_PART_ASSIGN && len == sizeof(orchestra_part_assign_t)) ||
+                      (type == MSG_JOIN_ACCEPT && len == sizeof(orchestra_join_accept_t));
+    return known_size && orchestra_frame_verify(data, len);
+}
+
 void espnow_on_data_recv(const esp_now_recv_info_t *recv_info, const uint8_t *incomingData, int len) {
-    // ✅ Debug: รับข้อมูลแล้ว!
-    ESP_LOGI(TAG, "📡 ESP-NOW Data Received! Size: %d bytes", len);
-    ESP_LOGI(TAG, "📡 From MAC: %02x:%02x:%02x:%02x:%02x:%02x", 
-             recv_info->src_addr[0], recv_info->src_addr[1], recv_info->src_addr[2],
-             recv_info->src_addr[3], recv_info->src_addr[4], recv_info->src_addr[5]);
+    // Stamp arrival time first - time sync uses it as t4
+    int64_t rx_time_us = esp_timer_get_time();
+    trace_begin(TRACE_EV_RECV, (uint16_t)len, get_message_type(incomingData, len));
+
+    bool queued = false;
+    if (!is_valid_frame(incomingData, len)) {
+        rx_ring_count_rejected();
+    } else if (rx_ring_push(recv_info->src_addr, incomingData, len, rx_time_us)) {
+        // Hand over to the dispatch task and give the Wi-Fi task back immediately
+        xTaskNotifyGive(dispatch_task_handle);
+        queued = true;
+    }
+    stress_stats_rx_callback(esp_timer_get_time() - rx_time_us);
+    trace_end(TRACE_EV_RECV, queued, 0);
+}
+
+static void dispatch_task(void *pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        espnow_dispatch_pending();
+    }
+}
+
+static void send_ctrl_ack(uint16_t sequence) {
+    if (musician_state.musician_id == MUSICIAN_ID_NONE) {
+        return; // The conductor does not wait for boards it has not admitted
+    }
     
-    if (len != sizeof(orchestra_message_t)) {
-        ESP_LOGW(TAG, "⚠️ Invalid message size: %d (expected: %d)", len, sizeof(orchestra_message_t));
+    orchestra_ctrl_ack_t ack = {0};
+    ack.header.type = MSG_CTRL_ACK;
+    ack.musician_id = musician_state.musician_id;
+    ack.sequence = sequence;
+    orchestra_frame_seal(&ack, sizeof(ack));
+
+    esp_err_t ret = espnow_musician_send(&ack, sizeof(ack));
+    if (ret != ESP_OK) {
+        HOT_LOGW_LIMITED(&ack_fail_limit, TAG, "⚠️ Control ACK failed: %s", esp_err_to_name(ret));
+    }
+}
+
+static void dispatch_frame(const rx_frame_t* frame) {
+    // Two-way time sync replies carry their own arrival timestamp
+    if (get_message_type(frame->data, frame->len) == MSG_SYNC_TIME &&
+        frame->len == sizeof(orchestra_sync_message_t)) {
+        orchestra_sync_message_t reply;
+        memcpy(&reply, frame->data, sizeof(reply));
+        clock_sync_handle_reply(&reply, frame->rx_time_us);
+        // A preloaded song sends no notes - the replies show the conductor is still there
+        musician_state.last_message_time = get_time_ms();
         return;
     }
     
-    orchestra_message_t msg;
-    memcpy(&msg, incomingData, sizeof(msg));
+    // Batched notes: pick out the entries for our part
+    if (get_message_type(frame->data, frame->len) == MSG_NOTE_BATCH) {
+        musician_state.last_message_time = get_time_ms();
+        musician_state.messages_received++;
+        if (musician_state.is_active && !note_fec_active) {
+            stress_stats_batch(((const orchestra_batch_message_t*)frame->data)->base_timestamp, frame->rx_time_us);
+        }
+        handle_note_batch((const orchestra_batch_message_t*)frame->data);
+        return;
+    }
     
-    // Debug: แสดงข้อมูลใน message
-    ESP_LOGI(TAG, "📡 Message Type: %d, Part ID: %d, Song ID: %d", 
-             msg.type, msg.part_id, msg.song_id);
+    // Score preload before the song starts
+    if (get_message_type(frame->data, frame->len) == MSG_SCORE_CHUNK) {
+        musician_state.last_message_time = get_time_ms();
+        musician_state.messages_received++;
+        handle_score_chunk((const orchestra_score_chunk_t*)frame->data);
+        return;
+    }
+
+    // Part table for the next song (sent a few times, every copy is the same)
+    if (get_message_type(frame->data, frame->len) == MSG_PART_ASSIGN) {
+        musician_state.last_message_time = get_time_ms();
+        musician_state.messages_received++;
+        handle_part_assign((const orchestra_part_assign_t*)frame->data);
+        return;
+    }
     
-    // Verify checksum
-    if (!verify_checksum(&msg)) {
-        ESP_LOGW(TAG, "⚠️ Message checksum failed");
+    // Our id (every board hears every accept, the MAC says whose it is)
+    if (get_message_type(frame->data, frame->len) == MSG_JOIN_ACCEPT) {
+        orchestra_join_accept_t accept;
+        memcpy(&accept, frame->data, sizeof(accept));
+        handle_join_accept(&accept);
         return;
     }
     
+    // ✅ Debug: รับข้อมูลแล้ว!
+    HOT_LOGI(TAG, "📡 ESP-NOW Data Received! Size: %d bytes", frame->len);
+    HOT_LOGI(TAG, "📡 From MAC: %02x:%02x:%02x:%02x:%02x:%02x",
+             frame->src_addr[0], frame->src_addr[1], frame->src_addr[2],
+             frame->src_addr[3], frame->src_addr[4], frame->src_addr[5]);
+
+    orchestra_message_t msg;
+    memcpy(&msg, frame->data, sizeof(msg));
+
+    // Debug: แสดงข้อมูลใน message
+    HOT_LOGI(TAG, "📡 Message Type: %d, Part ID: %d, Song ID: %d",
+             msg.header.type, msg.part_id, msg.song_id);
+
     // Update last message time
     musician_state.last_message_time = get_time_ms();
     musician_state.messages_received++;
     
+    // Song start/end: acknowledge every copy, act on the first one only
+    if (msg.sequence != RELIABLE_SEQ_NONE &&
+        (msg.header.type == MSG_SONG_START || msg.header.type == MSG_SONG_END)) {
+        send_ctrl_ack(msg.sequence);
+        if (!reliable_receiver_accept(&ctrl_receiver, msg.sequence)) {
+            return;
+        }
+    }
+
     // Check if message is for this musician
     if (!is_message_for_me(&msg)) {
         return; // Ignore messages not for this musician
     }
     
     // Handle message based on type
-    switch (msg.type) {
+    switch (msg.header.type) {
         case MSG_SONG_START:
             ESP_LOGI(TAG, "🎼 Processing SONG_START message");
             handle_song_start(&msg);
             break;
             
         case MSG_PLAY_NOTE:
-            ESP_LOGI(TAG, "🎵 Processing PLAY_NOTE message");
+            HOT_LOGI(TAG, "🎵 Processing PLAY_NOTE message");
             handle_play_note(&msg);
             break;
             
         case MSG_STOP_NOTE:
-            ESP_LOGI(TAG, "🔇 Processing STOP_NOTE message");
+            HOT_LOGI(TAG, "🔇 Processing STOP_NOTE message");
             handle_stop_note(&msg);
             break;
             
@@ -133,7 +404,7 @@ void espnow_on_data_recv(const esp_now_recv_info_t *recv_info, const uint8_t *in
             break;
             
         case MSG_SYNC_TIME:
-            ESP_LOGI(TAG, "⏰ Processing SYNC_TIME message");
+            HOT_LOGI(TAG, "⏰ Processing SYNC_TIME message");
             handle_sync_time(&msg);
             break;
             
@@ -142,17 +413,36 @@ void espnow_on_data_recv(const esp_now_recv_info_t *recv_info, const uint8_t *in
             break;
             
         default:
-            ESP_LOGW(TAG, "⚠️ Unknown message type: %d", msg.type);
+            ESP_LOGW(TAG, "⚠️ Unknown message type: %d", msg.header.type);
             break;
     }
 }
 
+void espnow_dispatch_pending(void) {
+    const rx_frame_t* frame;
+    while ((frame = rx_ring_front()) != NULL) {
+        trace_begin(TRACE_EV_DISPATCH, get_message_type(frame->data, frame->len), frame->len);
+        dispatch_frame(frame);
+        trace_end(TRACE_EV_DISPATCH, 0, 0);
+        rx_ring_release();
+    }
+}
+
+static bool plays_part(uint8_t part_id) {
+    return part_id < MAX_PARTS && (musician_state.part_mask & (1 << part_id)) != 0;
+}
+
+// Streamed notes of a part we already play from the preloaded score would sound twice
+static bool plays_streamed(uint8_t part_id) {
+    return plays_part(part_id) && !(part_id == musician_state.primary_part && score_player_is_playing());
+}
+
 bool is_message_for_me(const orchestra_message_t* msg) {
-    // Check if message is for all musicians or specifically for this musician
-    bool is_for_me = (msg->part_id == 0xFF || msg->part_id == musician_state.musician_id);
+    // Check if message is for all musicians or for one of the parts this board plays
+    bool is_for_me = (msg->part_id == 0xFF || plays_part(msg->part_id));
     
     // Debug: แสดงว่า message นี้เป็นของเราหรือไม่
-    ESP_LOGI(TAG, "🎯 Message for me? %s (msg part_id: %d, my id: %d)", 
+    HOT_LOGI(TAG, "🎯 Message for me? %s (msg part_id: %d, my id: %d)",
              is_for_me ? "YES" : "NO", msg->part_id, musician_state.musician_id);
     
     return is_for_me;
@@ -164,50 +454,176 @@ void handle_song_start(const orchestra_message_t* msg) {
     musician_state.is_active = true;
     musician_state.current_song_id = msg->song_id;
     musician_state.conductor_sync_time = msg->timestamp;
+    timing_log_song(msg->song_id, msg->timestamp, musician_state.part_mask);
     
-    // Stop any current notes
+    // Stop any current and pending notes
+    score_player_stop();
+    note_scheduler_clear();
     sound_stop_note();
+
+    // FEC songs repeat batched notes, only the first copy is scheduled
+    note_fec_active = (msg->note & SONG_FLAG_FEC) != 0;
+    note_fec_decoder_init(&note_fec);
+    stress_stats_song_start();
+
+    // Preloaded score: play it ourselves from the synced clock, nothing more will be streamed
+    // (velocity says which parts were preloaded - the others are streamed as usual)
+    uint8_t primary = musician_state.primary_part;
+    if ((msg->note & SONG_FLAG_PRELOADED) && primary < MAX_PARTS && (msg->velocity & (1u << primary))) {
+        if (score_player_is_ready(msg->song_id, primary)) {
+            score_player_start(msg->timestamp);
+        } else {
+            ESP_LOGW(TAG, "⚠️ Part %d of song %d was preloaded but our score is incomplete", primary, msg->song_id);
+        }
+    }
 }
 
-void handle_play_note(const orchestra_message_t* msg) {
+void handle_join_accept(const orchestra_join_accept_t* accept) {
+    if (memcmp(accept->mac, own_mac, 6) != 0 || accept->musician_id >= MAX_MUSICIANS) {
+        return;
+    }
+    esp_timer_stop(join_timer); // Not running (a repeated accept) is fine
+    if (accept->musician_id == musician_state.musician_id) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "🎫 Conductor assigned Musician ID %d", accept->musician_id);
+    musician_state.musician_id = accept->musician_id;
+    clock_sync_set_musician_id(accept->musician_id);
     if (!musician_state.is_active) {
+        set_default_parts(accept->musician_id);
+    }
+
+    esp_err_t ret = save_musician_id(accept->musician_id);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ Failed to save Musician ID: %s", esp_err_to_name(ret));
+    }
+}
+
+// Our parts for the next song - the primary one is preloaded, the rest streamed note by note.
+// Mid-song tables only add parts (a board that went silent): the preloaded score keeps playing.
+void handle_part_assign(const orchestra_part_assign_t* assign) {
+    uint8_t mask = part_assign_mask(assign, musician_state.musician_id);
+    if (mask == 0) {
         return;
     }
     
-    ESP_LOGI(TAG, "🎵 Received note command: Note %d, Duration %d ms", 
-             msg->note, msg->duration_ms);
+    if (mask != musician_state.part_mask) {
+        ESP_LOGI(TAG, "🎼 Song %d: playing parts mask 0x%02x (primary part %d)",
+                 assign->song_id, mask, part_mask_primary(mask));
+    }
+    musician_state.part_mask = mask;
+    if (!musician_state.is_active) {
+        musician_state.primary_part = part_mask_primary(mask);
+        score_player_clear(); // The chunks for this song follow the assignment
+    }
+}
+
+void handle_score_chunk(const orchestra_score_chunk_t* chunk) {
+    if (chunk->part_id != musician_state.primary_part) {
+        return;
+    }
+
+    if (!score_player_store_chunk(chunk)) {
+        return;
+    }
     
-    // Play the note
-    esp_err_t ret = sound_play_note(msg->note, msg->duration_ms);
+    // Acknowledge every stored chunk (also duplicates - the conductor may have missed our ACK)
+    orchestra_score_ack_t ack = {0};
+    ack.header.type = MSG_SCORE_ACK;
+    ack.song_id = chunk->song_id;
+    ack.part_id = chunk->part_id;
+    ack.musician_id = musician_state.musician_id;
+    ack.chunk_index = chunk->chunk_index;
+    orchestra_frame_seal(&ack, sizeof(ack));
+
+    esp_err_t ret = espnow_musician_send(&ack, sizeof(ack));
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ Score ACK failed: %s", esp_err_to_name(ret));
+    }
+}
+
+// Queue a note - the scheduler starts it at exactly its start time
+static void schedule_note(uint32_t start_timestamp, uint8_t note, uint8_t velocity, uint16_t duration_ms) {
+    // Without a time reference (or for an immediate note) play on arrival
+    int64_t start_time_us = esp_timer_get_time();
+    if (start_timestamp != NOTE_START_IMMEDIATE && clock_sync_get_state()->has_reference) {
+        start_time_us = conductor_ms_to_local_us(start_timestamp);
+        stress_stats_note(start_time_us - esp_timer_get_time());
+    }
+
+    esp_err_t ret = note_scheduler_enqueue(start_time_us, note, velocity, duration_ms);
     if (ret == ESP_OK) {
         musician_state.notes_played++;
     } else {
-        ESP_LOGE(TAG, "Failed to play note: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to schedule note: %s", esp_err_to_name(ret));
     }
 }
 
-void handle_stop_note(const orchestra_message_t* msg) {
-    ESP_LOGI(TAG, "🔇 Stop note command: Note %d", msg->note);
+void handle_play_note(const orchestra_message_t* msg) {
+    if (!musician_state.is_active) {
+        return;
+    }
+    if (msg->part_id < MAX_PARTS && !plays_streamed(msg->part_id)) {
+        return;
+    }
     
-    // Stop if currently playing the specified note
-    if (sound_player_is_playing() && sound_player_current_note() == msg->note) {
-        sound_stop_note();
+    HOT_LOGI(TAG, "🎵 Received note command: Note %d, Duration %d ms, Start %lu",
+             msg->note, msg->duration_ms, msg->timestamp);
+
+    schedule_note(msg->timestamp, msg->note, msg->velocity, msg->duration_ms);
+}
+
+void handle_note_batch(const orchestra_batch_message_t* batch) {
+    if (!musician_state.is_active) {
+        return;
     }
+
+    for (uint8_t i = 0; i < batch->note_count; i++) {
+        const batch_note_t* entry = &batch->notes[i];
+        if (!plays_streamed(entry->part_id)) {
+            continue;
+        }
+        if (note_fec_active) {
+            fec_note_t key = {batch->base_timestamp + entry->start_offset_ms, entry->duration_ms,
+                              entry->part_id, entry->note, entry->velocity};
+            if (!note_fec_decoder_accept(&note_fec, &key)) {
+                continue;
+            }
+        }
+
+        HOT_LOGI(TAG, "🎵 Batched note: Note %d, Duration %d ms, Start %lu",
+                 entry->note, entry->duration_ms, batch->base_timestamp + entry->start_offset_ms);
+        schedule_note(batch->base_timestamp + entry->start_offset_ms,
+                      entry->note, entry->velocity, entry->duration_ms);
+    }
+}
+
+void handle_stop_note(const orchestra_message_t* msg) {
+    HOT_LOGI(TAG, "🔇 Stop note command: Note %d", msg->note);
+
+    // Only the voices playing this note - the rest of a chord keeps sounding
+    sound_release_note(msg->note);
 }
 
 void handle_song_end(const orchestra_message_t* msg) {
     ESP_LOGI(TAG, "🎊 Song ended: ID %d", msg->song_id);
+    stress_stats_print();
+    trace_request_dump();
     
     musician_state.is_active = false;
     musician_state.current_song_id = 0;
     
-    // Stop any playing notes
+    // Stop any playing and pending notes
+    score_player_stop();
+    note_scheduler_clear();
     sound_stop_note();
 }
 
 void handle_sync_time(const orchestra_message_t* msg) {
-    ESP_LOGI(TAG, "⏰ Time sync: %lu ms", msg->timestamp);
+    HOT_LOGI(TAG, "⏰ Time sync: %lu ms", msg->timestamp);
     musician_state.conductor_sync_time = msg->timestamp;
+    clock_sync_one_way_sample(msg->timestamp);
 }
 
 void handle_heartbeat(const orchestra_message_t* msg) {
@@ -221,6 +637,7 @@ void handle_heartbeat(const orchestra_message_t* msg) {
     }
     
     musician_state.conductor_sync_time = msg->timestamp;
+    clock_sync_one_way_sample(msg->timestamp);
 }
 
 void print_debug_info(void) {
@@ -267,13 +684,61 @@ void update_musician_status(void) {
         last_debug_update = current_time;
     }
     
+    // สรุปแทน log รายแพ็กเก็ต (HOT_LOG_LEVEL)
+    hot_log_summary(TAG, &frames_summary, musician_state.messages_received);
+    hot_log_summary(TAG, &notes_summary, musician_state.notes_played);
+
     if (current_time - last_status_update > 15000) { // Every 15 seconds
-        ESP_LOGI(TAG, "📊 Musician %d Status:", musician_state.musician_id);
+        if (musician_state.musician_id == MUSICIAN_ID_NONE) {
+            ESP_LOGI(TAG, "📊 Musician Status (no ID yet, joining):");
+        } else {
+            ESP_LOGI(TAG, "📊 Musician %d Status:", musician_state.musician_id);
+        }
         ESP_LOGI(TAG, "   Active: %s", musician_state.is_active ? "Yes" : "No");
         ESP_LOGI(TAG, "   Current Song: %d", musician_state.current_song_id);
-        ESP_LOGI(TAG, "   Messages Received: %lu", musician_state.messages_received);
+        ESP_LOGI(TAG, "   Parts: mask 0x%02x (primary part %d)", musician_state.part_mask, musician_state.primary_part);
+        ESP_LOGI(TAG, "   Messages Received: %lu (control %lu, duplicates dropped %lu)",
+                 musician_state.messages_received, ctrl_receiver.accepted, ctrl_receiver.duplicates);
+        if (note_fec_active) {
+            ESP_LOGI(TAG, "   Note FEC: %lu notes, %lu repeats dropped", note_fec.accepted, note_fec.duplicates);
+        }
+
+        const rx_ring_stats_t* rx = rx_ring_get_stats();
+        ESP_LOGI(TAG, "   RX Queue: depth %d (max %d/%d), overflow %lu, rejected %lu",
+                 rx_ring_depth(), rx->high_water, RX_RING_SIZE, rx->overflows, rx->rejected);
+        if (other_version_frames > 0) {
+            ESP_LOGW(TAG, "   ⚠️ %lu frames from protocol version %d (we are %d) - update the conductor firmware",
+                     other_version_frames, other_version_seen, ORCHESTRA_PROTOCOL_VERSION);
+        }
         ESP_LOGI(TAG, "   Notes Played: %lu", musician_state.notes_played);
+
+        const note_scheduler_stats_t* sched = note_scheduler_get_stats();
+        ESP_LOGI(TAG, "   Pending Notes: %d (late: %lu, overflow: %lu, last onset error: %ld us)",
+                 note_scheduler_pending(), sched->notes_late, sched->queue_overflows,
+                 sched->last_onset_error_us);
+
+        const score_player_stats_t* score = score_player_get_stats();
+        ESP_LOGI(TAG, "   Score Preload: %s, chunks %lu (dup %lu, bad %lu), notes fed %lu",
+                 score_player_is_playing() ? "playing" : "idle", score->chunks_received,
+                 score->chunks_duplicate, score->chunks_rejected, score->notes_fed);
+
+        const clock_sync_state_t* sync = clock_sync_get_state();
+        ESP_LOGI(TAG, "   Clock Sync: %s, offset %lld +- %ld us, drift %ld +- %ld ppb, rtt %lld us (%lu/%lu samples)",
+                 sync->is_locked ? "locked" : "unlocked", sync->offset_us, sync->offset_std_us,
+                 sync->drift_ppb, sync->drift_std_ppb, sync->last_rtt_us,
+                 sync->samples_accepted, sync->requests_sent);
         ESP_LOGI(TAG, "   Currently Playing: %s", sound_player_is_playing() ? "Yes" : "No");
+#if SOUND_ENGINE == SOUND_ENGINE_LEDC
+        const ledc_voices_stats_t* voices = ledc_voices_get_stats();
+        ESP_LOGI(TAG, "   LEDC Voices: %d/%d busy (max %d), notes %lu, stolen %lu",
+                 voices->voices_active, LEDC_VOICE_COUNT, voices->max_voices_active,
+                 voices->notes_started, voices->voices_stolen);
+#else
+        const synth_output_stats_t* synth = synth_output_get_stats();
+        ESP_LOGI(TAG, "   Synth: %d/%d voices (stolen %lu), render %lu us (max %lu), load %d%%, cmd overflow %lu",
+                 synth->voices_active, SYNTH_MAX_VOICES, synth->voices_stolen, synth->render_us_last,
+                 synth->render_us_max, synth->load_percent, synth->cmd_overflows);
+#endif
         
         if (sound_player_is_playing()) {
             ESP_LOGI(TAG, "   Current Note: %d (%.1f Hz)", 
@@ -295,6 +760,8 @@ void check_communication_timeout(void) {
         current_time - musician_state.last_message_time > 10000) {
         ESP_LOGW(TAG, "⚠️ Conductor timeout - stopping playback");
         musician_state.is_active = false;
+        score_player_stop();
+        note_scheduler_clear();
         sound_stop_note();
     }
 }
@@ -8,7 +8,9 @@
 // Musician State
 typedef struct {
     bool is_initialized;
-    uint8_t musician_id;        // Part ID that this musician plays (0-3)
+    uint8_t musician_id;        // Board ID from the conductor (MUSICIAN_ID_NONE until joined)
+    uint8_t part_mask;          // Every part played on this board (bit n = part n)
+    uint8_t primary_part;       // The part that is preloaded, others are streamed
     bool is_active;             // Currently part of an active song
     uint8_t current_song_id;
     uint32_t last_message_time;
@@ -17,13 +19,25 @@ typedef struct {
     uint32_t notes_played;
 } musician_state_t;
 
+// musician_id from MSG_JOIN_ACCEPT, kept across reboots (erase-flash = join as a new board)
+#define MUSICIAN_NVS_NAMESPACE  "musician"
+#define MUSICIAN_NVS_KEY_ID     "id"
+
 // ESP-NOW Functions
-esp_err_t espnow_musician_init(uint8_t musician_id);
+esp_err_t espnow_musician_init(void);       // ID from NVS, otherwise assigned by the conductor
 void espnow_on_data_recv(const esp_now_recv_info_t *recv_info, const uint8_t *incomingData, int len);
+esp_err_t espnow_musician_send(const void* data, size_t len);
+void espnow_dispatch_pending(void);
+
+#define RX_DISPATCH_TASK_PRIORITY 10   // Above the app tasks, below the Wi-Fi task
 
 // Message Handlers
 void handle_song_start(const orchestra_message_t* msg);
 void handle_play_note(const orchestra_message_t* msg);
+void handle_note_batch(const orchestra_batch_message_t* batch);
+void handle_score_chunk(const orchestra_score_chunk_t* chunk);
+void handle_part_assign(const orchestra_part_assign_t* assign);
+void handle_join_accept(const orchestra_join_accept_t* accept);
 void handle_stop_note(const orchestra_message_t* msg);
 void handle_song_end(const orchestra_message_t* msg);
 void handle_sync_time(const orchestra_message_t* msg);
@@ -0,0 +1,306 @@
+/*
+ * LEDC Voice Allocator Implementation for ESP-IDF
+ * กระจายโน๊ตที่เล่นพร้อมกันไปหลาย LEDC timer/channel/GPIO - บอร์ดเดียวเล่น chord
+ * หรือเล่น 2 parts ได้ แต่ละ voice มี note-off timer ของตัวเอง
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "ledc_voices.h"
+#include "timing_log.h"
+#include "note_table.h"
+#include "hot_log.h"
+
+static const char *TAG = "VOICES";
+
+static ledc_voice_t voices[LEDC_VOICE_COUNT] = {
+    {.speed_mode = LEDC_LOW_SPEED_MODE, .timer = LEDC_TIMER_0, .channel = LEDC_CHANNEL_0, .gpio = LEDC_VOICE_GPIO_0},
+    {.speed_mode = LEDC_LOW_SPEED_MODE, .timer = LEDC_TIMER_1, .channel = LEDC_CHANNEL_1, .gpio = LEDC_VOICE_GPIO_1},
+    {.speed_mode = LEDC_LOW_SPEED_MODE, .timer = LEDC_TIMER_2, .channel = LEDC_CHANNEL_2, .gpio = LEDC_VOICE_GPIO_2},
+    {.speed_mode = LEDC_LOW_SPEED_MODE, .timer = LEDC_TIMER_3, .channel = LEDC_CHANNEL_3, .gpio = LEDC_VOICE_GPIO_3},
+};
+
+static SemaphoreHandle_t voices_mutex = NULL;
+static uint32_t age_counter = 0;
+static ledc_voices_stats_t stats = {0};
+static hot_log_limit_t steal_limit;
+static uint8_t velocity_duty[128];   // Square wave volume follows the duty cycle: 50% at full velocity
+
+static void voice_off_timer_callback(void *arg);
+
+esp_err_t ledc_voices_init(void) {
+    if (!note_table_is_ready()) {
+        note_table_init(MIN_FREQUENCY, MAX_FREQUENCY);
+    }
+    for (int velocity = 0; velocity < 128; velocity++) {
+        uint32_t duty = ((1 << NOTE_TABLE_DUTY_BITS) / 2) * velocity / 127;
+        velocity_duty[velocity] = duty < 8 ? 8 : (uint8_t)duty;
+    }
+
+    voices_mutex = xSemaphoreCreateMutex();
+    if (voices_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < LEDC_VOICE_COUNT; i++) {
+        ledc_voice_t* voice = &voices[i];
+
+        ledc_timer_config_t ledc_timer = {
+            .duty_resolution = NOTE_TABLE_DUTY_BITS,
+            .freq_hz = 1000,
+            .speed_mode = voice->speed_mode,
+            .timer_num = voice->timer,
+            .clk_cfg = LEDC_AUTO_CLK,
+        };
+        esp_err_t ret = ledc_timer_config(&ledc_timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure LEDC timer %d: %s", voice->timer, esp_err_to_name(ret));
+            return ret;
+        }
+
+        ledc_channel_config_t ledc_channel = {
+            .channel    = voice->channel,
+            .duty       = 0,                 // Silent until a note is assigned
+            .gpio_num   = voice->gpio,
+            .speed_mode = voice->speed_mode,
+            .hpoint     = 0,
+            .timer_sel  = voice->timer,
+        };
+        ret = ledc_channel_config(&ledc_channel);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure LEDC channel %d: %s", voice->channel, esp_err_to_name(ret));
+            return ret;
+        }
+
+        const esp_timer_create_args_t timer_args = {
+            .callback = voice_off_timer_callback,
+            .arg = voice,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "voice_off",
+            .skip_unhandled_events = false,
+        };
+        ret = esp_timer_create(&timer_args, &voice->off_timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create note-off timer: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        voice->active = false;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    ESP_LOGI(TAG, "🎹 %d LEDC voices on GPIO %d/%d/%d/%d (steal: %s)", LEDC_VOICE_COUNT,
+             LEDC_VOICE_GPIO_0, LEDC_VOICE_GPIO_1, LEDC_VOICE_GPIO_2, LEDC_VOICE_GPIO_3,
+             LEDC_VOICE_STEAL == LEDC_STEAL_LOWEST_VELOCITY ? "lowest velocity" : "oldest");
+#if LEDC_ONSET_BENCHMARK
+    ledc_voices_onset_benchmark();
+#endif
+    return ESP_OK;
+}
+
+// Divider, resolution and clock come from the note table - only the timer and duty registers are written
+static esp_err_t voice_set_note(const ledc_voice_t* voice, const note_table_entry_t* entry, uint32_t duty) {
+    esp_err_t ret = ledc_timer_set(voice->speed_mode, voice->timer, entry->clock_divider, entry->duty_resolution,
+                                   entry->clk_src == NOTE_CLK_REF_TICK ? LEDC_REF_TICK : LEDC_APB_CLK);
+    if (ret == ESP_OK) {
+        ret = ledc_set_duty(voice->speed_mode, voice->channel, duty);
+    }
+    if (ret == ESP_OK) {
+        ret = ledc_update_duty(voice->speed_mode, voice->channel);
+    }
+    return ret;
+}
+
+// Must be called with voices_mutex held
+static void voice_silence(ledc_voice_t* voice) {
+    esp_timer_stop(voice->off_timer);
+    ledc_set_duty(voice->speed_mode, voice->channel, 0);
+    ledc_update_duty(voice->speed_mode, voice->channel);
+    if (voice->active) {
+        timing_log_note(false, (uint8_t)(voice - voices), voice->note);
+        voice->active = false;
+        stats.voices_active--;
+    }
+}
+
+// Free voice first, otherwise steal by LEDC_VOICE_STEAL. Must be called with voices_mutex held.
+static ledc_voice_t* pick_voice(void) {
+    ledc_voice_t* victim = NULL;
+
+    for (int i = 0; i < LEDC_VOICE_COUNT; i++) {
+        ledc_voice_t* voice = &voices[i];
+        if (!voice->active) {
+            return voice;
+        }
+        if (victim == NULL) {
+            victim = voice;
+            continue;
+        }
+#if LEDC_VOICE_STEAL == LEDC_STEAL_LOWEST_VELOCITY
+        if (voice->velocity < victim->velocity ||
+            (voice->velocity == victim->velocity && (int32_t)(voice->age - victim->age) < 0)) {
+            victim = voice;
+        }
+#else
+        if ((int32_t)(voice->age - victim->age) < 0) {
+            victim = voice;
+        }
+#endif
+    }
+
+    stats.voices_stolen++;
+    HOT_LOGW_LIMITED(&steal_limit, TAG, "⚠️ All %d voices busy, note %d stolen", LEDC_VOICE_COUNT, victim->note);
+    return victim;
+}
+
+esp_err_t ledc_voices_note_on(uint8_t note, uint8_t velocity, int64_t end_us) {
+    if (voices_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const note_table_entry_t* entry = note_table_get(note);
+    if (entry == NULL || entry->clock_divider == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(voices_mutex, portMAX_DELAY);
+
+    ledc_voice_t* voice = pick_voice();
+    esp_err_t ret = voice_set_note(voice, entry, velocity_duty[velocity & 0x7F]);
+    if (ret != ESP_OK) {
+        voice_silence(voice);
+        xSemaphoreGive(voices_mutex);
+        ESP_LOGE(TAG, "Failed to start voice on channel %d: %s", voice->channel, esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (voice->active) {
+        timing_log_note(false, (uint8_t)(voice - voices), voice->note);    // Stolen
+    }
+    timing_log_note(true, (uint8_t)(voice - voices), note);
+
+    if (!voice->active) {
+        voice->active = true;
+        stats.voices_active++;
+        if (stats.voices_active > stats.max_voices_active) {
+            stats.max_voices_active = stats.voices_active;
+        }
+    }
+    voice->note = note;
+    voice->velocity = velocity;
+    voice->age = ++age_counter;
+    voice->end_us = end_us;
+    stats.notes_started++;
+
+    int64_t now_us = esp_timer_get_time();
+    esp_timer_stop(voice->off_timer); // A stolen voice drops its old note-off
+    esp_timer_start_once(voice->off_timer, end_us > now_us ? (uint64_t)(end_us - now_us) : 0);
+
+    xSemaphoreGive(voices_mutex);
+    return ESP_OK;
+}
+
+void ledc_voices_note_off(uint8_t note) {
+    if (voices_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(voices_mutex, portMAX_DELAY);
+    for (int i = 0; i < LEDC_VOICE_COUNT; i++) {
+        if (voices[i].active && voices[i].note == note) {
+            voice_silence(&voices[i]);
+        }
+    }
+    xSemaphoreGive(voices_mutex);
+}
+
+void ledc_voices_all_off(void) {
+    if (voices_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(voices_mutex, portMAX_DELAY);
+    for (int i = 0; i < LEDC_VOICE_COUNT; i++) {
+        voice_silence(&voices[i]);
+    }
+    xSemaphoreGive(voices_mutex);
+}
+
+void ledc_voices_deinit(void) {
+    if (voices_mutex == NULL) {
+        return;
+    }
+
+    ledc_voices_all_off();
+    for (int i = 0; i < LEDC_VOICE_COUNT; i++) {
+        ledc_stop(voices[i].speed_mode, voices[i].channel, 0);
+        esp_timer_delete(voices[i].off_timer);
+        voices[i].off_timer = NULL;
+    }
+    vSemaphoreDelete(voices_mutex);
+    voices_mutex = NULL;
+}
+
+uint8_t ledc_voices_active(void) {
+    return stats.voices_active;
+}
+
+const ledc_voices_stats_t* ledc_voices_get_stats(void) {
+    return &stats;
+}
+
+#define BENCH_ROUNDS 20
+#define BENCH_LOW_NOTE 36
+#define BENCH_HIGH_NOTE 96
+
+// Time the note onset on voice 0 (duty 0, silent): powf + ledc_set_freq vs the note table
+void ledc_voices_onset_benchmark(void) {
+    if (voices_mutex == NULL) {
+        return;
+    }
+    const ledc_voice_t* voice = &voices[0];
+    int64_t total_us[2] = {0};
+    int64_t max_us[2] = {0};
+    uint32_t calls = 0;
+
+    xSemaphoreTake(voices_mutex, portMAX_DELAY);
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint8_t note = BENCH_LOW_NOTE; note <= BENCH_HIGH_NOTE; note++) {
+            int64_t start_us = esp_timer_get_time();
+            float frequency = midi_note_to_frequency(note);
+            if (frequency < MIN_FREQUENCY) frequency = MIN_FREQUENCY;
+            if (frequency > MAX_FREQUENCY) frequency = MAX_FREQUENCY;
+            ledc_set_freq(voice->speed_mode, voice->timer, (uint32_t)frequency);
+            ledc_set_duty(voice->speed_mode, voice->channel, 0);
+            ledc_update_duty(voice->speed_mode, voice->channel);
+            int64_t runtime_us = esp_timer_get_time() - start_us;
+
+            start_us = esp_timer_get_time();
+            voice_set_note(voice, note_table_get(note), 0);
+            int64_t table_us = esp_timer_get_time() - start_us;
+
+            total_us[0] += runtime_us;
+            total_us[1] += table_us;
+            max_us[0] = runtime_us > max_us[0] ? runtime_us : max_us[0];
+            max_us[1] = table_us > max_us[1] ? table_us : max_us[1];
+            calls++;
+        }
+    }
+    xSemaphoreGive(voices_mutex);
+
+    ESP_LOGI(TAG, "⏱️ Onset benchmark, %lu notes: ledc_set_freq avg %lld ns max %lld us | note table avg %lld ns max %lld us",
+             calls, total_us[0] * 1000 / calls, max_us[0], total_us[1] * 1000 / calls, max_us[1]);
+}
+
+static void voice_off_timer_callback(void *arg) {
+    ledc_voice_t* voice = (ledc_voice_t*)arg;
+
+    xSemaphoreTake(voices_mutex, portMAX_DELAY);
+    // The voice may have been stolen by a newer note after this timer was armed
+    if (voice->active && esp_timer_get_time() >= voice->end_us) {
+        voice_silence(voice);
+    }
+    xSemaphoreGive(voices_mutex);
+}
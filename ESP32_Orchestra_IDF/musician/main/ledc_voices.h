@@ -0,0 +1,61 @@
+#ifndef LEDC_VOICES_H
+#define LEDC_VOICES_H
+
+#include "esp_err.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "orchestra_common.h"
+
+// Every voice has its own LEDC timer (own frequency), channel and GPIO.
+// Buzzers per pin, or every pin through 1 kΩ to one speaker/amplifier input (passive mix).
+#define LEDC_VOICE_COUNT        4       // ESP32 has 4 low-speed timers
+#define LEDC_VOICE_GPIO_0       BUZZER_PIN
+#define LEDC_VOICE_GPIO_1       19
+#define LEDC_VOICE_GPIO_2       21
+#define LEDC_VOICE_GPIO_3       23
+
+// Voice stealing when every voice is busy
+#define LEDC_STEAL_OLDEST           0
+#define LEDC_STEAL_LOWEST_VELOCITY  1   // Ties go to the oldest
+#ifndef LEDC_VOICE_STEAL
+#define LEDC_VOICE_STEAL            LEDC_STEAL_OLDEST
+#endif
+
+// 1 = time ledc_set_freq against the note table at boot (log line "Onset benchmark")
+#ifndef LEDC_ONSET_BENCHMARK
+#define LEDC_ONSET_BENCHMARK        0
+#endif
+
+// Voice State
+typedef struct {
+    ledc_mode_t speed_mode;
+    ledc_timer_t timer;
+    ledc_channel_t channel;
+    int gpio;
+    esp_timer_handle_t off_timer;   // Ends this voice only
+    bool active;
+    uint8_t note;
+    uint8_t velocity;
+    uint32_t age;                   // note_on order
+    int64_t end_us;                 // Local esp_timer time of the note-off
+} ledc_voice_t;
+
+// Voice Allocator Statistics
+typedef struct {
+    uint32_t notes_started;
+    uint32_t voices_stolen;
+    uint8_t voices_active;
+    uint8_t max_voices_active;
+} ledc_voices_stats_t;
+
+// Voice Functions
+esp_err_t ledc_voices_init(void);
+esp_err_t ledc_voices_note_on(uint8_t note, uint8_t velocity, int64_t end_us);
+void ledc_voices_note_off(uint8_t note);
+void ledc_voices_all_off(void);
+void ledc_voices_deinit(void);
+uint8_t ledc_voices_active(void);
+const ledc_voices_stats_t* ledc_voices_get_stats(void);
+void ledc_voices_onset_benchmark(void);
+
+#endif // LEDC_VOICES_H
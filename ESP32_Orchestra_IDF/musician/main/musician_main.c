@@ -8,9 +8,10 @@
  * 3. ซิงค์เวลากับ Conductor และ musicians อื่น
  * 4. แสดงสถานะผ่าน LED
  * 
- * การตั้งค่า MUSICIAN_ID:
- * - เปลี่ยนค่า MUSICIAN_ID ในไฟล์นี้ให้ต่างกันในแต่ละ ESP32
- * - 0 = Part A (Melody), 1 = Part B (Harmony), 2 = Part C (Bass), 3 = Part D (Rhythm)
+ * Musician ID:
+ * - ทุกบอร์ดใช้ firmware เดียวกัน - ID มาจาก Conductor ตอน join (MSG_JOIN_ACCEPT) แล้วเก็บใน NVS
+ * - Part ที่เล่นมาจาก Conductor (MSG_PART_ASSIGN) ก่อนแต่ละเพลง - บอร์ดที่ online แบ่งกันเล่นครบทุก part
+ * - อยากได้ ID ใหม่: idf.py erase-flash แล้ว flash ใหม่
  */
 
 #include <stdio.h>
@@ -24,6 +25,10 @@
 #include "orchestra_common.h"
 #include "sound_player.h"
 #include "espnow_musician.h"
+#include "note_scheduler.h"
+#include "score_player.h"
+#include "timing_log.h"
+#include "trace_ring.h"
 
 // External functions
 extern void handle_song_start(const orchestra_message_t* msg);
@@ -32,9 +37,6 @@ extern void handle_song_end(const orchestra_message_t* msg);
 
 static const char *TAG = "MAIN";
 
-// ⚠️ IMPORTANT: Change this for each musician ESP32
-#define MUSICIAN_ID 2  // 0=Part A, 1=Part B, 2=Part C, 3=Part D
-
 // LED Control
 static led_pattern_t current_led_pattern = LED_SLOW_BLINK;
 static uint32_t led_last_update = 0;
@@ -42,7 +44,6 @@ static bool led_state = false;
 
 // Task handles
 static TaskHandle_t led_task_handle = NULL;
-static TaskHandle_t sound_task_handle = NULL;
 static TaskHandle_t status_task_handle = NULL;
 
 // External functions
@@ -51,16 +52,12 @@ extern void check_communication_timeout(void);
 // Function Prototypes
 static void setup_gpio(void);
 static void led_task(void *pvParameters);
-static void sound_task(void *pvParameters);
 static void status_task(void *pvParameters);
 static void print_musician_info(void);
 
 void app_main(void) {
     ESP_LOGI(TAG, "🎵 ESP32 Orchestra Musician Starting...");
     
-    // Print musician info
-    print_musician_info();
-    
     // Setup GPIO
     setup_gpio();
     
@@ -71,8 +68,22 @@ void app_main(void) {
         current_led_pattern = LED_FAST_BLINK;
     }
     
+    // Initialize note scheduler (plays queued notes at their start time)
+    ret = note_scheduler_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to initialize note scheduler: %s", esp_err_to_name(ret));
+        current_led_pattern = LED_FAST_BLINK;
+    }
+
+    // Initialize score player (plays scores preloaded by the conductor)
+    ret = score_player_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to initialize score player: %s", esp_err_to_name(ret));
+        current_led_pattern = LED_FAST_BLINK;
+    }
+
     // Initialize ESP-NOW
-    ret = espnow_musician_init(MUSICIAN_ID);
+    ret = espnow_musician_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "❌ Failed to initialize ESP-NOW: %s", esp_err_to_name(ret));
         current_led_pattern = LED_FAST_BLINK;
@@ -81,6 +92,9 @@ void app_main(void) {
         ESP_LOGI(TAG, "✅ Musician ready and listening for conductor!");
     }
     
+    // Print musician info (ID loaded from NVS by espnow_musician_init)
+    print_musician_info();
+
     ESP_LOGI(TAG, "💡 LED Patterns:");
     ESP_LOGI(TAG, "   Slow blink = Ready/Waiting");
     ESP_LOGI(TAG, "   Solid = Playing song"); 
@@ -93,7 +107,6 @@ void app_main(void) {
     
     // Create tasks
     xTaskCreate(led_task, "led_task", 2048, NULL, 3, &led_task_handle);
-    xTaskCreate(sound_task, "sound_task", 2048, NULL, 4, &sound_task_handle);
     xTaskCreate(status_task, "status_task", 3072, NULL, 2, &status_task_handle);
     
     ESP_LOGI(TAG, "🚀 All tasks created, musician is ready!");
@@ -126,12 +139,13 @@ static void setup_gpio(void) {
 
 static void print_musician_info(void) {
     ESP_LOGI(TAG, "🎭 Musician Information:");
-    ESP_LOGI(TAG, "   ID: %d", MUSICIAN_ID);
-    
-    const char* part_names[] = {"Part A (Melody)", "Part B (Harmony)", "Part C (Bass)", "Part D (Rhythm)"};
-    if (MUSICIAN_ID < 4) {
-        ESP_LOGI(TAG, "   Role: %s", part_names[MUSICIAN_ID]);
+    musician_state_t* state = get_musician_state();
+    if (state->musician_id == MUSICIAN_ID_NONE) {
+        ESP_LOGI(TAG, "   ID: none yet (joining, the conductor assigns one)");
+    } else {
+        ESP_LOGI(TAG, "   ID: %d (saved, confirmed again on join)", state->musician_id);
     }
+    ESP_LOGI(TAG, "   Voices: %d, parts come from the conductor before each song", sound_player_voice_count());
     
     // Get MAC address
     uint8_t mac[6];
@@ -202,30 +216,20 @@ static void led_task(void *pvParameters) {
     }
 }
 
-static void sound_task(void *pvParameters) {
-    while (1) {
-        // Update sound player (handle note timing)
-        sound_update();
-        
-        vTaskDelay(pdMS_TO_TICKS(10)); // Update every 10ms for precise timing
-    }
-}
-
 // Function to test song playback manually
 static void test_song_playback(void) {
     ESP_LOGI(TAG, "🧪 Testing song playback manually...");
     
     // Create a fake SONG_START message
     orchestra_message_t test_msg = {
-        .type = MSG_SONG_START,
+        .header.type = MSG_SONG_START,
         .song_id = SONG_TWINKLE_STAR,
-        .part_id = MUSICIAN_ID,
+        .part_id = 0xFF,
         .note = 0,
         .velocity = 100,
-        .timestamp = get_time_ms(),
+        .timestamp = NOTE_START_IMMEDIATE, // Play on arrival
         .duration_ms = 0,
-        .tempo_bpm = 120,
-        .checksum = 0
+        .tempo_bpm = 120
     };
     
     ESP_LOGI(TAG, "🧪 Simulating SONG_START message...");
@@ -234,7 +238,7 @@ static void test_song_playback(void) {
     // Test a few notes
     vTaskDelay(pdMS_TO_TICKS(500));
     
-    test_msg.type = MSG_PLAY_NOTE;
+    test_msg.header.type = MSG_PLAY_NOTE;
     test_msg.note = NOTE_C4;
     test_msg.duration_ms = 500;
     ESP_LOGI(TAG, "🧪 Simulating PLAY_NOTE (C4)...");
@@ -248,7 +252,7 @@ static void test_song_playback(void) {
     
     vTaskDelay(pdMS_TO_TICKS(600));
     
-    test_msg.type = MSG_SONG_END;
+    test_msg.header.type = MSG_SONG_END;
     ESP_LOGI(TAG, "🧪 Simulating SONG_END...");
     handle_song_end(&test_msg);
 }
@@ -273,6 +277,8 @@ static void status_task(void *pvParameters) {
         
         // Update status periodically
         update_musician_status();
+        timing_log_flush();
+        trace_poll(get_musician_state()->musician_id);
         
         vTaskDelay(pdMS_TO_TICKS(100)); // Update every 100ms for button responsiveness
     }
@@ -0,0 +1,161 @@
+/*
+ * Note Scheduler Implementation for ESP-IDF
+ * คิวโน๊ตที่รอเล่น เรียงตามเวลาเริ่ม และเล่นตรงเวลาด้วย esp_timer (one-shot)
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "note_scheduler.h"
+#include "sound_player.h"
+#include "hot_log.h"
+
+static const char *TAG = "SCHEDULER";
+
+// Time-ordered queue of pending notes (index 0 = next note to play)
+static scheduled_note_t note_queue[NOTE_QUEUE_SIZE];
+static uint8_t note_count = 0;
+static SemaphoreHandle_t queue_mutex = NULL;
+static esp_timer_handle_t onset_timer = NULL;
+static note_scheduler_stats_t stats = {0};
+static hot_log_limit_t late_limit;
+static hot_log_limit_t overflow_limit;
+
+static void onset_timer_callback(void *arg);
+
+// Re-arm the one-shot timer for the note at the head of the queue.
+// Must be called with queue_mutex held.
+static void arm_onset_timer(void) {
+    esp_timer_stop(onset_timer); // Not running is fine
+
+    if (note_count == 0) {
+        return;
+    }
+
+    int64_t delay_us = note_queue[0].start_time_us - esp_timer_get_time();
+    if (delay_us < 0) {
+        delay_us = 0;
+    }
+    esp_timer_start_once(onset_timer, (uint64_t)delay_us);
+}
+
+esp_err_t note_scheduler_init(void) {
+    queue_mutex = xSemaphoreCreateMutex();
+    if (queue_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = onset_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "note_onset",
+        .skip_unhandled_events = false,
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &onset_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create onset timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    note_count = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    ESP_LOGI(TAG, "⏱️ Note scheduler initialized (queue: %d notes)", NOTE_QUEUE_SIZE);
+    return ESP_OK;
+}
+
+esp_err_t note_scheduler_enqueue(int64_t start_time_us, uint8_t note, uint8_t velocity, uint16_t duration_ms) {
+    if (onset_timer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Buffered audio output sounds later than the call - start that much earlier
+    start_time_us -= sound_output_latency_us();
+
+    // Too late to sound in time - better silent than audibly out of place
+    if (start_time_us < esp_timer_get_time() - (int64_t)SYNC_TOLERANCE_MS * 1000) {
+        stats.notes_late++;
+        HOT_LOGW_LIMITED(&late_limit, TAG, "⚠️ Late note %d dropped (%lld us late)", note,
+                         esp_timer_get_time() - start_time_us);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    xSemaphoreTake(queue_mutex, portMAX_DELAY);
+
+    if (note_count >= NOTE_QUEUE_SIZE) {
+        xSemaphoreGive(queue_mutex);
+        stats.queue_overflows++;
+        HOT_LOGW_LIMITED(&overflow_limit, TAG, "⚠️ Note queue full, note %d dropped", note);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Insertion sort - notes normally arrive in order, so this is usually O(1)
+    uint8_t pos = note_count;
+    while (pos > 0 && note_queue[pos - 1].start_time_us > start_time_us) {
+        note_queue[pos] = note_queue[pos - 1];
+        pos--;
+    }
+    note_queue[pos].start_time_us = start_time_us;
+    note_queue[pos].note = note;
+    note_queue[pos].velocity = velocity;
+    note_queue[pos].duration_ms = duration_ms;
+    note_count++;
+    stats.notes_scheduled++;
+
+    // New earliest note - the timer has to fire sooner
+    if (pos == 0) {
+        arm_onset_timer();
+    }
+
+    xSemaphoreGive(queue_mutex);
+    return ESP_OK;
+}
+
+void note_scheduler_clear(void) {
+    if (queue_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(queue_mutex, portMAX_DELAY);
+    note_count = 0;
+    esp_timer_stop(onset_timer);
+    xSemaphoreGive(queue_mutex);
+}
+
+uint8_t note_scheduler_pending(void) {
+    return note_count;
+}
+
+const note_scheduler_stats_t* note_scheduler_get_stats(void) {
+    return &stats;
+}
+
+static void onset_timer_callback(void *arg) {
+    scheduled_note_t due[NOTE_QUEUE_SIZE];
+    uint8_t due_count = 0;
+    int64_t now = esp_timer_get_time();
+
+    // Take every note whose start time has come, then re-arm for the rest
+    xSemaphoreTake(queue_mutex, portMAX_DELAY);
+    while (due_count < note_count && note_queue[due_count].start_time_us <= now) {
+        due[due_count] = note_queue[due_count];
+        due_count++;
+    }
+    if (due_count > 0) {
+        memmove(&note_queue[0], &note_queue[due_count], (note_count - due_count) * sizeof(scheduled_note_t));
+        note_count -= due_count;
+    }
+    arm_onset_timer();
+    xSemaphoreGive(queue_mutex);
+
+    // Play outside the lock so the radio side is never blocked by LEDC calls
+    for (uint8_t i = 0; i < due_count; i++) {
+        stats.last_onset_error_us = (int32_t)(now - due[i].start_time_us);
+        if (sound_play_note(due[i].note, due[i].velocity, due[i].duration_ms) == ESP_OK) {
+            stats.notes_started++;
+        }
+    }
+}
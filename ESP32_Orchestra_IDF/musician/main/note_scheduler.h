@@ -0,0 +1,31 @@
+#ifndef NOTE_SCHEDULER_H
+#define NOTE_SCHEDULER_H
+
+#include "esp_err.h"
+#include "orchestra_common.h"
+
+// Pending note (start time is on the local esp_timer clock)
+typedef struct {
+    int64_t start_time_us;
+    uint8_t note;
+    uint8_t velocity;
+    uint16_t duration_ms;
+} scheduled_note_t;
+
+// Note Scheduler Statistics
+typedef struct {
+    uint32_t notes_scheduled;
+    uint32_t notes_started;
+    uint32_t notes_late;        // Arrived after their start time (+ SYNC_TOLERANCE_MS)
+    uint32_t queue_overflows;   // Dropped because the queue was full
+    int32_t last_onset_error_us; // Timer callback time - scheduled start time
+} note_scheduler_stats_t;
+
+// Scheduler Functions
+esp_err_t note_scheduler_init(void);
+esp_err_t note_scheduler_enqueue(int64_t start_time_us, uint8_t note, uint8_t velocity, uint16_t duration_ms);
+void note_scheduler_clear(void);
+uint8_t note_scheduler_pending(void);
+const note_scheduler_stats_t* note_scheduler_get_stats(void);
+
+#endif // NOTE_SCHEDULER_H
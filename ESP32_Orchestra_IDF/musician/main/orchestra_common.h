@@ -3,16 +3,21 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "frame_crc.h"
 
 // ESP-NOW Configuration
 #define BROADCAST_ADDR {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
-#define MAX_MUSICIANS 4
+#define MAX_MUSICIANS 32   // Boards in the part assignment table (musician_id 0-31)
+#define MUSICIAN_ID_NONE 0xFF  // ยังไม่ได้ id จาก Conductor
+#define MAX_PARTS 8        // Parts per song (part_id 0-7), bit n of a part mask = part n
 #define ESPNOW_CHANNEL 10
 
 // Message Types for Orchestra Communication
@@ -22,9 +27,27 @@ typedef enum {
     MSG_STOP_NOTE = 3,      // หยุดโน๊ต - หยุดโน๊ตเฉพาะ
     MSG_SONG_END = 4,       // จบเพลง - หยุดทุกอย่าง
     MSG_SYNC_TIME = 5,      // ซิงค์เวลา - ปรับเวลาให้ตรงกัน
-    MSG_HEARTBEAT = 6       // ตรวจสอบการเชื่อมต่อ
+    MSG_HEARTBEAT = 6,      // ตรวจสอบการเชื่อมต่อ
+    MSG_NOTE_BATCH = 7,     // หลายโน๊ตใน frame เดียว (ประหยัด airtime)
+    MSG_SCORE_CHUNK = 8,    // ส่วนหนึ่งของโน๊ตทั้ง part (preload ก่อนเริ่มเพลง)
+    MSG_SCORE_ACK = 9,      // Musician ยืนยันการได้รับ score chunk
+    MSG_PART_ASSIGN = 10,   // ตาราง part ของทุก Musician (ส่งก่อนเริ่มเพลง)
+    MSG_JOIN = 11,          // Musician ประกาศตัว (capabilities) ขอ musician_id
+    MSG_JOIN_ACCEPT = 12,   // Conductor ให้ musician_id กับ MAC นั้น
+    MSG_CTRL_ACK = 13       // Musician ยืนยัน MSG_SONG_START / MSG_SONG_END (ตาม sequence)
 } message_type_t;
 
+// Frame Header - 4 byte แรกของทุก message (ตำแหน่งเดียวกับ message_type_t 4 byte ของ firmware เดิม)
+// Firmware เดิม (version 0) เก็บ type เป็น enum 4 byte และ checksum แบบบวก byte ไว้ท้าย frame:
+// firmware ใหม่เห็น version 0 จึงรู้ว่าเป็นบอร์ดรุ่นเก่า ส่วนบอร์ดเก่าเห็น type ไม่รู้จักแล้วทิ้ง frame
+#define ORCHESTRA_PROTOCOL_VERSION  1   // 1 = CRC-16 ใน header
+
+typedef struct {
+    uint8_t type;              // message_type_t
+    uint8_t version;           // ORCHESTRA_PROTOCOL_VERSION ของผู้ส่ง
+    uint16_t crc;              // frame_crc16 ของ type, version และทุก byte หลัง header
+} __attribute__((packed)) orchestra_header_t;
+
 // Song IDs
 typedef enum {
     SONG_TWINKLE_STAR = 1,  // Twinkle Twinkle Little Star (4 parts)
@@ -33,7 +56,8 @@ typedef enum {
     SONG_MARY_LAMB = 4      // Mary Had a Little Lamb (2 parts)
 } song_id_t;
 
-// Musician Parts (แต่ละ ESP32 จะรับผิดชอบ part ใดpart หนึ่ง)
+// Musician Parts - ชื่อของ 4 parts แรก (เพลงมีได้ถึง MAX_PARTS parts)
+// บอร์ดไหนเล่น part ไหนมาจาก MSG_PART_ASSIGN: หลายบอร์ดเล่น part เดียวกัน หรือบอร์ดเดียวเล่นหลาย parts ได้
 typedef enum {
     PART_A = 0,    // Melody หรือ Voice 1
     PART_B = 1,    // Harmony หรือ Voice 2  
@@ -43,17 +67,153 @@ typedef enum {
 
 // Orchestra Message Structure
 typedef struct {
-    message_type_t type;        // ประเภทข้อความ
+    orchestra_header_t header; // ประเภทข้อความ
     uint8_t song_id;           // รหัสเพลง (1-4)
     uint8_t part_id;           // Part ที่เฉพาะเจาะจง (0-3), 0xFF = ทุก parts
-    uint8_t note;              // MIDI Note number (0-127)
-    uint8_t velocity;          // ความแรงเสียง (0-127)
-    uint32_t timestamp;        // เวลาที่ควรเล่น (milliseconds)
+    uint8_t note;              // MIDI Note number (0-127), song flags สำหรับ MSG_SONG_START
+    uint8_t velocity;          // ความแรงเสียง (0-127), MSG_SONG_START: bit n = part n preload แล้ว
+    uint32_t timestamp;        // เวลาที่ควรเล่น (conductor time, milliseconds)
     uint16_t duration_ms;      // ความยาวโน๊ต (milliseconds)
     uint8_t tempo_bpm;         // Beats per minute (เฉพาะ MSG_SONG_START)
-    uint8_t checksum;          // checksum สำหรับตรวจสอบข้อมูล
+    uint16_t sequence;         // MSG_SONG_START / MSG_SONG_END: reliable_ctrl sequence, 0 = best-effort
 } __attribute__((packed)) orchestra_message_t;
 
+// ACK ของข้อความควบคุม - ส่งทุกครั้งที่ได้รับ (รวม duplicate) Conductor ส่งซ้ำจนทุกบอร์ด ACK
+typedef struct {
+    orchestra_header_t header; // MSG_CTRL_ACK
+    uint8_t musician_id;
+    uint16_t sequence;         // sequence ของข้อความที่ยืนยัน
+} __attribute__((packed)) orchestra_ctrl_ack_t;
+
+// Time Sync Stages (MSG_SYNC_TIME)
+typedef enum {
+    SYNC_STAGE_REQUEST = 0,    // Musician -> Conductor: t1
+    SYNC_STAGE_REPLY = 1       // Conductor -> Musician: t1 (echo), t2, t3
+} sync_stage_t;
+
+// Two-way Time Sync Message (NTP-style, microseconds from esp_timer_get_time())
+// offset = ((t2 - t1) + (t3 - t4)) / 2, round trip = (t4 - t1) - (t3 - t2)
+typedef struct {
+    orchestra_header_t header; // MSG_SYNC_TIME
+    uint8_t stage;             // sync_stage_t
+    uint8_t musician_id;       // Musician ที่ขอซิงค์
+    uint8_t sequence;          // ลำดับการขอซิงค์ของ musician
+    int64_t t1_us;             // Musician ส่ง request (musician clock)
+    int64_t t2_us;             // Conductor ได้รับ request (conductor clock)
+    int64_t t3_us;             // Conductor ส่ง reply (conductor clock)
+} __attribute__((packed)) orchestra_sync_message_t;
+
+// Batched Notes (MSG_NOTE_BATCH)
+// โน๊ตหลายตัว (หลาย parts) ที่ถึงเวลาใกล้กันรวมอยู่ใน ESP-NOW frame เดียว
+#define ORCHESTRA_MAX_FRAME_LEN  250    // ESP_NOW_MAX_DATA_LEN
+
+typedef struct {
+    uint8_t part_id;           // Part ของโน๊ตนี้
+    uint8_t note;              // MIDI Note number (0-127)
+    uint8_t velocity;          // ความแรงเสียง (0-127)
+    uint16_t start_offset_ms;  // เวลาเริ่มเล่น นับจาก base_timestamp
+    uint16_t duration_ms;      // ความยาวโน๊ต (milliseconds)
+} __attribute__((packed)) batch_note_t;
+
+#define NOTE_BATCH_HEADER_LEN    (sizeof(orchestra_header_t) + 2 + sizeof(uint32_t))
+#define NOTE_BATCH_MAX_NOTES     ((ORCHESTRA_MAX_FRAME_LEN - NOTE_BATCH_HEADER_LEN) / sizeof(batch_note_t))
+
+// Frame = header + note_count entries (only the used entries are sent)
+typedef struct {
+    orchestra_header_t header; // MSG_NOTE_BATCH
+    uint8_t song_id;           // รหัสเพลง
+    uint8_t note_count;        // จำนวนโน๊ตใน frame
+    uint32_t base_timestamp;   // เวลาอ้างอิง (conductor time, milliseconds)
+    batch_note_t notes[NOTE_BATCH_MAX_NOTES];
+} __attribute__((packed)) orchestra_batch_message_t;
+
+static inline size_t note_batch_frame_len(uint8_t note_count) {
+    return NOTE_BATCH_HEADER_LEN + (size_t)note_count * sizeof(batch_note_t);
+}
+
+// Score Preload (MSG_SCORE_CHUNK / MSG_SCORE_ACK)
+// Conductor ส่งโน๊ตทั้ง part ให้ Musician ก่อนเริ่มเพลง แล้ว MSG_SONG_START (flag
+// SONG_FLAG_PRELOADED) บอกแค่เวลาเริ่ม - Musician เล่นเองจากนาฬิกาที่ซิงค์แล้ว
+#define SONG_FLAG_PRELOADED      0x01   // MSG_SONG_START: เล่นจาก score ที่ preload ไว้ (เฉพาะ parts ใน velocity)
+#define SONG_FLAG_FEC            0x02   // MSG_SONG_START: batch มีโน๊ตซ้ำ (note_fec) ต้องตัด duplicate
+
+// Score is sent as one encoded .osc blob (common/orchestra_score) split into chunks
+#define SCORE_CHUNK_HEADER_LEN   (sizeof(orchestra_header_t) + 5 + sizeof(uint16_t))
+#define SCORE_CHUNK_MAX_BYTES    (ORCHESTRA_MAX_FRAME_LEN - SCORE_CHUNK_HEADER_LEN)
+#define SCORE_MAX_CHUNKS         32     // ต้องไม่เกินจำนวน bit ใน bitmap (uint32_t)
+#define SCORE_MAX_BLOB_LEN       2048   // ขนาด score (encoded) สูงสุดต่อ part
+#define SCORE_MAX_EVENTS         512    // ความยาว score สูงสุดต่อ part ใน RAM ของ Musician
+
+// Frame = header + data_len bytes
+typedef struct {
+    orchestra_header_t header; // MSG_SCORE_CHUNK
+    uint8_t song_id;           // รหัสเพลง
+    uint8_t part_id;           // Part ของ score นี้
+    uint8_t chunk_index;       // ลำดับ chunk (0 .. chunk_count-1)
+    uint8_t chunk_count;       // จำนวน chunk ทั้งหมดของ part
+    uint8_t data_len;          // จำนวน byte ใน chunk นี้
+    uint16_t total_len;        // ขนาด blob ทั้ง part
+    uint8_t data[SCORE_CHUNK_MAX_BYTES];
+} __attribute__((packed)) orchestra_score_chunk_t;
+
+static inline size_t score_chunk_frame_len(uint8_t data_len) {
+    return SCORE_CHUNK_HEADER_LEN + (size_t)data_len;
+}
+
+typedef struct {
+    orchestra_header_t header; // MSG_SCORE_ACK
+    uint8_t song_id;
+    uint8_t part_id;
+    uint8_t musician_id;
+    uint8_t chunk_index;
+} __attribute__((packed)) orchestra_score_ack_t;
+
+// Part Assignment (MSG_PART_ASSIGN)
+// Conductor broadcast ตารางเดียวทั้งวง ก่อนเริ่มเพลง: part_masks[id] = parts ที่บอร์ด id เล่น
+// 0 = ค่า default คือ part (musician_id % part_count) - บอร์ดเกินจำนวน parts จะเล่นซ้ำ (doubling)
+typedef struct {
+    orchestra_header_t header; // MSG_PART_ASSIGN
+    uint8_t song_id;           // เพลงที่ตารางนี้ใช้
+    uint8_t part_count;        // จำนวน parts ของเพลง
+    uint8_t part_masks[MAX_MUSICIANS];
+} __attribute__((packed)) orchestra_part_assign_t;
+
+// Parts that one board plays under an assignment table
+static inline uint8_t part_assign_mask(const orchestra_part_assign_t* assign, uint8_t musician_id) {
+    if (assign->part_count == 0 || assign->part_count > MAX_PARTS || musician_id >= MAX_MUSICIANS) {
+        return 0;
+    }
+    uint8_t all_parts = (uint8_t)((1u << assign->part_count) - 1);
+    uint8_t mask = assign->part_masks[musician_id] & all_parts;
+    return mask ? mask : (uint8_t)(1u << (musician_id % assign->part_count));
+}
+
+// The one part a board preloads (the score player holds a single part), others are streamed
+static inline uint8_t part_mask_primary(uint8_t part_mask) {
+    for (uint8_t part = 0; part < MAX_PARTS; part++) {
+        if (part_mask & (1u << part)) {
+            return part;
+        }
+    }
+    return 0xFF;
+}
+
+// Join (MSG_JOIN / MSG_JOIN_ACCEPT)
+// Firmware เดียวใช้ได้ทุกบอร์ด: Musician ส่ง MSG_JOIN จนได้ accept แล้วเก็บ id ไว้ใน NVS
+// Conductor จำ MAC -> id ใน NVS (roster) บอร์ดเดิมจึงได้ id เดิมทุกครั้ง
+typedef struct {
+    orchestra_header_t header; // MSG_JOIN
+    uint8_t requested_id;      // id เดิมจาก NVS ของ Musician, MUSICIAN_ID_NONE = ยังไม่มี
+    uint8_t voices;            // เล่นพร้อมกันได้กี่เสียง
+    uint8_t engine;            // SOUND_ENGINE_* ของ Musician
+} __attribute__((packed)) orchestra_join_t;
+
+typedef struct {
+    orchestra_header_t header; // MSG_JOIN_ACCEPT
+    uint8_t mac[6];            // บอร์ดที่ได้ id นี้
+    uint8_t musician_id;
+} __attribute__((packed)) orchestra_join_accept_t;
+
 // Note definitions (MIDI note numbers)
 #define NOTE_C4  60   // Middle C (Do)
 #define NOTE_D4  62   // D (Re)  
@@ -83,6 +243,25 @@ typedef struct {
 #define DEFAULT_TEMPO_BPM    120    // Default tempo
 #define QUARTER_NOTE_MS      500    // ความยาว quarter note ที่ 120 BPM
 #define SYNC_TOLERANCE_MS    50     // ความเผื่อในการซิงค์เวลา
+#define HEARTBEAT_INTERVAL_MS 5000  // Conductor ส่ง heartbeat ทุก 5 วินาที
+
+// Look-ahead Scheduling
+// Conductor ส่งโน๊ตล่วงหน้า NOTE_LOOKAHEAD_MS และใช้ timestamp เป็นเวลาเริ่มเล่น
+// (conductor time) ส่วน Musician เก็บโน๊ตไว้ในคิวแล้วเล่นตรงเวลาด้วย esp_timer
+#define NOTE_LOOKAHEAD_MS    150    // ส่งโน๊ตล่วงหน้า (0 = เล่นทันทีที่ได้รับ)
+#define NOTE_QUEUE_SIZE      16     // จำนวนโน๊ตที่รอเล่นได้สูงสุด
+#define NOTE_START_IMMEDIATE 0      // timestamp = 0 หมายถึงเล่นทันที
+#define NOTE_BATCH_WINDOW_MS 40     // รวมโน๊ตที่ถึงเวลาส่งภายในช่วงนี้เป็น frame เดียว
+#define SCORE_ACK_TIMEOUT_MS 50     // รอ ACK ของแต่ละ score chunk
+#define SCORE_CHUNK_RETRIES  5      // ส่ง chunk ซ้ำได้กี่ครั้งก่อนยอมแพ้
+#define PART_ASSIGN_REPEAT   3      // ส่ง MSG_PART_ASSIGN ซ้ำกี่ครั้ง (broadcast ไม่มี ACK)
+#define JOIN_RETRY_MS        1000   // Musician ส่ง MSG_JOIN ซ้ำจนได้ accept
+#define ROSTER_TIMEOUT_MS    8000   // ไม่ได้ยินบอร์ดนานเท่านี้ = offline (sync request ทุก 2 วินาที)
+
+// Clock Sync
+#define SYNC_INTERVAL_MS         2000   // ช่วงเวลาซิงค์ปกติ
+#define SYNC_FAST_INTERVAL_MS    250    // ช่วงเวลาซิงค์ตอนเริ่มต้น (ยังไม่ lock)
+#define SYNC_LOCK_SAMPLES        4      // จำนวน sample ก่อนถือว่า lock แล้ว
 
 // Sound Configuration
 #define MAX_FREQUENCY        4000   // ความถี่สูงสุด (Hz)
@@ -98,17 +277,38 @@ typedef struct {
 #define LEDC_FREQUENCY          (4000) // Frequency in Hertz. Set frequency at 4 kHz
 
 // Utility Functions
-static inline uint8_t calculate_checksum(const orchestra_message_t* msg) {
-    uint8_t sum = 0;
-    const uint8_t* data = (const uint8_t*)msg;
-    for (int i = 0; i < sizeof(orchestra_message_t) - 1; i++) { // -1 เพื่อไม่รวม checksum field
-        sum += data[i];
+// CRC-16 over the frame without the crc field itself
+static inline uint16_t orchestra_frame_crc(const void* frame, size_t len) {
+    const uint8_t* data = (const uint8_t*)frame;
+    uint16_t crc = frame_crc16(0, data, offsetof(orchestra_header_t, crc));
+    return frame_crc16(crc, data + sizeof(orchestra_header_t), len - sizeof(orchestra_header_t));
+}
+
+// Fill in version and CRC - last step before a frame is sent (every other field already set)
+static inline void orchestra_frame_seal(void* frame, size_t len) {
+    orchestra_header_t* header = (orchestra_header_t*)frame;
+    header->version = ORCHESTRA_PROTOCOL_VERSION;
+    header->crc = orchestra_frame_crc(frame, len);
+}
+
+// Sender's protocol version, 0 = firmware from before the versioned header
+static inline uint8_t orchestra_frame_version(const uint8_t* data, int len) {
+    return len >= (int)sizeof(orchestra_header_t) ? data[offsetof(orchestra_header_t, version)] : 0;
+}
+
+static inline bool orchestra_frame_verify(const void* frame, size_t len) {
+    if (len < sizeof(orchestra_header_t) ||
+        orchestra_frame_version((const uint8_t*)frame, (int)len) != ORCHESTRA_PROTOCOL_VERSION) {
+        return false;
     }
-    return sum;
+    uint16_t crc;
+    memcpy(&crc, (const uint8_t*)frame + offsetof(orchestra_header_t, crc), sizeof(crc));
+    return orchestra_frame_crc(frame, len) == crc;
 }
 
-static inline bool verify_checksum(const orchestra_message_t* msg) {
-    return calculate_checksum(msg) == msg->checksum;
+// Every message starts with orchestra_header_t
+static inline message_type_t get_message_type(const uint8_t* data, int len) {
+    return len >= (int)sizeof(orchestra_header_t) ? (message_type_t)data[0] : (message_type_t)0;
 }
 
 // Convert MIDI note to frequency (Hz)
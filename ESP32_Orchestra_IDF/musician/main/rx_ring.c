@@ -0,0 +1,68 @@
+/*
+ * Receive Ring Buffer Implementation
+ * Single-producer (Wi-Fi task) / single-consumer (dispatch task) ring แบบ lock-free
+ * ทำให้ ESP-NOW callback แค่ตรวจสอบและคัดลอก frame แล้วคืนให้ Wi-Fi stack ทันที
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include "rx_ring.h"
+
+static rx_frame_t ring[RX_RING_SIZE];
+static atomic_uint_fast32_t head = 0;   // Next slot to write (producer only)
+static atomic_uint_fast32_t tail = 0;   // Next slot to read (consumer only)
+static rx_ring_stats_t stats = {0};
+
+bool rx_ring_push(const uint8_t* src_addr, const uint8_t* data, int len, int64_t rx_time_us) {
+    uint32_t h = atomic_load_explicit(&head, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&tail, memory_order_acquire);
+
+    if (h - t >= RX_RING_SIZE || len <= 0 || len > RX_RING_FRAME_MAX) {
+        stats.overflows++;
+        return false;
+    }
+
+    rx_frame_t* slot = &ring[h % RX_RING_SIZE];
+    slot->rx_time_us = rx_time_us;
+    memcpy(slot->src_addr, src_addr, ESP_NOW_ETH_ALEN);
+    slot->len = (uint8_t)len;
+    memcpy(slot->data, data, len);
+
+    // Publish the slot only after its contents are written
+    atomic_store_explicit(&head, h + 1, memory_order_release);
+
+    stats.pushed++;
+    uint8_t depth = (uint8_t)(h + 1 - t);
+    if (depth > stats.high_water) {
+        stats.high_water = depth;
+    }
+    return true;
+}
+
+void rx_ring_count_rejected(void) {
+    stats.rejected++;
+}
+
+const rx_frame_t* rx_ring_front(void) {
+    uint32_t t = atomic_load_explicit(&tail, memory_order_relaxed);
+    uint32_t h = atomic_load_explicit(&head, memory_order_acquire);
+
+    if (t == h) {
+        return NULL;
+    }
+    return &ring[t % RX_RING_SIZE];
+}
+
+void rx_ring_release(void) {
+    uint32_t t = atomic_load_explicit(&tail, memory_order_relaxed);
+    // Hand the slot back to the producer only after we are done reading it
+    atomic_store_explicit(&tail, t + 1, memory_order_release);
+}
+
+uint8_t rx_ring_depth(void) {
+    return (uint8_t)(atomic_load(&head) - atomic_load(&tail));
+}
+
+const rx_ring_stats_t* rx_ring_get_stats(void) {
+    return &stats;
+}
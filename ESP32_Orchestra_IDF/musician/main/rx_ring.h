@@ -0,0 +1,39 @@
+#ifndef RX_RING_H
+#define RX_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_now.h"
+
+#define RX_RING_SIZE       16                    // Slots (power of two)
+#define RX_RING_FRAME_MAX  ESP_NOW_MAX_DATA_LEN  // Largest ESP-NOW payload
+
+// One received frame, stamped in the receive callback
+typedef struct {
+    int64_t rx_time_us;
+    uint8_t src_addr[ESP_NOW_ETH_ALEN];
+    uint8_t len;
+    uint8_t data[RX_RING_FRAME_MAX];
+} rx_frame_t;
+
+// Receive Ring Statistics
+typedef struct {
+    uint32_t pushed;
+    uint32_t overflows;         // Frames dropped because the ring was full
+    uint32_t rejected;          // Frames that failed validation in the callback
+    uint8_t high_water;         // Deepest the ring has been
+} rx_ring_stats_t;
+
+// Producer side (Wi-Fi task only)
+bool rx_ring_push(const uint8_t* src_addr, const uint8_t* data, int len, int64_t rx_time_us);
+void rx_ring_count_rejected(void);
+
+// Consumer side (dispatch task only) - front() returns NULL when empty
+const rx_frame_t* rx_ring_front(void);
+void rx_ring_release(void);
+
+// Statistics
+uint8_t rx_ring_depth(void);
+const rx_ring_stats_t* rx_ring_get_stats(void);
+
+#endif // RX_RING_H
@@ -0,0 +1,241 @@
+/*
+ * Score Player Implementation for ESP-IDF
+ * เก็บโน๊ตทั้ง part ที่ Conductor preload มาไว้ใน RAM แล้วเล่นเองตามนาฬิกาที่ซิงค์แล้ว
+ * ระหว่างเพลงไม่ต้องรอโน๊ตทางวิทยุ - packet หายก็ไม่ทำให้โน๊ตหาย
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "score_player.h"
+#include "note_scheduler.h"
+#include "clock_sync.h"
+#include "score_codec.h"
+
+static const char *TAG = "SCORE";
+
+// Encoded score being received (one part of one song)
+static uint8_t score_blob[SCORE_MAX_BLOB_LEN];
+static uint8_t score_song_id = 0;
+static uint8_t score_part_id = 0;
+static uint8_t score_chunk_count = 0;
+static uint16_t score_total_len = 0;
+static uint32_t score_chunk_bitmap = 0;   // bit n = chunk n received
+
+// Decoded once every chunk is in
+static score_note_t score_events[SCORE_MAX_EVENTS];
+static uint16_t score_total_events = 0;
+static bool score_decoded = false;
+
+// Playback cursor
+static bool is_playing = false;
+static uint32_t play_start_timestamp = 0; // Conductor time of the first event
+static uint16_t play_position = 0;        // Next event to hand to the scheduler
+static uint32_t play_offset_ms = 0;       // Start of that event relative to play_start_timestamp
+
+static SemaphoreHandle_t score_mutex = NULL;
+static esp_timer_handle_t feed_timer = NULL;
+static score_player_stats_t stats = {0};
+
+static void feed_timer_callback(void *arg);
+
+esp_err_t score_player_init(void) {
+    score_mutex = xSemaphoreCreateMutex();
+    if (score_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = feed_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "score_feed",
+        .skip_unhandled_events = true,
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &feed_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create feed timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    ESP_LOGI(TAG, "📜 Score player initialized (max %d events)", SCORE_MAX_EVENTS);
+    return ESP_OK;
+}
+
+static bool score_complete(void) {
+    return score_chunk_count > 0 &&
+           score_chunk_bitmap == (score_chunk_count >= 32 ? UINT32_MAX : (1UL << score_chunk_count) - 1);
+}
+
+// Every chunk is in - unpack the blob into score_events. Must be called with score_mutex held.
+static void decode_score(void) {
+    score_info_t info;
+    int count = -1;
+    if (score_parse(score_blob, score_total_len, &info) && info.part_count == 1) {
+        count = score_decode_part(&info, 0, score_events, SCORE_MAX_EVENTS);
+    }
+
+    if (count < 0) {
+        score_decoded = false;
+        ESP_LOGE(TAG, "❌ Score for song %d part %d could not be decoded", score_song_id, score_part_id);
+        return;
+    }
+    score_total_events = (uint16_t)count;
+    score_decoded = true;
+    ESP_LOGI(TAG, "📜 Score for song %d part %d complete (%d events from %d bytes)",
+             score_song_id, score_part_id, score_total_events, score_total_len);
+}
+
+bool score_player_store_chunk(const orchestra_score_chunk_t* chunk) {
+    uint32_t first = (uint32_t)chunk->chunk_index * SCORE_CHUNK_MAX_BYTES;
+
+    if (chunk->chunk_count == 0 || chunk->chunk_count > SCORE_MAX_CHUNKS ||
+        chunk->chunk_index >= chunk->chunk_count || chunk->total_len > SCORE_MAX_BLOB_LEN ||
+        first + chunk->data_len > chunk->total_len) {
+        stats.chunks_rejected++;
+        ESP_LOGW(TAG, "⚠️ Invalid score chunk %d/%d", chunk->chunk_index, chunk->chunk_count);
+        return false;
+    }
+
+    xSemaphoreTake(score_mutex, portMAX_DELAY);
+
+    // A chunk of another song (or another upload) replaces the stored score
+    if (chunk->song_id != score_song_id || chunk->part_id != score_part_id ||
+        chunk->chunk_count != score_chunk_count || chunk->total_len != score_total_len) {
+        is_playing = false;
+        esp_timer_stop(feed_timer);
+        score_song_id = chunk->song_id;
+        score_part_id = chunk->part_id;
+        score_chunk_count = chunk->chunk_count;
+        score_total_len = chunk->total_len;
+        score_chunk_bitmap = 0;
+        score_decoded = false;
+    }
+
+    // Retransmissions are acknowledged again - our ACK may be what got lost
+    if (score_chunk_bitmap & (1UL << chunk->chunk_index)) {
+        stats.chunks_duplicate++;
+    } else {
+        memcpy(&score_blob[first], chunk->data, chunk->data_len);
+        score_chunk_bitmap |= 1UL << chunk->chunk_index;
+        stats.chunks_received++;
+        if (score_complete()) {
+            decode_score();
+        }
+    }
+
+    xSemaphoreGive(score_mutex);
+    return true;
+}
+
+bool score_player_is_ready(uint8_t song_id, uint8_t part_id) {
+    return score_song_id == song_id && score_part_id == part_id && score_decoded;
+}
+
+// Hand every event starting within SCORE_FEED_AHEAD_MS to the note scheduler,
+// then sleep until the next one comes into range. Must be called with score_mutex held.
+static void feed_scheduler(void) {
+    uint32_t horizon = clock_sync_now_ms() + SCORE_FEED_AHEAD_MS;
+    bool queue_full = false;
+
+    while (play_position < score_total_events) {
+        const score_note_t* event = &score_events[play_position];
+        uint32_t start_timestamp = play_start_timestamp + play_offset_ms;
+
+        if ((int32_t)(start_timestamp - horizon) > 0) {
+            break;
+        }
+        if (event->note != NOTE_REST && event->duration_ms > 0) {
+            if (note_scheduler_pending() >= NOTE_QUEUE_SIZE) {
+                queue_full = true;
+                break;
+            }
+            if (note_scheduler_enqueue(conductor_ms_to_local_us(start_timestamp), event->note,
+                                       100, event->duration_ms) == ESP_OK) { // Default velocity
+                stats.notes_fed++;
+            }
+        }
+        play_offset_ms += event->duration_ms + event->delay_ms;
+        play_position++;
+    }
+
+    if (play_position >= score_total_events) {
+        is_playing = false;
+        ESP_LOGI(TAG, "📜 All %d score events scheduled", score_total_events);
+        return;
+    }
+
+    int64_t delay_us = (int64_t)SCORE_FEED_RETRY_MS * 1000;
+    if (!queue_full) {
+        uint32_t feed_timestamp = play_start_timestamp + play_offset_ms - SCORE_FEED_AHEAD_MS;
+        delay_us = conductor_ms_to_local_us(feed_timestamp) - esp_timer_get_time();
+    }
+    esp_timer_start_once(feed_timer, delay_us > 0 ? (uint64_t)delay_us : 0);
+}
+
+esp_err_t score_player_start(uint32_t start_timestamp) {
+    if (feed_timer == NULL || !score_decoded) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(score_mutex, portMAX_DELAY);
+    esp_timer_stop(feed_timer);
+    is_playing = true;
+    play_start_timestamp = start_timestamp;
+    play_position = 0;
+    play_offset_ms = 0;
+    feed_scheduler();
+    xSemaphoreGive(score_mutex);
+
+    ESP_LOGI(TAG, "▶️ Playing preloaded score: song %d part %d at %lu",
+             score_song_id, score_part_id, start_timestamp);
+    return ESP_OK;
+}
+
+void score_player_stop(void) {
+    if (score_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(score_mutex, portMAX_DELAY);
+    is_playing = false;
+    esp_timer_stop(feed_timer);
+    xSemaphoreGive(score_mutex);
+}
+
+// Forget the stored score - the next song may give us another part
+void score_player_clear(void) {
+    if (score_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(score_mutex, portMAX_DELAY);
+    is_playing = false;
+    esp_timer_stop(feed_timer);
+    score_song_id = 0;
+    score_part_id = 0;
+    score_chunk_count = 0;
+    score_total_len = 0;
+    score_chunk_bitmap = 0;
+    score_decoded = false;
+    xSemaphoreGive(score_mutex);
+}
+
+bool score_player_is_playing(void) {
+    return is_playing;
+}
+
+const score_player_stats_t* score_player_get_stats(void) {
+    return &stats;
+}
+
+static void feed_timer_callback(void *arg) {
+    xSemaphoreTake(score_mutex, portMAX_DELAY);
+    if (is_playing) {
+        feed_scheduler();
+    }
+    xSemaphoreGive(score_mutex);
+}
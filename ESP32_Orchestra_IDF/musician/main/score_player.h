@@ -0,0 +1,28 @@
+#ifndef SCORE_PLAYER_H
+#define SCORE_PLAYER_H
+
+#include "esp_err.h"
+#include "orchestra_common.h"
+
+#define SCORE_FEED_AHEAD_MS   NOTE_LOOKAHEAD_MS  // ป้อนโน๊ตเข้า note_scheduler ล่วงหน้ากี่ ms
+#define SCORE_FEED_RETRY_MS   20                 // ลองใหม่เมื่อคิวของ scheduler เต็ม
+
+// Score Player Statistics
+typedef struct {
+    uint32_t chunks_received;
+    uint32_t chunks_duplicate;
+    uint32_t chunks_rejected;
+    uint32_t notes_fed;
+} score_player_stats_t;
+
+// Score Player Functions
+esp_err_t score_player_init(void);
+bool score_player_store_chunk(const orchestra_score_chunk_t* chunk);
+bool score_player_is_ready(uint8_t song_id, uint8_t part_id);
+esp_err_t score_player_start(uint32_t start_timestamp);
+void score_player_stop(void);
+void score_player_clear(void);
+bool score_player_is_playing(void);
+const score_player_stats_t* score_player_get_stats(void);
+
+#endif // SCORE_PLAYER_H
@@ -1,58 +1,63 @@
 /*
  * Sound Player Implementation for ESP-IDF
- * ระบบการเล่นเสียงด้วย LEDC (PWM) สำหรับ Buzzer/Speaker
+ * ระบบการเล่นเสียงด้วย LEDC (PWM) สำหรับ Buzzer/Speaker - หลาย voice ผ่าน ledc_voices
+ * หรือส่งต่อให้ synth_output (หลายเสียงพร้อมกัน) เมื่อ SOUND_ENGINE == SOUND_ENGINE_SYNTH
  */
 
 #include <string.h>
-#include "driver/ledc.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "sound_player.h"
+#include "clock_sync.h"
+#include "note_table.h"
+#include "trace_ring.h"
+#include "hot_log.h"
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+#include "synth_output.h"
+#else
+#include "ledc_voices.h"
+#endif
 
 static const char *TAG = "SOUND";
 
 // Global sound player state
 static sound_player_t sound_player = {0};
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+static hot_log_limit_t queue_full_limit;
+#endif
 
 esp_err_t sound_player_init(void) {
-    // Configure LEDC timer
-    ledc_timer_config_t ledc_timer = {
-        .duty_resolution = LEDC_TIMER_8_BIT, // 8-bit resolution
-        .freq_hz = 1000,                     // Default frequency 1 kHz
-        .speed_mode = LEDC_LOW_SPEED_MODE,   // Low speed mode
-        .timer_num = LEDC_TIMER_0,           // Timer 0
-        .clk_cfg = LEDC_AUTO_CLK,            // Auto select the source clock
-    };
-    esp_err_t ret = ledc_timer_config(&ledc_timer);
+    // Frequencies and LEDC dividers of all 128 notes, once - no powf at note onset
+    note_table_init(MIN_FREQUENCY, MAX_FREQUENCY);
+
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    esp_err_t ret = synth_output_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LEDC timer: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to initialize synth: %s", esp_err_to_name(ret));
         return ret;
     }
-
-    // Configure LEDC channel
-    ledc_channel_config_t ledc_channel = {
-        .channel    = LEDC_CHANNEL_0,        // Channel 0
-        .duty       = 0,                     // Start with 0% duty cycle (no sound)
-        .gpio_num   = BUZZER_PIN,            // GPIO pin for buzzer
-        .speed_mode = LEDC_LOW_SPEED_MODE,   // Low speed mode
-        .hpoint     = 0,                     // Set high point to 0
-        .timer_sel  = LEDC_TIMER_0,          // Timer 0
-    };
-    ret = ledc_channel_config(&ledc_channel);
+    sound_player.is_initialized = true;
+    sound_player.is_playing = false;
+    ESP_LOGI(TAG, "🔊 Sound player initialized (synth, %d voices)", SYNTH_MAX_VOICES);
+    return ESP_OK;
+#else
+    // One LEDC timer + channel + GPIO per voice, each with its own note-off timer
+    esp_err_t ret = ledc_voices_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LEDC channel: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to initialize LEDC voices: %s", esp_err_to_name(ret));
         return ret;
     }
 
     // Initialize sound player state
     sound_player.is_initialized = true;
     sound_player.is_playing = false;
-    sound_player.ledc_channel = LEDC_CHANNEL_0;
     
-    ESP_LOGI(TAG, "🔊 Sound player initialized (Buzzer: GPIO %d)", BUZZER_PIN);
+    ESP_LOGI(TAG, "🔊 Sound player initialized (LEDC, %d voices, Buzzer: GPIO %d)", LEDC_VOICE_COUNT, BUZZER_PIN);
     return ESP_OK;
+#endif
 }
 
-esp_err_t sound_play_note(uint8_t note, uint16_t duration_ms) {
+static esp_err_t play_note(uint8_t note, uint8_t velocity, uint16_t duration_ms) {
     if (!sound_player.is_initialized) {
         return ESP_ERR_INVALID_STATE;
     }
@@ -62,46 +67,61 @@ esp_err_t sound_play_note(uint8_t note, uint16_t duration_ms) {
         return sound_stop_note();
     }
     
-    float frequency = midi_note_to_frequency(note);
-    if (frequency <= 0) {
+    const note_table_entry_t* entry = note_table_get(note);
+    if (entry == NULL || entry->frequency <= 0) {
         return ESP_ERR_INVALID_ARG;
     }
+    float frequency = entry->frequency;
     
-    // Clamp frequency to reasonable range
-    if (frequency < MIN_FREQUENCY) frequency = MIN_FREQUENCY;
-    if (frequency > MAX_FREQUENCY) frequency = MAX_FREQUENCY;
-    
-    // Update timer frequency
-    esp_err_t ret = ledc_set_freq(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, (uint32_t)frequency);
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    // The synth ends every voice itself, counted in samples - no note-off timer
+    int64_t start_us = esp_timer_get_time();
+    int64_t stop_us = conductor_time_to_local_us(local_time_to_conductor_us(start_us) + (int64_t)duration_ms * 1000);
+    esp_err_t ret = synth_output_note_on(note, velocity, stop_us > start_us ? (uint32_t)(stop_us - start_us) : 0);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set LEDC frequency: %s", esp_err_to_name(ret));
+        HOT_LOGW_LIMITED(&queue_full_limit, TAG, "Synth command queue full, note %d dropped", note);
         return ret;
     }
     
-    // Set 50% duty cycle for square wave
-    uint32_t duty = (1 << LEDC_TIMER_8_BIT) / 2; // 50% of 2^8 = 128
-    ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, sound_player.ledc_channel, duty);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set LEDC duty: %s", esp_err_to_name(ret));
-        return ret;
+    sound_player.is_playing = true;
+    sound_player.current_note = note;
+    sound_player.current_frequency = frequency;
+    sound_player.note_start_time = clock_sync_now_ms();
+    sound_player.note_duration_ms = duration_ms;
+    if (stop_us > sound_player.note_end_us) {
+        sound_player.note_end_us = stop_us; // Last voice to finish
     }
     
-    // Update duty to start the PWM
-    ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, sound_player.ledc_channel);
+    HOT_LOGI(TAG, "🎵 Playing note %d (%.1f Hz, velocity %d) for %d ms", note, frequency, velocity, duration_ms);
+    return ESP_OK;
+#else
+    // The duration is in conductor time, so map the end onto our clock
+    int64_t now_us = esp_timer_get_time();
+    int64_t end_us = conductor_time_to_local_us(local_time_to_conductor_us(now_us) + (int64_t)duration_ms * 1000);
+    esp_err_t ret = ledc_voices_note_on(note, velocity, end_us);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update LEDC duty: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // Update player state
     sound_player.is_playing = true;
     sound_player.current_note = note;
-    sound_player.current_frequency = frequency;
-    sound_player.note_start_time = get_time_ms();
+    sound_player.current_frequency = entry->ledc_frequency; // What the timer really plays
+    sound_player.note_start_time = clock_sync_now_ms(); // Drift-corrected, runs at conductor rate
     sound_player.note_duration_ms = duration_ms;
+    sound_player.note_end_us = end_us;
     
-    ESP_LOGI(TAG, "🎵 Playing note %d (%.1f Hz) for %d ms", note, frequency, duration_ms);
+    HOT_LOGI(TAG, "🎵 Playing note %d (%.1f Hz, velocity %d) for %d ms, %d voices busy",
+             note, frequency, velocity, duration_ms, ledc_voices_active());
     return ESP_OK;
+#endif
+}
+
+esp_err_t sound_play_note(uint8_t note, uint8_t velocity, uint16_t duration_ms) {
+    trace_begin(TRACE_EV_PLAY_NOTE, note, duration_ms);
+    esp_err_t ret = play_note(note, velocity, duration_ms);
+    trace_end(TRACE_EV_PLAY_NOTE, 0, (uint32_t)ret);
+    return ret;
 }
 
 esp_err_t sound_stop_note(void) {
@@ -113,41 +133,47 @@ esp_err_t sound_stop_note(void) {
         return ESP_OK; // Already stopped
     }
     
-    // Set duty cycle to 0 to stop sound
-    esp_err_t ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, sound_player.ledc_channel, 0);
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    // Every voice goes into its release stage
+    esp_err_t ret = synth_output_all_off();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to stop LEDC: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    // Update duty
-    ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, sound_player.ledc_channel);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update LEDC duty (stop): %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to stop synth voices: %s", esp_err_to_name(ret));
         return ret;
     }
+    sound_player.note_end_us = 0;
+#else
+    ledc_voices_all_off();
+#endif
     
     // Update player state
     sound_player.is_playing = false;
     sound_player.current_note = 0;
     sound_player.current_frequency = 0;
     
-    ESP_LOGI(TAG, "🔇 Note stopped");
+    HOT_LOGI(TAG, "🔇 Note stopped");
     return ESP_OK;
 }
 
-void sound_update(void) {
-    if (!sound_player.is_playing) {
-        return;
+// Stop one note only - other voices keep playing
+esp_err_t sound_release_note(uint8_t note) {
+    if (!sound_player.is_initialized) {
+        return ESP_ERR_INVALID_STATE;
     }
     
-    uint32_t current_time = get_time_ms();
-    uint32_t elapsed_time = current_time - sound_player.note_start_time;
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    esp_err_t ret = synth_output_note_off(note);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+#else
+    ledc_voices_note_off(note);
+#endif
     
-    // Check if note duration has expired
-    if (elapsed_time >= sound_player.note_duration_ms) {
-        sound_stop_note();
+    if (sound_player.current_note == note) {
+        sound_player.current_note = 0;
+        sound_player.current_frequency = 0;
     }
+    return ESP_OK;
 }
 
 void sound_cleanup(void) {
@@ -155,20 +181,42 @@ void sound_cleanup(void) {
         sound_stop_note();
     }
     
+#if SOUND_ENGINE == SOUND_ENGINE_LEDC
     if (sound_player.is_initialized) {
-        // Stop LEDC channel
-        ledc_stop(LEDC_LOW_SPEED_MODE, sound_player.ledc_channel, 0);
+        ledc_voices_deinit();
         sound_player.is_initialized = false;
     }
+#endif
+}
+
+int64_t sound_output_latency_us(void) {
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    return synth_output_latency_us();
+#else
+    return 0; // LEDC changes the tone immediately
+#endif
+}
+
+uint8_t sound_player_voice_count(void) {
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    return SYNTH_MAX_VOICES;
+#else
+    return LEDC_VOICE_COUNT;
+#endif
 }
 
 float note_to_frequency(uint8_t note) {
-    return midi_note_to_frequency(note);
+    const note_table_entry_t* entry = note_table_get(note);
+    return entry != NULL ? entry->frequency : 0.0f;
 }
 
 // Getter functions for external access
 bool sound_player_is_playing(void) {
-    return sound_player.is_playing;
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+    return sound_player.is_playing && esp_timer_get_time() < sound_player.note_end_us;
+#else
+    return sound_player.is_playing && ledc_voices_active() > 0;
+#endif
 }
 
 uint8_t sound_player_current_note(void) {
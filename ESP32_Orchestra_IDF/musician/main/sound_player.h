@@ -4,6 +4,13 @@
 #include "esp_err.h"
 #include "orchestra_common.h"
 
+// Audio engine: square wave on the buzzer (LEDC) or the polyphonic synth (synth_output, I2S/DAC)
+#define SOUND_ENGINE_LEDC   0
+#define SOUND_ENGINE_SYNTH  1
+#ifndef SOUND_ENGINE
+#define SOUND_ENGINE        SOUND_ENGINE_LEDC
+#endif
+
 // Sound Player State
 typedef struct {
     bool is_initialized;
@@ -12,15 +19,17 @@ typedef struct {
     float current_frequency;
     uint32_t note_start_time;
     uint32_t note_duration_ms;
-    int ledc_channel;
+    int64_t note_end_us;        // Local esp_timer time at which the latest note ends
 } sound_player_t;
 
 // Sound Functions
 esp_err_t sound_player_init(void);
-esp_err_t sound_play_note(uint8_t note, uint16_t duration_ms);
-esp_err_t sound_stop_note(void);
-void sound_update(void);
+esp_err_t sound_play_note(uint8_t note, uint8_t velocity, uint16_t duration_ms);
+esp_err_t sound_stop_note(void);           // Every voice
+esp_err_t sound_release_note(uint8_t note); // Only voices playing this note
 void sound_cleanup(void);
+int64_t sound_output_latency_us(void);  // Schedulers start notes this much early
+uint8_t sound_player_voice_count(void); // Notes at once, announced in MSG_JOIN
 
 // Utility Functions
 float note_to_frequency(uint8_t note);
@@ -0,0 +1,93 @@
+/*
+ * Stress Stats Implementation
+ * Histogram ต่อเพลง: callback อยู่ใน Wi-Fi task ส่วนที่เหลืออยู่ใน dispatch task จึงล็อกด้วย portMUX
+ */
+
+#include "stress_stats.h"
+
+#if STRESS_STATS
+
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "latency_hist.h"
+#include "clock_sync.h"
+#include "note_scheduler.h"
+#include "rx_ring.h"
+#include "orchestra_common.h"
+
+static const char *TAG = "STRESS";
+
+typedef struct {
+    latency_hist_t callback_us;
+    latency_hist_t lead_us;
+    latency_hist_t batch_latency_us;
+    uint32_t notes_late;
+    uint32_t rx_overflows;      // At song start, the difference is printed
+    uint32_t queue_overflows;
+} stress_stats_t;
+
+static stress_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void stress_stats_song_start(void) {
+    portENTER_CRITICAL(&stats_lock);
+    latency_hist_reset(&stats.callback_us);
+    latency_hist_reset(&stats.lead_us);
+    latency_hist_reset(&stats.batch_latency_us);
+    stats.notes_late = 0;
+    stats.rx_overflows = rx_ring_get_stats()->overflows;
+    stats.queue_overflows = note_scheduler_get_stats()->queue_overflows;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void stress_stats_rx_callback(int64_t elapsed_us) {
+    portENTER_CRITICAL(&stats_lock);
+    latency_hist_add(&stats.callback_us, (uint32_t)elapsed_us);
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void stress_stats_note(int64_t lead_us) {
+    portENTER_CRITICAL(&stats_lock);
+    if (lead_us < 0) {
+        stats.notes_late++;
+    }
+    latency_hist_add(&stats.lead_us, lead_us > 0 ? (uint32_t)lead_us : 0);
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void stress_stats_batch(uint32_t base_timestamp, int64_t rx_time_us) {
+    if (!clock_sync_get_state()->has_reference) {
+        return;
+    }
+    int64_t due_us = ((int64_t)base_timestamp - NOTE_LOOKAHEAD_MS) * 1000;
+    int64_t latency_us = local_time_to_conductor_us(rx_time_us) - due_us;
+    portENTER_CRITICAL(&stats_lock);
+    latency_hist_add(&stats.batch_latency_us, latency_us > 0 ? (uint32_t)latency_us : 0);
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void stress_stats_print(void) {
+    static stress_stats_t copy;
+    portENTER_CRITICAL(&stats_lock);
+    copy = stats;
+    portEXIT_CRITICAL(&stats_lock);
+    if (copy.callback_us.count == 0) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "📈 RX callback: %lu frames, p50 %lu p99 %lu max %lu us", copy.callback_us.count,
+             latency_hist_percentile(&copy.callback_us, 500), latency_hist_percentile(&copy.callback_us, 990),
+             copy.callback_us.max);
+    ESP_LOGI(TAG, "📈 Batch latency: p50 %lu p99 %lu max %lu us (%lu batches)",
+             latency_hist_percentile(&copy.batch_latency_us, 500),
+             latency_hist_percentile(&copy.batch_latency_us, 990), copy.batch_latency_us.max,
+             copy.batch_latency_us.count);
+    ESP_LOGI(TAG, "📈 Note lead: %lu notes, p1 %lu p50 %lu us, %lu late", copy.lead_us.count,
+             latency_hist_percentile(&copy.lead_us, 10), latency_hist_percentile(&copy.lead_us, 500),
+             copy.notes_late);
+    ESP_LOGI(TAG, "📈 Overflows: rx ring %lu, note queue %lu",
+             rx_ring_get_stats()->overflows - copy.rx_overflows,
+             note_scheduler_get_stats()->queue_overflows - copy.queue_overflows);
+}
+
+#endif // STRESS_STATS
@@ -0,0 +1,30 @@
+#ifndef STRESS_STATS_H
+#define STRESS_STATS_H
+
+#include <stdint.h>
+
+// 1 = receive side of the conductor's STRESS_TEST, per song and printed when it ends:
+//   - time spent in the ESP-NOW receive callback (Wi-Fi task)
+//   - lead: note start minus the moment it reached the scheduler, < 0 = arrived too late
+//   - batch latency: arrival (conductor clock) minus when the conductor was due to send the batch
+//     (first note - NOTE_LOOKAHEAD_MS), so a late scheduler counts too. Songs without note FEC only.
+//   - rx ring / note queue overflows during the song
+#ifndef STRESS_STATS
+#define STRESS_STATS            0
+#endif
+
+#if STRESS_STATS
+void stress_stats_song_start(void);
+void stress_stats_rx_callback(int64_t elapsed_us);
+void stress_stats_note(int64_t lead_us);
+void stress_stats_batch(uint32_t base_timestamp, int64_t rx_time_us);
+void stress_stats_print(void);
+#else
+static inline void stress_stats_song_start(void) {}
+static inline void stress_stats_rx_callback(int64_t elapsed_us) {}
+static inline void stress_stats_note(int64_t lead_us) {}
+static inline void stress_stats_batch(uint32_t base_timestamp, int64_t rx_time_us) {}
+static inline void stress_stats_print(void) {}
+#endif
+
+#endif // STRESS_STATS_H
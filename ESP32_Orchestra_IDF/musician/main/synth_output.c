@@ -0,0 +1,227 @@
+/*
+ * Synth Output Implementation for ESP-IDF
+ * Task เดียวเป็นเจ้าของ synth_t: รับคำสั่ง note on/off จากคิว, render ทีละ block
+ * แล้วเขียนลง DMA (I2S หรือ DAC ภายใน) - write จะ block จนมี buffer ว่าง จึงได้ double buffer เอง
+ */
+
+#include "sound_player.h"
+
+// Only with SOUND_ENGINE_SYNTH - the default LEDC build has no I2S channel or synth buffers
+#if SOUND_ENGINE == SOUND_ENGINE_SYNTH
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "synth_output.h"
+#if SYNTH_OUTPUT == SYNTH_OUTPUT_DAC
+#include "driver/dac_continuous.h"
+#else
+#include "driver/i2s_std.h"
+#endif
+
+static const char *TAG = "SYNTH";
+
+typedef enum {
+    SYNTH_CMD_NOTE_ON,
+    SYNTH_CMD_NOTE_OFF,
+    SYNTH_CMD_ALL_OFF,
+} synth_cmd_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t note;
+    uint8_t velocity;
+    uint32_t duration_frames;
+} synth_cmd_t;
+
+static synth_t synth;
+static QueueHandle_t cmd_queue = NULL;
+static TaskHandle_t synth_task_handle = NULL;
+static synth_output_stats_t stats = {0};
+static int16_t render_buf[SYNTH_BLOCK_FRAMES];
+
+#if SYNTH_OUTPUT == SYNTH_OUTPUT_DAC
+static dac_continuous_handle_t dac_handle = NULL;
+static uint8_t dac_buf[SYNTH_BLOCK_FRAMES];
+#else
+static i2s_chan_handle_t tx_chan = NULL;
+#endif
+
+static const synth_adsr_t synth_adsr = {
+    .attack_ms = 5,
+    .decay_ms = 80,
+    .sustain_level = 180,
+    .release_ms = 60,
+};
+
+static void synth_task(void *pvParameters);
+
+static esp_err_t output_init(void) {
+#if SYNTH_OUTPUT == SYNTH_OUTPUT_DAC
+    dac_continuous_config_t dac_cfg = {
+        .chan_mask = DAC_CHANNEL_MASK_CH0,      // GPIO 25
+        .desc_num = SYNTH_DMA_BUFFERS,
+        .buf_size = SYNTH_BLOCK_FRAMES,
+        .freq_hz = SYNTH_SAMPLE_RATE,
+        .offset = 0,
+        .clk_src = DAC_DIGI_CLK_SRC_DEFAULT,
+        .chan_mode = DAC_CHANNEL_MODE_SIMUL,
+    };
+    esp_err_t ret = dac_continuous_new_channels(&dac_cfg, &dac_handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return dac_continuous_enable(dac_handle);
+#else
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = SYNTH_DMA_BUFFERS;
+    chan_cfg.dma_frame_num = SYNTH_BLOCK_FRAMES;
+    chan_cfg.auto_clear = true;             // Underrun plays silence, not the old buffer
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &tx_chan, NULL);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    i2s_std_config_t std_cfg = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(SYNTH_SAMPLE_RATE),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = SYNTH_I2S_BCLK_PIN,
+            .ws = SYNTH_I2S_WS_PIN,
+            .dout = SYNTH_I2S_DOUT_PIN,
+            .din = I2S_GPIO_UNUSED,
+            .invert_flags = {
+                .mclk_inv = false,
+                .bclk_inv = false,
+                .ws_inv = false,
+            },
+        },
+    };
+    ret = i2s_channel_init_std_mode(tx_chan, &std_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return i2s_channel_enable(tx_chan);
+#endif
+}
+
+// Blocks until a DMA buffer is free
+static void output_write(const int16_t* samples, size_t frames) {
+#if SYNTH_OUTPUT == SYNTH_OUTPUT_DAC
+    for (size_t i = 0; i < frames; i++) {
+        dac_buf[i] = (uint8_t)((samples[i] >> 8) + 128);   // 8-bit unsigned
+    }
+    dac_continuous_write(dac_handle, dac_buf, frames, NULL, -1);
+#else
+    size_t written = 0;
+    i2s_channel_write(tx_chan, samples, frames * sizeof(int16_t), &written, portMAX_DELAY);
+#endif
+}
+
+esp_err_t synth_output_init(void) {
+    synth_init(&synth, SYNTH_SAMPLE_RATE, SYNTH_WAVE, &synth_adsr);
+
+    cmd_queue = xQueueCreate(SYNTH_CMD_QUEUE_SIZE, sizeof(synth_cmd_t));
+    if (cmd_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = output_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize audio output: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (xTaskCreatePinnedToCore(synth_task, "synth_task", 3072, NULL, SYNTH_TASK_PRIORITY,
+                                &synth_task_handle, SYNTH_TASK_CORE) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "🎹 Synth ready: %s, %d Hz, %d voices, %d x %d frame DMA buffers (latency %lld us)",
+             SYNTH_OUTPUT == SYNTH_OUTPUT_DAC ? "internal DAC" : "I2S", SYNTH_SAMPLE_RATE,
+             SYNTH_MAX_VOICES, SYNTH_DMA_BUFFERS, SYNTH_BLOCK_FRAMES, synth_output_latency_us());
+    return ESP_OK;
+}
+
+static esp_err_t send_cmd(const synth_cmd_t* cmd) {
+    if (cmd_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xQueueSend(cmd_queue, cmd, 0) != pdTRUE) {
+        stats.cmd_overflows++;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t synth_output_note_on(uint8_t note, uint8_t velocity, uint32_t duration_us) {
+    synth_cmd_t cmd = {
+        .type = SYNTH_CMD_NOTE_ON,
+        .note = note,
+        .velocity = velocity,
+        .duration_frames = (uint32_t)(((uint64_t)duration_us * SYNTH_SAMPLE_RATE) / 1000000),
+    };
+    return send_cmd(&cmd);
+}
+
+esp_err_t synth_output_note_off(uint8_t note) {
+    synth_cmd_t cmd = {.type = SYNTH_CMD_NOTE_OFF, .note = note};
+    return send_cmd(&cmd);
+}
+
+esp_err_t synth_output_all_off(void) {
+    synth_cmd_t cmd = {.type = SYNTH_CMD_ALL_OFF};
+    return send_cmd(&cmd);
+}
+
+// A command waits for the next block (<= 1 block), then the DMA buffers ahead of it play out
+int64_t synth_output_latency_us(void) {
+    return ((int64_t)(SYNTH_DMA_BUFFERS + 1) * SYNTH_BLOCK_FRAMES * 1000000) / SYNTH_SAMPLE_RATE;
+}
+
+const synth_output_stats_t* synth_output_get_stats(void) {
+    stats.voices_active = synth_active_voices(&synth);
+    stats.voices_stolen = synth.voices_stolen;
+    return &stats;
+}
+
+static void synth_task(void *pvParameters) {
+    const uint32_t block_us = (uint32_t)(((uint64_t)SYNTH_BLOCK_FRAMES * 1000000) / SYNTH_SAMPLE_RATE);
+    synth_cmd_t cmd;
+
+    while (1) {
+        // Commands are applied at block boundaries - the synth is only touched by this task
+        while (xQueueReceive(cmd_queue, &cmd, 0) == pdTRUE) {
+            switch (cmd.type) {
+                case SYNTH_CMD_NOTE_ON:
+                    synth_note_on(&synth, cmd.note, cmd.velocity, cmd.duration_frames);
+                    break;
+                case SYNTH_CMD_NOTE_OFF:
+                    synth_note_off(&synth, cmd.note);
+                    break;
+                case SYNTH_CMD_ALL_OFF:
+                    synth_all_off(&synth);
+                    break;
+            }
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        synth_render(&synth, render_buf, SYNTH_BLOCK_FRAMES);
+        uint32_t render_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        stats.blocks_rendered++;
+        stats.render_us_last = render_us;
+        if (render_us > stats.render_us_max) {
+            stats.render_us_max = render_us;
+        }
+        stats.load_percent = (uint8_t)((render_us * 100) / block_us);
+
+        output_write(render_buf, SYNTH_BLOCK_FRAMES);
+    }
+}
+
+#endif // SOUND_ENGINE == SOUND_ENGINE_SYNTH
@@ -0,0 +1,48 @@
+#ifndef SYNTH_OUTPUT_H
+#define SYNTH_OUTPUT_H
+
+#include "esp_err.h"
+#include "orchestra_common.h"
+#include "synth_core.h"
+
+// Output device: external I2S DAC (MAX98357A, PCM5102...) or the ESP32 internal 8-bit DAC
+#define SYNTH_OUTPUT_I2S        0
+#define SYNTH_OUTPUT_DAC        1
+#ifndef SYNTH_OUTPUT
+#define SYNTH_OUTPUT            SYNTH_OUTPUT_I2S
+#endif
+
+// Audio Configuration
+#define SYNTH_SAMPLE_RATE       32000   // 22050-44100 Hz
+#define SYNTH_BLOCK_FRAMES      128     // One DMA buffer (4 ms at 32 kHz)
+#define SYNTH_DMA_BUFFERS       2       // Double buffer: render one while the other plays
+#define SYNTH_WAVE              SYNTH_WAVE_TRIANGLE
+#define SYNTH_CMD_QUEUE_SIZE    32
+#define SYNTH_TASK_PRIORITY     10      // Above the radio-side tasks, audio must never starve
+#define SYNTH_TASK_CORE         1       // Wi-Fi runs on core 0
+
+// I2S pins (SYNTH_OUTPUT_I2S) - the internal DAC always uses GPIO 25
+#define SYNTH_I2S_BCLK_PIN      26
+#define SYNTH_I2S_WS_PIN        25
+#define SYNTH_I2S_DOUT_PIN      22
+
+// Synth Output Statistics
+typedef struct {
+    uint32_t blocks_rendered;
+    uint32_t render_us_last;
+    uint32_t render_us_max;
+    uint8_t load_percent;       // Render time / block time of the last block (one core)
+    uint8_t voices_active;
+    uint32_t voices_stolen;
+    uint32_t cmd_overflows;     // Note commands dropped because the queue was full
+} synth_output_stats_t;
+
+// Synth Output Functions
+esp_err_t synth_output_init(void);
+esp_err_t synth_output_note_on(uint8_t note, uint8_t velocity, uint32_t duration_us);
+esp_err_t synth_output_note_off(uint8_t note);
+esp_err_t synth_output_all_off(void);
+int64_t synth_output_latency_us(void);      // Note command -> sound at the output pin
+const synth_output_stats_t* synth_output_get_stats(void);
+
+#endif // SYNTH_OUTPUT_H
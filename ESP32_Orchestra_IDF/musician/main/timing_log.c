@@ -0,0 +1,86 @@
+/*
+ * Timing Log Implementation
+ * เก็บเวลาที่ LEDC เริ่ม/หยุดโน๊ตจริง (เวลา conductor) ลง ring แล้วพิมพ์ทีหลัง
+ * จึงไม่มี UART อยู่ใน onset/note-off timer callback
+ */
+
+#include "timing_log.h"
+
+#if TIMING_LOG
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "clock_sync.h"
+#include "espnow_musician.h"
+
+typedef enum {
+    TIMING_RECORD_SONG,
+    TIMING_RECORD_ON,
+    TIMING_RECORD_OFF,
+} timing_record_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t a;                  // song ID / voice
+    uint8_t b;                  // part mask / note
+    int64_t time;               // Song start (ms) / conductor time (us)
+} timing_record_t;
+
+static timing_record_t ring[TIMING_LOG_RING_SIZE];
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static uint32_t lost = 0;
+static portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void timing_log_push(uint8_t type, uint8_t a, uint8_t b, int64_t time) {
+    portENTER_CRITICAL(&ring_lock);
+    if (head - tail >= TIMING_LOG_RING_SIZE) {
+        lost++;
+    } else {
+        ring[head % TIMING_LOG_RING_SIZE] = (timing_record_t){type, a, b, time};
+        head++;
+    }
+    portEXIT_CRITICAL(&ring_lock);
+}
+
+void timing_log_song(uint8_t song_id, uint32_t start_ms, uint8_t part_mask) {
+    timing_log_push(TIMING_RECORD_SONG, song_id, part_mask, start_ms);
+}
+
+void timing_log_note(bool on, uint8_t voice, uint8_t note) {
+    timing_log_push(on ? TIMING_RECORD_ON : TIMING_RECORD_OFF, voice, note,
+                    local_time_to_conductor_us(esp_timer_get_time()));
+}
+
+void timing_log_flush(void) {
+    uint8_t id = get_musician_state()->musician_id;
+    while (true) {
+        timing_record_t record;
+        uint32_t dropped;
+        portENTER_CRITICAL(&ring_lock);
+        bool empty = head == tail;
+        if (!empty) {
+            record = ring[tail % TIMING_LOG_RING_SIZE];
+            tail++;
+        }
+        dropped = lost;
+        lost = 0;
+        portEXIT_CRITICAL(&ring_lock);
+
+        if (dropped) {
+            printf("TIMING,%u,lost,%lu\n", id, (unsigned long)dropped);
+        }
+        if (empty) {
+            break;
+        }
+        if (record.type == TIMING_RECORD_SONG) {
+            printf("TIMING,%u,song,%u,%lu,0x%02x\n", id, record.a, (unsigned long)record.time, record.b);
+        } else {
+            printf("TIMING,%u,%s,%u,%u,%lld\n", id, record.type == TIMING_RECORD_ON ? "on" : "off",
+                   record.a, record.b, (long long)record.time);
+        }
+    }
+}
+
+#endif // TIMING_LOG
@@ -0,0 +1,28 @@
+#ifndef TIMING_LOG_H
+#define TIMING_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 1 = print every LEDC note onset/offset on the conductor clock for tools/host/timing_report:
+//   TIMING,<musician id>,song,<song id>,<start ms>,<part mask>
+//   TIMING,<musician id>,on|off,<voice>,<note>,<conductor us>
+//   TIMING,<musician id>,lost,<records dropped because the ring was full>
+// Records are stamped where the duty is written and printed later from status_task
+#ifndef TIMING_LOG
+#define TIMING_LOG              0
+#endif
+
+#define TIMING_LOG_RING_SIZE    128     // Records between two flushes (100 ms)
+
+#if TIMING_LOG
+void timing_log_song(uint8_t song_id, uint32_t start_ms, uint8_t part_mask);
+void timing_log_note(bool on, uint8_t voice, uint8_t note);
+void timing_log_flush(void);
+#else
+static inline void timing_log_song(uint8_t song_id, uint32_t start_ms, uint8_t part_mask) {}
+static inline void timing_log_note(bool on, uint8_t voice, uint8_t note) {}
+static inline void timing_log_flush(void) {}
+#endif
+
+#endif // TIMING_LOG_H
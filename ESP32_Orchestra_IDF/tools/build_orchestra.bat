@@ -48,9 +48,6 @@ call :build_project conductor Conductor
 goto :eof
 
 :build_musician
-if not "%~2"=="" (
-    call :update_musician_id %2
-)
 call :build_project musician Musician
 goto :eof
 
@@ -65,18 +62,13 @@ goto :eof
 
 :flash_musician
 if "%~2"=="" (
-    echo %ERROR% Usage: %~nx0 flash-musician ^<musician_id^> ^<port^>
-    echo Example: %~nx0 flash-musician 0 COM3
-    exit /b 1
-)
-if "%~3"=="" (
-    echo %ERROR% Usage: %~nx0 flash-musician ^<musician_id^> ^<port^>
-    echo Example: %~nx0 flash-musician 0 COM3
+    echo %ERROR% Usage: %~nx0 flash-musician ^<port^>
+    echo Example: %~nx0 flash-musician COM3
     exit /b 1
 )
-call :update_musician_id %2
+REM Same image for every board - the conductor assigns the ID when it joins
 call :build_project musician Musician
-call :flash_project musician Musician %3
+call :flash_project musician Musician %2
 goto :eof
 
 :monitor
@@ -101,37 +93,26 @@ goto :eof
 
 :setup_musicians
 if "%~4"=="" (
-    echo %ERROR% Usage: %~nx0 setup-musicians ^<port1^> ^<port2^> ^<port3^> [port4]
+    echo %ERROR% Usage: %~nx0 setup-musicians ^<port1^> ^<port2^> ^<port3^> [port4 ...]
     echo Example: %~nx0 setup-musicians COM3 COM4 COM5
     exit /b 1
 )
 
 echo %INFO% Setting up multiple musicians...
 
-REM Flash musician 0
-call :update_musician_id 0
-call :build_project musician Musician
-call :flash_project musician Musician %2
-
-REM Flash musician 1
-call :update_musician_id 1
-call :build_project musician Musician
-call :flash_project musician Musician %3
-
-REM Flash musician 2
-call :update_musician_id 2
+REM One build, flashed to every port - IDs come from the conductor on first join
 call :build_project musician Musician
-call :flash_project musician Musician %4
-
-REM Flash musician 3 if port provided
-if not "%~5"=="" (
-    call :update_musician_id 3
-    call :build_project musician Musician
-    call :flash_project musician Musician %5
-)
+shift
+:setup_musicians_next
+if "%~1"=="" goto setup_musicians_done
+call :flash_project musician Musician %1
+shift
+goto setup_musicians_next
+:setup_musicians_done
 
 echo %SUCCESS% All musicians set up successfully!
 echo %INFO% Now flash the conductor with: %~nx0 flash-conductor ^<port^>
+echo %INFO% Boards keep their ID in NVS - erase-flash a board to join it as a new one
 goto :eof
 
 :help
@@ -142,18 +123,18 @@ echo.
 echo Commands:
 echo   build-all                     - Build conductor and musician
 echo   build-conductor              - Build conductor only
-echo   build-musician [id]          - Build musician (optionally set ID)
+echo   build-musician               - Build musician (same image for every board)
 echo   flash-conductor ^<port^>       - Build and flash conductor
-echo   flash-musician ^<id^> ^<port^>   - Build and flash musician with specific ID
+echo   flash-musician ^<port^>        - Build and flash musician (ID assigned on join)
 echo   monitor ^<project^> ^<port^>     - Monitor project logs
 echo   clean-all                    - Clean all projects
-echo   setup-musicians ^<ports...^>   - Setup multiple musicians with different IDs
+echo   setup-musicians ^<ports...^>   - Flash the musician image to several boards
 echo   help                         - Show this help
 echo.
 echo Examples:
 echo   %~nx0 build-all
 echo   %~nx0 flash-conductor COM3
-echo   %~nx0 flash-musician 0 COM4
+echo   %~nx0 flash-musician COM4
 echo   %~nx0 setup-musicians COM3 COM4 COM5
 echo   %~nx0 monitor conductor COM3
 goto :eof
@@ -223,29 +204,3 @@ idf.py fullclean
 echo %SUCCESS% %project_name% cleaned
 cd ..
 goto :eof
-
-:update_musician_id
-set musician_id=%~1
-set file=musician\main\musician_main.c
-
-if not exist "%file%" (
-    echo %ERROR% Musician source file not found: %file%
-    exit /b 1
-)
-
-echo %INFO% Updating MUSICIAN_ID to %musician_id%...
-
-REM Backup original file
-copy "%file%" "%file%.backup" >nul
-
-REM Update MUSICIAN_ID using PowerShell (more reliable than batch)
-powershell -Command "(Get-Content '%file%') -replace '#define MUSICIAN_ID.*', '#define MUSICIAN_ID %musician_id%  // 0=Part A, 1=Part B, 2=Part C, 3=Part D' | Set-Content '%file%'"
-
-findstr /C:"#define MUSICIAN_ID %musician_id%" "%file%" >nul
-if errorlevel 1 (
-    echo %ERROR% Failed to update MUSICIAN_ID
-    exit /b 1
-)
-
-echo %SUCCESS% MUSICIAN_ID updated to %musician_id%
-goto :eof
\ No newline at end of file
@@ -92,32 +92,6 @@ monitor_project() {
     idf.py -p "$port" monitor
 }
 
-# Update MUSICIAN_ID
-update_musician_id() {
-    local musician_id=$1
-    local file="musician/main/musician_main.c"
-    
-    if [ ! -f "$file" ]; then
-        print_error "Musician source file not found: $file"
-        exit 1
-    fi
-    
-    print_status "Updating MUSICIAN_ID to $musician_id..."
-    
-    # Backup original file
-    cp "$file" "$file.backup"
-    
-    # Update MUSICIAN_ID
-    sed -i "s/#define MUSICIAN_ID.*/#define MUSICIAN_ID $musician_id  \/\/ 0=Part A, 1=Part B, 2=Part C, 3=Part D/" "$file"
-    
-    if grep -q "#define MUSICIAN_ID $musician_id" "$file"; then
-        print_success "MUSICIAN_ID updated to $musician_id"
-    else
-        print_error "Failed to update MUSICIAN_ID"
-        exit 1
-    fi
-}
-
 # Clean project
 clean_project() {
     local project_dir=$1
@@ -156,9 +130,6 @@ main() {
             ;;
             
         "build-musician")
-            if [ -n "$2" ]; then
-                update_musician_id "$2"
-            fi
             build_project "musician" "Musician"
             ;;
             
@@ -172,14 +143,14 @@ main() {
             ;;
             
         "flash-musician")
-            if [ -z "$2" ] || [ -z "$3" ]; then
-                print_error "Usage: $0 flash-musician <musician_id> <port>"
-                print_error "Example: $0 flash-musician 0 /dev/ttyUSB0"
+            if [ -z "$2" ]; then
+                print_error "Usage: $0 flash-musician <port>"
+                print_error "Example: $0 flash-musician /dev/ttyUSB0"
                 exit 1
             fi
-            update_musician_id "$2"
+            # Same image for every board - the conductor assigns the ID when it joins
             build_project "musician" "Musician"
-            flash_project "musician" "Musician" "$3"
+            flash_project "musician" "Musician" "$2"
             ;;
             
         "monitor")
@@ -199,37 +170,22 @@ main() {
             
         "setup-musicians")
             if [ "$#" -lt 4 ]; then
-                print_error "Usage: $0 setup-musicians <port1> <port2> <port3> [port4]"
+                print_error "Usage: $0 setup-musicians <port1> <port2> <port3> [port4 ...]"
                 print_error "Example: $0 setup-musicians /dev/ttyUSB0 /dev/ttyUSB1 /dev/ttyUSB2"
                 exit 1
             fi
             
             print_status "Setting up multiple musicians..."
             
-            # Flash musician 0
-            update_musician_id 0
+            # One build, flashed to every port - IDs come from the conductor on first join
             build_project "musician" "Musician"
-            flash_project "musician" "Musician" "$2"
-            
-            # Flash musician 1
-            update_musician_id 1
-            build_project "musician" "Musician"
-            flash_project "musician" "Musician" "$3"
-            
-            # Flash musician 2
-            update_musician_id 2
-            build_project "musician" "Musician"
-            flash_project "musician" "Musician" "$4"
-            
-            # Flash musician 3 if port provided
-            if [ -n "$5" ]; then
-                update_musician_id 3
-                build_project "musician" "Musician"
-                flash_project "musician" "Musician" "$5"
-            fi
+            for port in "${@:2}"; do
+                flash_project "musician" "Musician" "$port"
+            done
             
             print_success "All musicians set up successfully!"
             print_status "Now flash the conductor with: $0 flash-conductor <port>"
+            print_status "Boards keep their ID in NVS - erase-flash a board to join it as a new one"
             ;;
             
         "full-setup")
@@ -241,7 +197,7 @@ main() {
             print_status "Full Orchestra Setup..."
             
             # Setup musicians
-            "$0" setup-musicians "${@:2}"
+            "$0" setup-musicians "${@:3}"
             
             # Setup conductor
             build_project "conductor" "Conductor"
@@ -259,19 +215,19 @@ main() {
             echo "Commands:"
             echo "  build-all                     - Build conductor and musician"
             echo "  build-conductor              - Build conductor only"
-            echo "  build-musician [id]          - Build musician (optionally set ID)"
+            echo "  build-musician               - Build musician (same image for every board)"
             echo "  flash-conductor <port>       - Build and flash conductor"
-            echo "  flash-musician <id> <port>   - Build and flash musician with specific ID"
+            echo "  flash-musician <port>        - Build and flash musician (ID assigned on join)"
             echo "  monitor <project> <port>     - Monitor project logs"
             echo "  clean-all                    - Clean all projects"
-            echo "  setup-musicians <ports...>   - Setup multiple musicians with different IDs"
+            echo "  setup-musicians <ports...>   - Flash the musician image to several boards"
             echo "  full-setup <ports...>        - Complete orchestra setup"
             echo "  help                         - Show this help"
             echo ""
             echo "Examples:"
             echo "  $0 build-all"
             echo "  $0 flash-conductor /dev/ttyUSB0"
-            echo "  $0 flash-musician 0 /dev/ttyUSB1"
+            echo "  $0 flash-musician /dev/ttyUSB1"
             echo "  $0 setup-musicians /dev/ttyUSB1 /dev/ttyUSB2 /dev/ttyUSB3"
             echo "  $0 full-setup /dev/ttyUSB0 /dev/ttyUSB1 /dev/ttyUSB2 /dev/ttyUSB3"
             echo "  $0 monitor conductor /dev/ttyUSB0"
@@ -0,0 +1,255 @@
+/*
+ * crc_bench - ตรวจ frame CRC-16 และวัดต้นทุนต่อ packet เทียบกับ checksum แบบบวก byte เดิม บน PC
+ *
+ *   crc_bench check       check value, table = bitwise, seal/verify ทุก message, จับ error ได้
+ *   crc_bench bench       ns/packet ของ byte-sum, CRC bitwise และ CRC table ตามขนาด frame จริง
+ *   crc_bench errors      อัตรา error ที่หลุดการตรวจ: byte-sum เทียบกับ CRC-16
+ *
+ * บนบอร์ดใช้ esp_rom_crc16_le() (table ใน ROM) - ตัวเลขบน PC ใช้เทียบสัดส่วนเท่านั้น
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "orchestra_common.h"
+
+#define BENCH_ROUNDS    200000
+#define ERROR_TRIALS    1000000
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// The integrity check before ORCHESTRA_PROTOCOL_VERSION 1: sum of every byte but the last
+static uint8_t byte_sum(const uint8_t* data, size_t len) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i + 1 < len; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// Reference CRC-16/X-25, one bit at a time
+static uint16_t crc16_bitwise(uint16_t crc, const uint8_t* data, size_t len) {
+    crc = (uint16_t)~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint16_t)((crc >> 1) ^ (0x8408 & -(crc & 1)));
+        }
+    }
+    return (uint16_t)~crc;
+}
+
+static void fill_random(uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)rng_next();
+    }
+}
+
+// Frame sizes that are actually on the air
+typedef struct {
+    const char* name;
+    size_t len;
+} frame_size_t;
+
+static const frame_size_t frame_sizes[] = {
+    {"ctrl ack / join", sizeof(orchestra_ctrl_ack_t)},
+    {"message", sizeof(orchestra_message_t)},
+    {"sync", sizeof(orchestra_sync_message_t)},
+    {"part assign", sizeof(orchestra_part_assign_t)},
+    {"batch 4 notes", NOTE_BATCH_HEADER_LEN + 4 * sizeof(batch_note_t)},
+    {"full batch / chunk", ORCHESTRA_MAX_FRAME_LEN},
+};
+#define FRAME_SIZE_COUNT (sizeof(frame_sizes) / sizeof(frame_sizes[0]))
+
+static int cmd_check(void) {
+    expect(frame_crc16(0, "123456789", 9) == FRAME_CRC16_CHECK, "CRC-16/X-25 check value 0x906E");
+
+    uint8_t data[ORCHESTRA_MAX_FRAME_LEN];
+    bool same = true;
+    for (int trial = 0; trial < 1000; trial++) {
+        size_t len = rng_next() % sizeof(data);
+        fill_random(data, len);
+        same &= frame_crc16(0, data, len) == crc16_bitwise(0, data, len);
+    }
+    expect(same, "table matches bitwise reference");
+
+    fill_random(data, sizeof(data));
+    uint16_t chained = frame_crc16(frame_crc16(0, data, 100), data + 100, sizeof(data) - 100);
+    expect(chained == frame_crc16(0, data, sizeof(data)), "CRC can continue over split buffers");
+
+    bool sealed = true;
+    for (size_t i = 0; i < FRAME_SIZE_COUNT; i++) {
+        fill_random(data, frame_sizes[i].len);
+        data[0] = MSG_PLAY_NOTE;
+        orchestra_frame_seal(data, frame_sizes[i].len);
+        sealed &= orchestra_frame_verify(data, frame_sizes[i].len) &&
+                  get_message_type(data, (int)frame_sizes[i].len) == MSG_PLAY_NOTE;
+    }
+    expect(sealed, "seal -> verify for every frame size");
+
+    orchestra_message_t msg = {0};
+    msg.header.type = MSG_SONG_START;
+    msg.timestamp = 12345;
+    orchestra_frame_seal(&msg, sizeof(msg));
+    bool every_bit = true;
+    for (size_t bit = 0; bit < sizeof(msg) * 8; bit++) {
+        ((uint8_t*)&msg)[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        every_bit &= !orchestra_frame_verify(&msg, sizeof(msg));
+        ((uint8_t*)&msg)[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+    }
+    expect(every_bit, "every single-bit error is caught");
+
+    orchestra_message_t swapped = msg;
+    uint8_t* bytes = (uint8_t*)&swapped;
+    uint8_t tmp = bytes[8];
+    bytes[8] = bytes[9];
+    bytes[9] = tmp;
+    expect(bytes[8] == bytes[9] || !orchestra_frame_verify(&swapped, sizeof(swapped)),
+           "swapped bytes are caught (byte-sum misses them)");
+
+    // Old firmware: 4-byte enum type (version byte 0), byte-sum at the end
+    uint8_t old_frame[18] = {MSG_SONG_START, 0, 0, 0, 1, 0xFF};
+    old_frame[17] = byte_sum(old_frame, sizeof(old_frame));
+    expect(orchestra_frame_version(old_frame, sizeof(old_frame)) == 0 &&
+           !orchestra_frame_verify(old_frame, sizeof(old_frame)), "old firmware frame detected as version 0");
+    expect(orchestra_frame_version(old_frame, 3) == 0 && !orchestra_frame_verify(old_frame, 3),
+           "runt frame rejected");
+
+    return failures ? 1 : 0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmd_bench(void) {
+    static uint8_t data[ORCHESTRA_MAX_FRAME_LEN];
+    volatile uint32_t sink = 0;
+    fill_random(data, sizeof(data));
+
+    printf("%-20s %5s %12s %12s %12s\n", "", "bytes", "byte-sum ns", "bitwise ns", "table ns");
+    for (size_t i = 0; i < FRAME_SIZE_COUNT; i++) {
+        size_t len = frame_sizes[i].len;
+
+        double start = now_s();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            data[0] = (uint8_t)round;
+            sink += byte_sum(data, len);
+        }
+        double sum_s = now_s() - start;
+
+        start = now_s();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            data[0] = (uint8_t)round;
+            sink += crc16_bitwise(0, data, len);
+        }
+        double bitwise_s = now_s() - start;
+
+        start = now_s();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            data[0] = (uint8_t)round;
+            sink += orchestra_frame_crc(data, len);
+        }
+        double table_s = now_s() - start;
+
+        printf("%-20s %5zu %12.1f %12.1f %12.1f\n", frame_sizes[i].name, len, sum_s * 1e9 / BENCH_ROUNDS,
+               bitwise_s * 1e9 / BENCH_ROUNDS, table_s * 1e9 / BENCH_ROUNDS);
+    }
+    return sink == 0xFFFFFFFF; // Keep the loops alive
+}
+
+typedef enum {
+    ERROR_BYTE_SWAP,        // Two adjacent bytes exchanged
+    ERROR_BURST_16,         // Up to 16 bits flipped within 16 consecutive bits
+    ERROR_RANDOM_BYTES,     // 2-4 bytes replaced anywhere
+} error_kind_t;
+
+static const char* const error_names[] = {"adjacent byte swap", "burst <= 16 bits", "2-4 random bytes"};
+
+// Returns false when the error left the frame unchanged (not counted)
+static bool corrupt(uint8_t* frame, size_t len, error_kind_t kind) {
+    uint8_t before[ORCHESTRA_MAX_FRAME_LEN];
+    memcpy(before, frame, len);
+    if (kind == ERROR_BYTE_SWAP) {
+        size_t at = rng_next() % (len - 1);
+        uint8_t tmp = frame[at];
+        frame[at] = frame[at + 1];
+        frame[at + 1] = tmp;
+    } else if (kind == ERROR_BURST_16) {
+        size_t start = rng_next() % (len * 8 - 16);
+        uint32_t pattern = (rng_next() & 0xFFFF) | 0x8001;  // First and last bit of the burst set
+        for (int bit = 0; bit < 16; bit++) {
+            if (pattern & (1u << bit)) {
+                frame[(start + bit) / 8] ^= (uint8_t)(1u << ((start + bit) % 8));
+            }
+        }
+    } else {
+        int count = 2 + rng_next() % 3;
+        for (int i = 0; i < count; i++) {
+            frame[rng_next() % len] = (uint8_t)rng_next();
+        }
+    }
+    return memcmp(before, frame, len) != 0;
+}
+
+static int cmd_errors(void) {
+    uint8_t frame[sizeof(orchestra_message_t) + 1];
+    printf("%d corrupted %zu-byte frames per row\n", ERROR_TRIALS, sizeof(orchestra_message_t));
+    printf("%-20s %14s %14s\n", "", "byte-sum miss", "CRC-16 miss");
+    for (int kind = ERROR_BYTE_SWAP; kind <= ERROR_RANDOM_BYTES; kind++) {
+        uint32_t trials = 0, sum_missed = 0, crc_missed = 0;
+        while (trials < ERROR_TRIALS) {
+            // Old layout: byte-sum in the last byte
+            fill_random(frame, sizeof(frame));
+            frame[sizeof(frame) - 1] = byte_sum(frame, sizeof(frame));
+            if (!corrupt(frame, sizeof(frame), (error_kind_t)kind)) {
+                continue;
+            }
+            sum_missed += byte_sum(frame, sizeof(frame)) == frame[sizeof(frame) - 1];
+
+            // New layout: CRC-16 in the header
+            fill_random(frame, sizeof(orchestra_message_t));
+            orchestra_frame_seal(frame, sizeof(orchestra_message_t));
+            if (!corrupt(frame, sizeof(orchestra_message_t), (error_kind_t)kind)) {
+                continue;
+            }
+            crc_missed += orchestra_frame_verify(frame, sizeof(orchestra_message_t));
+            trials++;
+        }
+        printf("%-20s %13.4f%% %13.4f%%\n", error_names[kind], 100.0 * sum_missed / trials,
+               100.0 * crc_missed / trials);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return cmd_bench();
+    }
+    if (argc >= 2 && strcmp(argv[1], "errors") == 0) {
+        return cmd_errors();
+    }
+
+    fprintf(stderr, "usage: %s check | bench | errors\n", argv[0]);
+    return 2;
+}
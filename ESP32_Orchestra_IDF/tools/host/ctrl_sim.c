@@ -0,0 +1,264 @@
+/*
+ * ctrl_sim - ทดสอบ reliable_ctrl กับ link จำลองที่ทำ frame หายได้ บน PC
+ *
+ *   ctrl_sim check                                    กรณีพื้นฐาน + lossy link ต้องส่งถึงครบ ไม่ซ้ำ
+ *   ctrl_sim run [loss %] [musicians] [messages] [seed] สถิติของ loss rate เดียว
+ *   ctrl_sim sweep [musicians]                        loss 0-50% เทียบกับส่งครั้งเดียว (แบบเดิม)
+ *
+ * Link: ทุก frame (ทั้ง control และ ACK) หายอิสระต่อกันด้วยความน่าจะเป็น loss, latency คงที่
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "orchestra_common.h"
+#include "reliable_ctrl.h"
+
+#define SIM_MAX_MUSICIANS   MAX_MUSICIANS
+#define SIM_LATENCY_MS      2
+#define SIM_SPACING_MS      1000    // Between control messages (song start ... song end)
+#define SIM_MAX_INFLIGHT    256
+
+typedef struct {
+    uint32_t due_ms;
+    bool to_conductor;          // ACK (else control frame to musician `node`)
+    uint8_t node;
+    uint16_t sequence;
+} sim_frame_t;
+
+typedef struct {
+    double loss;
+    int musicians;
+    int messages;
+    uint32_t seed;
+} sim_config_t;
+
+typedef struct {
+    uint32_t deliveries;        // (musician, message) pairs acted on exactly once
+    uint32_t missed;            // Never acted on
+    uint32_t doubled;           // Acted on more than once (must stay 0)
+    uint32_t transmissions;     // Control frames put on the air
+    uint32_t expired;
+    uint64_t complete_ms_sum;   // Time until every musician acknowledged
+    uint32_t complete_ms_max;
+    uint32_t completed;
+} sim_result_t;
+
+static uint32_t rng_state;
+
+static double rng_uniform(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static sim_frame_t inflight[SIM_MAX_INFLIGHT];
+static int inflight_count;
+
+static void air_send(const sim_config_t* cfg, uint32_t now_ms, bool to_conductor, uint8_t node, uint16_t sequence) {
+    if (rng_uniform() < cfg->loss || inflight_count >= SIM_MAX_INFLIGHT) {
+        return;
+    }
+    inflight[inflight_count++] = (sim_frame_t){now_ms + SIM_LATENCY_MS, to_conductor, node, sequence};
+}
+
+// Broadcast: every musician draws its own loss
+static void air_broadcast(const sim_config_t* cfg, uint32_t now_ms, uint16_t sequence, sim_result_t* result) {
+    result->transmissions++;
+    for (int node = 0; node < cfg->musicians; node++) {
+        air_send(cfg, now_ms, false, (uint8_t)node, sequence);
+    }
+}
+
+static sim_result_t simulate(const sim_config_t* cfg) {
+    static reliable_sender_t sender;
+    static reliable_receiver_t receivers[SIM_MAX_MUSICIANS];
+    static uint8_t acted[SIM_MAX_MUSICIANS];
+    sim_result_t result = {0};
+
+    rng_state = cfg->seed ? cfg->seed : 1;
+    inflight_count = 0;
+    reliable_sender_init(&sender, (uint16_t)(cfg->seed * 7919u));
+    for (int node = 0; node < cfg->musicians; node++) {
+        reliable_receiver_init(&receivers[node]);
+    }
+    uint32_t all_mask = cfg->musicians >= 32 ? 0xFFFFFFFFu : (1u << cfg->musicians) - 1;
+
+    uint32_t now_ms = 0;
+    for (int message = 0; message < cfg->messages; message++) {
+        orchestra_message_t msg = {0};
+        msg.header.type = (message & 1) ? MSG_SONG_END : MSG_SONG_START;
+        msg.part_id = 0xFF;
+        msg.sequence = reliable_sender_next_sequence(&sender);
+        orchestra_frame_seal(&msg, sizeof(msg));
+        memset(acted, 0, sizeof(acted));
+
+        uint32_t start_ms = now_ms;
+        bool complete = false;
+        uint32_t completed_before = sender.stats.completed;
+        air_broadcast(cfg, now_ms, msg.sequence, &result);
+        reliable_sender_submit(&sender, &msg, sizeof(msg), msg.sequence, all_mask, now_ms);
+
+        for (; now_ms < start_ms + SIM_SPACING_MS; now_ms++) {
+            // Deliver what is due (in order of sending, fixed latency)
+            int kept = 0;
+            for (int i = 0; i < inflight_count; i++) {
+                sim_frame_t frame = inflight[i];
+                if (frame.due_ms > now_ms) {
+                    inflight[kept++] = frame;
+                    continue;
+                }
+                if (frame.to_conductor) {
+                    reliable_sender_ack(&sender, frame.node, frame.sequence);
+                } else {
+                    air_send(cfg, now_ms, true, frame.node, frame.sequence);  // ACK every copy
+                    if (reliable_receiver_accept(&receivers[frame.node], frame.sequence)) {
+                        acted[frame.node]++;
+                    }
+                }
+            }
+            inflight_count = kept;
+
+            uint8_t frame[RELIABLE_MAX_FRAME];
+            while (reliable_sender_poll(&sender, now_ms, frame, sizeof(frame)) > 0) {
+                orchestra_message_t resent;
+                memcpy(&resent, frame, sizeof(resent));
+                air_broadcast(cfg, now_ms, resent.sequence, &result);
+            }
+
+            if (!complete && sender.stats.completed != completed_before) {
+                complete = true;
+                uint32_t took_ms = now_ms - start_ms;
+                result.completed++;
+                result.complete_ms_sum += took_ms;
+                result.complete_ms_max = took_ms > result.complete_ms_max ? took_ms : result.complete_ms_max;
+            }
+        }
+
+        for (int node = 0; node < cfg->musicians; node++) {
+            result.deliveries += acted[node] == 1;
+            result.missed += acted[node] == 0;
+            result.doubled += acted[node] > 1;
+        }
+    }
+    result.expired = sender.stats.expired;
+    return result;
+}
+
+static void print_header(void) {
+    printf("%6s %9s %9s %8s %8s %9s %9s %8s\n", "loss", "delivered", "one-shot", "doubled",
+           "tx/msg", "expired", "ack avg", "ack max");
+}
+
+static void print_result(const sim_config_t* cfg, const sim_result_t* r) {
+    double pairs = (double)cfg->musicians * cfg->messages;
+    printf("%5.0f%% %8.3f%% %8.3f%% %8lu %8.2f %9lu %7.1fms %6lums\n", cfg->loss * 100,
+           100.0 * r->deliveries / pairs, 100.0 * (1.0 - cfg->loss), (unsigned long)r->doubled,
+           (double)r->transmissions / cfg->messages, (unsigned long)r->expired,
+           r->completed ? (double)r->complete_ms_sum / r->completed : 0.0, (unsigned long)r->complete_ms_max);
+}
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static int cmd_check(void) {
+    reliable_receiver_t rx;
+    reliable_receiver_init(&rx);
+    bool first = reliable_receiver_accept(&rx, 100);
+    bool dup = reliable_receiver_accept(&rx, 100);
+    bool newer = reliable_receiver_accept(&rx, 103);
+    bool late = reliable_receiver_accept(&rx, 101);
+    bool late_dup = reliable_receiver_accept(&rx, 101);
+    expect(first && !dup && newer && late && !late_dup, "receiver drops duplicates, keeps late first copies");
+    expect(reliable_receiver_accept(&rx, 103 - 1000), "receiver restarts on a far older sequence (reboot)");
+    expect(reliable_receiver_accept(&rx, RELIABLE_SEQ_NONE) && reliable_receiver_accept(&rx, RELIABLE_SEQ_NONE),
+           "best-effort frames always pass");
+
+    reliable_sender_t tx;
+    reliable_sender_init(&tx, 0xFFFF);
+    uint16_t a = reliable_sender_next_sequence(&tx);
+    uint16_t b = reliable_sender_next_sequence(&tx);
+    expect(a == 0xFFFF && b == 1, "sequence wraps around RELIABLE_SEQ_NONE");
+
+    uint8_t frame[RELIABLE_MAX_FRAME] = {1, 2, 3};
+    uint8_t out[RELIABLE_MAX_FRAME];
+    reliable_sender_submit(&tx, frame, 3, 7, 0x3, 0);
+    reliable_sender_ack(&tx, 0, 7);
+    size_t early = reliable_sender_poll(&tx, RELIABLE_RETRY_MS - 1, out, sizeof(out));
+    size_t due = reliable_sender_poll(&tx, RELIABLE_RETRY_MS, out, sizeof(out));
+    reliable_sender_ack(&tx, 1, 7);
+    expect(early == 0 && due == 3 && !reliable_sender_busy(&tx) && tx.stats.completed == 1,
+           "retransmit when due, done once every musician ACKed");
+
+    reliable_sender_submit(&tx, frame, 3, 8, 0x1, 0);
+    int sends = 1;
+    for (uint32_t t = 0; t < 2000; t++) {
+        sends += reliable_sender_poll(&tx, t, out, sizeof(out)) > 0;
+    }
+    expect(sends == RELIABLE_MAX_ATTEMPTS && tx.stats.expired == 1 && tx.stats.last_expired_mask == 0x1,
+           "bounded attempts, silent musician reported");
+
+    reliable_sender_submit(&tx, frame, 3, 9, 0x1, 0);
+    reliable_sender_cancel_all(&tx);
+    expect(reliable_sender_poll(&tx, 1000, out, sizeof(out)) == 0, "cancelled message is not resent");
+
+    sim_config_t clean = {0.0, 8, 200, 1};
+    sim_result_t r = simulate(&clean);
+    expect(r.deliveries == 8 * 200 && r.transmissions == 200 && r.doubled == 0, "lossless link: one transmission each");
+
+    sim_config_t lossy = {0.2, 8, 1000, 2};
+    r = simulate(&lossy);
+    expect(r.doubled == 0, "20% loss: no musician acts twice");
+    expect(r.deliveries >= 8 * 1000 * 999 / 1000, "20% loss: >= 99.9% delivered (one-shot 80%)");
+
+    sim_config_t heavy = {0.5, 32, 300, 3};
+    r = simulate(&heavy);
+    expect(r.doubled == 0 && r.missed > 0 && r.expired > 0, "50% loss, 32 boards: bounded, losses reported");
+
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        sim_config_t cfg = {
+            .loss = argc > 2 ? atof(argv[2]) / 100.0 : 0.1,
+            .musicians = argc > 3 ? atoi(argv[3]) : 4,
+            .messages = argc > 4 ? atoi(argv[4]) : 1000,
+            .seed = argc > 5 ? (uint32_t)strtoul(argv[5], NULL, 0) : 1,
+        };
+        if (cfg.musicians < 1 || cfg.musicians > SIM_MAX_MUSICIANS || cfg.messages < 1) {
+            fprintf(stderr, "musicians 1-%d, messages >= 1\n", SIM_MAX_MUSICIANS);
+            return 2;
+        }
+        sim_result_t r = simulate(&cfg);
+        print_header();
+        print_result(&cfg, &r);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "sweep") == 0) {
+        int musicians = argc > 2 ? atoi(argv[2]) : 4;
+        if (musicians < 1 || musicians > SIM_MAX_MUSICIANS) {
+            fprintf(stderr, "musicians 1-%d\n", SIM_MAX_MUSICIANS);
+            return 2;
+        }
+        printf("%d musicians, 1000 control messages per row\n", musicians);
+        print_header();
+        for (int loss = 0; loss <= 50; loss += 10) {
+            sim_config_t cfg = {loss / 100.0, musicians, 1000, 1};
+            sim_result_t r = simulate(&cfg);
+            print_result(&cfg, &r);
+        }
+        return 0;
+    }
+
+    fprintf(stderr, "usage: %s check | run [loss%%] [musicians] [messages] [seed] | sweep [musicians]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,238 @@
+/*
+ * Ensemble timing - จับคู่โน๊ตที่ควรเล่นกับ onset ที่วัดได้ แล้วคำนวณ error / skew / ความยาว
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ensemble_timing.h"
+
+static void samples_add(ensemble_samples_t* samples, int64_t value) {
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 256;
+        samples->values = realloc(samples->values, samples->capacity * sizeof(samples->values[0]));
+        if (samples->values == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    samples->values[samples->count++] = value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : (int32_t)value;
+}
+
+void ensemble_report_init(ensemble_report_t* report) {
+    memset(report, 0, sizeof(*report));
+}
+
+void ensemble_report_free(ensemble_report_t* report) {
+    free(report->onset_error_us.values);
+    free(report->skew_us.values);
+    free(report->length_error_us.values);
+    ensemble_report_init(report);
+}
+
+void ensemble_song_begin(ensemble_song_t* song, const orchestra_song_t* source, uint32_t start_ms) {
+    song->song = source;
+    song->start_ms = start_ms;
+    song->note_count = 0;
+    song->tone_count = 0;
+    song->dropped = 0;
+    memset(song->open_tone, 0xFF, sizeof(song->open_tone));
+}
+
+// Same timing as the conductor's scheduler and the musician's score_player
+void ensemble_song_add_board(ensemble_song_t* song, uint8_t board, uint8_t part_mask) {
+    for (uint8_t part = 0; part < song->song->part_count; part++) {
+        if (!(part_mask & (1u << part))) {
+            continue;
+        }
+        const song_part_t* source = &song->song->parts[part];
+        int64_t time_us = (int64_t)song->start_ms * 1000;
+        for (uint16_t i = 0; i < source->event_count; i++) {
+            const note_event_t* event = &source->events[i];
+            if (event->note != NOTE_REST && event->duration_ms > 0) {
+                if (song->note_count >= ENSEMBLE_MAX_NOTES) {
+                    song->dropped++;
+                } else {
+                    song->notes[song->note_count++] = (ensemble_note_t){
+                        time_us, time_us + (int64_t)event->duration_ms * 1000, board, part, event->note, -1};
+                }
+            }
+            time_us += (int64_t)(event->duration_ms + event->delay_ms) * 1000;
+        }
+    }
+}
+
+void ensemble_song_note_on(ensemble_song_t* song, uint8_t board, uint8_t voice, uint8_t note, int64_t time_us) {
+    if (board >= ENSEMBLE_MAX_BOARDS || voice >= ENSEMBLE_MAX_VOICES) {
+        return;
+    }
+    ensemble_song_note_off(song, board, voice, time_us);   // A voice plays one note at a time
+    if (song->tone_count >= ENSEMBLE_MAX_TONES) {
+        song->dropped++;
+        return;
+    }
+    song->open_tone[board][voice] = song->tone_count;
+    song->tones[song->tone_count++] = (ensemble_tone_t){time_us, -1, board, voice, note, false};
+}
+
+void ensemble_song_note_off(ensemble_song_t* song, uint8_t board, uint8_t voice, int64_t time_us) {
+    if (board >= ENSEMBLE_MAX_BOARDS || voice >= ENSEMBLE_MAX_VOICES) {
+        return;
+    }
+    int32_t open = song->open_tone[board][voice];
+    if (open >= 0) {
+        song->tones[open].end_us = time_us;
+        song->open_tone[board][voice] = -1;
+    }
+}
+
+static int compare_notes(const void* a, const void* b) {
+    const ensemble_note_t* x = a;
+    const ensemble_note_t* y = b;
+    if (x->start_us != y->start_us) {
+        return x->start_us < y->start_us ? -1 : 1;
+    }
+    return x->board != y->board ? x->board - y->board : x->part - y->part;
+}
+
+void ensemble_song_analyze(ensemble_song_t* song, ensemble_report_t* report, ensemble_report_t* total) {
+    ensemble_report_t* targets[2] = {report, total};
+    qsort(song->notes, song->note_count, sizeof(song->notes[0]), compare_notes);
+
+    // Each intended note takes the closest free onset of the same pitch on its board
+    for (int i = 0; i < song->note_count; i++) {
+        ensemble_note_t* note = &song->notes[i];
+        int best = -1;
+        int64_t best_distance = ENSEMBLE_MATCH_WINDOW_US + 1;
+        for (int t = 0; t < song->tone_count; t++) {
+            const ensemble_tone_t* tone = &song->tones[t];
+            if (tone->matched || tone->board != note->board || tone->note != note->note) {
+                continue;
+            }
+            int64_t distance = llabs(tone->start_us - note->start_us);
+            if (distance < best_distance) {
+                best = t;
+                best_distance = distance;
+            }
+        }
+        note->tone = best;
+        if (best >= 0) {
+            song->tones[best].matched = true;
+        }
+    }
+
+    for (int r = 0; r < 2; r++) {
+        ensemble_report_t* target = targets[r];
+        if (target == NULL) {
+            continue;
+        }
+        for (int i = 0; i < song->note_count; i++) {
+            const ensemble_note_t* note = &song->notes[i];
+            target->notes++;
+            if (note->tone < 0) {
+                target->missing++;
+                continue;
+            }
+            const ensemble_tone_t* tone = &song->tones[note->tone];
+            target->played++;
+            samples_add(&target->onset_error_us, tone->start_us - note->start_us);
+            if (tone->end_us >= 0) {
+                samples_add(&target->length_error_us,
+                            (tone->end_us - tone->start_us) - (note->end_us - note->start_us));
+            }
+        }
+        for (int t = 0; t < song->tone_count; t++) {
+            target->extra += !song->tones[t].matched;
+        }
+
+        // Notes are sorted by intended start: one group per instant that several boards/parts share
+        for (int first = 0; first < song->note_count;) {
+            int last = first;
+            int64_t earliest = INT64_MAX, latest = INT64_MIN;
+            int sounded = 0;
+            while (last < song->note_count && song->notes[last].start_us == song->notes[first].start_us) {
+                if (song->notes[last].tone >= 0) {
+                    int64_t start_us = song->tones[song->notes[last].tone].start_us;
+                    earliest = start_us < earliest ? start_us : earliest;
+                    latest = start_us > latest ? start_us : latest;
+                    sounded++;
+                }
+                last++;
+            }
+            if (sounded >= 2) {
+                samples_add(&target->skew_us, latest - earliest);
+            }
+            first = last;
+        }
+    }
+}
+
+static int compare_int32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile of |value|
+static int32_t percentile(const int32_t* sorted, size_t count, double fraction) {
+    size_t rank = (size_t)ceil(fraction * count);
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void ensemble_summarize(const ensemble_samples_t* samples, ensemble_summary_t* summary) {
+    memset(summary, 0, sizeof(*summary));
+    summary->count = samples->count;
+    if (samples->count == 0) {
+        return;
+    }
+    int32_t* magnitudes = malloc(samples->count * sizeof(int32_t));
+    double sum = 0;
+    for (size_t i = 0; i < samples->count; i++) {
+        sum += samples->values[i];
+        magnitudes[i] = samples->values[i] < 0 ? -samples->values[i] : samples->values[i];
+    }
+    qsort(magnitudes, samples->count, sizeof(int32_t), compare_int32);
+    summary->mean = sum / samples->count;
+    summary->p50 = percentile(magnitudes, samples->count, 0.50);
+    summary->p99 = percentile(magnitudes, samples->count, 0.99);
+    summary->max = magnitudes[samples->count - 1];
+    free(magnitudes);
+}
+
+void ensemble_print_header(FILE* out) {
+    fprintf(out, "%-28s %6s %6s %5s | %-25s | %-19s | %s\n", "", "", "", "", "onset error us", "skew us",
+            "length error us");
+    fprintf(out, "%-28s %6s %6s %5s | %6s %5s %5s %6s | %5s %6s %6s | %6s %5s %5s %6s\n", "", "notes", "played",
+            "extra", "mean", "p50", "p99", "max", "p50", "p99", "max", "mean", "p50", "p99", "max");
+}
+
+void ensemble_print_row(FILE* out, const char* name, const ensemble_report_t* report) {
+    ensemble_summary_t onset, skew, length;
+    ensemble_summarize(&report->onset_error_us, &onset);
+    ensemble_summarize(&report->skew_us, &skew);
+    ensemble_summarize(&report->length_error_us, &length);
+    fprintf(out, "%-28.28s %6lu %6lu %5lu | %6.0f %5ld %5ld %6ld | %5ld %6ld %6ld | %6.0f %5ld %5ld %6ld\n", name,
+            (unsigned long)report->notes, (unsigned long)report->played, (unsigned long)report->extra,
+            onset.mean, (long)onset.p50, (long)onset.p99, (long)onset.max,
+            (long)skew.p50, (long)skew.p99, (long)skew.max,
+            length.mean, (long)length.p50, (long)length.p99, (long)length.max);
+}
+
+static void write_summary(FILE* out, const char* name, const ensemble_samples_t* samples) {
+    ensemble_summary_t summary;
+    ensemble_summarize(samples, &summary);
+    fprintf(out, "\"%s\": {\"count\": %zu, \"mean\": %.1f, \"p50\": %ld, \"p99\": %ld, \"max\": %ld}", name,
+            summary.count, summary.mean, (long)summary.p50, (long)summary.p99, (long)summary.max);
+}
+
+void ensemble_write_json(FILE* out, const ensemble_report_t* report) {
+    fprintf(out, "{\"notes\": %lu, \"played\": %lu, \"missing\": %lu, \"extra\": %lu, ",
+            (unsigned long)report->notes, (unsigned long)report->played, (unsigned long)report->missing,
+            (unsigned long)report->extra);
+    write_summary(out, "onset_error_us", &report->onset_error_us);
+    fprintf(out, ", ");
+    write_summary(out, "skew_us", &report->skew_us);
+    fprintf(out, ", ");
+    write_summary(out, "length_error_us", &report->length_error_us);
+    fprintf(out, "}");
+}
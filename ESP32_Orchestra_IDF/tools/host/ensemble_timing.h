@@ -0,0 +1,97 @@
+#ifndef ENSEMBLE_TIMING_H
+#define ENSEMBLE_TIMING_H
+
+/*
+ * Ensemble timing - เทียบเวลาที่ควรเล่นกับเวลาที่ LEDC เล่นจริง ของทุกโน๊ตทุก part
+ * ใช้ทั้ง orchestra_sim timing (simulation) และ timing_report (log จากบอร์ดจริง, TIMING_LOG 1)
+ * ทุกเวลาอยู่บนนาฬิกาของ Conductor (us)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "midi_songs.h"
+
+#define ENSEMBLE_MAX_BOARDS         33
+#define ENSEMBLE_MAX_VOICES         8
+#define ENSEMBLE_MAX_NOTES          4096    // Intended notes of one song, all boards
+#define ENSEMBLE_MAX_TONES          8192    // Onsets measured during one song, all boards
+#define ENSEMBLE_MATCH_WINDOW_US    100000  // Farther than this from its intended time = another note
+
+// One note a board should play
+typedef struct {
+    int64_t start_us;
+    int64_t end_us;
+    uint8_t board;
+    uint8_t part;
+    uint8_t note;
+    int32_t tone;               // Index of the measured onset, -1 = never sounded
+} ensemble_note_t;
+
+// One note a board did play (end_us = -1 while still sounding)
+typedef struct {
+    int64_t start_us;
+    int64_t end_us;
+    uint8_t board;
+    uint8_t voice;
+    uint8_t note;
+    bool matched;
+} ensemble_tone_t;
+
+typedef struct {
+    const orchestra_song_t* song;
+    uint32_t start_ms;          // MSG_SONG_START timestamp
+    ensemble_note_t notes[ENSEMBLE_MAX_NOTES];
+    int note_count;
+    ensemble_tone_t tones[ENSEMBLE_MAX_TONES];
+    int tone_count;
+    int32_t open_tone[ENSEMBLE_MAX_BOARDS][ENSEMBLE_MAX_VOICES];
+    uint32_t dropped;           // Notes/tones beyond the arrays
+} ensemble_song_t;
+
+// Growing list of microsecond samples
+typedef struct {
+    int32_t* values;
+    size_t count;
+    size_t capacity;
+} ensemble_samples_t;
+
+typedef struct {
+    uint32_t notes;             // Intended
+    uint32_t played;            // Matched to an onset
+    uint32_t missing;
+    uint32_t extra;             // Onsets that match no intended note
+    ensemble_samples_t onset_error_us;   // Actual - intended onset
+    ensemble_samples_t skew_us;          // Latest - earliest onset of notes that share an intended time
+    ensemble_samples_t length_error_us;  // Actual - intended length
+} ensemble_report_t;
+
+typedef struct {
+    size_t count;
+    double mean;                // Signed
+    int32_t p50;                // Percentiles of the absolute value
+    int32_t p99;
+    int32_t max;
+} ensemble_summary_t;
+
+// Song and the parts each board plays (part_mask as in MSG_PART_ASSIGN)
+void ensemble_song_begin(ensemble_song_t* song, const orchestra_song_t* source, uint32_t start_ms);
+void ensemble_song_add_board(ensemble_song_t* song, uint8_t board, uint8_t part_mask);
+
+// Measured LEDC events, in time order per board
+void ensemble_song_note_on(ensemble_song_t* song, uint8_t board, uint8_t voice, uint8_t note, int64_t time_us);
+void ensemble_song_note_off(ensemble_song_t* song, uint8_t board, uint8_t voice, int64_t time_us);
+
+// Match onsets to notes and add the results to report (and total, may be NULL)
+void ensemble_song_analyze(ensemble_song_t* song, ensemble_report_t* report, ensemble_report_t* total);
+
+void ensemble_report_init(ensemble_report_t* report);
+void ensemble_report_free(ensemble_report_t* report);
+void ensemble_summarize(const ensemble_samples_t* samples, ensemble_summary_t* summary);
+
+// Table row / JSON object ("name": {...}) of one report
+void ensemble_print_row(FILE* out, const char* name, const ensemble_report_t* report);
+void ensemble_print_header(FILE* out);
+void ensemble_write_json(FILE* out, const ensemble_report_t* report);
+
+#endif // ENSEMBLE_TIMING_H
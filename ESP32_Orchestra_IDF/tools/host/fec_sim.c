@@ -0,0 +1,268 @@
+/*
+ * fec_sim - ทดสอบ note FEC (note_fec) กับ link จำลองที่ทำ frame หายได้ บน PC
+ * ส่งเพลง built-in ทุก part แบบ stream เหมือน conductor (look-ahead + batch window)
+ *
+ *   fec_sim check                          กรณีพื้นฐาน + lossy link ต้องได้โน๊ตเพิ่มและไม่ซ้ำ
+ *   fec_sim run [loss %] [depth] [seed]    สถิติของ loss rate และ depth เดียว
+ *   fec_sim sweep                          loss 0-50% x depth 0-NOTE_FEC_MAX_DEPTH
+ *
+ * Link: แต่ละ musician (1 บอร์ดต่อ part) เสีย broadcast frame อิสระต่อกันด้วยความน่าจะเป็น loss
+ * โน๊ตนับว่าได้รับเมื่อ copy แรกถึงก่อนเวลาเล่น (latency คงที่)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "midi_songs.h"
+#include "note_fec.h"
+
+#define SIM_LATENCY_MS      2
+#define SIM_REPEATS         200     // Plays of every song per row
+#define SIM_MAX_EVENTS      2048
+
+typedef struct {
+    uint32_t send_ms;           // start_ms - look-ahead
+    fec_note_t note;
+    uint8_t received;           // Copies the musician scheduled (must stay <= 1)
+} sim_event_t;
+
+typedef struct {
+    double loss;
+    uint8_t depth;
+    uint32_t seed;
+} sim_config_t;
+
+typedef struct {
+    uint32_t notes;             // Notes × the one board that plays them
+    uint32_t delivered;         // Scheduled in time
+    uint32_t recovered;         // ... only thanks to a repeat (first copy lost)
+    uint32_t doubled;
+    uint32_t frames;
+    uint64_t frame_bytes;
+} sim_result_t;
+
+static uint32_t rng_state;
+
+static double rng_uniform(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static sim_event_t events[SIM_MAX_EVENTS];
+static int event_count;
+
+static int compare_send(const void* a, const void* b) {
+    const sim_event_t* x = a;
+    const sim_event_t* y = b;
+    return x->send_ms < y->send_ms ? -1 : x->send_ms > y->send_ms;
+}
+
+// Every note of the song in the order the conductor's heap sends them
+static void load_song(const orchestra_song_t* song, uint32_t song_start_ms) {
+    event_count = 0;
+    for (uint8_t p = 0; p < song->part_count && p < MAX_PARTS; p++) {
+        uint32_t t = 0;
+        for (uint16_t i = 0; i < song->parts[p].event_count && event_count < SIM_MAX_EVENTS; i++) {
+            const note_event_t* ev = &song->parts[p].events[i];
+            if (ev->note != NOTE_REST && ev->duration_ms > 0) {
+                sim_event_t* e = &events[event_count++];
+                e->note = (fec_note_t){song_start_ms + t, ev->duration_ms, p, ev->note, 100};
+                e->send_ms = e->note.start_ms - NOTE_LOOKAHEAD_MS;
+                e->received = 0;
+            }
+            t += ev->duration_ms + ev->delay_ms;
+        }
+    }
+    qsort(events, event_count, sizeof(sim_event_t), compare_send);
+}
+
+static sim_event_t* find_event(const fec_note_t* note) {
+    for (int i = 0; i < event_count; i++) {
+        const fec_note_t* n = &events[i].note;
+        if (n->start_ms == note->start_ms && n->part_id == note->part_id && n->note == note->note) {
+            return &events[i];
+        }
+    }
+    return NULL;
+}
+
+// One song, one play: flush like send_song_events(), every board draws its own loss per frame
+static void play_song(const orchestra_song_t* song, const sim_config_t* cfg, uint32_t song_start_ms,
+                      sim_result_t* result) {
+    static note_fec_encoder_t encoder;
+    static note_fec_decoder_t decoders[MAX_PARTS];
+    static fec_note_t frame[NOTE_BATCH_MAX_NOTES];
+
+    load_song(song, song_start_ms);
+    note_fec_encoder_init(&encoder, cfg->depth);
+    for (int p = 0; p < MAX_PARTS; p++) {
+        note_fec_decoder_init(&decoders[p]);
+    }
+    size_t limit = note_fec_new_notes_limit(&encoder, NOTE_BATCH_MAX_NOTES);
+
+    // Wake up for the next event, or for a repeat-only frame like arm_event_timer()
+    int next = 0;
+    uint32_t last_batch_ms = 0;
+    while (next < event_count || note_fec_encoder_pending(&encoder, last_batch_ms)) {
+        uint32_t now_ms = next < event_count ? events[next].send_ms : UINT32_MAX;
+        uint32_t repeat_ms = last_batch_ms + NOTE_FEC_REPEAT_MS;
+        if (cfg->depth > 0 && repeat_ms < now_ms && note_fec_encoder_pending(&encoder, last_batch_ms)) {
+            now_ms = repeat_ms;
+        }
+        size_t fresh = 0;
+        while (next < event_count && events[next].send_ms <= now_ms + NOTE_BATCH_WINDOW_MS && fresh < limit) {
+            frame[fresh++] = events[next++].note;
+        }
+        size_t repeats = note_fec_encoder_repeat(&encoder, frame + fresh, NOTE_BATCH_MAX_NOTES - fresh, now_ms);
+        note_fec_encoder_push(&encoder, frame, fresh);
+        last_batch_ms = now_ms;
+        if (fresh + repeats == 0) {
+            continue;
+        }
+        result->frames++;
+        result->frame_bytes += note_batch_frame_len((uint8_t)(fresh + repeats));
+
+        for (uint8_t p = 0; p < song->part_count && p < MAX_PARTS; p++) {
+            if (rng_uniform() < cfg->loss) {
+                continue;
+            }
+            for (size_t i = 0; i < fresh + repeats; i++) {
+                const fec_note_t* note = &frame[i];
+                if (note->part_id != p || (int32_t)(note->start_ms - (now_ms + SIM_LATENCY_MS)) < 0) {
+                    continue;
+                }
+                if (cfg->depth > 0 && !note_fec_decoder_accept(&decoders[p], note)) {
+                    continue;
+                }
+                sim_event_t* ev = find_event(note);
+                if (ev && ev->received++ == 0 && i >= fresh) {
+                    result->recovered++;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < event_count; i++) {
+        result->notes++;
+        result->delivered += events[i].received > 0;
+        result->doubled += events[i].received > 1;
+    }
+}
+
+static sim_result_t simulate(const sim_config_t* cfg) {
+    sim_result_t result = {0};
+    rng_state = cfg->seed ? cfg->seed : 1;
+    uint32_t song_start_ms = 1000;
+    for (int repeat = 0; repeat < SIM_REPEATS; repeat++) {
+        for (size_t s = 0; s < TOTAL_SONGS; s++) {
+            play_song(&all_songs[s], cfg, song_start_ms, &result);
+            song_start_ms += 60000;
+        }
+    }
+    return result;
+}
+
+static void print_header(void) {
+    printf("%6s %6s %10s %10s %8s %8s %11s\n", "loss", "depth", "delivered", "recovered",
+           "doubled", "frames", "bytes/frame");
+}
+
+static void print_result(const sim_config_t* cfg, const sim_result_t* r) {
+    printf("%5.0f%% %6d %9.3f%% %9.3f%% %8lu %8lu %11.1f\n", cfg->loss * 100, cfg->depth,
+           100.0 * r->delivered / r->notes, 100.0 * r->recovered / r->notes, (unsigned long)r->doubled,
+           (unsigned long)r->frames, r->frames ? (double)r->frame_bytes / r->frames : 0.0);
+}
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static int cmd_check(void) {
+    note_fec_encoder_t enc;
+    note_fec_encoder_init(&enc, 2);
+    fec_note_t a[2] = {{100, 50, 0, 60, 100}, {300, 50, 1, 62, 100}};
+    fec_note_t b[1] = {{200, 50, 0, 64, 100}};
+    fec_note_t out[8];
+    expect(note_fec_encoder_repeat(&enc, out, 8, 0) == 0, "nothing to repeat before the first batch");
+    note_fec_encoder_push(&enc, a, 2);
+    note_fec_encoder_push(&enc, b, 1);
+    size_t n = note_fec_encoder_repeat(&enc, out, 8, 150);
+    expect(n == 2 && out[0].start_ms == 300 && out[1].start_ms == 200, "repeats in send order, skips notes already played");
+    n = note_fec_encoder_repeat(&enc, out, 1, 150);
+    expect(n == 1 && out[0].start_ms == 300, "repeats stop at the room left in the frame");
+    n = note_fec_encoder_repeat(&enc, out, 8, 150);
+    expect(n == 1 && out[0].start_ms == 200 && !note_fec_encoder_pending(&enc, 0), "every note repeated depth times");
+
+    note_fec_encoder_t off;
+    note_fec_encoder_init(&off, 0);
+    note_fec_encoder_push(&off, a, 2);
+    expect(note_fec_encoder_repeat(&off, out, 8, 0) == 0 && !note_fec_encoder_pending(&off, 0) &&
+           note_fec_new_notes_limit(&off, NOTE_BATCH_MAX_NOTES) == NOTE_BATCH_MAX_NOTES,
+           "depth 0: plain batches");
+    note_fec_encoder_init(&off, 200);
+    expect(off.depth == NOTE_FEC_MAX_DEPTH, "depth clamped to NOTE_FEC_MAX_DEPTH");
+
+    note_fec_decoder_t dec;
+    note_fec_decoder_init(&dec);
+    bool first = note_fec_decoder_accept(&dec, &a[0]);
+    bool again = note_fec_decoder_accept(&dec, &a[0]);
+    fec_note_t other_part = a[0];
+    other_part.part_id = 1;
+    expect(first && !again && note_fec_decoder_accept(&dec, &other_part), "decoder drops repeats, keys on part");
+
+    sim_config_t clean = {0.0, 2, 1};
+    sim_result_t r = simulate(&clean);
+    expect(r.delivered == r.notes && r.recovered == 0 && r.doubled == 0, "lossless link: every note once");
+
+    sim_config_t plain = {0.2, 0, 2};
+    sim_config_t fec = {0.2, 2, 2};
+    sim_result_t rp = simulate(&plain);
+    sim_result_t rf = simulate(&fec);
+    expect(rf.doubled == 0, "20% loss: no note scheduled twice");
+    expect(rp.delivered < rp.notes * 85 / 100 && rf.delivered >= rf.notes * 98 / 100,
+           "20% loss: depth 2 delivers >= 98% (no FEC ~80%)");
+
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        sim_config_t cfg = {
+            .loss = argc > 2 ? atof(argv[2]) / 100.0 : 0.1,
+            .depth = (uint8_t)(argc > 3 ? atoi(argv[3]) : 1),
+            .seed = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 0) : 1,
+        };
+        if (cfg.depth > NOTE_FEC_MAX_DEPTH) {
+            fprintf(stderr, "depth 0-%d\n", NOTE_FEC_MAX_DEPTH);
+            return 2;
+        }
+        sim_result_t r = simulate(&cfg);
+        print_header();
+        print_result(&cfg, &r);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "sweep") == 0) {
+        printf("%d built-in songs x %d plays per row, look-ahead %d ms, batch window %d ms\n",
+               (int)TOTAL_SONGS, SIM_REPEATS, NOTE_LOOKAHEAD_MS, NOTE_BATCH_WINDOW_MS);
+        print_header();
+        for (int loss = 0; loss <= 50; loss += 10) {
+            for (uint8_t depth = 0; depth <= NOTE_FEC_MAX_DEPTH; depth++) {
+                sim_config_t cfg = {loss / 100.0, depth, 1};
+                sim_result_t r = simulate(&cfg);
+                print_result(&cfg, &r);
+            }
+        }
+        return 0;
+    }
+
+    fprintf(stderr, "usage: %s check | run [loss%%] [depth] [seed] | sweep\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,5 @@
+// Host build shim
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void* TaskHandle_t;
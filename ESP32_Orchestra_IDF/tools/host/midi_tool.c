@@ -0,0 +1,200 @@
+/*
+ * midi_tool - แปลง Standard MIDI File (type 0/1) เป็นเพลงของ Orchestra
+ * อ่านไฟล์ทีละ 256 byte ผ่าน smf_parser (ตัวเดียวกับที่ใช้บน Conductor)
+ *
+ *   midi_tool song.mid                       สรุป parts / จำนวนโน๊ต / ความยาว
+ *   midi_tool song.mid --c NAME              พิมพ์ note_event_t arrays สำหรับ midi_songs.h
+ *   midi_tool song.mid --osc out.osc         เขียน score แบบ binary (.osc)
+ *
+ * Options:
+ *   --tracks | --channels    แยก part ตาม track หรือ channel (ค่าเริ่มต้น: type 1 = track, type 0 = channel)
+ *   --map a,b,c,d            track/channel ของ PART_A..PART_D ("auto" หรือ "-" = ไม่ใช้)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "smf_parser.h"
+#include "score_codec.h"
+
+#define MAX_EVENTS     4096
+#define READ_SIZE      256
+#define MAX_BLOB_LEN   65536
+
+static score_note_t part_events[SMF_MAX_PARTS][MAX_EVENTS];
+static uint8_t blob[MAX_BLOB_LEN];
+
+static bool parse_map(const char* arg, smf_config_t* config) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    int part = 0;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        if (part >= SMF_MAX_PARTS) {
+            return false;
+        }
+        if (strcmp(tok, "auto") == 0) {
+            config->part_source[part] = SMF_SOURCE_AUTO;
+        } else if (strcmp(tok, "-") == 0) {
+            config->part_source[part] = SMF_SOURCE_NONE;
+        } else {
+            char* end;
+            long value = strtol(tok, &end, 10);
+            if (*end || value < 0 || value >= SMF_SOURCE_AUTO) {
+                return false;
+            }
+            config->part_source[part] = (uint8_t)value;
+        }
+        part++;
+    }
+    for (; part < SMF_MAX_PARTS; part++) {
+        config->part_source[part] = SMF_SOURCE_NONE;
+    }
+    return true;
+}
+
+static void print_c_arrays(const smf_parser_t* parser, const char* name) {
+    static const char* const suffix[SMF_MAX_PARTS] = {"a", "b", "c", "d"};
+    uint8_t part_count = 0;
+
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        if (parser->parts[p].count == 0) {
+            continue;
+        }
+        part_count = p + 1;
+        printf("// Part %c\n", 'A' + p);
+        printf("static const note_event_t %s_%s[] = {\n", name, suffix[p]);
+        for (uint16_t i = 0; i < parser->parts[p].count; i++) {
+            const score_note_t* e = &parser->parts[p].events[i];
+            printf("    {%d, %d, %d},\n", e->note, e->duration_ms, e->delay_ms);
+        }
+        printf("};\n\n");
+    }
+
+    printf("static const song_part_t %s_parts[] = {\n", name);
+    for (uint8_t p = 0; p < part_count; p++) {
+        if (parser->parts[p].count == 0) {
+            printf("    {NULL, 0, \"Part %c\"},\n", 'A' + p);
+        } else {
+            printf("    SONG_PART(%s_%s, \"Part %c\"),\n", name, suffix[p], 'A' + p);
+        }
+    }
+    printf("};\n");
+    printf("// all_songs[]: .tempo_bpm = %d, .part_count = %d, .parts = %s_parts\n",
+           smf_parser_tempo_bpm(parser), part_count, name);
+}
+
+static int write_osc(const smf_parser_t* parser, const char* path) {
+    score_part_src_t parts[SMF_MAX_PARTS];
+    uint8_t part_count = 0;
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        parts[p].events = parser->parts[p].events;
+        parts[p].event_count = parser->parts[p].count;
+        if (parts[p].event_count > 0) {
+            part_count = p + 1;
+        }
+    }
+
+    size_t len = score_encode(parts, part_count, smf_parser_tempo_bpm(parser), SCORE_FLAG_RLE,
+                              blob, sizeof(blob));
+    if (len == 0) {
+        fprintf(stderr, "score does not fit the .osc format\n");
+        return 1;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f || fwrite(blob, 1, len, f) != len) {
+        fprintf(stderr, "%s: write failed\n", path);
+        if (f) {
+            fclose(f);
+        }
+        return 1;
+    }
+    fclose(f);
+    printf("%s: %zu bytes\n", path, len);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* input = NULL;
+    const char* c_name = NULL;
+    const char* osc_path = NULL;
+    smf_config_t config = {SMF_MAP_AUTO, {SMF_SOURCE_AUTO, SMF_SOURCE_AUTO, SMF_SOURCE_AUTO, SMF_SOURCE_AUTO}};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tracks") == 0) {
+            config.mode = SMF_MAP_TRACKS;
+        } else if (strcmp(argv[i], "--channels") == 0) {
+            config.mode = SMF_MAP_CHANNELS;
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            if (!parse_map(argv[++i], &config)) {
+                fprintf(stderr, "bad --map: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--c") == 0 && i + 1 < argc) {
+            c_name = argv[++i];
+        } else if (strcmp(argv[i], "--osc") == 0 && i + 1 < argc) {
+            osc_path = argv[++i];
+        } else if (!input && argv[i][0] != '-') {
+            input = argv[i];
+        } else {
+            input = NULL;
+            break;
+        }
+    }
+    if (!input) {
+        fprintf(stderr, "usage: %s file.mid [--tracks|--channels] [--map a,b,c,d] [--c NAME] [--osc out.osc]\n",
+                argv[0]);
+        return 2;
+    }
+
+    FILE* f = fopen(input, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", input);
+        return 1;
+    }
+
+    static smf_parser_t parser;
+    smf_parser_init(&parser, &config);
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        smf_parser_set_part_buffer(&parser, p, part_events[p], MAX_EVENTS);
+    }
+
+    uint8_t chunk[READ_SIZE];
+    size_t n;
+    smf_result_t result = SMF_OK;
+    while (result == SMF_OK && (n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        result = smf_parser_feed(&parser, chunk, n);
+    }
+    fclose(f);
+    if (result == SMF_OK) {
+        result = smf_parser_finish(&parser);
+    }
+    if (result != SMF_OK) {
+        fprintf(stderr, "%s: %s\n", input, smf_result_name(result));
+        return 1;
+    }
+
+    if (c_name) {
+        print_c_arrays(&parser, c_name);
+    } else {
+        printf("SMF type %d, %d tracks, %d tempo changes, %d BPM\n", parser.format, parser.track_count,
+               parser.tempo_count, smf_parser_tempo_bpm(&parser));
+        for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+            const smf_part_t* part = &parser.parts[p];
+            if (part->count == 0) {
+                continue;
+            }
+            uint32_t length_ms = 0;
+            for (uint16_t i = 0; i < part->count; i++) {
+                length_ms += part->events[i].duration_ms + part->events[i].delay_ms;
+            }
+            printf("Part %c: %s %d, %d events, %lu ms%s\n", 'A' + p,
+                   (config.mode == SMF_MAP_CHANNELS || (config.mode == SMF_MAP_AUTO && parser.format == 0))
+                       ? "channel" : "track",
+                   part->source, part->count, (unsigned long)length_ms,
+                   part->overflow ? " (truncated)" : "");
+        }
+    }
+
+    return osc_path ? write_osc(&parser, osc_path) : 0;
+}
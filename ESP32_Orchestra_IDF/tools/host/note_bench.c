@@ -0,0 +1,153 @@
+/*
+ * note_bench - ตรวจตาราง note_table และวัดเวลาเตรียมโน๊ตก่อน/หลังใช้ตาราง บน PC
+ *
+ *   note_bench check       ทุกโน๊ตมี divider ที่ใช้ได้, ความถี่ตรงกับ midi_note_to_frequency
+ *   note_bench bench       powf + หา divider แบบ ledc_set_freq เทียบกับอ่านจากตาราง
+ *   note_bench dump        ตารางทั้ง 128 โน๊ต
+ *
+ * bench วัดเฉพาะส่วนคำนวณ - เวลาจริงรวม register write บนบอร์ดดูจาก LEDC_ONSET_BENCHMARK
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "orchestra_common.h"
+#include "note_table.h"
+
+#define BENCH_ROUNDS    200000
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double cents(double hz, double reference) {
+    return 1200.0 * log2(hz / reference);
+}
+
+static double clamp_hz(double hz) {
+    return hz < MIN_FREQUENCY ? MIN_FREQUENCY : hz > MAX_FREQUENCY ? MAX_FREQUENCY : hz;
+}
+
+// What ledc_set_freq does at every onset: integer Hz, pick a clock, divide
+static uint32_t runtime_divider(uint8_t note, uint8_t* clk_src) {
+    float frequency = midi_note_to_frequency(note);
+    if (frequency < MIN_FREQUENCY) frequency = MIN_FREQUENCY;
+    if (frequency > MAX_FREQUENCY) frequency = MAX_FREQUENCY;
+    uint32_t freq_hz = (uint32_t)frequency;
+
+    uint64_t div = ((uint64_t)NOTE_TABLE_APB_HZ << NOTE_TABLE_DIV_FRAC_BITS) / freq_hz / (1 << NOTE_TABLE_DUTY_BITS);
+    *clk_src = NOTE_CLK_APB;
+    if (div > NOTE_TABLE_DIV_MAX) {
+        div = ((uint64_t)NOTE_TABLE_REF_TICK_HZ << NOTE_TABLE_DIV_FRAC_BITS) / freq_hz / (1 << NOTE_TABLE_DUTY_BITS);
+        *clk_src = NOTE_CLK_REF_TICK;
+    }
+    return (uint32_t)div;
+}
+
+static double divider_hz(uint32_t div, uint8_t clk_src) {
+    double src = clk_src == NOTE_CLK_REF_TICK ? NOTE_TABLE_REF_TICK_HZ : NOTE_TABLE_APB_HZ;
+    return src * (1 << NOTE_TABLE_DIV_FRAC_BITS) / ((double)div * (1 << NOTE_TABLE_DUTY_BITS));
+}
+
+static int cmd_check(void) {
+    note_table_init(MIN_FREQUENCY, MAX_FREQUENCY);
+
+    bool all_playable = true;
+    bool pitch_exact = true;
+    double worst_table = 0;
+    double worst_runtime = 0;
+    for (int note = 1; note < NOTE_TABLE_SIZE; note++) {
+        const note_table_entry_t* entry = note_table_get((uint8_t)note);
+        all_playable &= entry->clock_divider >= NOTE_TABLE_DIV_MIN && entry->clock_divider <= NOTE_TABLE_DIV_MAX;
+        pitch_exact &= fabs(cents(entry->frequency, midi_note_to_frequency((uint8_t)note))) < 0.01;
+
+        double target = clamp_hz(entry->frequency);
+        double table_err = fabs(cents(entry->ledc_frequency, target));
+        worst_table = table_err > worst_table ? table_err : worst_table;
+
+        uint8_t clk_src;
+        uint32_t div = runtime_divider((uint8_t)note, &clk_src);
+        double runtime_err = fabs(cents(divider_hz(div, clk_src), target));
+        worst_runtime = runtime_err > worst_runtime ? runtime_err : worst_runtime;
+    }
+    expect(all_playable, "every note 1-127 has a divider in range");
+    expect(pitch_exact, "frequencies match midi_note_to_frequency");
+    expect(note_table_get(NOTE_REST)->clock_divider == 0 && note_table_get(128) == NULL,
+           "rest and out-of-range notes are not playable");
+    expect(note_table_get(57)->clk_src == NOTE_CLK_REF_TICK && note_table_get(81)->clk_src == NOTE_CLK_APB,
+           "low notes use REF_TICK, high notes APB");
+    expect(worst_table <= worst_runtime && worst_table < 3.0, "table pitch at least as close as ledc_set_freq");
+    printf("worst pitch error: table %.2f cents, ledc_set_freq %.2f cents\n", worst_table, worst_runtime);
+
+    return failures ? 1 : 0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmd_bench(void) {
+    volatile uint32_t sink = 0;
+    uint8_t clk_src;
+
+    double start = now_s();
+    note_table_init(MIN_FREQUENCY, MAX_FREQUENCY);
+    double build_s = now_s() - start;
+
+    start = now_s();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint8_t note = 36; note <= 96; note++) {
+            sink += runtime_divider(note, &clk_src) + clk_src;
+        }
+    }
+    double runtime_s = now_s() - start;
+
+    start = now_s();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint8_t note = 36; note <= 96; note++) {
+            const note_table_entry_t* entry = note_table_get(note);
+            sink += entry->clock_divider + entry->clk_src;
+        }
+    }
+    double table_s = now_s() - start;
+
+    double calls = (double)BENCH_ROUNDS * (96 - 36 + 1);
+    printf("%-28s %10s\n", "", "ns/note");
+    printf("%-28s %10.2f\n", "powf + divider (runtime)", runtime_s * 1e9 / calls);
+    printf("%-28s %10.2f\n", "note table lookup", table_s * 1e9 / calls);
+    printf("table build (once at boot): %.1f us\n", build_s * 1e6);
+    return sink == 0xFFFFFFFF; // Keep the loops alive
+}
+
+static int cmd_dump(void) {
+    note_table_init(MIN_FREQUENCY, MAX_FREQUENCY);
+    printf("%4s %10s %10s %8s %8s\n", "note", "Hz", "LEDC Hz", "divider", "clock");
+    for (int note = 0; note < NOTE_TABLE_SIZE; note++) {
+        const note_table_entry_t* entry = note_table_get((uint8_t)note);
+        printf("%4d %10.2f %10.2f %8lu %8s\n", note, entry->frequency, entry->ledc_frequency,
+               (unsigned long)entry->clock_divider, entry->clk_src == NOTE_CLK_REF_TICK ? "REF_TICK" : "APB");
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return cmd_bench();
+    }
+    if (argc >= 2 && strcmp(argv[1], "dump") == 0) {
+        return cmd_dump();
+    }
+
+    fprintf(stderr, "usage: %s check | bench | dump\n", argv[0]);
+    return 2;
+}
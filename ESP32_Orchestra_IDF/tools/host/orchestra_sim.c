@@ -0,0 +1,947 @@
+/*
+ * orchestra_sim - Conductor และ Musician หลายตัวรัน firmware จริงใน process เดียว บน PC
+ * ผ่าน ESP-NOW จำลอง (latency, jitter, loss) และนาฬิกาแต่ละบอร์ดเดินไม่ตรงกัน (skew ppm)
+ *
+ *   orchestra_sim check                                          join, sync, ทุกโน๊ตดัง, ผลซ้ำได้
+ *   orchestra_sim run [-v|-q] [musicians] [loss %] [skew ppm] [seed] [songs] [latency us] [jitter us]
+ *   orchestra_sim timing [json file|-] [musicians] [loss %] [skew ppm] [seed]
+ *   orchestra_sim stress [musicians] [parts] [PHY kbps] [tx queue] [seed]
+ *   orchestra_sim logcost [musicians] [seed] [songs]
+ *
+ * run พิมพ์ทุก note onset/offset ที่ LEDC ของแต่ละบอร์ด (เวลาจริงและเวลา conductor) แล้วสรุปท้าย
+ * songs = song ID คั่นด้วย comma เช่น 1,4 (ค่า default = ทุกเพลง built-in)
+ * timing เล่นทุกเพลงใน all_songs[] แล้ววัด onset error, skew ระหว่าง parts, ความยาวโน๊ต (ensemble_timing)
+ * stress ส่งเพลงสังเคราะห์ (stress_test.h) หนาขึ้นทีละระดับบนอากาศที่มี airtime และคิวส่งจำกัด
+ * แล้ววัด NO_MEM, latency ส่ง-รับ, เวลาใน receive callback, โน๊ตที่หาย/ช้า ต่อระดับ
+ * logcost เล่นเพลงเดียวกันด้วย firmware ที่ log ทุก packet (HOT_LOG_LEVEL INFO) และ build ปกติ
+ * แล้วเทียบ log ต่อ frame ที่รับ: จำนวนบรรทัด, byte บน UART, เวลา format บน PC, เวลาส่งที่ 115200 baud
+ *
+ * Firmware แต่ละบอร์ดเป็น copy ของ shared module ที่ dlopen แยกกัน: static state ไม่ปนกัน
+ * เหมือนบอร์ดจริงแต่ละตัว ส่วน esp_timer / FreeRTOS / ESP-NOW / LEDC มาจาก tools/host/sim
+ */
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "espnow_conductor.h"
+#include "song_library.h"
+#include "espnow_musician.h"
+#include "clock_sync.h"
+#include "note_scheduler.h"
+#include "rx_ring.h"
+#include "stress_test.h"
+#include "ensemble_timing.h"
+
+#define SIM_MAX_SONGS           16
+#define SIM_BOOT_SPREAD_US      500000      // Musicians power on 0-500 ms after the conductor
+#define SIM_READY_TIMEOUT_US    20000000LL  // Join + clock lock
+#define SIM_SONG_GAP_MS         1500        // Last notes ring out before the next song
+#define SIM_TIME_LIMIT_US       (30LL * 60 * 1000000)
+#define SIM_STRESS_TX_QUEUE     32          // Frames esp_now_send() holds before NO_MEM (sim_radio_config_t)
+#define SIM_POLL_MS             100
+#define SIM_UART_BAUD           115200      // Console of every board, 10 bits per byte
+#define SCENARIO_PRIORITY       5           // Where the conductor's button_task runs
+#define APP_MAIN_PRIORITY       1
+
+typedef struct {
+    int musicians;
+    double loss;
+    double skew_ppm;            // Every musician gets a skew in +-skew_ppm
+    uint32_t seed;
+    uint32_t latency_us;
+    uint32_t jitter_us;
+    uint8_t songs[SIM_MAX_SONGS];
+    int song_count;             // 0 = every built-in song
+    FILE* log;                  // Note log, NULL = none
+    uint32_t phy_rate_kbps;     // Airtime model, 0 = off (sim_radio_config_t)
+    uint8_t tx_queue;
+    bool broadcast_only;        // conductor_set_unicast(false): part traffic and score chunks broadcast
+    uint8_t stress_parts;       // Stress scores instead of songs, one per level
+    uint16_t stress_note_ms[SIM_MAX_SONGS];
+    int stress_levels;
+    const char* conductor_module;   // Firmware images, NULL = SIM_CONDUCTOR_MODULE / SIM_MUSICIAN_MODULE
+    const char* musician_module;
+} orchestra_config_t;
+
+typedef struct {
+    bool ready;                 // Every board joined and locked before SIM_READY_TIMEOUT_US
+    bool finished;              // Every song played before SIM_TIME_LIMIT_US
+    int64_t ready_us;
+    int songs_played;
+    uint32_t expected;          // Non-rest notes of the parts each board was assigned
+    uint32_t onsets;
+    uint32_t offsets;
+    uint32_t board_onsets[SIM_MAX_NODES];
+    uint32_t board_expected[SIM_MAX_NODES];
+    uint32_t hash;              // Every tone event with its true time (same seed = same hash)
+} orchestra_result_t;
+
+// Firmware entry points of one board (each board has its own copy)
+typedef struct {
+    bool (*start_song)(uint8_t song_id);
+    bool (*is_playing)(void);
+    conductor_state_t* (*state)(void);
+    const orchestra_song_t* (*find_song)(uint8_t song_id);
+    bool (*set_preload)(bool enabled);
+    bool (*set_unicast)(bool enabled);
+    const orchestra_song_t* (*stress_build)(uint8_t part_count, uint16_t note_ms, uint16_t notes_per_part);
+} conductor_api_t;
+
+typedef struct {
+    musician_state_t* (*state)(void);
+    const clock_sync_state_t* (*sync)(void);
+    int64_t (*to_conductor_us)(int64_t local_time_us);
+    const note_scheduler_stats_t* (*scheduler)(void);
+    const rx_ring_stats_t* (*rx)(void);
+} musician_api_t;
+
+// One stress level: radio and firmware counters of that song only
+typedef struct {
+    uint16_t note_ms;
+    uint32_t notes_per_part;
+    int64_t elapsed_us;         // Song start to end
+    sim_radio_stats_t radio;
+    uint32_t send_failures;     // Conductor
+    uint32_t send_no_mem;
+    uint32_t rx_overflows;      // Every musician
+    uint32_t queue_overflows;
+    uint32_t notes_late;
+} stress_level_t;
+
+typedef struct {
+    const orchestra_config_t* config;
+    orchestra_result_t* result;
+    sim_node_t* conductor;
+    conductor_api_t conductor_api;
+    sim_node_t* boards[SIM_MAX_NODES];
+    musician_api_t musician_api[SIM_MAX_NODES];
+
+    // orchestra_sim timing
+    bool measure;
+    ensemble_song_t* measuring;     // Song being played, NULL between songs
+    int measured_count;
+    struct {
+        uint8_t song_id;
+        uint32_t start_ms;
+        ensemble_report_t report;
+    } measured[SIM_MAX_SONGS];
+    ensemble_report_t total;
+
+    // orchestra_sim stress (levels[i] is measured[i])
+    stress_level_t levels[SIM_MAX_SONGS];
+    int level_count;
+} orchestra_run_t;
+
+// orchestra_sim logcost: log output of every board over one run of one firmware build
+typedef struct {
+    const char* build;
+    uint32_t frames;            // Frame copies delivered to a receive callback
+    uint32_t onsets;
+    uint32_t lines;
+    uint64_t bytes;
+    uint64_t ns;
+    double busiest_uart;        // Largest share of the run one board spends printing at SIM_UART_BAUD
+    uint32_t hash;
+    bool finished;
+} log_cost_t;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static uint32_t rng_state = 1;
+
+static double rng_uniform(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+// --- Firmware images ---
+
+static char image_dir[64];
+static int image_count = 0;
+
+static void remove_image_dir(void) {
+    rmdir(image_dir);
+}
+
+// dlopen() returns the already loaded object for the same file, so every board gets its own copy
+static void* load_firmware(const char* path) {
+    if (image_dir[0] == '\0') {
+        snprintf(image_dir, sizeof(image_dir), "/tmp/orchestra_sim.XXXXXX");
+        if (mkdtemp(image_dir) == NULL) {
+            sim_fatal("cannot create a directory for firmware images");
+        }
+        atexit(remove_image_dir);
+    }
+    char copy[96];
+    snprintf(copy, sizeof(copy), "%s/board%d.so", image_dir, image_count++);
+
+    FILE* in = fopen(path, "rb");
+    FILE* out = fopen(copy, "wb");
+    if (in == NULL || out == NULL) {
+        sim_fatal("cannot copy firmware %s", path);
+    }
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        fwrite(buf, 1, n, out);
+    }
+    fclose(in);
+    fclose(out);
+
+    void* image = dlopen(copy, RTLD_NOW | RTLD_LOCAL);
+    unlink(copy); // Stays mapped
+    if (image == NULL) {
+        sim_fatal("dlopen: %s", dlerror());
+    }
+    return image;
+}
+
+static void* firmware_symbol(const sim_node_t* node, const char* name) {
+    void* symbol = dlsym(node->module, name);
+    if (symbol == NULL) {
+        sim_fatal("%s: firmware has no %s", node->name, name);
+    }
+    return symbol;
+}
+
+// --- Note log ---
+
+static void on_tone(const sim_tone_t* tone, void* arg) {
+    orchestra_run_t* run = arg;
+    orchestra_result_t* result = run->result;
+    int board = tone->node->index;
+
+    if (tone->on) {
+        result->onsets++;
+        result->board_onsets[board]++;
+    } else {
+        result->offsets++;
+    }
+    const uint32_t fields[] = {(uint32_t)tone->true_us, (uint32_t)(tone->true_us >> 32), (uint32_t)board,
+                               tone->channel, tone->on, tone->note};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        result->hash = (result->hash ^ fields[i]) * 16777619u;   // FNV-1a, one word at a time
+    }
+
+    if (run->measuring) {
+        int64_t conductor_us = sim_node_local_us(run->conductor, tone->true_us);
+        if (tone->on) {
+            ensemble_song_note_on(run->measuring, (uint8_t)board, tone->channel, tone->note, conductor_us);
+        } else {
+            ensemble_song_note_off(run->measuring, (uint8_t)board, tone->channel, conductor_us);
+        }
+    }
+
+    if (run->config->log) {
+        const musician_state_t* state = run->musician_api[board].state ? run->musician_api[board].state() : NULL;
+        fprintf(run->config->log, "%12.3f %12.3f %-4s %3d %5u %-3s %4u %9.2f\n", tone->true_us / 1000.0,
+                sim_node_local_us(run->conductor, tone->true_us) / 1000.0, tone->node->name,
+                state ? state->musician_id : -1, tone->channel, tone->on ? "on" : "off", tone->note,
+                tone->frequency);
+    }
+}
+
+// --- Scenario: the conductor's button, pressed once per song ---
+
+static bool band_ready(const orchestra_run_t* run) {
+    if (run->conductor_api.state()->connected_musicians != run->config->musicians) {
+        return false;
+    }
+    for (int i = 1; i <= run->config->musicians; i++) {
+        if (run->musician_api[i].state()->musician_id == MUSICIAN_ID_NONE ||
+            !run->musician_api[i].sync()->is_locked) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t part_notes(const orchestra_song_t* song, uint8_t part_mask) {
+    uint32_t notes = 0;
+    for (uint8_t part = 0; part < song->part_count; part++) {
+        if (!(part_mask & (1u << part))) {
+            continue;
+        }
+        for (uint16_t i = 0; i < song->parts[part].event_count; i++) {
+            notes += song->parts[part].events[i].note != NOTE_REST;
+        }
+    }
+    return notes;
+}
+
+static void play_song(orchestra_run_t* run, uint8_t song_id) {
+    const orchestra_config_t* config = run->config;
+    orchestra_result_t* result = run->result;
+
+    if (!run->conductor_api.start_song(song_id)) {
+        if (config->log) {
+            fprintf(config->log, "# song %u did not start\n", song_id);
+        }
+        return;
+    }
+    const orchestra_song_t* song = run->conductor_api.find_song(song_id);
+    static ensemble_song_t measuring;
+    if (run->measure && run->measured_count < SIM_MAX_SONGS) {
+        ensemble_song_begin(&measuring, song, run->conductor_api.state()->song_start_time);
+        run->measuring = &measuring;
+    }
+    if (config->log) {
+        fprintf(config->log, "# song %u \"%s\" starts at conductor %lu ms, parts:", song_id, song->song_name,
+                (unsigned long)run->conductor_api.state()->song_start_time);
+    }
+    for (int i = 1; i <= config->musicians; i++) {
+        const musician_state_t* state = run->musician_api[i].state();
+        uint32_t notes = part_notes(song, state->part_mask);
+        result->expected += notes;
+        result->board_expected[i] += notes;
+        if (run->measuring) {
+            ensemble_song_add_board(run->measuring, (uint8_t)i, state->part_mask);
+        }
+        if (config->log) {
+            fprintf(config->log, " %s=0x%02x", run->boards[i]->name, state->part_mask);
+        }
+    }
+    if (config->log) {
+        fprintf(config->log, "\n");
+    }
+
+    while (run->conductor_api.is_playing()) {
+        vTaskDelay(pdMS_TO_TICKS(SIM_POLL_MS));
+    }
+    vTaskDelay(pdMS_TO_TICKS(SIM_SONG_GAP_MS));
+    result->songs_played++;
+    if (run->measuring) {
+        ensemble_report_t* report = &run->measured[run->measured_count].report;
+        ensemble_report_init(report);
+        ensemble_song_analyze(run->measuring, report, &run->total);
+        run->measured[run->measured_count].song_id = song_id;
+        run->measured[run->measured_count].start_ms = run->measuring->start_ms;
+        run->measured_count++;
+        run->measuring = NULL;
+    }
+    if (config->log) {
+        fprintf(config->log, "# song %u ends at conductor %lu ms\n", song_id,
+                (unsigned long)(esp_timer_get_time() / 1000));
+    }
+}
+
+// Firmware counters summed over the conductor and every musician, radio counters of the whole medium
+static void stress_snapshot(const orchestra_run_t* run, stress_level_t* level) {
+    const conductor_state_t* conductor = run->conductor_api.state();
+    level->radio = sim_radio_stats;
+    level->send_failures = conductor->send_failures;
+    level->send_no_mem = conductor->send_no_mem;
+    level->rx_overflows = level->queue_overflows = level->notes_late = 0;
+    for (int i = 1; i <= run->config->musicians; i++) {
+        level->rx_overflows += run->musician_api[i].rx()->overflows;
+        level->queue_overflows += run->musician_api[i].scheduler()->queue_overflows;
+        level->notes_late += run->musician_api[i].scheduler()->notes_late;
+    }
+}
+
+static void play_stress_level(orchestra_run_t* run, uint16_t note_ms) {
+    uint16_t notes = STRESS_LEVEL_MS / note_ms;
+    if (run->level_count >= SIM_MAX_SONGS ||
+        !run->conductor_api.stress_build(run->config->stress_parts, note_ms, notes)) {
+        return;
+    }
+
+    stress_level_t before;
+    stress_snapshot(run, &before);
+    latency_hist_reset(&sim_radio_stats.latency_us);
+    latency_hist_reset(&sim_radio_stats.callback_ns);
+    int64_t start_us = sim_now_us();
+    play_song(run, STRESS_SONG_ID);
+    if (run->measured_count != run->level_count + 1) {
+        return; // Did not start
+    }
+
+    stress_level_t* level = &run->levels[run->level_count++];
+    stress_snapshot(run, level);
+    level->note_ms = note_ms;
+    level->notes_per_part = notes < STRESS_MAX_NOTES ? notes : STRESS_MAX_NOTES;
+    level->elapsed_us = sim_now_us() - start_us - SIM_SONG_GAP_MS * 1000LL;
+    level->radio.frames_sent -= before.radio.frames_sent;
+    level->radio.broadcasts -= before.radio.broadcasts;
+    level->radio.deliveries -= before.radio.deliveries;
+    level->radio.losses -= before.radio.losses;
+    level->radio.unicast_retries -= before.radio.unicast_retries;
+    level->radio.unicast_failures -= before.radio.unicast_failures;
+    level->radio.no_mem -= before.radio.no_mem;
+    level->radio.airtime_us -= before.radio.airtime_us;
+    level->send_failures -= before.send_failures;
+    level->send_no_mem -= before.send_no_mem;
+    level->rx_overflows -= before.rx_overflows;
+    level->queue_overflows -= before.queue_overflows;
+    level->notes_late -= before.notes_late;
+}
+
+static void scenario_task(void* arg) {
+    orchestra_run_t* run = arg;
+    const orchestra_config_t* config = run->config;
+
+    while (!band_ready(run)) {
+        if (sim_now_us() > SIM_READY_TIMEOUT_US) {
+            sim_stop();
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(SIM_POLL_MS));
+    }
+    run->result->ready = true;
+    run->result->ready_us = sim_now_us();
+    if (config->broadcast_only) {
+        run->conductor_api.set_unicast(false);
+    }
+
+    if (config->stress_levels > 0) {
+        run->conductor_api.set_preload(false);   // Every note goes through the radio
+        for (int i = 0; i < config->stress_levels; i++) {
+            play_stress_level(run, config->stress_note_ms[i]);
+        }
+    } else if (config->song_count > 0) {
+        for (int i = 0; i < config->song_count; i++) {
+            play_song(run, config->songs[i]);
+        }
+    } else {
+        for (size_t i = 0; i < TOTAL_SONGS; i++) {
+            play_song(run, all_songs[i].song_id);
+        }
+    }
+    run->result->finished = true;
+    sim_stop();
+}
+
+// --- One simulated concert ---
+
+static void run_orchestra(const orchestra_config_t* config, orchestra_result_t* result, orchestra_run_t* run,
+                          bool measure) {
+    for (int i = 0; i < run->measured_count; i++) {
+        ensemble_report_free(&run->measured[i].report);
+    }
+    ensemble_report_free(&run->total);
+    memset(result, 0, sizeof(*result));
+    memset(run, 0, sizeof(*run));
+    run->measure = measure;
+    result->hash = 2166136261u;
+    run->config = config;
+    run->result = result;
+
+    sim_radio.latency_us = config->latency_us;
+    sim_radio.jitter_us = config->jitter_us;
+    sim_radio.loss = config->loss;
+    sim_radio.seed = config->seed;
+    sim_radio.phy_rate_kbps = config->phy_rate_kbps;
+    sim_radio.tx_queue = config->tx_queue;
+    sim_reset();
+    sim_set_tone_hook(on_tone, run);
+
+    rng_state = config->seed ? config->seed : 1;
+    run->conductor = sim_node_create("C", 0, config->seed * 31 + 1);
+    run->conductor->module = load_firmware(config->conductor_module ? config->conductor_module : SIM_CONDUCTOR_MODULE);
+    run->conductor_api.start_song = firmware_symbol(run->conductor, "start_song");
+    run->conductor_api.is_playing = firmware_symbol(run->conductor, "is_conductor_playing");
+    run->conductor_api.state = firmware_symbol(run->conductor, "get_conductor_state");
+    run->conductor_api.find_song = firmware_symbol(run->conductor, "song_library_find");
+    run->conductor_api.set_preload = firmware_symbol(run->conductor, "conductor_set_preload");
+    run->conductor_api.set_unicast = firmware_symbol(run->conductor, "conductor_set_unicast");
+    run->conductor_api.stress_build = firmware_symbol(run->conductor, "stress_score_build");
+    run->boards[0] = run->conductor;
+    sim_node_boot(run->conductor, 0, (void (*)(void))firmware_symbol(run->conductor, "app_main"), APP_MAIN_PRIORITY);
+
+    for (int i = 1; i <= config->musicians; i++) {
+        char name[8];
+        snprintf(name, sizeof(name), "M%d", i);
+        double skew = config->skew_ppm * (2 * rng_uniform() - 1);
+        sim_node_t* node = sim_node_create(name, skew, config->seed * 31 + 1 + i);
+        node->module = load_firmware(config->musician_module ? config->musician_module : SIM_MUSICIAN_MODULE);
+        run->boards[i] = node;
+        run->musician_api[i].state = firmware_symbol(node, "get_musician_state");
+        run->musician_api[i].sync = firmware_symbol(node, "clock_sync_get_state");
+        run->musician_api[i].to_conductor_us = firmware_symbol(node, "local_time_to_conductor_us");
+        run->musician_api[i].scheduler = firmware_symbol(node, "note_scheduler_get_stats");
+        run->musician_api[i].rx = firmware_symbol(node, "rx_ring_get_stats");
+        int64_t boot_us = (int64_t)(rng_uniform() * SIM_BOOT_SPREAD_US);
+        sim_node_boot(node, boot_us, (void (*)(void))firmware_symbol(node, "app_main"), APP_MAIN_PRIORITY);
+    }
+
+    sim_task_create(run->conductor, "scenario", scenario_task, run, SCENARIO_PRIORITY);
+    sim_run_until(SIM_TIME_LIMIT_US);
+}
+
+// Conductor time a musician estimates now minus the conductor's real clock (after run_orchestra)
+static int64_t sync_error_us(const orchestra_run_t* run, int board) {
+    int64_t now_us = sim_now_us();
+    int64_t local_us = sim_node_local_us(run->boards[board], now_us);
+    return run->musician_api[board].to_conductor_us(local_us) - sim_node_local_us(run->conductor, now_us);
+}
+
+// Every board still locked, and both the real and the estimated offset error under the lock threshold
+static bool sync_within_lock(const orchestra_run_t* run) {
+    bool ok = true;
+    for (int i = 1; i <= run->config->musicians; i++) {
+        const clock_sync_state_t* sync = run->musician_api[i].sync();
+        int64_t error_us = sync_error_us(run, i);
+        ok &= sync->is_locked && sync->offset_std_us < CLOCK_SYNC_LOCK_STD_US &&
+              llabs(error_us) < CLOCK_SYNC_LOCK_STD_US;
+    }
+    return ok;
+}
+
+static void print_summary(FILE* out, const orchestra_run_t* run) {
+    const orchestra_config_t* config = run->config;
+    const orchestra_result_t* result = run->result;
+    fprintf(out, "# %d musicians, loss %.1f%%, skew +-%.0f ppm, latency %lu+%lu us, seed %lu\n",
+            config->musicians, config->loss * 100, config->skew_ppm, (unsigned long)config->latency_us,
+            (unsigned long)config->jitter_us, (unsigned long)config->seed);
+    if (!result->ready) {
+        fprintf(out, "# band not ready after %lld ms (joined %u)\n", SIM_READY_TIMEOUT_US / 1000,
+                run->conductor_api.state()->connected_musicians);
+    } else {
+        fprintf(out, "# ready at %.1f ms, %d songs played%s\n", result->ready_us / 1000.0, result->songs_played,
+                result->finished ? "" : " (time limit reached)");
+    }
+    fprintf(out, "# %-4s %4s %8s %6s %9s %9s %8s %6s %8s\n", "", "id", "skew ppm", "parts", "expected", "onsets",
+            "late", "sync", "offset");
+    for (int i = 1; i <= config->musicians; i++) {
+        const sim_node_t* node = run->boards[i];
+        const musician_state_t* state = run->musician_api[i].state();
+        const clock_sync_state_t* sync = run->musician_api[i].sync();
+        const note_scheduler_stats_t* scheduler = run->musician_api[i].scheduler();
+        fprintf(out, "# %-4s %4d %8.1f %#6x %9lu %9lu %8lu %6s %6ldus\n", node->name,
+                state->musician_id == MUSICIAN_ID_NONE ? -1 : state->musician_id, node->skew_ppm,
+                state->part_mask, (unsigned long)result->board_expected[i], (unsigned long)result->board_onsets[i],
+                (unsigned long)scheduler->notes_late, sync->is_locked ? "locked" : "-", (long)sync->offset_std_us);
+    }
+    fprintf(out, "# notes %lu of %lu sounded, %lu ended, hash %08lx\n", (unsigned long)result->onsets,
+            (unsigned long)result->expected, (unsigned long)result->offsets, (unsigned long)result->hash);
+    fprintf(out, "# radio: %lu frames (%lu broadcast), %lu delivered, %lu lost, %lu unicast retries, %lu failed\n",
+            (unsigned long)sim_radio_stats.frames_sent, (unsigned long)sim_radio_stats.broadcasts,
+            (unsigned long)sim_radio_stats.deliveries, (unsigned long)sim_radio_stats.losses,
+            (unsigned long)sim_radio_stats.unicast_retries, (unsigned long)sim_radio_stats.unicast_failures);
+}
+
+static void print_stress_header(FILE* out) {
+    fprintf(out, "%7s %7s %8s %5s %6s | %-22s | %-13s | %-26s | %s\n", "", "", "", "", "", "send->recv latency us",
+            "callback ns", "notes", "onset us");
+    fprintf(out, "%7s %7s %8s %5s %6s | %6s %6s %8s | %6s %6s | %6s %6s %4s %4s %4s | %6s\n", "note ms", "notes/s",
+            "frames/s", "air%", "NO_MEM", "p50", "p99", "max", "p50", "p99", "notes", "played", "late", "rxov", "qov",
+            "p99");
+}
+
+static void print_stress_row(FILE* out, const stress_level_t* level, const ensemble_report_t* report) {
+    double seconds = level->elapsed_us / 1e6;
+    ensemble_summary_t onset;
+    ensemble_summarize(&report->onset_error_us, &onset);
+    fprintf(out, "%7u %7.0f %8.0f %5.1f %6lu | %6lu %6lu %8lu | %6lu %6lu | %6lu %6lu %4lu %4lu %4lu | %6ld\n",
+            level->note_ms, report->notes / seconds, level->radio.frames_sent / seconds,
+            100.0 * level->radio.airtime_us / level->elapsed_us, (unsigned long)level->send_no_mem,
+            (unsigned long)latency_hist_percentile(&level->radio.latency_us, 500),
+            (unsigned long)latency_hist_percentile(&level->radio.latency_us, 990),
+            (unsigned long)level->radio.latency_us.max,
+            (unsigned long)latency_hist_percentile(&level->radio.callback_ns, 500),
+            (unsigned long)latency_hist_percentile(&level->radio.callback_ns, 990),
+            (unsigned long)report->notes, (unsigned long)report->played, (unsigned long)level->notes_late,
+            (unsigned long)level->rx_overflows, (unsigned long)level->queue_overflows, (long)onset.p99);
+}
+
+static double uart_us(uint64_t bytes) {
+    return bytes * 10 * 1e6 / SIM_UART_BAUD;
+}
+
+// Same config with the given firmware, every ESP_LOGx up to INFO formatted into /dev/null
+static void measure_log_cost(orchestra_config_t* config, const char* build, const char* conductor_module,
+                             const char* musician_module, log_cost_t* cost) {
+    static orchestra_run_t run;
+    orchestra_result_t result;
+    esp_log_level_t level = sim_log_level;
+    FILE* sink = fopen("/dev/null", "w");
+    if (sink == NULL) {
+        sim_fatal("cannot open /dev/null");
+    }
+    config->conductor_module = conductor_module;
+    config->musician_module = musician_module;
+    sim_log_level = ESP_LOG_INFO;
+    sim_log_file = sink;
+    run_orchestra(config, &result, &run, false);
+    sim_log_file = NULL;
+    sim_log_level = level;
+    fclose(sink);
+
+    memset(cost, 0, sizeof(*cost));
+    cost->build = build;
+    cost->frames = sim_radio_stats.deliveries;
+    cost->onsets = result.onsets;
+    cost->hash = result.hash;
+    cost->finished = result.ready && result.finished;
+    int64_t elapsed_us = sim_now_us();
+    for (int i = 0; i <= config->musicians; i++) {
+        const sim_node_t* node = run.boards[i];
+        cost->lines += node->log_lines;
+        cost->bytes += node->log_bytes;
+        cost->ns += node->log_ns;
+        double share = uart_us(node->log_bytes) / elapsed_us;
+        if (share > cost->busiest_uart) {
+            cost->busiest_uart = share;
+        }
+    }
+}
+
+static void print_log_cost_header(FILE* out) {
+    fprintf(out, "%-9s %7s %7s %8s | %-32s | %s\n", "", "frames", "notes", "lines", "per received frame",
+            "busiest UART");
+    fprintf(out, "%-9s %7s %7s %8s | %7s %7s %8s %8s | %s\n", "build", "", "", "", "lines", "bytes", "host ns",
+            "UART us", "%");
+}
+
+// Periodic status and debug output stays, what goes is the packet path
+static log_cost_t log_cost_saved(const log_cost_t* before, const log_cost_t* after) {
+    log_cost_t saved = *before;
+    saved.build = "saved";
+    saved.lines -= after->lines;
+    saved.bytes -= after->bytes;
+    saved.ns = before->ns > after->ns ? before->ns - after->ns : 0;
+    saved.busiest_uart -= after->busiest_uart;
+    return saved;
+}
+
+static void print_log_cost_row(FILE* out, const log_cost_t* cost) {
+    double frames = cost->frames ? cost->frames : 1;
+    fprintf(out, "%-9s %7lu %7lu %8lu | %7.2f %7.1f %8.0f %8.1f | %5.1f\n", cost->build,
+            (unsigned long)cost->frames, (unsigned long)cost->onsets, (unsigned long)cost->lines,
+            cost->lines / frames, cost->bytes / frames, cost->ns / frames, uart_us(cost->bytes) / frames,
+            100 * cost->busiest_uart);
+}
+
+static orchestra_config_t default_config(void) {
+    orchestra_config_t config = {
+        .musicians = 4,
+        .loss = 0,
+        .skew_ppm = 20,
+        .seed = 1,
+        .latency_us = 1500,
+        .jitter_us = 500,
+    };
+    return config;
+}
+
+static int cmd_check(void) {
+    static orchestra_run_t run;
+    orchestra_result_t result;
+    sim_log_level = ESP_LOG_NONE;
+
+    orchestra_config_t config = default_config();
+    config.songs[config.song_count++] = SONG_TWINKLE_STAR;
+    run_orchestra(&config, &result, &run, true);
+    expect(result.ready && result.ready_us < 10000000, "4 boards join and lock within 10 s");
+    bool distinct = true;
+    for (int i = 1; i <= config.musicians; i++) {
+        for (int j = 1; j < i; j++) {
+            distinct &= run.musician_api[i].state()->musician_id != run.musician_api[j].state()->musician_id;
+        }
+    }
+    expect(distinct, "every board got its own musician ID");
+    expect(result.finished && result.songs_played == 1, "song played to the end");
+    expect(result.expected > 0 && result.onsets == result.expected, "lossless: every note sounds exactly once");
+    expect(result.offsets == result.onsets, "every note ends");
+    ensemble_summary_t onset, skew, length;
+    ensemble_summarize(&run.total.onset_error_us, &onset);
+    ensemble_summarize(&run.total.skew_us, &skew);
+    ensemble_summarize(&run.total.length_error_us, &length);
+    expect(run.total.played == result.expected && run.total.extra == 0, "timing: every onset matches its intended note");
+    expect(onset.count > 0 && onset.max < 2000, "timing: onset error < 2 ms");
+    expect(skew.count > 0 && skew.max < 2000, "timing: inter-part skew < 2 ms");
+    expect(length.count == onset.count && length.max < 1000, "timing: note length error < 1 ms");
+    expect(sync_within_lock(&run), "clock sync: offset error and std < 500 us");
+    uint32_t first_hash = result.hash;
+
+    run_orchestra(&config, &result, &run, false);
+    expect(result.hash == first_hash, "same seed gives the same onsets");
+
+    config.loss = 0.10;
+    config.skew_ppm = 50;
+    config.seed = 7;
+    config.song_count = 0;
+    config.songs[config.song_count++] = SONG_MARY_LAMB;
+    run_orchestra(&config, &result, &run, false);
+    expect(result.ready && result.finished, "10% loss, 50 ppm: band joins and plays");
+    expect(result.onsets >= result.expected * 95 / 100 && result.onsets <= result.expected,
+           "10% loss: >= 95% of notes sound, none twice");
+
+    // Two boards per part, chunks broadcast: a board that lost one must still get the whole score
+    config = default_config();
+    config.musicians = 8;
+    config.loss = 0.10;
+    config.broadcast_only = true;
+    config.songs[config.song_count++] = SONG_TWINKLE_STAR;
+    bool every_board = true;
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        config.seed = seed;
+        run_orchestra(&config, &result, &run, false);
+        every_board &= result.ready && result.finished;
+        for (int i = 1; i <= config.musicians; i++) {
+            every_board &= result.board_onsets[i] >= result.board_expected[i] * 90 / 100;
+        }
+    }
+    expect(every_board, "doubled parts, 10% loss: every board plays its part");
+
+    latency_hist_t hist;
+    latency_hist_reset(&hist);
+    for (uint32_t value = 1; value <= 1000; value++) {
+        latency_hist_add(&hist, value);
+    }
+    uint32_t p50 = latency_hist_percentile(&hist, 500);
+    expect(hist.count == 1000 && hist.min == 1 && hist.max == 1000 && latency_hist_mean(&hist) == 500,
+           "latency_hist: count, min, max, mean");
+    expect(p50 >= 500 && p50 <= 500 * 5 / 4 && latency_hist_percentile(&hist, 1000) == 1000,
+           "latency_hist: percentiles within a sub-bucket");
+
+    // Airtime model: a light level gets through untouched, the densest one saturates the medium
+    config = default_config();
+    config.phy_rate_kbps = 1000;
+    config.tx_queue = SIM_STRESS_TX_QUEUE;
+    config.stress_parts = STRESS_PARTS;
+    config.stress_note_ms[config.stress_levels++] = 62;
+    config.stress_note_ms[config.stress_levels++] = 4;
+    run_orchestra(&config, &result, &run, true);
+    expect(result.finished && run.level_count == 2, "stress: both levels played");
+    const stress_level_t* light = &run.levels[0];
+    const stress_level_t* dense = &run.levels[1];
+    expect(light->send_no_mem == 0 && run.measured[0].report.played == run.measured[0].report.notes &&
+           light->notes_late == 0, "stress 62 ms: no NO_MEM, every note on time");
+    expect(light->radio.latency_us.count > 0 && light->radio.latency_us.min >= 192 + 43 * 8,
+           "stress: no frame arrives faster than its airtime");
+    expect(dense->send_no_mem > 0 || dense->notes_late > 0 ||
+           run.measured[1].report.played < run.measured[1].report.notes, "stress 4 ms: saturation shows");
+    expect(dense->radio.airtime_us * light->elapsed_us > 2 * light->radio.airtime_us * dense->elapsed_us,
+           "stress: denser level keeps the air busier");
+
+    // Packet-path logging: the default build prints a fraction of the per-packet lines and plays the same notes
+    config = default_config();
+    config.songs[config.song_count++] = SONG_TWINKLE_STAR;
+    log_cost_t verbose, stripped;
+    measure_log_cost(&config, "verbose", SIM_CONDUCTOR_VERBOSE_MODULE, SIM_MUSICIAN_VERBOSE_MODULE, &verbose);
+    measure_log_cost(&config, "stripped", NULL, NULL, &stripped);
+    expect(verbose.finished && stripped.finished, "logcost: both builds play the song");
+    expect(verbose.onsets > 0 && verbose.lines >= stripped.lines + 2 * verbose.onsets,
+           "logcost: stripped build saves >= 2 lines per note");
+    expect(stripped.hash == verbose.hash, "logcost: log level changes no onset");
+
+    return failures ? 1 : 0;
+}
+
+static int cmd_run(int argc, char** argv) {
+    static orchestra_run_t run;
+    orchestra_result_t result;
+    orchestra_config_t config = default_config();
+    sim_log_level = ESP_LOG_WARN;
+
+    const char* args[8];
+    int count = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            sim_log_level = ESP_LOG_INFO;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            sim_log_level = ESP_LOG_NONE;
+        } else if (count < 8) {
+            args[count++] = argv[i];
+        }
+    }
+    if (count > 0) config.musicians = atoi(args[0]);
+    if (count > 1) config.loss = atof(args[1]) / 100.0;
+    if (count > 2) config.skew_ppm = atof(args[2]);
+    if (count > 3) config.seed = (uint32_t)strtoul(args[3], NULL, 0);
+    if (count > 4 && strcmp(args[4], "all") != 0) {
+        char songs[64];
+        snprintf(songs, sizeof(songs), "%s", args[4]);
+        for (char* id = strtok(songs, ","); id && config.song_count < SIM_MAX_SONGS; id = strtok(NULL, ",")) {
+            config.songs[config.song_count++] = (uint8_t)atoi(id);
+        }
+    }
+    if (count > 5) config.latency_us = (uint32_t)strtoul(args[5], NULL, 0);
+    if (count > 6) config.jitter_us = (uint32_t)strtoul(args[6], NULL, 0);
+    if (config.musicians < 1 || config.musicians > SIM_MAX_NODES - 1) {
+        fprintf(stderr, "musicians: 1-%d\n", SIM_MAX_NODES - 1);
+        return 2;
+    }
+
+    config.log = stdout;
+    fprintf(stdout, "# %10s %12s %-4s %3s %5s %-3s %4s %9s\n", "true ms", "conductor ms", "board", "id", "voice",
+            "", "note", "Hz");
+    run_orchestra(&config, &result, &run, false);
+    print_summary(stdout, &run);
+    return result.ready && result.finished ? 0 : 1;
+}
+
+static int cmd_timing(int argc, char** argv) {
+    static orchestra_run_t run;
+    orchestra_result_t result;
+    orchestra_config_t config = default_config();
+    sim_log_level = ESP_LOG_NONE;
+
+    const char* json_path = argc > 0 ? argv[0] : NULL;
+    if (argc > 1) config.musicians = atoi(argv[1]);
+    if (argc > 2) config.loss = atof(argv[2]) / 100.0;
+    if (argc > 3) config.skew_ppm = atof(argv[3]);
+    if (argc > 4) config.seed = (uint32_t)strtoul(argv[4], NULL, 0);
+    if (config.musicians < 1 || config.musicians > SIM_MAX_NODES - 1) {
+        fprintf(stderr, "musicians: 1-%d\n", SIM_MAX_NODES - 1);
+        return 2;
+    }
+
+    run_orchestra(&config, &result, &run, true);
+    if (!result.ready || !result.finished) {
+        print_summary(stderr, &run);
+        return 1;
+    }
+
+    FILE* table = json_path && strcmp(json_path, "-") == 0 ? stderr : stdout;
+    fprintf(table, "%d musicians, loss %.1f%%, skew +-%.0f ppm, latency %lu+%lu us, seed %lu\n", config.musicians,
+            config.loss * 100, config.skew_ppm, (unsigned long)config.latency_us, (unsigned long)config.jitter_us,
+            (unsigned long)config.seed);
+    ensemble_print_header(table);
+    for (int i = 0; i < run.measured_count; i++) {
+        char name[40];
+        const orchestra_song_t* song = get_song_by_id(run.measured[i].song_id);
+        snprintf(name, sizeof(name), "%u %s", run.measured[i].song_id, song ? song->song_name : "?");
+        ensemble_print_row(table, name, &run.measured[i].report);
+    }
+    ensemble_print_row(table, "all songs", &run.total);
+
+    if (json_path) {
+        FILE* json = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (json == NULL) {
+            perror(json_path);
+            return 1;
+        }
+        fprintf(json, "{\n  \"source\": \"orchestra_sim\",\n");
+        fprintf(json, "  \"config\": {\"musicians\": %d, \"loss\": %.3f, \"skew_ppm\": %.1f, \"latency_us\": %lu, "
+                "\"jitter_us\": %lu, \"seed\": %lu},\n", config.musicians, config.loss, config.skew_ppm,
+                (unsigned long)config.latency_us, (unsigned long)config.jitter_us, (unsigned long)config.seed);
+        fprintf(json, "  \"songs\": [\n");
+        for (int i = 0; i < run.measured_count; i++) {
+            const orchestra_song_t* song = get_song_by_id(run.measured[i].song_id);
+            fprintf(json, "    {\"id\": %u, \"name\": \"%s\", \"start_ms\": %lu, \"timing\": ", run.measured[i].song_id,
+                    song ? song->song_name : "", (unsigned long)run.measured[i].start_ms);
+            ensemble_write_json(json, &run.measured[i].report);
+            fprintf(json, "}%s\n", i + 1 < run.measured_count ? "," : "");
+        }
+        fprintf(json, "  ],\n  \"total\": ");
+        ensemble_write_json(json, &run.total);
+        fprintf(json, "\n}\n");
+        if (json != stdout) {
+            fclose(json);
+        }
+    }
+    return 0;
+}
+
+static int cmd_stress(int argc, char** argv) {
+    static orchestra_run_t run;
+    static const uint16_t levels_ms[] = STRESS_NOTE_MS;
+    orchestra_result_t result;
+    orchestra_config_t config = default_config();
+    sim_log_level = ESP_LOG_NONE;
+
+    config.phy_rate_kbps = 1000;
+    config.tx_queue = SIM_STRESS_TX_QUEUE;
+    config.stress_parts = STRESS_PARTS;
+    if (argc > 0) config.musicians = atoi(argv[0]);
+    if (argc > 1) config.stress_parts = (uint8_t)atoi(argv[1]);
+    if (argc > 2) config.phy_rate_kbps = (uint32_t)strtoul(argv[2], NULL, 0);
+    if (argc > 3) config.tx_queue = (uint8_t)atoi(argv[3]);
+    if (argc > 4) config.seed = (uint32_t)strtoul(argv[4], NULL, 0);
+    if (config.musicians < 1 || config.musicians > SIM_MAX_NODES - 1) {
+        fprintf(stderr, "musicians: 1-%d\n", SIM_MAX_NODES - 1);
+        return 2;
+    }
+    for (size_t i = 0; i < sizeof(levels_ms) / sizeof(levels_ms[0]); i++) {
+        config.stress_note_ms[config.stress_levels++] = levels_ms[i];
+    }
+
+    run_orchestra(&config, &result, &run, true);
+    if (!result.ready || run.level_count == 0) {
+        print_summary(stderr, &run);
+        return 1;
+    }
+    printf("%d musicians, %u parts, PHY %lu kbps, tx queue %u, processing %lu+%lu us, seed %lu\n",
+           config.musicians, config.stress_parts, (unsigned long)config.phy_rate_kbps, config.tx_queue,
+           (unsigned long)config.latency_us, (unsigned long)config.jitter_us, (unsigned long)config.seed);
+    print_stress_header(stdout);
+    for (int i = 0; i < run.level_count; i++) {
+        print_stress_row(stdout, &run.levels[i], &run.measured[i].report);
+    }
+    return result.finished ? 0 : 1;
+}
+
+static int cmd_logcost(int argc, char** argv) {
+    orchestra_config_t config = default_config();
+    sim_log_level = ESP_LOG_NONE;
+
+    if (argc > 0) config.musicians = atoi(argv[0]);
+    if (argc > 1) config.seed = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (argc > 2 && strcmp(argv[2], "all") != 0) {
+        char songs[64];
+        snprintf(songs, sizeof(songs), "%s", argv[2]);
+        for (char* id = strtok(songs, ","); id && config.song_count < SIM_MAX_SONGS; id = strtok(NULL, ",")) {
+            config.songs[config.song_count++] = (uint8_t)atoi(id);
+        }
+    }
+    if (config.musicians < 1 || config.musicians > SIM_MAX_NODES - 1) {
+        fprintf(stderr, "musicians: 1-%d\n", SIM_MAX_NODES - 1);
+        return 2;
+    }
+
+    log_cost_t verbose, stripped;
+    measure_log_cost(&config, "verbose", SIM_CONDUCTOR_VERBOSE_MODULE, SIM_MUSICIAN_VERBOSE_MODULE, &verbose);
+    measure_log_cost(&config, "stripped", NULL, NULL, &stripped);
+    printf("%d musicians, seed %lu, log level INFO, UART %d baud\n", config.musicians, (unsigned long)config.seed,
+           SIM_UART_BAUD);
+    print_log_cost_header(stdout);
+    print_log_cost_row(stdout, &verbose);
+    print_log_cost_row(stdout, &stripped);
+    log_cost_t saved = log_cost_saved(&verbose, &stripped);
+    print_log_cost_row(stdout, &saved);
+    if (stripped.hash != verbose.hash) {
+        printf("onsets differ between the builds (hash %08lx / %08lx)\n", (unsigned long)verbose.hash,
+               (unsigned long)stripped.hash);
+    }
+    return verbose.finished && stripped.finished ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        return cmd_run(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "timing") == 0) {
+        return cmd_timing(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "stress") == 0) {
+        return cmd_stress(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "logcost") == 0) {
+        return cmd_logcost(argc - 2, argv + 2);
+    }
+
+    fprintf(stderr, "usage: %s check | run [-v|-q] [musicians] [loss%%] [skew ppm] [seed] [songs|all] "
+            "[latency us] [jitter us]\n"
+            "       %s timing [json file|-] [musicians] [loss%%] [skew ppm] [seed]\n"
+            "       %s stress [musicians] [parts] [PHY kbps] [tx queue] [seed]\n"
+            "       %s logcost [musicians] [seed] [songs|all]\n", argv[0], argv[0], argv[0], argv[0]);
+    return 2;
+}
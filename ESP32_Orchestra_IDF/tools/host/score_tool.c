@@ -0,0 +1,180 @@
+/*
+ * score_tool - host converter for the Orchestra Score Format (.osc)
+ * แปลงเพลงใน midi_songs.h เป็น .osc, ตรวจ round trip และดูเนื้อหาไฟล์
+ *
+ *   score_tool stats            ขนาด array เดิมเทียบกับ .osc ของทุกเพลง
+ *   score_tool verify           encode -> decode ทุกเพลง/part แล้วเทียบกับต้นฉบับ
+ *   score_tool export <dir>     เขียน song_<id>.osc ของทุกเพลง
+ *   score_tool dump <file.osc>  แสดงโน๊ตใน .osc
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "midi_songs.h"
+#include "score_codec.h"
+
+#define MAX_BLOB_LEN   16384
+#define MAX_EVENTS     4096
+
+static uint8_t blob[MAX_BLOB_LEN];
+static score_note_t decoded[MAX_EVENTS];
+
+static size_t encode_song(const orchestra_song_t* song, uint8_t flags) {
+    score_part_src_t parts[SCORE_MAX_PARTS];
+    for (uint8_t p = 0; p < song->part_count; p++) {
+        parts[p].events = song->parts[p].events;
+        parts[p].event_count = song->parts[p].event_count;
+    }
+    return score_encode(parts, song->part_count, song->tempo_bpm, flags, blob, sizeof(blob));
+}
+
+// Decode blob and compare every part with the original table
+static bool check_round_trip(const score_part_src_t* parts, uint8_t part_count, size_t len) {
+    score_info_t info;
+    if (!score_parse(blob, len, &info) || info.part_count != part_count) {
+        return false;
+    }
+    for (uint8_t p = 0; p < part_count; p++) {
+        int count = score_decode_part(&info, p, decoded, MAX_EVENTS);
+        if (count != parts[p].event_count) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            if (decoded[i].note != parts[p].events[i].note ||
+                decoded[i].duration_ms != parts[p].events[i].duration_ms ||
+                decoded[i].delay_ms != parts[p].events[i].delay_ms) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int cmd_stats(void) {
+    size_t total_raw = 0, total_osc = 0;
+
+    printf("%-30s %6s %8s %8s %8s\n", "song", "events", "array", "osc", "osc+rle");
+    for (size_t s = 0; s < TOTAL_SONGS; s++) {
+        const orchestra_song_t* song = &all_songs[s];
+        size_t events = 0;
+        for (uint8_t p = 0; p < song->part_count; p++) {
+            events += song->parts[p].event_count;
+        }
+        size_t raw = events * sizeof(note_event_t);
+        size_t plain = encode_song(song, 0);
+        size_t rle = encode_song(song, SCORE_FLAG_RLE);
+
+        printf("%-30s %6zu %8zu %8zu %8zu  (%.1fx)\n", song->song_name, events, raw, plain, rle,
+               rle ? (double)raw / rle : 0.0);
+        total_raw += raw;
+        total_osc += rle;
+    }
+    printf("%-30s %6s %8zu %8s %8zu  (%.1fx)\n", "total", "", total_raw, "", total_osc,
+           total_osc ? (double)total_raw / total_osc : 0.0);
+    return 0;
+}
+
+static int cmd_verify(void) {
+    int failures = 0;
+
+    for (size_t s = 0; s < TOTAL_SONGS; s++) {
+        const orchestra_song_t* song = &all_songs[s];
+        score_part_src_t parts[SCORE_MAX_PARTS];
+        for (uint8_t p = 0; p < song->part_count; p++) {
+            parts[p].events = song->parts[p].events;
+            parts[p].event_count = song->parts[p].event_count;
+        }
+
+        for (int rle = 0; rle <= 1; rle++) {
+            uint8_t flags = rle ? SCORE_FLAG_RLE : 0;
+
+            // Whole song, then every part on its own (the preload format)
+            size_t len = score_encode(parts, song->part_count, song->tempo_bpm, flags, blob, sizeof(blob));
+            bool ok = len > 0 && check_round_trip(parts, song->part_count, len);
+            for (uint8_t p = 0; p < song->part_count && ok; p++) {
+                len = score_encode(&parts[p], 1, song->tempo_bpm, flags, blob, sizeof(blob));
+                ok = len > 0 && check_round_trip(&parts[p], 1, len);
+            }
+
+            printf("%-30s %-7s %s\n", song->song_name, rle ? "rle" : "plain", ok ? "OK" : "FAIL");
+            failures += ok ? 0 : 1;
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+static int cmd_export(const char* dir) {
+    for (size_t s = 0; s < TOTAL_SONGS; s++) {
+        const orchestra_song_t* song = &all_songs[s];
+        size_t len = encode_song(song, SCORE_FLAG_RLE);
+        if (len == 0) {
+            fprintf(stderr, "%s: does not fit\n", song->song_name);
+            return 1;
+        }
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/song_%d.osc", dir, song->song_id);
+        FILE* f = fopen(path, "wb");
+        if (!f || fwrite(blob, 1, len, f) != len) {
+            fprintf(stderr, "%s: write failed\n", path);
+            if (f) {
+                fclose(f);
+            }
+            return 1;
+        }
+        fclose(f);
+        printf("%s (%zu bytes)\n", path, len);
+    }
+    return 0;
+}
+
+static int cmd_dump(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    size_t len = fread(blob, 1, sizeof(blob), f);
+    fclose(f);
+
+    score_info_t info;
+    if (!score_parse(blob, len, &info)) {
+        fprintf(stderr, "%s: not a valid .osc file\n", path);
+        return 1;
+    }
+    printf("version %d, flags 0x%02x, tempo %d BPM, %d parts, time unit %d ms, %d distinct notes\n",
+           info.version, info.flags, info.tempo_bpm, info.part_count, info.time_unit_ms,
+           info.note_table_len);
+
+    for (uint8_t p = 0; p < info.part_count; p++) {
+        int count = score_decode_part(&info, p, decoded, MAX_EVENTS);
+        printf("part %d: %d events in %d bytes\n", p, info.event_count[p], info.stream_len[p]);
+        if (count < 0) {
+            fprintf(stderr, "part %d: corrupt\n", p);
+            return 1;
+        }
+        for (int i = 0; i < count; i++) {
+            printf("  {%3d, %5d, %5d}\n", decoded[i].note, decoded[i].duration_ms, decoded[i].delay_ms);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "stats") == 0) {
+        return cmd_stats();
+    }
+    if (argc >= 2 && strcmp(argv[1], "verify") == 0) {
+        return cmd_verify();
+    }
+    if (argc >= 3 && strcmp(argv[1], "export") == 0) {
+        return cmd_export(argv[2]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "dump") == 0) {
+        return cmd_dump(argv[2]);
+    }
+
+    fprintf(stderr, "usage: %s stats | verify | export <dir> | dump <file.osc>\n", argv[0]);
+    return 2;
+}
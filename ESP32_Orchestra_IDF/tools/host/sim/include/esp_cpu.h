@@ -0,0 +1,6 @@
+// Orchestra simulator shim - one core, the cycle counter runs with the board's own clock
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_cpu_get_cycle_count(void);
+int esp_cpu_get_core_id(void);
@@ -0,0 +1,5 @@
+// Orchestra simulator shim
+#pragma once
+#include "esp_err.h"
+
+esp_err_t esp_event_loop_create_default(void);
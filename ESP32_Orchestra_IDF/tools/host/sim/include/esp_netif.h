@@ -0,0 +1,6 @@
+// Orchestra simulator shim
+#pragma once
+#include "esp_err.h"
+#include "esp_event.h"
+
+esp_err_t esp_netif_init(void);
@@ -0,0 +1,5 @@
+// Orchestra simulator shim - seeded per board, runs repeat exactly
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_random(void);
@@ -0,0 +1,5 @@
+// Orchestra simulator shim - same results as the ROM tables (state inverted in and out)
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len);
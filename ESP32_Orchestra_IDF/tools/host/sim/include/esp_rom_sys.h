@@ -0,0 +1,5 @@
+// Orchestra simulator shim - CPU at SIM_CPU_MHZ
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void);
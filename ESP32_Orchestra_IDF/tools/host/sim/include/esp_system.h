@@ -0,0 +1,7 @@
+// Orchestra simulator shim
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_random.h"
+
+void esp_restart(void);
@@ -0,0 +1,6 @@
+// Orchestra simulator shim - every board starts with an empty flash
+#pragma once
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
@@ -0,0 +1,173 @@
+#ifndef SIM_H
+#define SIM_H
+
+/*
+ * Orchestra simulator - เวลาจำลอง, บอร์ด, วิทยุ และ hardware สำหรับรัน firmware ของ conductor/musician บน PC
+ *
+ * ทุกบอร์ด (node) มีนาฬิกาของตัวเอง: เริ่มนับจาก 0 ตอน boot และเดินเร็ว/ช้ากว่าเวลาจริงตาม skew (ppm)
+ * FreeRTOS task แต่ละตัวเป็น pthread แต่รันทีละตัว - เวลาเดินเฉพาะตอนทุก task รออยู่ (code ใช้เวลา 0)
+ * esp_timer callback, ESP-NOW receive/send callback รันจาก scheduler เหมือน esp_timer/Wi-Fi task
+ * ผลลัพธ์ออกมาเหมือนเดิมทุกครั้งสำหรับ seed เดียวกัน
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "esp_now.h"
+#include "driver/ledc.h"
+#include "latency_hist.h"
+
+#define SIM_MAX_NODES           33      // Conductor + MAX_MUSICIANS
+#define SIM_NVS_ENTRIES         16
+#define SIM_NVS_NAMESPACES      8
+#define SIM_NVS_MAX_LEN         256
+#define SIM_LEDC_APB_HZ         80000000UL
+#define SIM_LEDC_REF_TICK_HZ    1000000UL
+#define SIM_CPU_MHZ             240     // esp_cpu_get_cycle_count()
+
+// ESP-NOW medium: every frame is on the air at send time + latency + 0..jitter (in send order per
+// board), every receiver loses it on its own with probability loss. Unicast frames are resent up
+// to unicast_retries times, retry_us apart, before the send callback reports a failure.
+// With phy_rate_kbps set, latency is only the time to reach the radio: every board then shares one
+// medium - a frame waits until it is free (DIFS + random backoff when it was busy), occupies it for
+// its airtime (802.11b preamble + bytes at the PHY rate, unicast + ACK) and arrives when it ends.
+// Collisions are not modelled, contention shows up as queueing for the medium.
+typedef struct {
+    uint32_t latency_us;
+    uint32_t jitter_us;
+    double loss;
+    uint8_t unicast_retries;
+    uint32_t retry_us;
+    uint32_t seed;
+    uint32_t phy_rate_kbps;     // 0 = no airtime, frames never wait for each other
+    uint8_t tx_queue;           // Frames of one board not yet reported in the send callback,
+                                // full = ESP_ERR_ESPNOW_NO_MEM (0 = no limit)
+} sim_radio_config_t;
+
+typedef struct {
+    uint32_t frames_sent;       // esp_now_send() calls that went on the air
+    uint32_t broadcasts;
+    uint32_t deliveries;        // Frame copies handed to a receive callback
+    uint32_t losses;            // Frame copies a receiver missed (unicast: every failed attempt)
+    uint32_t unicast_retries;
+    uint32_t unicast_failures;  // Send callback got ESP_NOW_SEND_FAIL
+    uint32_t no_mem;            // esp_now_send() refused, tx_queue full
+    int64_t airtime_us;         // Medium busy, ACKs included (phy_rate_kbps only)
+    latency_hist_t latency_us;  // esp_now_send() call to receive callback, every delivered copy
+    latency_hist_t callback_ns; // Host time spent in receive callbacks
+} sim_radio_stats_t;
+
+typedef struct {
+    char ns[16];
+    char key[16];
+    uint8_t value[SIM_NVS_MAX_LEN];
+    size_t len;
+} sim_nvs_entry_t;
+
+typedef struct {
+    uint32_t clock_divider;     // Q10.8
+    uint32_t duty_resolution;
+    uint32_t src_hz;
+} sim_ledc_timer_t;
+
+typedef struct {
+    bool configured;
+    ledc_timer_t timer;
+    uint32_t duty_set;          // ledc_set_duty(), takes effect on ledc_update_duty()
+    uint32_t duty;
+} sim_ledc_channel_t;
+
+typedef struct sim_node {
+    int index;
+    char name[8];
+    uint8_t mac[6];
+    double skew_ppm;            // Crystal error: +20 = the clock gains 20 us per second
+    int64_t boot_us;            // True time of power-on (local clock 0)
+    bool booted;
+    void (*app_main)(void);     // Entry of the main task
+    int main_priority;
+    void* module;               // Firmware image (dlopen handle), NULL = sim-only node
+    uint32_t rng;               // esp_random()
+
+    // Radio
+    bool espnow_ready;
+    esp_now_recv_cb_t recv_cb;
+    esp_now_send_cb_t send_cb;
+    uint8_t peers[ESP_NOW_MAX_TOTAL_PEER_NUM][ESP_NOW_ETH_ALEN];
+    int peer_count;
+    uint8_t channel;
+    int64_t last_air_us;        // Frames of one board go on the air in order
+    int tx_pending;             // Sent, send callback still to come
+
+    // Flash
+    char nvs_namespaces[SIM_NVS_NAMESPACES][16];
+    int nvs_namespace_count;
+    sim_nvs_entry_t nvs[SIM_NVS_ENTRIES];
+    int nvs_count;
+
+    // LEDC
+    sim_ledc_timer_t ledc_timers[LEDC_TIMER_MAX];
+    sim_ledc_channel_t ledc_channels[LEDC_CHANNEL_MAX];
+
+    // Log (ESP_LOGx that passed sim_log_level)
+    uint32_t log_lines;
+    uint64_t log_bytes;         // As the board prints them on its UART: "I (ms) TAG: text\n"
+    uint64_t log_ns;            // Host time to format and write them
+} sim_node_t;
+
+// A note starting or ending on an LEDC channel (a new tone on a sounding channel is both)
+typedef struct {
+    int64_t true_us;
+    const sim_node_t* node;
+    uint8_t channel;
+    bool on;
+    float frequency;
+    uint8_t note;               // Nearest MIDI note to the frequency
+    uint32_t duty;
+} sim_tone_t;
+
+typedef void (*sim_tone_hook_t)(const sim_tone_t* tone, void* arg);
+typedef void (*sim_event_fn_t)(void* arg, uint32_t gen);
+
+// --- Clock and scheduler (sim_rtos.c) ---
+
+// Drop every node, task and pending event (threads of an earlier run stay parked forever)
+void sim_reset(void);
+
+// Node with its own clock; boot_us is when its entry task starts
+sim_node_t* sim_node_create(const char* name, double skew_ppm, uint32_t seed);
+void sim_node_boot(sim_node_t* node, int64_t boot_us, void (*entry)(void), int priority);
+int sim_node_count(void);
+sim_node_t* sim_node_get(int index);
+
+// Sim-side task on a node (scenario scripts that call into the firmware)
+void sim_task_create(sim_node_t* node, const char* name, void (*fn)(void* arg), void* arg, int priority);
+
+// Run until true time end_us or sim_stop()
+void sim_run_until(int64_t end_us);
+void sim_stop(void);
+
+int64_t sim_now_us(void);
+sim_node_t* sim_current_node(void);         // Board whose code is running, NULL between events
+int64_t sim_node_local_us(const sim_node_t* node, int64_t true_us);
+int64_t sim_node_true_us(const sim_node_t* node, int64_t local_us);   // First instant the clock shows local_us
+
+// Event on the true time line, run with node as the current board (gen is passed back for cancelling)
+void sim_schedule(int64_t true_us, sim_node_t* node, sim_event_fn_t fn, void* arg, uint32_t gen);
+
+// Print to stderr and exit - firmware did something the simulation cannot model
+void sim_fatal(const char* fmt, ...);
+
+// --- Radio (sim_radio.c) ---
+
+extern sim_radio_config_t sim_radio;
+extern sim_radio_stats_t sim_radio_stats;
+void sim_radio_reset(void);
+
+// --- Hardware (sim_hw.c) ---
+
+void sim_set_tone_hook(sim_tone_hook_t hook, void* arg);
+
+extern FILE* sim_log_file;      // ESP_LOGx output, NULL = stderr
+
+#endif // SIM_H
@@ -0,0 +1,434 @@
+/*
+ * Orchestra simulator - hardware ต่อบอร์ด: NVS ใน RAM, LEDC, GPIO, esp_random, cycle counter และ log
+ * LEDC ไม่สร้างเสียงจริง แต่แปลงการเขียน timer/duty เป็น note เริ่ม/จบ ส่งให้ tone hook พร้อมเวลาจริง
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_rom_sys.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+
+esp_log_level_t sim_log_level = ESP_LOG_WARN;
+FILE* sim_log_file = NULL;
+
+static sim_tone_hook_t tone_hook = NULL;
+static void* tone_hook_arg = NULL;
+
+static sim_node_t* this_node(void) {
+    sim_node_t* node = sim_current_node();
+    if (node == NULL) {
+        sim_fatal("hardware access outside any board");
+    }
+    return node;
+}
+
+// --- Errors and logging ---
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_ESPNOW_NOT_INIT: return "ESP_ERR_ESPNOW_NOT_INIT";
+        case ESP_ERR_ESPNOW_ARG: return "ESP_ERR_ESPNOW_ARG";
+        case ESP_ERR_ESPNOW_NO_MEM: return "ESP_ERR_ESPNOW_NO_MEM";
+        case ESP_ERR_ESPNOW_FULL: return "ESP_ERR_ESPNOW_FULL";
+        case ESP_ERR_ESPNOW_NOT_FOUND: return "ESP_ERR_ESPNOW_NOT_FOUND";
+        case ESP_ERR_ESPNOW_EXIST: return "ESP_ERR_ESPNOW_EXIST";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void sim_error_check_failed(esp_err_t rc, const char *file, int line, const char *expression) {
+    sim_fatal("ESP_ERROR_CHECK failed: %s (0x%x) at %s:%d: %s", esp_err_to_name(rc), rc, file, line, expression);
+}
+
+void esp_restart(void) {
+    sim_fatal("esp_restart() on %s", sim_current_node() ? sim_current_node()->name : "-");
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = "NEWIDV";
+    sim_node_t* node = sim_current_node();
+    FILE* out = sim_log_file ? sim_log_file : stderr;
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    fprintf(out, "%10.3f %-4s %c (%s) ", sim_now_us() / 1000.0, node ? node->name : "-", letters[level], tag);
+    va_list args;
+    va_start(args, format);
+    int text = vfprintf(out, format, args);
+    va_end(args);
+    fputc('\n', out);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (node) {
+        // ESP-IDF prefix: "I (12345) TAG: "
+        int prefix = snprintf(NULL, 0, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000),
+                              tag);
+        node->log_lines++;
+        node->log_bytes += (uint64_t)(prefix + (text > 0 ? text : 0) + 1);
+        node->log_ns += (uint64_t)((end.tv_sec - begin.tv_sec) * 1000000000LL + end.tv_nsec - begin.tv_nsec);
+    }
+}
+
+uint32_t esp_random(void) {
+    sim_node_t* node = this_node();
+    node->rng ^= node->rng << 13;
+    node->rng ^= node->rng >> 17;
+    node->rng ^= node->rng << 5;
+    return node->rng;
+}
+
+uint32_t esp_cpu_get_cycle_count(void) {
+    return (uint32_t)(esp_timer_get_time() * SIM_CPU_MHZ);
+}
+
+int esp_cpu_get_core_id(void) {
+    return 0;
+}
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void) {
+    return SIM_CPU_MHZ;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// --- NVS: namespace index + 1 is the handle ---
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    sim_node_t* node = this_node();
+    node->nvs_count = 0;
+    node->nvs_namespace_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    sim_node_t* node = this_node();
+    for (int i = 0; i < node->nvs_namespace_count; i++) {
+        if (strcmp(node->nvs_namespaces[i], name) == 0) {
+            *out_handle = (nvs_handle_t)(i + 1);
+            return ESP_OK;
+        }
+    }
+    if (open_mode == NVS_READONLY) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (node->nvs_namespace_count >= SIM_NVS_NAMESPACES || strlen(name) >= sizeof(node->nvs_namespaces[0])) {
+        return ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+    strcpy(node->nvs_namespaces[node->nvs_namespace_count++], name);
+    *out_handle = (nvs_handle_t)node->nvs_namespace_count;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_OK;
+}
+
+static sim_nvs_entry_t* nvs_find(sim_node_t* node, nvs_handle_t handle, const char* key) {
+    if (handle == 0 || (int)handle > node->nvs_namespace_count) {
+        return NULL;
+    }
+    const char* ns = node->nvs_namespaces[handle - 1];
+    for (int i = 0; i < node->nvs_count; i++) {
+        if (strcmp(node->nvs[i].ns, ns) == 0 && strcmp(node->nvs[i].key, key) == 0) {
+            return &node->nvs[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t nvs_store(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    sim_node_t* node = this_node();
+    if (handle == 0 || (int)handle > node->nvs_namespace_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (length > SIM_NVS_MAX_LEN || strlen(key) >= sizeof(node->nvs[0].key)) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    sim_nvs_entry_t* entry = nvs_find(node, handle, key);
+    if (entry == NULL) {
+        if (node->nvs_count >= SIM_NVS_ENTRIES) {
+            return ESP_ERR_NVS_NO_FREE_PAGES;
+        }
+        entry = &node->nvs[node->nvs_count++];
+        strcpy(entry->ns, node->nvs_namespaces[handle - 1]);
+        strcpy(entry->key, key);
+    }
+    memcpy(entry->value, value, length);
+    entry->len = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    sim_nvs_entry_t* entry = nvs_find(this_node(), handle, key);
+    if (entry == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == NULL) {
+        *length = entry->len;
+        return ESP_OK;
+    }
+    if (*length < entry->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, entry->value, entry->len);
+    *length = entry->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return nvs_store(handle, key, value, length);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    sim_node_t* node = this_node();
+    sim_nvs_entry_t* entry = nvs_find(node, handle, key);
+    if (entry == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *entry = node->nvs[--node->nvs_count];
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value) {
+    sim_nvs_entry_t* entry = nvs_find(this_node(), handle, key);
+    if (entry == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (entry->len != 1) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    *out_value = entry->value[0];
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return nvs_store(handle, key, &value, 1);
+}
+
+// --- Partitions: none, song_library falls back to the built-in songs ---
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    return NULL;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory, const void** out_ptr,
+                             esp_partition_mmap_handle_t* out_handle) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t handle) {
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+// --- GPIO ---
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    return 1;   // Pull-up, button released
+}
+
+// --- LEDC ---
+
+void sim_set_tone_hook(sim_tone_hook_t hook, void* arg) {
+    tone_hook = hook;
+    tone_hook_arg = arg;
+}
+
+static float timer_frequency(const sim_ledc_timer_t* timer) {
+    if (timer->clock_divider == 0 || timer->duty_resolution == 0) {
+        return 0;
+    }
+    return (float)((double)timer->src_hz * 256.0 / ((double)timer->clock_divider * (1u << timer->duty_resolution)));
+}
+
+static void emit_tone(const sim_node_t* node, int channel, bool on) {
+    if (tone_hook == NULL) {
+        return;
+    }
+    const sim_ledc_channel_t* ch = &node->ledc_channels[channel];
+    sim_tone_t tone = {
+        .true_us = sim_now_us(),
+        .node = node,
+        .channel = (uint8_t)channel,
+        .on = on,
+        .frequency = timer_frequency(&node->ledc_timers[ch->timer]),
+        .duty = ch->duty,
+    };
+    if (tone.frequency > 0) {
+        double note = 69.0 + 12.0 * log2(tone.frequency / 440.0);
+        tone.note = note < 0 ? 0 : note > 127 ? 127 : (uint8_t)lround(note);
+    }
+    tone_hook(&tone, tone_hook_arg);
+}
+
+// A sounding channel on this timer ends its note and starts the next one (a stolen voice)
+static void retune(sim_node_t* node, ledc_timer_t timer, const sim_ledc_timer_t* next) {
+    bool sounding[LEDC_CHANNEL_MAX];
+    for (int i = 0; i < LEDC_CHANNEL_MAX; i++) {
+        const sim_ledc_channel_t* ch = &node->ledc_channels[i];
+        sounding[i] = ch->configured && ch->timer == timer && ch->duty > 0;
+        if (sounding[i]) {
+            emit_tone(node, i, false);
+        }
+    }
+    node->ledc_timers[timer] = *next;
+    for (int i = 0; i < LEDC_CHANNEL_MAX; i++) {
+        if (sounding[i]) {
+            emit_tone(node, i, true);
+        }
+    }
+}
+
+static uint32_t clk_src_hz(ledc_clk_src_t clk_src) {
+    return clk_src == LEDC_REF_TICK ? SIM_LEDC_REF_TICK_HZ : SIM_LEDC_APB_HZ;
+}
+
+// Closest divider for freq_hz on the APB clock, as ledc_set_freq() does
+static sim_ledc_timer_t timer_for_freq(uint32_t freq_hz, uint32_t duty_resolution) {
+    sim_ledc_timer_t timer = {0, duty_resolution, SIM_LEDC_APB_HZ};
+    if (freq_hz > 0 && duty_resolution > 0) {
+        timer.clock_divider = (uint32_t)(((uint64_t)SIM_LEDC_APB_HZ * 256 + ((uint64_t)freq_hz << duty_resolution) / 2) /
+                                         ((uint64_t)freq_hz << duty_resolution));
+    }
+    return timer;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf) {
+    if (timer_conf->timer_num >= LEDC_TIMER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_ledc_timer_t next = timer_for_freq(timer_conf->freq_hz, timer_conf->duty_resolution);
+    retune(this_node(), timer_conf->timer_num, &next);
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf) {
+    if (ledc_conf->channel >= LEDC_CHANNEL_MAX || ledc_conf->timer_sel >= LEDC_TIMER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_node_t* node = this_node();
+    sim_ledc_channel_t* ch = &node->ledc_channels[ledc_conf->channel];
+    if (ch->configured && ch->duty > 0) {
+        emit_tone(node, ledc_conf->channel, false);
+    }
+    ch->configured = true;
+    ch->timer = ledc_conf->timer_sel;
+    ch->duty_set = ledc_conf->duty;
+    ch->duty = ledc_conf->duty;
+    if (ch->duty > 0) {
+        emit_tone(node, ledc_conf->channel, true);
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_set(ledc_mode_t speed_mode, ledc_timer_t timer_sel, uint32_t clock_divider,
+                         uint32_t duty_resolution, ledc_clk_src_t clk_src) {
+    if (timer_sel >= LEDC_TIMER_MAX || clock_divider < 256) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_ledc_timer_t next = {clock_divider, duty_resolution, clk_src_hz(clk_src)};
+    retune(this_node(), timer_sel, &next);
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num, uint32_t freq_hz) {
+    if (timer_num >= LEDC_TIMER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_node_t* node = this_node();
+    sim_ledc_timer_t next = timer_for_freq(freq_hz, node->ledc_timers[timer_num].duty_resolution);
+    retune(node, timer_num, &next);
+    return ESP_OK;
+}
+
+uint32_t ledc_get_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num) {
+    if (timer_num >= LEDC_TIMER_MAX) {
+        return 0;
+    }
+    return (uint32_t)lroundf(timer_frequency(&this_node()->ledc_timers[timer_num]));
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    this_node()->ledc_channels[channel].duty_set = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_node_t* node = this_node();
+    sim_ledc_channel_t* ch = &node->ledc_channels[channel];
+    bool was_on = ch->duty > 0;
+    ch->duty = ch->duty_set;
+    if (ch->configured && was_on != (ch->duty > 0)) {
+        emit_tone(node, channel, !was_on);
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_node_t* node = this_node();
+    sim_ledc_channel_t* ch = &node->ledc_channels[channel];
+    if (ch->configured && ch->duty > 0) {
+        emit_tone(node, channel, false);
+    }
+    ch->duty = 0;
+    ch->duty_set = 0;
+    return ESP_OK;
+}
@@ -0,0 +1,375 @@
+/*
+ * Orchestra simulator - ESP-NOW และ Wi-Fi บนสื่อจำลอง
+ * Frame ขึ้นอากาศหลัง latency + jitter (เรียงตามลำดับที่บอร์ดส่ง), ผู้รับแต่ละตัวเสีย frame อิสระกัน
+ * Unicast ส่งซ้ำระดับ MAC จนถึงหรือครบ retry แล้วแจ้งผลใน send callback เหมือน ESP-NOW จริง
+ * ตั้ง phy_rate_kbps แล้วทุกบอร์ดใช้อากาศร่วมกัน: frame ต้องรอคิว + airtime ตามขนาด (orchestra_sim stress)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "esp_now.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+
+sim_radio_config_t sim_radio = {
+    .latency_us = 1500,
+    .jitter_us = 500,
+    .loss = 0.0,
+    .unicast_retries = 7,
+    .retry_us = 600,
+    .seed = 1,
+    .phy_rate_kbps = 0,
+    .tx_queue = 0,
+};
+
+// 802.11b DSSS (ESP-NOW sends at 1 Mbps by default): long preamble + PLCP header, then the MAC frame
+#define AIR_PLCP_US             192
+#define AIR_ESPNOW_BYTES        43      // MAC header, action + vendor element header, FCS around the payload
+#define AIR_ACK_BYTES           14
+#define AIR_SIFS_US             10
+#define AIR_DIFS_US             50
+#define AIR_SLOT_US             20
+#define AIR_CW_MIN              31
+#define AIR_CW_MAX              1023
+sim_radio_stats_t sim_radio_stats;
+
+static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static uint32_t medium_rng = 1;     // Separate from esp_random(): firmware calls do not shift the losses
+static int64_t medium_free_us = 0;  // Airtime model: end of the last reserved transmission
+
+typedef struct {
+    sim_node_t* from;
+    sim_node_t* to;
+    uint8_t src_addr[ESP_NOW_ETH_ALEN];
+    uint8_t des_addr[ESP_NOW_ETH_ALEN];
+    esp_now_send_status_t status;   // Send callback only
+    int64_t sent_us;                // esp_now_send() call
+    int len;
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} sim_frame_t;
+
+static uint32_t medium_next(void) {
+    medium_rng ^= medium_rng << 13;
+    medium_rng ^= medium_rng >> 17;
+    medium_rng ^= medium_rng << 5;
+    return medium_rng;
+}
+
+static bool medium_lost(void) {
+    return sim_radio.loss > 0 && (medium_next() >> 8) / 16777216.0 < sim_radio.loss;
+}
+
+void sim_radio_reset(void) {
+    memset(&sim_radio_stats, 0, sizeof(sim_radio_stats));
+    medium_rng = sim_radio.seed ? sim_radio.seed : 1;
+    medium_free_us = 0;
+}
+
+static sim_node_t* this_node(void) {
+    sim_node_t* node = sim_current_node();
+    if (node == NULL) {
+        sim_fatal("Wi-Fi call outside any board");
+    }
+    return node;
+}
+
+static int find_peer(const sim_node_t* node, const uint8_t* mac) {
+    for (int i = 0; i < node->peer_count; i++) {
+        if (memcmp(node->peers[i], mac, ESP_NOW_ETH_ALEN) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static sim_node_t* node_by_mac(const uint8_t* mac) {
+    for (int i = 0; i < sim_node_count(); i++) {
+        sim_node_t* node = sim_node_get(i);
+        if (memcmp(node->mac, mac, ESP_NOW_ETH_ALEN) == 0) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+static sim_frame_t* frame_copy(sim_node_t* from, sim_node_t* to, const uint8_t* des_addr,
+                               const uint8_t* data, size_t len) {
+    sim_frame_t* frame = malloc(sizeof(*frame));
+    if (frame == NULL) {
+        sim_fatal("out of memory for frames");
+    }
+    frame->from = from;
+    frame->to = to;
+    memcpy(frame->src_addr, from->mac, ESP_NOW_ETH_ALEN);
+    memcpy(frame->des_addr, des_addr, ESP_NOW_ETH_ALEN);
+    frame->status = ESP_NOW_SEND_SUCCESS;
+    frame->sent_us = sim_now_us();
+    frame->len = (int)len;
+    memcpy(frame->data, data, len);
+    return frame;
+}
+
+// Receiver side, runs like the Wi-Fi task of the receiving board
+static void deliver_event(void* arg, uint32_t gen) {
+    sim_frame_t* frame = arg;
+    if (frame->to->espnow_ready && frame->to->recv_cb) {
+        wifi_pkt_rx_ctrl_t rx_ctrl = {.rssi = -50, .channel = frame->to->channel};
+        esp_now_recv_info_t info = {frame->src_addr, frame->des_addr, &rx_ctrl};
+        sim_radio_stats.deliveries++;
+        latency_hist_add(&sim_radio_stats.latency_us, (uint32_t)(sim_now_us() - frame->sent_us));
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        frame->to->recv_cb(&info, frame->data, frame->len);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        latency_hist_add(&sim_radio_stats.callback_ns,
+                         (uint32_t)((end.tv_sec - begin.tv_sec) * 1000000000LL + end.tv_nsec - begin.tv_nsec));
+    }
+    free(frame);
+}
+
+// Sender side: ESP-NOW reports every frame, broadcasts always as a success
+static void send_done_event(void* arg, uint32_t gen) {
+    sim_frame_t* frame = arg;
+    frame->from->tx_pending--;
+    if (frame->status != ESP_NOW_SEND_SUCCESS) {
+        sim_radio_stats.unicast_failures++;
+    }
+    if (frame->from->espnow_ready && frame->from->send_cb) {
+        wifi_tx_info_t info = {frame->des_addr, frame->src_addr, WIFI_IF_STA, frame->data, (uint8_t)frame->len};
+        frame->from->send_cb(&info, frame->status);
+    }
+    free(frame);
+}
+
+static uint32_t air_us(size_t bytes) {
+    return AIR_PLCP_US + (uint32_t)((bytes * 8 * 1000 + sim_radio.phy_rate_kbps - 1) / sim_radio.phy_rate_kbps);
+}
+
+// First instant a frame ready at ready_us gets the medium: right after DIFS when it is idle,
+// otherwise after the current transmission, DIFS and a random backoff from the contention window
+static int64_t medium_access(int64_t ready_us, uint32_t cw) {
+    if (ready_us >= medium_free_us) {
+        return ready_us + AIR_DIFS_US;
+    }
+    return medium_free_us + AIR_DIFS_US + (int64_t)(medium_next() % (cw + 1)) * AIR_SLOT_US;
+}
+
+static void medium_reserve(int64_t start_us, int64_t end_us) {
+    medium_free_us = end_us;
+    sim_radio_stats.airtime_us += end_us - start_us;
+}
+
+static void send_broadcast(sim_node_t* node, const uint8_t* peer_addr, const uint8_t* data, size_t len,
+                           int64_t ready_us) {
+    int64_t arrive_us = ready_us;
+    if (sim_radio.phy_rate_kbps > 0) {
+        int64_t start_us = medium_access(ready_us, AIR_CW_MIN);
+        arrive_us = start_us + air_us(len + AIR_ESPNOW_BYTES);
+        medium_reserve(start_us, arrive_us);
+    }
+    node->last_air_us = arrive_us;
+
+    sim_radio_stats.broadcasts++;
+    for (int i = 0; i < sim_node_count(); i++) {
+        sim_node_t* receiver = sim_node_get(i);
+        if (receiver == node || !receiver->booted) {
+            continue;
+        }
+        if (medium_lost()) {
+            sim_radio_stats.losses++;
+            continue;
+        }
+        sim_schedule(arrive_us, receiver, deliver_event, frame_copy(node, receiver, peer_addr, data, len), 0);
+    }
+    sim_schedule(arrive_us, node, send_done_event, frame_copy(node, node, peer_addr, data, len), 0);
+}
+
+// Unicast: resent until one copy gets through (and is acknowledged) or the retries run out
+static void send_unicast(sim_node_t* node, const uint8_t* peer_addr, const uint8_t* data, size_t len,
+                         int64_t ready_us) {
+    sim_node_t* receiver = node_by_mac(peer_addr);
+    sim_frame_t* done = frame_copy(node, node, peer_addr, data, len);
+    done->status = ESP_NOW_SEND_FAIL;
+    int64_t attempt_us = ready_us;
+    int64_t done_us = ready_us;
+    uint32_t cw = AIR_CW_MIN;
+    for (int attempt = 0; attempt <= sim_radio.unicast_retries; attempt++) {
+        if (attempt > 0) {
+            sim_radio_stats.unicast_retries++;
+            if (sim_radio.phy_rate_kbps == 0) {
+                attempt_us += sim_radio.retry_us;
+            }
+        }
+        int64_t arrive_us = attempt_us;
+        done_us = attempt_us;
+        if (sim_radio.phy_rate_kbps > 0) {
+            // The sender waits for the ACK (or its timeout) either way, the window doubles on a miss
+            int64_t start_us = medium_access(attempt_us, cw);
+            arrive_us = start_us + air_us(len + AIR_ESPNOW_BYTES);
+            done_us = arrive_us + AIR_SIFS_US + air_us(AIR_ACK_BYTES);
+            medium_reserve(start_us, done_us);
+            attempt_us = done_us;
+            cw = cw * 2 + 1 < AIR_CW_MAX ? cw * 2 + 1 : AIR_CW_MAX;
+        }
+        if (receiver == NULL || !receiver->booted || medium_lost()) {
+            sim_radio_stats.losses++;
+            continue;
+        }
+        sim_schedule(arrive_us, receiver, deliver_event, frame_copy(node, receiver, peer_addr, data, len), 0);
+        done->status = ESP_NOW_SEND_SUCCESS;
+        break;
+    }
+    node->last_air_us = sim_radio.phy_rate_kbps > 0 ? done_us : ready_us;   // One transmission at a time
+    sim_schedule(done_us, node, send_done_event, done, 0);
+}
+
+esp_err_t esp_now_send(const uint8_t *peer_addr, const uint8_t *data, size_t len) {
+    sim_node_t* node = this_node();
+    if (!node->espnow_ready) {
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    }
+    if (peer_addr == NULL || data == NULL || len == 0 || len > ESP_NOW_MAX_DATA_LEN) {
+        return ESP_ERR_ESPNOW_ARG;
+    }
+    if (find_peer(node, peer_addr) < 0) {
+        return ESP_ERR_ESPNOW_NOT_FOUND;
+    }
+    if (sim_radio.tx_queue > 0 && node->tx_pending >= sim_radio.tx_queue) {
+        sim_radio_stats.no_mem++;
+        return ESP_ERR_ESPNOW_NO_MEM;
+    }
+
+    // Channel access delay, but never overtaking an earlier frame of the same board
+    int64_t ready_us = sim_now_us() + sim_radio.latency_us;
+    if (sim_radio.jitter_us > 0) {
+        ready_us += medium_next() % (sim_radio.jitter_us + 1);
+    }
+    if (ready_us < node->last_air_us) {
+        ready_us = node->last_air_us;
+    }
+    node->tx_pending++;
+    sim_radio_stats.frames_sent++;
+
+    if (memcmp(peer_addr, broadcast_mac, ESP_NOW_ETH_ALEN) == 0) {
+        send_broadcast(node, peer_addr, data, len, ready_us);
+    } else {
+        send_unicast(node, peer_addr, data, len, ready_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_now_init(void) {
+    sim_node_t* node = this_node();
+    node->espnow_ready = true;
+    node->peer_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_deinit(void) {
+    sim_node_t* node = this_node();
+    node->espnow_ready = false;
+    node->recv_cb = NULL;
+    node->send_cb = NULL;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+    sim_node_t* node = this_node();
+    if (!node->espnow_ready) {
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    }
+    node->recv_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+    sim_node_t* node = this_node();
+    if (!node->espnow_ready) {
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    }
+    node->send_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer) {
+    sim_node_t* node = this_node();
+    if (!node->espnow_ready) {
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    }
+    if (peer == NULL) {
+        return ESP_ERR_ESPNOW_ARG;
+    }
+    if (find_peer(node, peer->peer_addr) >= 0) {
+        return ESP_ERR_ESPNOW_EXIST;
+    }
+    if (node->peer_count >= ESP_NOW_MAX_TOTAL_PEER_NUM) {
+        return ESP_ERR_ESPNOW_FULL;
+    }
+    memcpy(node->peers[node->peer_count++], peer->peer_addr, ESP_NOW_ETH_ALEN);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_del_peer(const uint8_t *peer_addr) {
+    sim_node_t* node = this_node();
+    int i = find_peer(node, peer_addr);
+    if (i < 0) {
+        return ESP_ERR_ESPNOW_NOT_FOUND;
+    }
+    memmove(node->peers[i], node->peers[i + 1], (size_t)(node->peer_count - i - 1) * ESP_NOW_ETH_ALEN);
+    node->peer_count--;
+    return ESP_OK;
+}
+
+bool esp_now_is_peer_exist(const uint8_t *peer_addr) {
+    return find_peer(this_node(), peer_addr) >= 0;
+}
+
+// --- Wi-Fi: one shared channel, ESPNOW_CHANNEL of both firmwares is not checked ---
+
+esp_err_t esp_netif_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_create_default(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t *mode) {
+    *mode = WIFI_MODE_STA;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t second) {
+    this_node()->channel = primary;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_channel(uint8_t *primary, wifi_second_chan_t *second) {
+    *primary = this_node()->channel;
+    *second = WIFI_SECOND_CHAN_NONE;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6]) {
+    memcpy(mac, this_node()->mac, 6);
+    return ESP_OK;
+}
@@ -0,0 +1,710 @@
+/*
+ * Orchestra simulator - scheduler, FreeRTOS และ esp_timer ในเวลาจำลอง
+ * Task แต่ละตัวเป็น pthread ที่ต้องถือ baton ถึงจะรันได้ - มีแค่ task เดียวหรือ scheduler ที่รันอยู่
+ * Scheduler: รัน task ที่ ready จนทุกตัวรอ แล้วเลื่อนเวลาไปยัง event ถัดไป (timer, frame, timeout)
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#define SIM_TASK_STACK_BYTES    (512 * 1024)
+#define SIM_MAX_TASKS           512
+
+struct sim_task {
+    sim_node_t* node;
+    char name[16];
+    TaskFunction_t fn;
+    void* arg;
+    UBaseType_t priority;
+    pthread_cond_t cond;
+    bool ready;
+    bool dead;
+    bool woken;                 // Last wait ended by a give/notify, not by its timeout
+    uint64_t ready_seq;         // FIFO among tasks of the same priority
+    uint32_t notify_count;
+    bool notify_waiting;
+    uint32_t wait_gen;          // Bumped on every wake, stale timeouts compare against it
+    struct sim_task** waiting_list;
+    struct sim_task* next_waiter;
+};
+
+struct sim_queue {
+    UBaseType_t length;
+    UBaseType_t item_size;      // 0 = semaphore
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t* items;
+    struct sim_task* receivers; // Waiting for an item (FIFO)
+    struct sim_task* senders;   // Waiting for room
+};
+
+struct esp_timer {
+    sim_node_t* node;
+    esp_timer_cb_t callback;
+    void* arg;
+    bool active;
+    bool periodic;
+    int64_t period_us;
+    int64_t due_local_us;
+    uint32_t gen;
+};
+
+typedef struct {
+    int64_t true_us;
+    uint64_t seq;               // Same instant: first scheduled runs first
+    sim_node_t* node;
+    sim_event_fn_t fn;
+    void* arg;
+    uint32_t gen;
+} sim_event_t;
+
+static pthread_mutex_t baton = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t scheduler_cond = PTHREAD_COND_INITIALIZER;
+static bool scheduler_holds_baton = false;
+static struct sim_task* running = NULL;    // NULL = the scheduler (timer/radio callbacks)
+static sim_node_t* current_node = NULL;
+static int64_t now_us = 0;
+static bool stop_requested = false;
+
+static sim_node_t* nodes[SIM_MAX_NODES];
+static int node_count = 0;
+static struct sim_task* tasks[SIM_MAX_TASKS];
+static int task_count = 0;
+static uint64_t ready_counter = 0;
+
+static sim_event_t* events = NULL;
+static size_t event_count = 0;
+static size_t event_capacity = 0;
+static uint64_t event_seq = 0;
+
+void sim_fatal(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "orchestra_sim: %.3f ms %s: ", now_us / 1000.0, current_node ? current_node->name : "-");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    exit(1);
+}
+
+// --- Time ---
+
+int64_t sim_now_us(void) {
+    return now_us;
+}
+
+sim_node_t* sim_current_node(void) {
+    return current_node;
+}
+
+static double clock_rate(const sim_node_t* node) {
+    return 1.0 + node->skew_ppm * 1e-6;
+}
+
+int64_t sim_node_local_us(const sim_node_t* node, int64_t true_us) {
+    return (int64_t)floor((double)(true_us - node->boot_us) * clock_rate(node));
+}
+
+int64_t sim_node_true_us(const sim_node_t* node, int64_t local_us) {
+    int64_t true_us = node->boot_us + (int64_t)ceil((double)local_us / clock_rate(node));
+    // Rounding: a timer must never see its clock short of the due time (it would re-arm for 0 us forever)
+    while (sim_node_local_us(node, true_us) < local_us) {
+        true_us++;
+    }
+    while (sim_node_local_us(node, true_us - 1) >= local_us) {
+        true_us--;
+    }
+    return true_us;
+}
+
+static sim_node_t* node_context(const char* what) {
+    if (current_node == NULL) {
+        sim_fatal("%s called outside any board", what);
+    }
+    return current_node;
+}
+
+static int64_t local_now_us(const sim_node_t* node) {
+    return sim_node_local_us(node, now_us);
+}
+
+// --- Events ---
+
+static bool event_before(const sim_event_t* a, const sim_event_t* b) {
+    return a->true_us < b->true_us || (a->true_us == b->true_us && a->seq < b->seq);
+}
+
+void sim_schedule(int64_t true_us, sim_node_t* node, sim_event_fn_t fn, void* arg, uint32_t gen) {
+    if (event_count == event_capacity) {
+        event_capacity = event_capacity ? event_capacity * 2 : 256;
+        events = realloc(events, event_capacity * sizeof(sim_event_t));
+        if (events == NULL) {
+            sim_fatal("out of memory for events");
+        }
+    }
+    sim_event_t ev = {true_us < now_us ? now_us : true_us, event_seq++, node, fn, arg, gen};
+    size_t i = event_count++;
+    while (i > 0 && event_before(&ev, &events[(i - 1) / 2])) {
+        events[i] = events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    events[i] = ev;
+}
+
+static sim_event_t event_pop(void) {
+    sim_event_t top = events[0];
+    sim_event_t last = events[--event_count];
+    size_t i = 0;
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= event_count) {
+            break;
+        }
+        if (child + 1 < event_count && event_before(&events[child + 1], &events[child])) {
+            child++;
+        }
+        if (!event_before(&events[child], &last)) {
+            break;
+        }
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+    return top;
+}
+
+// --- Tasks ---
+
+static void make_ready(struct sim_task* task) {
+    if (!task->ready && !task->dead) {
+        task->ready = true;
+        task->ready_seq = ready_counter++;
+    }
+}
+
+static struct sim_task* pop_ready(void) {
+    struct sim_task* best = NULL;
+    for (int i = 0; i < task_count; i++) {
+        struct sim_task* task = tasks[i];
+        if (task->ready && (best == NULL || task->priority > best->priority ||
+                            (task->priority == best->priority && task->ready_seq < best->ready_seq))) {
+            best = task;
+        }
+    }
+    if (best) {
+        best->ready = false;
+    }
+    return best;
+}
+
+// Scheduler side: hand the baton to a task and wait until it blocks or ends
+static void run_task(struct sim_task* task) {
+    running = task;
+    current_node = task->node;
+    pthread_cond_signal(&task->cond);
+    while (running != NULL) {
+        pthread_cond_wait(&scheduler_cond, &baton);
+    }
+    current_node = NULL;
+}
+
+// Task side: give the baton back and sleep until the scheduler picks this task again
+static void task_block(struct sim_task* task) {
+    running = NULL;
+    pthread_cond_signal(&scheduler_cond);
+    while (running != task) {
+        pthread_cond_wait(&task->cond, &baton);
+    }
+}
+
+static void task_finish(struct sim_task* task) {
+    task->dead = true;
+    task->ready = false;
+    running = NULL;
+    pthread_cond_signal(&scheduler_cond);
+    pthread_mutex_unlock(&baton);
+}
+
+static void* task_thread(void* arg) {
+    struct sim_task* task = arg;
+    pthread_mutex_lock(&baton);
+    while (running != task) {
+        pthread_cond_wait(&task->cond, &baton);
+    }
+    task->fn(task->arg);
+    task_finish(task);
+    return NULL;
+}
+
+static struct sim_task* task_create(sim_node_t* node, const char* name, TaskFunction_t fn, void* arg,
+                                    UBaseType_t priority) {
+    if (task_count >= SIM_MAX_TASKS) {
+        sim_fatal("more than %d tasks", SIM_MAX_TASKS);
+    }
+    struct sim_task* task = calloc(1, sizeof(*task));
+    task->node = node;
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "task");
+    task->fn = fn;
+    task->arg = arg;
+    task->priority = priority;
+    pthread_cond_init(&task->cond, NULL);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SIM_TASK_STACK_BYTES);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, task_thread, task) != 0) {
+        sim_fatal("cannot start a thread for task %s", task->name);
+    }
+    pthread_attr_destroy(&attr);
+
+    tasks[task_count++] = task;
+    make_ready(task);
+    return task;
+}
+
+static struct sim_task* current_task(const char* what) {
+    if (running == NULL) {
+        sim_fatal("%s would block in a timer or ESP-NOW callback", what);
+    }
+    return running;
+}
+
+static void waiter_add(struct sim_task** list, struct sim_task* task) {
+    task->next_waiter = NULL;
+    task->waiting_list = list;
+    while (*list) {
+        list = &(*list)->next_waiter;
+    }
+    *list = task;
+}
+
+static void waiter_remove(struct sim_task* task) {
+    struct sim_task** list = task->waiting_list;
+    while (list && *list) {
+        if (*list == task) {
+            *list = task->next_waiter;
+            break;
+        }
+        list = &(*list)->next_waiter;
+    }
+    task->waiting_list = NULL;
+    task->next_waiter = NULL;
+}
+
+static void task_wake(struct sim_task* task) {
+    task->wait_gen++;
+    task->woken = true;
+    task->notify_waiting = false;
+    waiter_remove(task);
+    make_ready(task);
+}
+
+static void wait_timeout(void* arg, uint32_t gen) {
+    struct sim_task* task = arg;
+    if (task->wait_gen != gen || task->dead) {
+        return;
+    }
+    task->wait_gen++;
+    task->notify_waiting = false;
+    waiter_remove(task);
+    make_ready(task);
+}
+
+// Block the running task until woken or until the deadline (INT64_MAX = forever). True if woken.
+static bool task_wait_until(struct sim_task* task, int64_t deadline_us) {
+    task->woken = false;
+    uint32_t gen = ++task->wait_gen;
+    if (deadline_us != INT64_MAX) {
+        sim_schedule(deadline_us, task->node, wait_timeout, task, gen);
+    }
+    task_block(task);
+    return task->woken;
+}
+
+static int64_t ticks_deadline(const sim_node_t* node, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return INT64_MAX;
+    }
+    return sim_node_true_us(node, local_now_us(node) + (int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created_task) {
+    struct sim_task* task = task_create(node_context("xTaskCreate"), name, fn, arg, priority);
+    if (created_task) {
+        *created_task = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id) {
+    return xTaskCreate(fn, name, stack_depth, arg, priority, created_task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct sim_task* task = current_task("vTaskDelay");
+    if (ticks == 0) {
+        make_ready(task); // Yield to tasks that are ready at the same instant
+        task_block(task);
+        return;
+    }
+    task_wait_until(task, ticks_deadline(task->node, ticks));
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL || task == running) {
+        struct sim_task* self = current_task("vTaskDelete");
+        task_finish(self);
+        pthread_exit(NULL);
+    }
+    task->dead = true;
+    task->ready = false;
+    waiter_remove(task);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    sim_node_t* node = node_context("xTaskGetTickCount");
+    return (TickType_t)(local_now_us(node) / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return running;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    struct sim_task* task = current_task("ulTaskNotifyTake");
+    if (task->notify_count == 0 && ticks_to_wait > 0) {
+        task->notify_waiting = true;
+        task_wait_until(task, ticks_deadline(task->node, ticks_to_wait));
+        task->notify_waiting = false;
+    }
+    uint32_t value = task->notify_count;
+    if (value > 0) {
+        task->notify_count = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (task == NULL) {
+        sim_fatal("xTaskNotifyGive(NULL)");
+    }
+    task->notify_count++;
+    if (task->notify_waiting) {
+        task_wake(task);
+    }
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken) {
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+}
+
+// --- Queues and semaphores ---
+
+static QueueHandle_t queue_create(UBaseType_t length, UBaseType_t item_size, UBaseType_t initial_count) {
+    struct sim_queue* queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->count = initial_count;
+    if (item_size > 0) {
+        queue->items = calloc(length, item_size);
+    }
+    return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return queue_create(length, item_size, 0);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait) {
+    int64_t deadline_us = 0;
+    if (ticks_to_wait > 0) {
+        deadline_us = ticks_deadline(node_context("xQueueSend"), ticks_to_wait);
+    }
+    while (queue->count >= queue->length) {
+        if (ticks_to_wait == 0) {
+            return pdFALSE;
+        }
+        struct sim_task* task = current_task("xQueueSend");
+        waiter_add(&queue->senders, task);
+        if (!task_wait_until(task, deadline_us)) {
+            return pdFALSE;
+        }
+    }
+
+    if (queue->item_size > 0) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + (size_t)tail * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    if (queue->receivers) {
+        task_wake(queue->receivers);
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait) {
+    int64_t deadline_us = 0;
+    if (ticks_to_wait > 0) {
+        deadline_us = ticks_deadline(node_context("xQueueReceive"), ticks_to_wait);
+    }
+    // A task that was woken may still find the queue empty (another one got there first)
+    while (queue->count == 0) {
+        if (ticks_to_wait == 0) {
+            return pdFALSE;
+        }
+        struct sim_task* task = current_task("xQueueReceive");
+        waiter_add(&queue->receivers, task);
+        if (!task_wait_until(task, deadline_us)) {
+            return pdFALSE;
+        }
+    }
+
+    if (queue->item_size > 0) {
+        memcpy(item, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    if (queue->senders) {
+        task_wake(queue->senders);
+    }
+    return pdTRUE;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue) {
+        free(queue->items);
+        free(queue);
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return queue_create(1, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return queue_create(1, 0, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    return xQueueReceive(semaphore, NULL, ticks_to_wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return xQueueSend(semaphore, NULL, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    vQueueDelete(semaphore);
+}
+
+// --- esp_timer ---
+
+static void timer_fire(void* arg, uint32_t gen);
+
+static void timer_arm(struct esp_timer* timer, int64_t due_local_us) {
+    timer->due_local_us = due_local_us;
+    sim_schedule(sim_node_true_us(timer->node, due_local_us), timer->node, timer_fire, timer, ++timer->gen);
+}
+
+static void timer_fire(void* arg, uint32_t gen) {
+    struct esp_timer* timer = arg;
+    if (timer->gen != gen || !timer->active) {
+        return; // Stopped or re-armed since
+    }
+    if (timer->periodic) {
+        timer_arm(timer, timer->due_local_us + timer->period_us);
+    } else {
+        timer->active = false;
+    }
+    timer->callback(timer->arg);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_timer* timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->node = node_context("esp_timer_create");
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->periodic = false;
+    timer_arm(timer, local_now_us(timer->node) + (int64_t)timeout_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (timer == NULL || period == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->periodic = true;
+    timer->period_us = (int64_t)period;
+    timer_arm(timer, local_now_us(timer->node) + (int64_t)period);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    timer->gen++;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->gen++; // Kept allocated: a stale event may still point at it
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer != NULL && timer->active;
+}
+
+int64_t esp_timer_get_time(void) {
+    return local_now_us(node_context("esp_timer_get_time"));
+}
+
+// --- Nodes and the run loop ---
+
+void sim_reset(void) {
+    if (running != NULL) {
+        sim_fatal("sim_reset() from a task");
+    }
+    for (int i = 0; i < node_count; i++) {
+        free(nodes[i]); // Firmware images stay loaded, their parked tasks still point into them
+    }
+    node_count = 0;
+    task_count = 0;
+    event_count = 0;
+    event_seq = 0;
+    ready_counter = 0;
+    now_us = 0;
+    current_node = NULL;
+    stop_requested = false;
+    sim_radio_reset();
+}
+
+sim_node_t* sim_node_create(const char* name, double skew_ppm, uint32_t seed) {
+    if (node_count >= SIM_MAX_NODES) {
+        sim_fatal("more than %d boards", SIM_MAX_NODES);
+    }
+    sim_node_t* node = calloc(1, sizeof(*node));
+    node->index = node_count;
+    snprintf(node->name, sizeof(node->name), "%s", name);
+    // Locally administered unicast MAC, last byte = node index
+    const uint8_t mac[6] = {0x02, 0x0E, 0x5A, 0x00, 0x00, (uint8_t)node_count};
+    memcpy(node->mac, mac, 6);
+    node->skew_ppm = skew_ppm;
+    node->rng = seed ? seed : 1;
+    nodes[node_count++] = node;
+    return node;
+}
+
+int sim_node_count(void) {
+    return node_count;
+}
+
+sim_node_t* sim_node_get(int index) {
+    return index >= 0 && index < node_count ? nodes[index] : NULL;
+}
+
+static void main_task(void* arg) {
+    sim_node_t* node = arg;
+    node->app_main(); // ESP-IDF deletes the main task once app_main() returns
+}
+
+static void boot_event(void* arg, uint32_t gen) {
+    sim_node_t* node = arg;
+    node->booted = true;
+    task_create(node, "main", main_task, node, (UBaseType_t)node->main_priority);
+}
+
+void sim_node_boot(sim_node_t* node, int64_t boot_us, void (*entry)(void), int priority) {
+    node->boot_us = boot_us;
+    node->app_main = entry;
+    node->main_priority = priority;
+    sim_schedule(boot_us, node, boot_event, node, 0);
+}
+
+void sim_task_create(sim_node_t* node, const char* name, void (*fn)(void* arg), void* arg, int priority) {
+    task_create(node, name, fn, arg, (UBaseType_t)priority);
+}
+
+void sim_stop(void) {
+    stop_requested = true;
+}
+
+void sim_run_until(int64_t end_us) {
+    if (!scheduler_holds_baton) {
+        pthread_mutex_lock(&baton);
+        scheduler_holds_baton = true;
+    }
+    stop_requested = false;
+
+    while (!stop_requested) {
+        struct sim_task* task = pop_ready();
+        if (task) {
+            run_task(task);
+            continue;
+        }
+        if (event_count == 0 || events[0].true_us > end_us) {
+            break;
+        }
+        sim_event_t ev = event_pop();
+        now_us = ev.true_us;
+        current_node = ev.node;
+        ev.fn(ev.arg, ev.gen);
+        current_node = NULL;
+    }
+    if (!stop_requested && end_us != INT64_MAX && now_us < end_us) {
+        now_us = end_us;
+    }
+}
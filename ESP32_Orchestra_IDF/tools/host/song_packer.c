@@ -0,0 +1,332 @@
+/*
+ * song_packer - สร้าง song library image สำหรับ partition "songs" ของ Conductor
+ * รวมเพลง built-in, ไฟล์ MIDI และ .osc เป็น image เดียว (format: song_library_format.h)
+ *
+ *   song_packer -o songs.bin [--size BYTES] [--fec DEPTH] [--builtin] [ID:NAME:file.mid|file.osc ...]
+ *   song_packer --list songs.bin        ตรวจ CRC แล้วแสดงเพลงใน image
+ *
+ * --fec: note FEC depth ของเพลงจากไฟล์ (เพลง built-in ใช้ค่าใน midi_songs.h)
+ *
+ * เขียนลงบอร์ด:
+ *   parttool.py write_partition --partition-name songs --input songs.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "midi_songs.h"
+#include "score_codec.h"
+#include "smf_parser.h"
+#include "song_library_format.h"
+
+#define DEFAULT_IMAGE_SIZE  (1024 * 1024)   // songs partition in conductor/partitions.csv
+#define MAX_EVENTS          4096
+#define MAX_FILE_LEN        (256 * 1024)
+#define READ_SIZE           256
+
+static uint8_t* image = NULL;
+static uint32_t image_capacity = 0;
+static uint32_t image_used = 0;
+static uint8_t file_fec_depth = 0;
+
+static score_note_t part_events[SCORE_MAX_PARTS][MAX_EVENTS];
+static uint8_t file_buf[MAX_FILE_LEN];
+
+static uint32_t crc32_zlib(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static song_library_header_t* header(void) {
+    return (song_library_header_t*)image;
+}
+
+// Reserve len bytes at the next aligned offset, 0 = image full
+static uint32_t image_alloc(uint32_t len) {
+    uint32_t offset = (image_used + SONG_LIBRARY_ALIGN - 1) & ~(uint32_t)(SONG_LIBRARY_ALIGN - 1);
+    if (offset + len > image_capacity) {
+        return 0;
+    }
+    image_used = offset + len;
+    return offset;
+}
+
+static bool add_song(uint8_t song_id, const char* name, uint8_t tempo_bpm, uint8_t fec_depth,
+                     const score_part_src_t* parts, const char* const* part_names, uint8_t part_count) {
+    if (song_id == 0 || header()->index[song_id] != 0) {
+        fprintf(stderr, "song %d: ID is 0 or already used\n", song_id);
+        return false;
+    }
+    if (part_count == 0 || part_count > SCORE_MAX_PARTS) {
+        fprintf(stderr, "song %d: %d parts (1-%d supported)\n", song_id, part_count, SCORE_MAX_PARTS);
+        return false;
+    }
+
+    uint32_t record_len = sizeof(song_library_song_t) + part_count * sizeof(song_library_part_t);
+    uint32_t offset = image_alloc(record_len);
+    if (offset == 0) {
+        fprintf(stderr, "song %d: image full\n", song_id);
+        return false;
+    }
+
+    song_library_song_t* record = (song_library_song_t*)(image + offset);
+    record->song_id = song_id;
+    record->tempo_bpm = tempo_bpm;
+    record->part_count = part_count;
+    record->fec_depth = fec_depth;
+    snprintf(record->name, sizeof(record->name), "%s", name);
+
+    for (uint8_t p = 0; p < part_count; p++) {
+        uint32_t events_len = parts[p].event_count * sizeof(score_note_t);
+        uint32_t events_offset = image_alloc(events_len);
+        if (events_offset == 0) {
+            fprintf(stderr, "song %d: image full\n", song_id);
+            return false;
+        }
+        memcpy(image + events_offset, parts[p].events, events_len);
+        record->parts[p].events_offset = events_offset;
+        record->parts[p].event_count = parts[p].event_count;
+        snprintf(record->parts[p].name, sizeof(record->parts[p].name), "%s", part_names[p]);
+    }
+
+    header()->index[song_id] = offset;
+    header()->song_count++;
+    printf("  %3d  %-31s %d parts, %d BPM%s\n", song_id, record->name, part_count, tempo_bpm,
+           fec_depth ? ", FEC" : "");
+    return true;
+}
+
+static bool add_builtin_songs(void) {
+    for (size_t s = 0; s < TOTAL_SONGS; s++) {
+        const orchestra_song_t* song = &all_songs[s];
+        score_part_src_t parts[SCORE_MAX_PARTS];
+        const char* names[SCORE_MAX_PARTS];
+        for (uint8_t p = 0; p < song->part_count; p++) {
+            parts[p].events = song->parts[p].events;
+            parts[p].event_count = song->parts[p].event_count;
+            names[p] = song->parts[p].part_name;
+        }
+        if (!add_song(song->song_id, song->song_name, song->tempo_bpm, song->fec_depth, parts, names, song->part_count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const char* const default_part_names[SCORE_MAX_PARTS] = {
+    "Part A", "Part B", "Part C", "Part D", "Part E", "Part F", "Part G", "Part H"
+};
+
+static bool add_midi(uint8_t song_id, const char* name, const uint8_t* data, size_t len, const char* path) {
+    static smf_parser_t parser;
+    smf_parser_init(&parser, NULL);
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        smf_parser_set_part_buffer(&parser, p, part_events[p], MAX_EVENTS);
+    }
+
+    smf_result_t result = SMF_OK;
+    for (size_t pos = 0; pos < len && result == SMF_OK; pos += READ_SIZE) {
+        result = smf_parser_feed(&parser, data + pos, len - pos < READ_SIZE ? len - pos : READ_SIZE);
+    }
+    if (result == SMF_OK) {
+        result = smf_parser_finish(&parser);
+    }
+    if (result != SMF_OK) {
+        fprintf(stderr, "%s: %s\n", path, smf_result_name(result));
+        return false;
+    }
+
+    score_part_src_t parts[SMF_MAX_PARTS];
+    uint8_t part_count = 0;
+    for (uint8_t p = 0; p < SMF_MAX_PARTS; p++) {
+        parts[p].events = parser.parts[p].events;
+        parts[p].event_count = parser.parts[p].count;
+        if (parser.parts[p].count > 0) {
+            part_count = p + 1;
+        }
+        if (parser.parts[p].overflow) {
+            fprintf(stderr, "%s: part %c truncated to %d events\n", path, 'A' + p, MAX_EVENTS);
+        }
+    }
+    return add_song(song_id, name, smf_parser_tempo_bpm(&parser), file_fec_depth, parts, default_part_names, part_count);
+}
+
+static bool add_osc(uint8_t song_id, const char* name, const uint8_t* data, size_t len, const char* path) {
+    score_info_t info;
+    if (!score_parse(data, len, &info)) {
+        fprintf(stderr, "%s: not a valid .osc file\n", path);
+        return false;
+    }
+
+    score_part_src_t parts[SCORE_MAX_PARTS];
+    for (uint8_t p = 0; p < info.part_count; p++) {
+        int count = score_decode_part(&info, p, part_events[p], MAX_EVENTS);
+        if (count < 0) {
+            fprintf(stderr, "%s: part %d corrupt\n", path, p);
+            return false;
+        }
+        parts[p].events = part_events[p];
+        parts[p].event_count = (uint16_t)count;
+    }
+    return add_song(song_id, name, info.tempo_bpm, file_fec_depth, parts, default_part_names, info.part_count);
+}
+
+static size_t read_file(const char* path, uint8_t* buf, size_t size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 0;
+    }
+    size_t len = fread(buf, 1, size, f);
+    if (len == size && fgetc(f) != EOF) {
+        fprintf(stderr, "%s: larger than %zu bytes\n", path, size);
+        len = 0;
+    }
+    fclose(f);
+    return len;
+}
+
+// ID:NAME:path - the file type comes from the extension
+static bool add_spec(const char* spec) {
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    char* name = strchr(buf, ':');
+    char* path = name ? strchr(name + 1, ':') : NULL;
+    if (!path) {
+        fprintf(stderr, "bad song spec: %s (want ID:NAME:file)\n", spec);
+        return false;
+    }
+    *name++ = '\0';
+    *path++ = '\0';
+
+    char* end;
+    long song_id = strtol(buf, &end, 10);
+    if (*end || song_id < 1 || song_id >= SONG_LIBRARY_INDEX_SIZE) {
+        fprintf(stderr, "bad song ID: %s\n", buf);
+        return false;
+    }
+
+    size_t len = read_file(path, file_buf, sizeof(file_buf));
+    if (len == 0) {
+        return false;
+    }
+    const char* ext = strrchr(path, '.');
+    if (ext && (strcmp(ext, ".mid") == 0 || strcmp(ext, ".midi") == 0)) {
+        return add_midi((uint8_t)song_id, name, file_buf, len, path);
+    }
+    if (ext && strcmp(ext, ".osc") == 0) {
+        return add_osc((uint8_t)song_id, name, file_buf, len, path);
+    }
+    fprintf(stderr, "%s: unknown file type (.mid or .osc)\n", path);
+    return false;
+}
+
+static int cmd_list(const char* path) {
+    static uint8_t buf[16 * 1024 * 1024];
+    size_t len = read_file(path, buf, sizeof(buf));
+    const song_library_header_t* h = (const song_library_header_t*)buf;
+
+    if (len < sizeof(*h) || memcmp(h->magic, SONG_LIBRARY_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != SONG_LIBRARY_VERSION || h->image_size < sizeof(*h) || h->image_size > len) {
+        fprintf(stderr, "%s: not a song library image\n", path);
+        return 1;
+    }
+    uint32_t crc = crc32_zlib(buf + sizeof(*h), h->image_size - sizeof(*h));
+    printf("%s: %d songs, %lu bytes, CRC %08lx %s\n", path, h->song_count, (unsigned long)h->image_size,
+           (unsigned long)h->crc32, crc == h->crc32 ? "OK" : "MISMATCH");
+
+    for (int id = 0; id < SONG_LIBRARY_INDEX_SIZE; id++) {
+        uint32_t offset = h->index[id];
+        if (offset == 0) {
+            continue;
+        }
+        if (offset + sizeof(song_library_song_t) > h->image_size) {
+            printf("  %3d  <bad offset %lu>\n", id, (unsigned long)offset);
+            continue;
+        }
+        const song_library_song_t* record = (const song_library_song_t*)(buf + offset);
+        printf("  %3d  %-31.31s %d BPM, FEC depth %d\n", id, record->name, record->tempo_bpm, record->fec_depth);
+        for (uint8_t p = 0; p < record->part_count && p < SCORE_MAX_PARTS; p++) {
+            printf("         %-15.15s %5d events @ 0x%06lx\n", record->parts[p].name,
+                   record->parts[p].event_count, (unsigned long)record->parts[p].events_offset);
+        }
+    }
+    return crc == h->crc32 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    const char* out_path = NULL;
+    bool builtin = false;
+    unsigned long size = DEFAULT_IMAGE_SIZE;
+    int first_spec = argc;
+
+    if (argc == 3 && strcmp(argv[1], "--list") == 0) {
+        return cmd_list(argv[2]);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            size = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--fec") == 0 && i + 1 < argc) {
+            file_fec_depth = (uint8_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--builtin") == 0) {
+            builtin = true;
+        } else if (argv[i][0] != '-') {
+            first_spec = i;
+            break;
+        } else {
+            out_path = NULL;
+            break;
+        }
+    }
+    if (!out_path || size < sizeof(song_library_header_t) || (!builtin && first_spec == argc)) {
+        fprintf(stderr, "usage: %s -o songs.bin [--size BYTES] [--fec DEPTH] [--builtin] [ID:NAME:file.mid|file.osc ...]\n"
+                        "       %s --list songs.bin\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    image_capacity = (uint32_t)size;
+    image = calloc(1, image_capacity);
+    if (!image) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    memcpy(header()->magic, SONG_LIBRARY_MAGIC, sizeof(header()->magic));
+    header()->version = SONG_LIBRARY_VERSION;
+    image_used = sizeof(song_library_header_t);
+
+    bool ok = !builtin || add_builtin_songs();
+    for (int i = first_spec; i < argc && ok; i++) {
+        ok = add_spec(argv[i]);
+    }
+    if (!ok) {
+        free(image);
+        return 1;
+    }
+
+    header()->image_size = image_used;
+    header()->crc32 = crc32_zlib(image + sizeof(song_library_header_t),
+                                 image_used - sizeof(song_library_header_t));
+
+    FILE* f = fopen(out_path, "wb");
+    if (!f || fwrite(image, 1, image_used, f) != image_used) {
+        fprintf(stderr, "%s: write failed\n", out_path);
+        if (f) {
+            fclose(f);
+        }
+        free(image);
+        return 1;
+    }
+    fclose(f);
+    printf("%s: %d songs, %lu of %lu bytes\n", out_path, header()->song_count,
+           (unsigned long)image_used, size);
+    free(image);
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * synth_bench - ทดสอบและวัดความเร็ว mixing kernel ของ synth_core บน PC
+ *
+ *   synth_bench check              ตรวจ envelope, velocity, voice stealing, clipping
+ *   synth_bench bench [voices]     เวลา render ต่อ frame ที่ 22050/32000/44100 Hz
+ *   synth_bench wav out.wav        render chord + arpeggio ไว้ฟัง (mono 16 bit, 32 kHz)
+ *
+ * ตัวเลขจาก bench เป็นของเครื่อง host - บนบอร์ดดู "Synth" ใน status ของ Musician (load %)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "synth_core.h"
+
+#define BLOCK_FRAMES    128
+#define BENCH_SECONDS   10
+
+static const synth_adsr_t adsr = {.attack_ms = 5, .decay_ms = 80, .sustain_level = 180, .release_ms = 60};
+
+static int peak_of(const int16_t* buf, size_t frames) {
+    int peak = 0;
+    for (size_t i = 0; i < frames; i++) {
+        int v = abs(buf[i]);
+        if (v > peak) {
+            peak = v;
+        }
+    }
+    return peak;
+}
+
+// Render ms of audio, return the peak level
+static int render_ms(synth_t* synth, uint32_t ms) {
+    static int16_t buf[BLOCK_FRAMES];
+    uint32_t frames = synth_ms_to_frames(synth, ms);
+    int peak = 0;
+    while (frames > 0) {
+        uint32_t n = frames < BLOCK_FRAMES ? frames : BLOCK_FRAMES;
+        synth_render(synth, buf, n);
+        int p = peak_of(buf, n);
+        if (p > peak) {
+            peak = p;
+        }
+        frames -= n;
+    }
+    return peak;
+}
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static int cmd_check(void) {
+    static synth_t synth;
+
+    synth_init(&synth, 32000, SYNTH_WAVE_SINE, &adsr);
+    expect(render_ms(&synth, 50) == 0, "silent without notes");
+
+    synth_note_on(&synth, 69, 127, synth_ms_to_frames(&synth, 200));
+    int loud = render_ms(&synth, 100);
+    expect(loud > 5000 && synth_active_voices(&synth) == 1, "note sounds, one voice");
+    render_ms(&synth, 100 + adsr.release_ms + 10);
+    expect(synth_active_voices(&synth) == 0 && render_ms(&synth, 20) == 0,
+           "voice ends after duration + release");
+
+    synth_note_on(&synth, 69, 40, synth_ms_to_frames(&synth, 200));
+    int soft = render_ms(&synth, 100);
+    expect(soft > 0 && soft < loud / 4, "velocity 40 is much quieter than 127");
+    synth_all_off(&synth);
+    render_ms(&synth, adsr.release_ms + 10);
+    expect(synth_active_voices(&synth) == 0, "all_off releases every voice");
+
+    for (int i = 0; i < SYNTH_MAX_VOICES + 2; i++) {
+        synth_note_on(&synth, (uint8_t)(48 + i), 100, synth_ms_to_frames(&synth, 1000));
+    }
+    render_ms(&synth, 20);
+    expect(synth_active_voices(&synth) == SYNTH_MAX_VOICES && synth.voices_stolen == 2,
+           "extra notes steal voices");
+
+    // Full master gain drives the chord into clipping: a wrapped mix jumps by ~65536
+    // between samples, a saturated one cannot
+    synth.master_gain = INT16_MAX;
+    static int16_t chord[32 * BLOCK_FRAMES];
+    int max_step = 0;
+    synth_render(&synth, chord, 32 * BLOCK_FRAMES);
+    for (int i = 1; i < 32 * BLOCK_FRAMES; i++) {
+        int step = abs(chord[i] - chord[i - 1]);
+        max_step = step > max_step ? step : max_step;
+    }
+    expect(peak_of(chord, 32 * BLOCK_FRAMES) >= INT16_MAX && max_step < 20000, "full chord saturates instead of wrapping");
+
+    synth_all_off(&synth);
+    render_ms(&synth, adsr.release_ms + 10);
+    synth_note_on(&synth, 60, 100, synth_ms_to_frames(&synth, 500));
+    synth_note_off(&synth, 60);
+    render_ms(&synth, adsr.release_ms + 10);
+    expect(synth_active_voices(&synth) == 0, "note_off releases early");
+
+    synth_init(&synth, 22050, SYNTH_WAVE_SQUARE, &adsr);
+    expect(synth_note_on(&synth, 127, 100, 1000) < 0, "notes above Nyquist are refused");
+
+    return failures ? 1 : 0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmd_bench(int voices) {
+    static const uint32_t rates[] = {22050, 32000, 44100};
+    static synth_t synth;
+    static int16_t buf[BLOCK_FRAMES];
+
+    printf("%d voices, %d frame blocks, %d s of audio per rate\n", voices, BLOCK_FRAMES, BENCH_SECONDS);
+    printf("%8s %12s %12s %12s\n", "rate", "ns/frame", "us/block", "x realtime");
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        synth_init(&synth, rates[r], SYNTH_WAVE_TRIANGLE, &adsr);
+        uint32_t total = rates[r] * BENCH_SECONDS;
+        for (int v = 0; v < voices; v++) {
+            synth_note_on(&synth, (uint8_t)(48 + v * 3), 100, total * 2); // Sustained the whole run
+        }
+
+        double start = now_s();
+        for (uint32_t done = 0; done < total; done += BLOCK_FRAMES) {
+            synth_render(&synth, buf, BLOCK_FRAMES);
+        }
+        double elapsed = now_s() - start;
+        double ns_per_frame = elapsed * 1e9 / total;
+        printf("%8lu %12.1f %12.2f %12.0f\n", (unsigned long)rates[r], ns_per_frame,
+               ns_per_frame * BLOCK_FRAMES / 1000.0, BENCH_SECONDS / elapsed);
+    }
+    return 0;
+}
+
+static void put_le(FILE* f, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xFF, f);
+    }
+}
+
+static int cmd_wav(const char* path) {
+    static synth_t synth;
+    static int16_t buf[BLOCK_FRAMES];
+    static const uint8_t chord[] = {60, 64, 67, 72};
+    const uint32_t rate = 32000;
+    const uint32_t total = rate * 3;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    fwrite("RIFF", 1, 4, f);
+    put_le(f, 36 + total * 2, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put_le(f, 16, 4);
+    put_le(f, 1, 2);            // PCM
+    put_le(f, 1, 2);            // Mono
+    put_le(f, rate, 4);
+    put_le(f, rate * 2, 4);
+    put_le(f, 2, 2);
+    put_le(f, 16, 2);
+    fwrite("data", 1, 4, f);
+    put_le(f, total * 2, 4);
+
+    // Chord for 1.2 s, then an arpeggio with rising velocity
+    synth_init(&synth, rate, SYNTH_WAVE_TRIANGLE, &adsr);
+    for (size_t i = 0; i < sizeof(chord); i++) {
+        synth_note_on(&synth, chord[i], 90, synth_ms_to_frames(&synth, 1200));
+    }
+    uint32_t next_ms = 1500;
+    uint8_t step = 0;
+    for (uint32_t frame = 0; frame < total; frame += BLOCK_FRAMES) {
+        if (frame * 1000 / rate >= next_ms && step < 8) {
+            synth_note_on(&synth, chord[step % sizeof(chord)] + 12 * (step / 4), (uint8_t)(60 + step * 8),
+                          synth_ms_to_frames(&synth, 140));
+            next_ms += 150;
+            step++;
+        }
+        synth_render(&synth, buf, BLOCK_FRAMES);
+        fwrite(buf, sizeof(int16_t), BLOCK_FRAMES, f);
+    }
+    fclose(f);
+    printf("%s: %lu frames\n", path, (unsigned long)total);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        int voices = argc >= 3 ? atoi(argv[2]) : SYNTH_MAX_VOICES;
+        return cmd_bench(voices < 1 ? 1 : voices > SYNTH_MAX_VOICES ? SYNTH_MAX_VOICES : voices);
+    }
+    if (argc >= 3 && strcmp(argv[1], "wav") == 0) {
+        return cmd_wav(argv[2]);
+    }
+
+    fprintf(stderr, "usage: %s check | bench [voices] | wav <out.wav>\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,286 @@
+/*
+ * timing_report - ความแม่นของจังหวะทั้งวงจาก console log ของบอร์ดจริง บน PC
+ * Musician build ด้วย TIMING_LOG 1 (timing_log.h) พิมพ์ทุก onset/offset บนนาฬิกา Conductor
+ *
+ *   timing_report check                        parser + สถิติกับ log สังเคราะห์ที่รู้คำตอบ
+ *   timing_report [--json file|-] log...       log ของบอร์ดละไฟล์ หรือรวมไฟล์เดียวก็ได้
+ *
+ * บรรทัดอื่นใน log (ESP_LOG, prefix ของ idf.py monitor) ถูกข้าม ใช้ได้เฉพาะเพลงใน all_songs[]
+ * ผลเหมือน orchestra_sim timing: onset error, skew ระหว่าง parts, ความยาวโน๊ต ต่อเพลงและรวม
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ensemble_timing.h"
+
+#define REPORT_MAX_SONGS    64
+#define REPORT_LINE_MAX     256
+
+typedef struct {
+    uint8_t song_id;
+    uint32_t start_ms;
+    ensemble_song_t* timing;
+} report_song_t;
+
+typedef struct {
+    report_song_t songs[REPORT_MAX_SONGS];
+    int song_count;
+    report_song_t* current[ENSEMBLE_MAX_BOARDS];   // Song each musician ID is playing
+    uint32_t records;
+    uint32_t lost;              // Records the boards dropped (ring full)
+    uint32_t unknown_songs;     // Song lines for IDs that are not in all_songs[]
+} report_t;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+// Boards of one performance log the same song ID and start time
+static report_song_t* find_song(report_t* report, uint8_t song_id, uint32_t start_ms) {
+    for (int i = 0; i < report->song_count; i++) {
+        if (report->songs[i].song_id == song_id && report->songs[i].start_ms == start_ms) {
+            return &report->songs[i];
+        }
+    }
+    const orchestra_song_t* source = get_song_by_id(song_id);
+    if (source == NULL || report->song_count >= REPORT_MAX_SONGS) {
+        report->unknown_songs++;
+        return NULL;
+    }
+    report_song_t* song = &report->songs[report->song_count++];
+    song->song_id = song_id;
+    song->start_ms = start_ms;
+    song->timing = malloc(sizeof(ensemble_song_t));
+    if (song->timing == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    ensemble_song_begin(song->timing, source, start_ms);
+    return song;
+}
+
+static void parse_line(report_t* report, const char* line) {
+    const char* record = strstr(line, "TIMING,");
+    if (record == NULL) {
+        return;
+    }
+    unsigned id, a, b;
+    unsigned long value;
+    long long time_us;
+    char kind[8];
+    int used = 0;
+    if (sscanf(record, "TIMING,%u,%7[a-z],%n", &id, kind, &used) != 2 || used == 0 || id >= ENSEMBLE_MAX_BOARDS) {
+        return;
+    }
+    const char* fields = record + used;
+
+    if (strcmp(kind, "song") == 0 && sscanf(fields, "%u,%lu,%x", &a, &value, &b) == 3) {
+        report_song_t* song = find_song(report, (uint8_t)a, (uint32_t)value);
+        report->current[id] = song;
+        if (song) {
+            ensemble_song_add_board(song->timing, (uint8_t)id, (uint8_t)b);
+        }
+    } else if (strcmp(kind, "lost") == 0 && sscanf(fields, "%lu", &value) == 1) {
+        report->lost += (uint32_t)value;
+    } else if ((strcmp(kind, "on") == 0 || strcmp(kind, "off") == 0) &&
+               sscanf(fields, "%u,%u,%lld", &a, &b, &time_us) == 3) {
+        report_song_t* song = report->current[id];
+        if (song == NULL) {
+            return; // Before the first song start of this board
+        }
+        if (kind[1] == 'n') {
+            ensemble_song_note_on(song->timing, (uint8_t)id, (uint8_t)a, (uint8_t)b, time_us);
+        } else {
+            ensemble_song_note_off(song->timing, (uint8_t)id, (uint8_t)a, time_us);
+        }
+    } else {
+        return;
+    }
+    report->records++;
+}
+
+static bool parse_file(report_t* report, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    char line[REPORT_LINE_MAX];
+    while (fgets(line, sizeof(line), file)) {
+        parse_line(report, line);
+    }
+    fclose(file);
+    return true;
+}
+
+static int compare_songs(const void* a, const void* b) {
+    const report_song_t* x = a;
+    const report_song_t* y = b;
+    return x->start_ms < y->start_ms ? -1 : x->start_ms > y->start_ms;
+}
+
+// Per song and total reports, in order of play
+static void analyze(report_t* report, ensemble_report_t* songs, ensemble_report_t* total) {
+    qsort(report->songs, report->song_count, sizeof(report->songs[0]), compare_songs);
+    ensemble_report_init(total);
+    for (int i = 0; i < report->song_count; i++) {
+        ensemble_report_init(&songs[i]);
+        ensemble_song_analyze(report->songs[i].timing, &songs[i], total);
+    }
+}
+
+static void report_free(report_t* report, ensemble_report_t* songs, ensemble_report_t* total) {
+    for (int i = 0; i < report->song_count; i++) {
+        free(report->songs[i].timing);
+        ensemble_report_free(&songs[i]);
+    }
+    ensemble_report_free(total);
+    memset(report, 0, sizeof(*report));
+}
+
+// Log of one board as the firmware would print it: every note of its parts, shifted and shortened
+static void write_board_log(FILE* out, const orchestra_song_t* song, uint32_t start_ms, uint8_t id,
+                            uint8_t part_mask, int32_t shift_us, int32_t shorten_us) {
+    fprintf(out, "I (12345) MUSICIAN: 🎼 Song started: ID %u\n", song->song_id);
+    fprintf(out, "TIMING,%u,song,%u,%lu,0x%02x\n", id, song->song_id, (unsigned long)start_ms, part_mask);
+    for (uint8_t part = 0; part < song->part_count; part++) {
+        if (!(part_mask & (1u << part))) {
+            continue;
+        }
+        int64_t time_us = (int64_t)start_ms * 1000;
+        for (uint16_t i = 0; i < song->parts[part].event_count; i++) {
+            const note_event_t* event = &song->parts[part].events[i];
+            if (event->note != NOTE_REST && event->duration_ms > 0) {
+                int64_t on_us = time_us + shift_us;
+                int64_t off_us = on_us + (int64_t)event->duration_ms * 1000 - shorten_us;
+                fprintf(out, "TIMING,%u,on,%u,%u,%lld\n", id, part, event->note, (long long)on_us);
+                fprintf(out, "TIMING,%u,off,%u,%u,%lld\n", id, part, event->note, (long long)off_us);
+            }
+            time_us += (int64_t)(event->duration_ms + event->delay_ms) * 1000;
+        }
+    }
+}
+
+static int cmd_check(void) {
+    static report_t report;
+    static ensemble_report_t songs[REPORT_MAX_SONGS];
+    ensemble_report_t total;
+    const orchestra_song_t* song = get_song_by_id(SONG_TWINKLE_STAR);
+
+    // 4 boards, one part each: board 2 plays 1.5 ms late, board 3 cuts every note 300 us short
+    FILE* log = tmpfile();
+    for (uint8_t id = 0; id < 4; id++) {
+        write_board_log(log, song, 5000, id, (uint8_t)(1u << id), id == 2 ? 1500 : 0, id == 3 ? 300 : 0);
+    }
+    fprintf(log, "TIMING,1,lost,3\nTIMING,garbage\nTIMING,40,on,0,60,1\n");
+    rewind(log);
+    char line[REPORT_LINE_MAX];
+    while (fgets(line, sizeof(line), log)) {
+        parse_line(&report, line);
+    }
+    fclose(log);
+    analyze(&report, songs, &total);
+
+    ensemble_summary_t onset, skew, length;
+    ensemble_summarize(&total.onset_error_us, &onset);
+    ensemble_summarize(&total.skew_us, &skew);
+    ensemble_summarize(&total.length_error_us, &length);
+    expect(report.song_count == 1 && report.lost == 3, "one song from 4 boards, lost records counted");
+    expect(total.notes > 0 && total.played == total.notes && total.extra == 0, "every note matched");
+    expect(onset.max == 1500 && onset.p50 == 0, "onset error: late board shows as max");
+    expect(skew.max == 1500 && skew.count > 0, "skew: late board against the others");
+    expect(length.max == 300 && length.mean < 0, "length error: shortened notes");
+    report_free(&report, songs, &total);
+
+    // A missing note and an unknown song
+    log = tmpfile();
+    fprintf(log, "TIMING,0,song,%u,100,0x01\n", SONG_MARY_LAMB);
+    uint8_t first_note = get_song_by_id(SONG_MARY_LAMB)->parts[0].events[0].note;
+    fprintf(log, "TIMING,0,on,0,%u,100000\nTIMING,0,off,0,%u,500000\n", first_note, first_note);
+    fprintf(log, "TIMING,1,song,250,100,0x01\nTIMING,1,on,0,60,100000\n");
+    rewind(log);
+    while (fgets(line, sizeof(line), log)) {
+        parse_line(&report, line);
+    }
+    fclose(log);
+    analyze(&report, songs, &total);
+    expect(total.played == 1 && total.missing == total.notes - 1, "notes that never sounded are missing");
+    expect(report.unknown_songs == 1, "songs outside all_songs[] are skipped");
+    report_free(&report, songs, &total);
+
+    return failures ? 1 : 0;
+}
+
+static int cmd_report(int argc, char** argv) {
+    static report_t report;
+    static ensemble_report_t songs[REPORT_MAX_SONGS];
+    ensemble_report_t total;
+    const char* json_path = NULL;
+
+    int files = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (parse_file(&report, argv[i])) {
+            files++;
+        } else {
+            return 1;
+        }
+    }
+    if (files == 0 || report.song_count == 0) {
+        fprintf(stderr, "no TIMING records (build the musicians with TIMING_LOG 1)\n");
+        return 1;
+    }
+    analyze(&report, songs, &total);
+
+    FILE* table = json_path && strcmp(json_path, "-") == 0 ? stderr : stdout;
+    fprintf(table, "%lu records from %d files, %lu lost on the boards, %lu unknown songs skipped\n",
+            (unsigned long)report.records, files, (unsigned long)report.lost, (unsigned long)report.unknown_songs);
+    ensemble_print_header(table);
+    for (int i = 0; i < report.song_count; i++) {
+        char name[40];
+        snprintf(name, sizeof(name), "%u %s", report.songs[i].song_id, report.songs[i].timing->song->song_name);
+        ensemble_print_row(table, name, &songs[i]);
+    }
+    ensemble_print_row(table, "all songs", &total);
+
+    if (json_path) {
+        FILE* json = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (json == NULL) {
+            perror(json_path);
+            return 1;
+        }
+        fprintf(json, "{\n  \"source\": \"console\",\n  \"records\": %lu,\n  \"lost\": %lu,\n  \"songs\": [\n",
+                (unsigned long)report.records, (unsigned long)report.lost);
+        for (int i = 0; i < report.song_count; i++) {
+            fprintf(json, "    {\"id\": %u, \"name\": \"%s\", \"start_ms\": %lu, \"timing\": ", report.songs[i].song_id,
+                    report.songs[i].timing->song->song_name, (unsigned long)report.songs[i].start_ms);
+            ensemble_write_json(json, &songs[i]);
+            fprintf(json, "}%s\n", i + 1 < report.song_count ? "," : "");
+        }
+        fprintf(json, "  ],\n  \"total\": ");
+        ensemble_write_json(json, &total);
+        fprintf(json, "\n}\n");
+        if (json != stdout) {
+            fclose(json);
+        }
+    }
+    report_free(&report, songs, &total);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2) {
+        return cmd_report(argc - 1, argv + 1);
+    }
+
+    fprintf(stderr, "usage: %s check | [--json file|-] log...\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,439 @@
+/*
+ * trace_decode - TRACE_RING dump จาก console log ของบอร์ด เป็น Chrome trace JSON บน PC
+ * Firmware build ด้วย TRACE_RING 1 (common/orchestra_trace/include/trace_ring.h) พิมพ์ ring ทุกครั้งที่เพลงจบ
+ *
+ *   trace_decode check                         decoder กับ dump สังเคราะห์ที่รู้คำตอบ
+ *   trace_decode [-o trace.json|-] log...      log ของบอร์ดละไฟล์ หรือรวมไฟล์เดียวก็ได้
+ *
+ * begin/end ของ event เดียวกันบน core เดียวกันรวมเป็น complete event ("X") หนึ่งอัน
+ * เวลาเป็น us ของนาฬิกาใน anchor (Musician ใช้เวลา Conductor) - เปิดใน ui.perfetto.dev หรือ chrome://tracing
+ * ตารางเวลาต่อ event (p50/p99/max) ออก stdout, ออก stderr เมื่อ JSON ไป stdout
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace_ring.h"
+#include "latency_hist.h"
+
+#define DECODE_LINE_MAX     512
+#define DECODE_MAX_OPEN     16          // Nested spans per core
+#define DECODE_BOARDS       257         // TRACE_BOARD_CONDUCTOR and musician IDs 0-255
+#define DECODE_CORES        2
+
+typedef struct {
+    uint8_t event;
+    char phase;                 // 'X' complete, 'i' instant
+    int board;
+    int core;
+    double ts_us;
+    double dur_us;
+    uint16_t arg0;              // Begin record
+    uint32_t arg1;
+    uint16_t end_arg0;
+    uint32_t end_arg1;
+} span_t;
+
+// Records of one core in one dump, decoded when the next header or the end line of the board comes
+typedef struct {
+    bool open;
+    int core;
+    uint32_t ticks_per_us;
+    uint32_t written;
+    trace_record_t* records;
+    size_t count;
+    size_t capacity;
+} section_t;
+
+typedef struct {
+    section_t sections[DECODE_BOARDS];          // Index board + 1
+    bool seen[DECODE_BOARDS][DECODE_CORES];
+    span_t* spans;
+    size_t span_count;
+    size_t span_capacity;
+    uint32_t records;
+    uint32_t overwritten;       // Written on the board but gone from the ring before the dump
+    uint32_t unmatched;         // Begin or end whose other half is missing
+    uint32_t unanchored;        // Sections without any anchor record
+    uint32_t unknown;           // Event IDs newer than this decoder
+    latency_hist_t duration_ns[TRACE_EV_COUNT];
+} decoder_t;
+
+static const char* const event_names[TRACE_EV_COUNT] = TRACE_EVENT_NAMES;
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-52s %s\n", what, ok ? "OK" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static void* grow(void* items, size_t* capacity, size_t size) {
+    *capacity = *capacity ? *capacity * 2 : 256;
+    items = realloc(items, *capacity * size);
+    if (items == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return items;
+}
+
+static span_t* add_span(decoder_t* decoder) {
+    if (decoder->span_count == decoder->span_capacity) {
+        decoder->spans = grow(decoder->spans, &decoder->span_capacity, sizeof(span_t));
+    }
+    span_t* span = &decoder->spans[decoder->span_count++];
+    memset(span, 0, sizeof(*span));
+    return span;
+}
+
+static void finish_section(decoder_t* decoder, int board, section_t* section) {
+    if (!section->open) {
+        return;
+    }
+    section->open = false;
+    decoder->records += section->count;
+    if (section->written > section->count) {
+        decoder->overwritten += section->written - section->count;
+    }
+
+    // Records older than the first anchor (it was overwritten) count back from it
+    size_t first = 0;
+    while (first < section->count && section->records[first].event != TRACE_EV_ANCHOR) {
+        first++;
+    }
+    if (first == section->count || section->ticks_per_us == 0) {
+        decoder->unanchored += section->count > 0;
+        section->count = 0;
+        return;
+    }
+    decoder->seen[board + 1][section->core] = true;
+
+    const trace_record_t* anchor = &section->records[first];
+    span_t open[DECODE_MAX_OPEN];
+    int depth = 0;
+    for (size_t i = 0; i < section->count; i++) {
+        const trace_record_t* record = &section->records[i];
+        if (record->event == TRACE_EV_ANCHOR) {
+            anchor = record;
+            continue;
+        }
+        if (record->event >= TRACE_EV_COUNT) {
+            decoder->unknown++;
+            continue;
+        }
+        int64_t anchor_us = ((int64_t)anchor->arg0 << 32) | anchor->arg1;
+        double ts_us = anchor_us + (int32_t)(record->cycles - anchor->cycles) / (double)section->ticks_per_us;
+
+        if (record->phase == TRACE_BEGIN) {
+            if (depth == DECODE_MAX_OPEN) {
+                decoder->unmatched++;
+                continue;
+            }
+            open[depth++] = (span_t){record->event, 'X', board, section->core, ts_us, 0, record->arg0, record->arg1, 0, 0};
+        } else if (record->phase == TRACE_END) {
+            int match = depth - 1;
+            while (match >= 0 && open[match].event != record->event) {
+                match--;
+            }
+            if (match < 0) {
+                decoder->unmatched++;
+                continue;
+            }
+            span_t* span = add_span(decoder);
+            *span = open[match];
+            span->dur_us = ts_us - span->ts_us;
+            span->end_arg0 = record->arg0;
+            span->end_arg1 = record->arg1;
+            latency_hist_add(&decoder->duration_ns[span->event], (uint32_t)(span->dur_us * 1000));
+            memmove(&open[match], &open[match + 1], (depth - match - 1) * sizeof(span_t));
+            depth--;
+        } else {
+            *add_span(decoder) = (span_t){record->event, 'i', board, section->core, ts_us, 0, record->arg0,
+                                          record->arg1, 0, 0};
+        }
+    }
+    decoder->unmatched += depth;
+    section->count = 0;
+}
+
+static void parse_line(decoder_t* decoder, const char* line) {
+    const char* dump = strstr(line, "TRACE,");
+    int board, used = 0;
+    if (dump == NULL || sscanf(dump, "TRACE,%d,%n", &board, &used) != 1 || used == 0 ||
+        board < TRACE_BOARD_CONDUCTOR || board >= DECODE_BOARDS - 1) {
+        return;
+    }
+    section_t* section = &decoder->sections[board + 1];
+    const char* fields = dump + used;
+    int core;
+    unsigned long ticks, written;
+
+    if (sscanf(fields, "core,%d,%lu,%lu", &core, &ticks, &written) == 3) {
+        finish_section(decoder, board, section);
+        if (core >= 0 && core < DECODE_CORES) {
+            section->open = true;
+            section->core = core;
+            section->ticks_per_us = (uint32_t)ticks;
+            section->written = (uint32_t)written;
+        }
+    } else if (strncmp(fields, "end", 3) == 0) {
+        finish_section(decoder, board, section);
+    } else if (section->open && sscanf(fields, "%d,%n", &core, &used) == 1 && core == section->core) {
+        unsigned long cycles, arg1;
+        unsigned event, phase, arg0;
+        for (const char* hex = fields + used;
+             sscanf(hex, "%8lx%2x%2x%4x%8lx", &cycles, &event, &phase, &arg0, &arg1) == 5; hex += 24) {
+            if (section->count == section->capacity) {
+                section->records = grow(section->records, &section->capacity, sizeof(trace_record_t));
+            }
+            section->records[section->count++] = (trace_record_t){(uint32_t)cycles, (uint8_t)event, (uint8_t)phase,
+                                                                   (uint16_t)arg0, (uint32_t)arg1};
+        }
+    }
+}
+
+static bool parse_file(decoder_t* decoder, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    char line[DECODE_LINE_MAX];
+    while (fgets(line, sizeof(line), file)) {
+        parse_line(decoder, line);
+    }
+    fclose(file);
+    return true;
+}
+
+// Logs cut off in the middle of a dump still give what arrived
+static void finish(decoder_t* decoder) {
+    for (int board = TRACE_BOARD_CONDUCTOR; board < DECODE_BOARDS - 1; board++) {
+        finish_section(decoder, board, &decoder->sections[board + 1]);
+    }
+}
+
+static void decoder_free(decoder_t* decoder) {
+    for (int i = 0; i < DECODE_BOARDS; i++) {
+        free(decoder->sections[i].records);
+    }
+    free(decoder->spans);
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+// pid 0 is the conductor, musician N is pid N + 1
+static void write_json(FILE* out, const decoder_t* decoder) {
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    const char* separator = "";
+    for (int board = TRACE_BOARD_CONDUCTOR; board < DECODE_BOARDS - 1; board++) {
+        bool named = false;
+        for (int core = 0; core < DECODE_CORES; core++) {
+            if (!decoder->seen[board + 1][core]) {
+                continue;
+            }
+            if (!named && board == TRACE_BOARD_CONDUCTOR) {
+                fprintf(out, "%s{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": 0, \"args\": {\"name\": "
+                        "\"conductor\"}}", separator);
+            } else if (!named) {
+                fprintf(out, "%s{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": %d, \"args\": {\"name\": "
+                        "\"musician %d\"}}", separator, board + 1, board);
+            }
+            named = true;
+            fprintf(out, ",\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": %d, \"tid\": %d, \"args\": "
+                    "{\"name\": \"core %d\"}}", board + 1, core, core);
+            separator = ",\n";
+        }
+    }
+    for (size_t i = 0; i < decoder->span_count; i++) {
+        const span_t* span = &decoder->spans[i];
+        fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, ", separator, event_names[span->event],
+                span->phase, span->ts_us);
+        if (span->phase == 'X') {
+            fprintf(out, "\"dur\": %.3f, ", span->dur_us);
+        } else {
+            fprintf(out, "\"s\": \"t\", ");
+        }
+        fprintf(out, "\"pid\": %d, \"tid\": %d, \"args\": {\"arg0\": %u, \"arg1\": %lu", span->board + 1, span->core,
+                span->arg0, (unsigned long)span->arg1);
+        if (span->phase == 'X') {
+            fprintf(out, ", \"end_arg0\": %u, \"end_arg1\": %lu", span->end_arg0, (unsigned long)span->end_arg1);
+        }
+        fprintf(out, "}}");
+        separator = ",\n";
+    }
+    fprintf(out, "\n]}\n");
+}
+
+static void print_summary(FILE* out, const decoder_t* decoder, int files) {
+    fprintf(out, "%lu records from %d files, %lu overwritten before the dump, %lu unmatched, %lu sections "
+            "without anchor\n", (unsigned long)decoder->records, files, (unsigned long)decoder->overwritten,
+            (unsigned long)decoder->unmatched, (unsigned long)decoder->unanchored);
+    fprintf(out, "%-22s %8s | %s\n", "", "", "duration us");
+    fprintf(out, "%-22s %8s | %9s %9s %9s %9s\n", "", "spans", "mean", "p50", "p99", "max");
+    for (int event = 0; event < TRACE_EV_COUNT; event++) {
+        const latency_hist_t* hist = &decoder->duration_ns[event];
+        if (hist->count == 0) {
+            continue;
+        }
+        fprintf(out, "%-22s %8lu | %9.1f %9.1f %9.1f %9.1f\n", event_names[event], (unsigned long)hist->count,
+                latency_hist_mean(hist) / 1000.0, latency_hist_percentile(hist, 500) / 1000.0,
+                latency_hist_percentile(hist, 990) / 1000.0, hist->max / 1000.0);
+    }
+}
+
+// One core of one board as trace_poll() prints it
+static void write_dump(FILE* out, int board, int core, uint32_t ticks_per_us, uint32_t written,
+                       const trace_record_t* records, size_t count) {
+    fprintf(out, "TRACE,%d,core,%d,%lu,%lu\n", board, core, (unsigned long)ticks_per_us, (unsigned long)written);
+    for (size_t i = 0; i < count; i++) {
+        if (i % TRACE_DUMP_PER_LINE == 0) {
+            fprintf(out, "I (1234) MUSICIAN: interleaved log line\nTRACE,%d,%d,", board, core);
+        }
+        fprintf(out, "%08lx%02x%02x%04x%08lx", (unsigned long)records[i].cycles, records[i].event,
+                records[i].phase, records[i].arg0, (unsigned long)records[i].arg1);
+        if (i % TRACE_DUMP_PER_LINE == TRACE_DUMP_PER_LINE - 1 || i == count - 1) {
+            fprintf(out, "\n");
+        }
+    }
+}
+
+static const span_t* find_span(const decoder_t* decoder, int board, uint8_t event) {
+    for (size_t i = 0; i < decoder->span_count; i++) {
+        if (decoder->spans[i].board == board && decoder->spans[i].event == event) {
+            return &decoder->spans[i];
+        }
+    }
+    return NULL;
+}
+
+static bool near(double value, double expected) {
+    return value > expected - 0.01 && value < expected + 0.01;
+}
+
+static int cmd_check(void) {
+    static decoder_t decoder;
+    const uint32_t mhz = 240;
+
+    // Musician 2, core 0: the cycle counter wraps between two records
+    const uint32_t wrap_base = 0xFFFF0000u;
+    trace_record_t core0[] = {
+        {wrap_base, TRACE_EV_ANCHOR, TRACE_INSTANT, 0, 5000000},
+        {wrap_base + mhz * 10, TRACE_EV_RECV, TRACE_BEGIN, 48, 7},
+        {wrap_base + mhz * 30, TRACE_EV_RECV, TRACE_END, 1, 0},
+        {0x1000, TRACE_EV_PLAY_NOTE, TRACE_BEGIN, 60, 250},
+        {0x1000 + mhz * 50, TRACE_EV_PLAY_NOTE, TRACE_END, 0, 0},
+    };
+    // Core 1: the first anchor was overwritten, 1500 records written
+    trace_record_t core1[] = {
+        {1000, TRACE_EV_DISPATCH, TRACE_BEGIN, 7, 48},
+        {1000 + mhz * 100, TRACE_EV_ANCHOR, TRACE_INSTANT, 0, 7000100},
+        {1000 + mhz * 105, TRACE_EV_DISPATCH, TRACE_END, 0, 0},
+    };
+    // Conductor: an end without begin, a begin without end, a nested span
+    trace_record_t conductor[] = {
+        {500, TRACE_EV_ANCHOR, TRACE_INSTANT, 1, 0},
+        {600, TRACE_EV_RECV, TRACE_END, 0, 0},
+        {700, TRACE_EV_SEND_EVENTS, TRACE_BEGIN, 3, 0},
+        {700 + mhz * 2, TRACE_EV_RECV, TRACE_BEGIN, 20, 0},
+        {700 + mhz * 4, TRACE_EV_RECV, TRACE_END, 0, 0},
+        {700 + mhz * 12, TRACE_EV_SEND_EVENTS, TRACE_END, 3, 0},
+        {700 + mhz * 20, TRACE_EV_SEND_EVENTS, TRACE_BEGIN, 0, 0},
+    };
+
+    FILE* log = tmpfile();
+    write_dump(log, 2, 0, mhz, 5, core0, sizeof(core0) / sizeof(core0[0]));
+    write_dump(log, 2, 1, mhz, 1500, core1, sizeof(core1) / sizeof(core1[0]));
+    fprintf(log, "TRACE,2,end\n");
+    write_dump(log, TRACE_BOARD_CONDUCTOR, 0, mhz, 7, conductor, sizeof(conductor) / sizeof(conductor[0]));
+    fprintf(log, "TRACE,-1,end\nTRACE,garbage\nTRACE,3,0,0000\n");
+    rewind(log);
+    char line[DECODE_LINE_MAX];
+    while (fgets(line, sizeof(line), log)) {
+        parse_line(&decoder, line);
+    }
+    fclose(log);
+    finish(&decoder);
+
+    const span_t* recv = find_span(&decoder, 2, TRACE_EV_RECV);
+    const span_t* play = find_span(&decoder, 2, TRACE_EV_PLAY_NOTE);
+    const span_t* dispatch = find_span(&decoder, 2, TRACE_EV_DISPATCH);
+    const span_t* send = find_span(&decoder, TRACE_BOARD_CONDUCTOR, TRACE_EV_SEND_EVENTS);
+    const span_t* nested = find_span(&decoder, TRACE_BOARD_CONDUCTOR, TRACE_EV_RECV);
+    expect(decoder.records == 15 && decoder.span_count == 5, "15 records, 5 spans");
+    expect(recv && near(recv->ts_us, 5000010) && near(recv->dur_us, 20) && recv->arg0 == 48 && recv->end_arg0 == 1,
+           "span: time, duration and both args");
+    expect(play && near(play->ts_us, 5000000 + (0x1000 + 0x10000) / 240.0) && near(play->dur_us, 50),
+           "cycle counter wrap between anchor and record");
+    expect(dispatch && dispatch->core == 1 && near(dispatch->ts_us, 7000000) && near(dispatch->dur_us, 105),
+           "records before the first anchor count back");
+    expect(send && nested && near(send->dur_us, 12) && near(nested->dur_us, 2) &&
+           near(send->ts_us, (1LL << 32) + 200 / 240.0), "conductor: nested spans, 48-bit anchor");
+    expect(decoder.unmatched == 2 && decoder.overwritten == 1497, "unmatched halves and overwritten records");
+    expect(latency_hist_percentile(&decoder.duration_ns[TRACE_EV_RECV], 1000) == 20000, "duration histogram in ns");
+
+    FILE* json = tmpfile();
+    write_json(json, &decoder);
+    rewind(json);
+    int complete = 0, names = 0;
+    bool conductor_named = false;
+    while (fgets(line, sizeof(line), json)) {
+        complete += strstr(line, "\"ph\": \"X\"") != NULL;
+        names += strstr(line, "\"thread_name\"") != NULL;
+        conductor_named |= strstr(line, "\"conductor\"") != NULL;
+    }
+    fclose(json);
+    expect(complete == 5 && names == 3 && conductor_named, "JSON: complete events, process and thread names");
+    decoder_free(&decoder);
+
+    return failures ? 1 : 0;
+}
+
+static int cmd_decode(int argc, char** argv) {
+    static decoder_t decoder;
+    const char* json_path = NULL;
+
+    int files = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (parse_file(&decoder, argv[i])) {
+            files++;
+        } else {
+            return 1;
+        }
+    }
+    finish(&decoder);
+    if (files == 0 || decoder.records == 0) {
+        fprintf(stderr, "no TRACE records (build with TRACE_RING 1, a dump follows every song end)\n");
+        return 1;
+    }
+
+    FILE* table = json_path && strcmp(json_path, "-") == 0 ? stderr : stdout;
+    print_summary(table, &decoder, files);
+    if (json_path) {
+        FILE* json = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (json == NULL) {
+            perror(json_path);
+            return 1;
+        }
+        write_json(json, &decoder);
+        if (json != stdout) {
+            fclose(json);
+        }
+    }
+    decoder_free(&decoder);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check();
+    }
+    if (argc >= 2) {
+        return cmd_decode(argc - 1, argv + 1);
+    }
+
+    fprintf(stderr, "usage: %s check | [-o trace.json|-] log...\n", argv[0]);
+    return 2;
+}